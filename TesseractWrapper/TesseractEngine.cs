@@ -1,4 +1,5 @@
 using System;
+using System.Collections.Generic;
 using System.Drawing;
 using System.Windows.Forms;
 using tesseract;
@@ -39,6 +40,119 @@ namespace TesseractWrapper
 			return this.tp.Init(this.langFilesPath, this.lang, 3);
 		}
 
+		public void EnablePageCache(int maxEntries, int maxMegabytes, string diskDir)
+		{
+			this.tp.EnablePageCache(maxEntries, maxMegabytes, diskDir);
+		}
+
+		public void DisablePageCache()
+		{
+			this.tp.DisablePageCache();
+		}
+
+		public double PageCacheHitRate
+		{
+			get
+			{
+				return this.tp.PageCacheHitRate;
+			}
+		}
+
+		public double PageCacheSavedMilliseconds
+		{
+			get
+			{
+				return this.tp.PageCacheSavedMilliseconds;
+			}
+		}
+
+		public int TimeoutMilliseconds
+		{
+			get
+			{
+				return this.tp.TimeoutMilliseconds;
+			}
+			set
+			{
+				this.tp.TimeoutMilliseconds = value;
+			}
+		}
+
+		public bool DegradeOnDeadline
+		{
+			set
+			{
+				this.tp.SetVariable("tessedit_degrade_on_deadline", value ? "true" : "false");
+			}
+		}
+
+		public int SkippedStages
+		{
+			get
+			{
+				return this.tp.SkippedStages;
+			}
+		}
+
+		public bool EnableAsync(int engineCount)
+		{
+			return this.tp.EnableAsync(engineCount);
+		}
+
+		public void DisableAsync()
+		{
+			this.tp.DisableAsync();
+		}
+
+		public TesseractAsyncJob BeginRecognize(Image img, OCROutputType outputType, int timeoutMilliseconds)
+		{
+			TesseractAsyncJob job;
+			bool hocr = outputType == OCROutputType.HOCR;
+			if (img.get_PixelFormat() != 196865)
+			{
+				job = this.tp.Submit(img, hocr, timeoutMilliseconds);
+			}
+			else
+			{
+				Bitmap bitmap = new Bitmap(img.get_Width(), img.get_Height(), 139273);
+				bitmap.SetResolution(img.get_HorizontalResolution(), img.get_VerticalResolution());
+				Graphics graphic = Graphics.FromImage(bitmap);
+				graphic.DrawImageUnscaled(img, 0, 0);
+				graphic.Dispose();
+				job = this.tp.Submit(bitmap, hocr, timeoutMilliseconds);
+				bitmap.Dispose();
+			}
+			return job;
+		}
+
+		public bool EnableBatch(int engineCount, int readerCount, int queueDepth, int maxMegabytes)
+		{
+			return this.tp.EnableBatch(engineCount, readerCount, queueDepth, maxMegabytes);
+		}
+
+		public void DisableBatch()
+		{
+			this.tp.DisableBatch();
+		}
+
+		public List<BatchResult> Recognize(List<string> filePaths, OCROutputType outputType)
+		{
+			return this.tp.RecognizeBatch(filePaths, outputType == OCROutputType.HOCR);
+		}
+
+		public List<BatchResult> RecognizeFolder(string folderPath, OCROutputType outputType)
+		{
+			return this.tp.RecognizeDirectory(folderPath, outputType == OCROutputType.HOCR);
+		}
+
+		public BatchStats LastBatchStats
+		{
+			get
+			{
+				return this.tp.LastBatchStats;
+			}
+		}
+
 		public string Recognize(string filePath, OCROutputType outputType)
 		{
 			string str;
@@ -0,0 +1,257 @@
+///////////////////////////////////////////////////////////////////////
+// File:        asyncapi.cpp
+// Description: Non-blocking page recognition on a pool of engines, with
+//              cancellation and progress reporting.
+// Created:     Tue Oct 13 14:37:05 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include "asyncapi.h"
+#include "allheaders.h"
+#include "baseapi.h"
+#include "ocrclass.h"
+#include "textrenderer.h"
+
+namespace tesseract {
+
+// Runs one job on a worker of the engine's pool.
+class TessAsyncTask : public TessClosure {
+ public:
+  TessAsyncTask(TessAsyncEngine* engine, TessAsyncJob* job)
+    : engine_(engine), job_(job) {}
+  virtual void Run() {
+    engine_->RunJob(job_);
+  }
+
+ private:
+  TessAsyncEngine* engine_;
+  TessAsyncJob* job_;
+};
+
+TessAsyncJob::TessAsyncJob(TessAsyncEngine* engine, Pix* pix,
+                           const TessJobOptions& options,
+                           TessCallback1<TessAsyncJob*>* done_callback)
+  : engine_(engine), pix_(pix), options_(options),
+    done_callback_(done_callback), state_(TJS_QUEUED),
+    cancel_requested_(false), monitor_(NULL), progress_(0), refs_(2) {
+}
+
+TessAsyncJob::~TessAsyncJob() {
+  if (pix_ != NULL)
+    pixDestroy(&pix_);
+  delete done_callback_;
+}
+
+// Only sets the flag, so that Finish, and with it done_callback, always
+// runs on a worker thread and never on the thread that cancels, which may
+// hold locks of its own. A queued job is finished as soon as a worker
+// reaches it, without taking an engine.
+void TessAsyncJob::Cancel() {
+  mutex_.Lock();
+  cancel_requested_ = true;
+  mutex_.Unlock();
+}
+
+int TessAsyncJob::Progress() {
+  mutex_.Lock();
+  int progress = monitor_ != NULL ? monitor_->progress : progress_;
+  mutex_.Unlock();
+  return progress;
+}
+
+TessJobState TessAsyncJob::state() {
+  mutex_.Lock();
+  TessJobState current = state_;
+  mutex_.Unlock();
+  return current;
+}
+
+bool TessAsyncJob::Wait(int timeout_msecs) {
+  return finished_.Wait(timeout_msecs);
+}
+
+void TessAsyncJob::Release() {
+  mutex_.Lock();
+  bool last = --refs_ == 0;
+  mutex_.Unlock();
+  if (last)
+    delete this;
+}
+
+void TessAsyncJob::Finish(TessJobState final_state) {
+  mutex_.Lock();
+  if (state_ != TJS_QUEUED && state_ != TJS_RUNNING) {
+    // Already final.
+    mutex_.Unlock();
+    return;
+  }
+  state_ = final_state;
+  monitor_ = NULL;
+  if (final_state == TJS_DONE)
+    progress_ = 100;
+  mutex_.Unlock();
+  if (done_callback_ != NULL)
+    done_callback_->Run(this);
+  finished_.Signal();
+}
+
+// Checked by recog_all_words at every word, and by Recognize after layout
+// analysis.
+bool TessAsyncJob::CancelFunc(void* cancel_this, int words) {
+  TessAsyncJob* job = reinterpret_cast<TessAsyncJob*>(cancel_this);
+  TessAsyncEngine* engine = job->engine_;
+  engine->mutex_.Lock();
+  bool shutting_down = engine->shutting_down_;
+  engine->mutex_.Unlock();
+  job->mutex_.Lock();
+  if (shutting_down)
+    job->cancel_requested_ = true;
+  bool cancel = job->cancel_requested_;
+  job->mutex_.Unlock();
+  return cancel;
+}
+
+TessAsyncEngine::TessAsyncEngine() : pool_(NULL), shutting_down_(false) {
+}
+
+TessAsyncEngine::~TessAsyncEngine() {
+  End();
+}
+
+bool TessAsyncEngine::Init(const char* datapath, const char* language,
+                           OcrEngineMode oem, int num_engines) {
+  End();
+  if (num_engines <= 0)
+    num_engines = ThreadPool::NumProcessors();
+  for (int i = 0; i < num_engines; ++i) {
+    TessBaseAPI* api = new TessBaseAPI;
+    if (api->Init(datapath, language, oem) < 0) {
+      delete api;
+      End();
+      return false;
+    }
+    engines_.push_back(api);
+    free_engines_.push_back(api);
+  }
+  shutting_down_ = false;
+  // One worker per engine, so a worker never waits for an engine.
+  pool_ = new ThreadPool(num_engines);
+  return true;
+}
+
+bool TessAsyncEngine::SetVariable(const char* name, const char* value) {
+  for (int i = 0; i < engines_.size(); ++i) {
+    if (!engines_[i]->SetVariable(name, value))
+      return false;
+  }
+  return !engines_.empty();
+}
+
+TessAsyncJob* TessAsyncEngine::Submit(
+    const Pix* pix, const TessJobOptions& options,
+    TessCallback1<TessAsyncJob*>* done_callback) {
+  if (pool_ == NULL || pix == NULL) {
+    delete done_callback;
+    return NULL;
+  }
+  Pix* copy = pixCopy(NULL, const_cast<Pix*>(pix));
+  TessAsyncJob* job = new TessAsyncJob(this, copy, options, done_callback);
+  pool_->Schedule(new TessAsyncTask(this, job));
+  return job;
+}
+
+void TessAsyncEngine::End() {
+  if (pool_ != NULL) {
+    // Queued jobs are finished as cancelled by RunJob, and running ones
+    // see shutting_down_ at their next cancel check.
+    mutex_.Lock();
+    shutting_down_ = true;
+    mutex_.Unlock();
+    delete pool_;
+    pool_ = NULL;
+  }
+  for (int i = 0; i < engines_.size(); ++i) {
+    engines_[i]->End();
+    delete engines_[i];
+  }
+  engines_.clear();
+  free_engines_.clear();
+}
+
+TessBaseAPI* TessAsyncEngine::AcquireEngine() {
+  mutex_.Lock();
+  TessBaseAPI* api = NULL;
+  if (!free_engines_.empty()) {
+    api = free_engines_[free_engines_.size() - 1];
+    free_engines_.truncate(free_engines_.size() - 1);
+  }
+  mutex_.Unlock();
+  return api;
+}
+
+void TessAsyncEngine::ReleaseEngine(TessBaseAPI* api) {
+  mutex_.Lock();
+  free_engines_.push_back(api);
+  mutex_.Unlock();
+}
+
+void TessAsyncEngine::RunJob(TessAsyncJob* job) {
+  ETEXT_DESC monitor;
+  monitor.cancel = &TessAsyncJob::CancelFunc;
+  monitor.cancel_this = job;
+  if (job->options_.timeout_msecs > 0)
+    monitor.set_deadline_msecs(job->options_.timeout_msecs);
+
+  bool skip = TessAsyncJob::CancelFunc(job, 0);
+  job->mutex_.Lock();
+  skip = skip || job->state_ != TJS_QUEUED;
+  if (!skip) {
+    job->state_ = TJS_RUNNING;
+    job->monitor_ = &monitor;
+  }
+  job->mutex_.Unlock();
+  TessBaseAPI* api = skip ? NULL : AcquireEngine();
+  if (api == NULL) {
+    job->Finish(TJS_CANCELLED);
+    job->Release();
+    return;
+  }
+
+  api->SetPageSegMode(job->options_.pageseg_mode);
+  api->SetImage(job->pix_);
+  bool ok = api->Recognize(&monitor) >= 0;
+  // recog_all_words returns normally when cancelled, so ask again.
+  bool cancelled = TessAsyncJob::CancelFunc(job, 0);
+  if (ok && !cancelled) {
+    // Rendered straight into the job, without a string in between.
+    TextBuffer text;
+    TextBuffer* buffers[TF_COUNT] = { NULL };
+    if (job->options_.hocr) {
+      api->SetInputName(job->options_.input_name.string());
+      buffers[TF_HOCR] = &text;
+    } else {
+      buffers[TF_UTF8] = &text;
+    }
+    if (api->RenderText(job->options_.page_number, buffers))
+      text.AppendTo(&job->text_);
+    else
+      ok = false;
+  }
+  api->Clear();
+  ReleaseEngine(api);
+  pixDestroy(&job->pix_);
+  job->Finish(cancelled ? TJS_CANCELLED : (ok ? TJS_DONE : TJS_FAILED));
+  job->Release();
+}
+
+}  // namespace tesseract.
@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////
+// File:        asyncapi.h
+// Description: Non-blocking page recognition on a pool of engines, with
+//              cancellation and progress reporting.
+// Created:     Tue Oct 13 14:37:05 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_API_ASYNCAPI_H__
+#define TESSERACT_API_ASYNCAPI_H__
+
+#include "apitypes.h"
+#include "ccutil.h"
+#include "genericvector.h"
+#include "strngs.h"
+#include "tesscallback.h"
+#include "threadpool.h"
+
+class ETEXT_DESC;
+struct Pix;
+
+namespace tesseract {
+
+class TessAsyncEngine;
+class TessBaseAPI;
+
+// Lifecycle of a TessAsyncJob. TJS_DONE, TJS_FAILED and TJS_CANCELLED are
+// final.
+enum TessJobState {
+  TJS_QUEUED,
+  TJS_RUNNING,
+  TJS_DONE,
+  TJS_FAILED,
+  TJS_CANCELLED
+};
+
+// Per-page settings for TessAsyncEngine::Submit.
+struct TessJobOptions {
+  TessJobOptions()
+    : pageseg_mode(PSM_AUTO), hocr(false), page_number(0),
+      timeout_msecs(0) {}
+
+  PageSegMode pageseg_mode;
+  bool hocr;            // hOCR output instead of plain UTF-8.
+  int page_number;      // Used in the hOCR page id.
+  int timeout_msecs;    // Deadline for recognition, 0 for none.
+  STRING input_name;    // Image name for the hOCR output.
+};
+
+// Handle on a page submitted to a TessAsyncEngine. The submitter holds one
+// reference and must call Release when done with the handle, whether or not
+// the job has finished; the engine holds another until the job is final.
+class TessAsyncJob {
+ public:
+  // Asks the job to stop. A queued job is cancelled when a worker reaches
+  // it, without being recognized. A running job stops at the next word
+  // boundary and its engine goes back to the pool; there is no result.
+  // Either way the job becomes final, and done_callback runs, on the
+  // worker thread, so Cancel may be called with locks held that the
+  // callback takes.
+  void Cancel();
+  // Returns the recognition progress as a percentage, 0-100.
+  int Progress();
+  TessJobState state();
+  bool IsFinal() {
+    TessJobState current = state();
+    return current != TJS_QUEUED && current != TJS_RUNNING;
+  }
+  // Blocks until the job is final or timeout_msecs has passed, forever if
+  // negative. Returns true if the job is final.
+  bool Wait(int timeout_msecs);
+  // The recognized text. Only valid once the state is TJS_DONE.
+  const STRING& text() const {
+    return text_;
+  }
+
+  void Release();
+
+ private:
+  friend class TessAsyncEngine;
+  friend class TessAsyncTask;
+
+  TessAsyncJob(TessAsyncEngine* engine, Pix* pix,
+               const TessJobOptions& options,
+               TessCallback1<TessAsyncJob*>* done_callback);
+  ~TessAsyncJob();
+
+  // Moves the job to a final state, wakes waiters and runs the callback.
+  void Finish(TessJobState final_state);
+  // CANCEL_FUNC hooked into the ETEXT_DESC used while the job runs.
+  static bool CancelFunc(void* cancel_this, int words);
+
+  TessAsyncEngine* engine_;
+  Pix* pix_;                   // Owned copy of the page, freed when run.
+  TessJobOptions options_;
+  // Owned, so permanent. May be NULL.
+  TessCallback1<TessAsyncJob*>* done_callback_;
+  STRING text_;
+
+  CCUtilMutex mutex_;          // Guards all that follows.
+  TessJobState state_;
+  bool cancel_requested_;
+  ETEXT_DESC* monitor_;        // Valid only while TJS_RUNNING.
+  int progress_;               // Progress when not running.
+  int refs_;
+  ThreadEvent finished_;
+};
+
+// Runs recognition of submitted pages on a fixed set of engines, each with
+// its own worker thread, so a caller never blocks on a page. All engines
+// share the same language, engine mode and variables.
+class TessAsyncEngine {
+ public:
+  TessAsyncEngine();
+  // Cancels any outstanding jobs and waits for the workers to stop.
+  ~TessAsyncEngine();
+
+  // Creates and initializes num_engines engines (one per processor if
+  // <= 0) with the arguments of TessBaseAPI::Init, and starts their
+  // workers. Returns false if any engine fails to initialize.
+  bool Init(const char* datapath, const char* language, OcrEngineMode oem,
+            int num_engines);
+  // Sets a variable on every engine. Only call when no jobs are running.
+  bool SetVariable(const char* name, const char* value);
+
+  // Queues pix for recognition and returns immediately. The image is copied,
+  // so the caller may destroy it at once. done_callback, if not NULL, is run
+  // on the worker thread when the job becomes final, and is deleted with
+  // the job, so it must be made with NewPermanentTessCallback: one that
+  // deletes itself would be freed twice. Returns NULL if the engine has not
+  // been initialized.
+  TessAsyncJob* Submit(const Pix* pix, const TessJobOptions& options,
+                       TessCallback1<TessAsyncJob*>* done_callback);
+
+  int num_engines() const {
+    return engines_.size();
+  }
+
+  // Cancels outstanding jobs, stops the workers and frees the engines.
+  void End();
+
+ private:
+  friend class TessAsyncJob;
+  friend class TessAsyncTask;
+
+  TessBaseAPI* AcquireEngine();
+  void ReleaseEngine(TessBaseAPI* api);
+  // Runs the job on an engine from the pool. Called on a worker thread.
+  void RunJob(TessAsyncJob* job);
+
+  GenericVector<TessBaseAPI*> engines_;
+  ThreadPool* pool_;
+  CCUtilMutex mutex_;          // Guards free_engines_ and shutting_down_.
+  GenericVector<TessBaseAPI*> free_engines_;
+  bool shutting_down_;
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_API_ASYNCAPI_H__
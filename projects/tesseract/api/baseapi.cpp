@@ -36,9 +36,16 @@
 #define _(x) (x)
 #endif
 
+#include <math.h>
+
 #include "baseapi.h"
 
 #include "resultiterator.h"
+#include "striprecognizer.h"
+#include "textrenderer.h"
+#include "blobbox.h"
+#include "tesscallback.h"
+#include "threadpool.h"
 #include "thresholder.h"
 #include "tesseractmain.h"
 #include "tesseractclass.h"
@@ -58,6 +65,9 @@
 #include "permute.h"
 #include "otsuthr.h"
 #include "osdetect.h"
+#include "pagecache.h"
+#include "tesslog.h"
+#include "tiffpagesource.h"
 
 #ifdef __MSW32__
 #include "version.h"
@@ -67,12 +77,6 @@ namespace tesseract {
 
 // Minimum sensible image size to be worth running tesseract.
 const int kMinRectSize = 10;
-// Character returned when Tesseract couldn't recognize as anything.
-const char kTesseractReject = '~';
-// Character used by UNLV error counter as a reject.
-const char kUNLVReject = '~';
-// Character used by UNLV as a suspect marker.
-const char kUNLVSuspect = '^';
 // Filename used for input image file, from which to derive a name to search
 // for a possible UNLV zone file, if none is specified by SetInputName.
 const char* kInputFile = "noname.tif";
@@ -80,6 +84,16 @@ const char* kInputFile = "noname.tif";
 const char* kOldVarsFile = "failed_vars.txt";
 // Max string length of an int.
 const int kMaxIntSize = 22;
+// Text buffers are sized for the output of the last page, plus this
+// fraction of it, so that a page with a little more text still fits.
+const int kTextSizeSlack = 8;
+
+// Returns the current wall clock time in milliseconds.
+static double ElapsedMsecs() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec * 1000.0 + now.tv_usec / 1000.0;
+}
 
 TessBaseAPI::TessBaseAPI()
   : tesseract_(NULL),
@@ -96,12 +110,19 @@ TessBaseAPI::TessBaseAPI()
     language_(NULL),
     last_oem_requested_(OEM_DEFAULT),
     recognition_done_(false),
+    page_cache_(NULL),
+    log_sink_(NULL),
+    strip_recognizer_(NULL),
+    strip_results_(false),
     rect_left_(0), rect_top_(0), rect_width_(0), rect_height_(0),
     image_width_(0), image_height_(0) {
+  for (int f = 0; f < TF_COUNT; ++f)
+    text_size_hints_[f] = 0;
 }
 
 TessBaseAPI::~TessBaseAPI() {
   End();
+  delete log_sink_;
 }
 
 /**
@@ -128,6 +149,14 @@ void TessBaseAPI::SetOutputName(const char* name) {
     *output_file_ = name;
 }
 
+// Send the output of this instance to the named file, or to the global
+// tprintf destination if name is NULL.
+void TessBaseAPI::SetLogFile(const char* name) {
+  // The destructor writes out anything still queued for the old file.
+  delete log_sink_;
+  log_sink_ = name != NULL ? new TessLogSink(name) : NULL;
+}
+
 bool TessBaseAPI::SetVariable(const char* name, const char* value) {
   if (tesseract_ == NULL) tesseract_ = new Tesseract;
   return ParamUtils::SetParam(name, value, false, tesseract_->params());
@@ -187,6 +216,7 @@ void TessBaseAPI::PrintVariables(FILE *fp) const {
 int TessBaseAPI::Init(const char* datapath, const char* language,
                       OcrEngineMode oem, char **configs, int configs_size,
                       bool configs_init_only) {
+  TessLogSinkScope log_scope(log_sink_);
   // If the datapath, OcrEngineMode or the language have changed - start again.
   // Note that the language_ field stores the last requested language that was
   // initialized successfully, while tesseract_->lang stores the language
@@ -228,6 +258,35 @@ int TessBaseAPI::Init(const char* datapath, const char* language,
   return 0;
 }
 
+// Copies the value of every member parameter in from_vec to the parameter
+// of the same name in to.
+template <class T>
+static void CopyParamValues(const GenericVector<T*>& from_vec,
+                            ParamsVectors* from, ParamsVectors* to) {
+  for (int i = 0; i < from_vec.size(); ++i) {
+    STRING value;
+    const char* name = from_vec[i]->name_str();
+    if (ParamUtils::GetParamAsString(name, from, &value))
+      ParamUtils::SetParam(name, value.string(), false, to);
+  }
+}
+
+// Start tesseract as other was started, with its variables.
+int TessBaseAPI::InitLike(TessBaseAPI* other) {
+  if (other->tesseract_ == NULL || other->datapath_ == NULL)
+    return -1;
+  if (Init(other->datapath_->string(), other->tesseract_->lang.string(),
+           other->last_oem_requested_) < 0)
+    return -1;
+  ParamsVectors* from = other->tesseract_->params();
+  ParamsVectors* to = tesseract_->params();
+  CopyParamValues(from->int_params, from, to);
+  CopyParamValues(from->bool_params, from, to);
+  CopyParamValues(from->string_params, from, to);
+  CopyParamValues(from->double_params, from, to);
+  return 0;
+}
+
 // Init only the lang model component of Tesseract. The only functions
 // that work after this init are SetVariable and IsValidWord.
 // WARNING: temporary! This function will be removed from here and placed
@@ -351,8 +410,11 @@ void TessBaseAPI::SetRectangle(int left, int top, int width, int height) {
 Pix* TessBaseAPI::GetThresholdedImage() {
   if (tesseract_ == NULL)
     return NULL;
-  if (tesseract_->pix_binary() == NULL)
+  if (tesseract_->pix_binary() == NULL) {
+    if (thresholder_ == NULL || thresholder_->IsEmpty())
+      return NULL;
     Threshold(tesseract_->mutable_pix_binary());
+  }
   return pixClone(tesseract_->pix_binary());
 }
 
@@ -393,31 +455,53 @@ Boxa* TessBaseAPI::GetWords(Pixa** pixa) {
 // as an array of one element per component. delete [] after use.
 Boxa* TessBaseAPI::GetComponentImages(PageIteratorLevel level,
                                       Pixa** pixa, int** blockids) {
+  return GetComponents(level, false, pixa, blockids);
+}
+
+// As GetComponentImages, but with boxes into a clone of the thresholded
+// image in place of an image per component.
+Boxa* TessBaseAPI::GetComponentViews(PageIteratorLevel level,
+                                     Pix** pix, int** blockids) {
+  Boxa* boxa = GetComponents(level, true, NULL, blockids);
+  if (boxa != NULL)
+    *pix = pixClone(tesseract_->pix_binary());
+  return boxa;
+}
+
+// Walks the components at the given level once. The Boxa and Pixa grow as
+// they go, and the block ids are copied out at the end.
+Boxa* TessBaseAPI::GetComponents(PageIteratorLevel level, bool in_binary,
+                                 Pixa** pixa, int** blockids) {
   PageIterator* page_it = GetIterator();
   if (page_it == NULL)
     page_it = AnalyseLayout();
   if (page_it == NULL)
     return NULL;  // Failed.
 
-  // Count the components to get a size for the arrays.
-  int component_count = 0;
-  int left, top, right, bottom;
-  do {
-    if (page_it->BoundingBox(level, &left, &top, &right, &bottom))
-      ++component_count;
-  } while (page_it->Next(level));
-
-  Boxa* boxa = boxaCreate(component_count);
+  Boxa* boxa = boxaCreate(0);
   if (pixa != NULL)
-    *pixa = pixaCreate(component_count);
-  if (blockids != NULL)
-    *blockids = new int[component_count];
-
+    *pixa = pixaCreate(0);
+  GenericVector<int> ids;
+  int binary_width = 0;
+  int binary_height = 0;
+  if (in_binary) {
+    binary_width = pixGetWidth(tesseract_->pix_binary());
+    binary_height = pixGetHeight(tesseract_->pix_binary());
+  }
   int blockid = 0;
-  int component_index = 0;
-  page_it->Begin();
+  int left, top, right, bottom;
   do {
-    if (page_it->BoundingBox(level, &left, &top, &right, &bottom)) {
+    bool found = in_binary
+        ? page_it->BinaryImageBox(level, &left, &top, &right, &bottom)
+        : page_it->BoundingBox(level, &left, &top, &right, &bottom);
+    if (found && in_binary) {
+      left = MAX(left, 0);
+      top = MAX(top, 0);
+      right = MIN(right, binary_width);
+      bottom = MIN(bottom, binary_height);
+      found = left < right && top < bottom;
+    }
+    if (found) {
       Box* lbox = boxCreate(left, top, right - left, bottom - top);
       boxaAddBox(boxa, lbox, L_INSERT);
       if (pixa != NULL) {
@@ -426,14 +510,18 @@ Boxa* TessBaseAPI::GetComponentImages(PageIteratorLevel level,
         pixaAddBox(*pixa, lbox, L_CLONE);
       }
       if (blockids != NULL) {
-        (*blockids)[component_index] = blockid;
+        ids.push_back(blockid);
         if (page_it->IsAtFinalElement(RIL_BLOCK, level))
           ++blockid;
       }
-      ++component_index;
     }
   } while (page_it->Next(level));
   delete page_it;
+  if (blockids != NULL) {
+    *blockids = new int[ids.size()];
+    for (int i = 0; i < ids.size(); ++i)
+      (*blockids)[i] = ids[i];
+  }
   return boxa;
 }
 
@@ -526,8 +614,14 @@ PageIterator* TessBaseAPI::AnalyseLayout() {
 int TessBaseAPI::Recognize(ETEXT_DESC* monitor) {
   if (tesseract_ == NULL)
     return -1;
+  TessLogSinkScope log_scope(log_sink_);
   if (FindLines() != 0)
     return -1;
+  // Layout analysis cannot be interrupted, so this is the first chance a
+  // cancelled caller has to get the engine back.
+  if (monitor != NULL && monitor->cancel != NULL &&
+      (*monitor->cancel)(monitor->cancel_this, 0))
+    return -1;
   if (page_res_ != NULL)
     delete page_res_;
 
@@ -560,11 +654,265 @@ int TessBaseAPI::Recognize(ETEXT_DESC* monitor) {
     fclose(training_output_file);
   } else {
     // Now run the main recognition.
-    tesseract_->recog_all_words(page_res_, monitor, NULL, NULL, 0);
+    double start_msecs = ElapsedMsecs();
+    tesseract_->recog_all_words(page_res_, monitor, NULL, NULL, 0, true);
+    stage_times_.recognize_msecs = ElapsedMsecs() - start_msecs;
   }
   return 0;
 }
 
+// Makes the rows and words of the blocks of a page one block at a time,
+// on a worker thread, handing each block over to the recognizing thread as
+// soon as it is ready. Blocks are handed over in reading order, each in a
+// BLOCK_LIST of its own that the receiver then owns.
+// Textord and recognition both work on the one Tesseract: recognition uses
+// its Textord to clean up single row results, and textord keeps state of
+// its own between calls, so neither is safe to run alongside the other.
+// They take turns under LockEngine instead. What overlaps the textord of a
+// block is the rest of the work on the block before it: the block callback
+// and the merging of its results, which only touch the block's own
+// PAGE_RES and the Tesseract's read-only unicharset and params.
+class BlockLayoutPipeline {
+ public:
+  // Takes over the blocks and TO_BLOCKs found by FindBlocks. Messages from
+  // the worker thread go to log_sink, which may be NULL.
+  BlockLayoutPipeline(Tesseract* tess, PageSegMode pageseg_mode,
+                      BLOCK_LIST* blocks, TO_BLOCK_LIST* to_blocks,
+                      TessLogSink* log_sink)
+    : tess_(tess), pageseg_mode_(pageseg_mode), log_sink_(log_sink),
+      stop_(false), finished_(false), next_ready_(0), layout_msecs_(0.0) {
+    BLOCK_IT(&blocks_).add_list_after(blocks);
+    TO_BLOCK_IT(&to_blocks_).add_list_after(to_blocks);
+  }
+  ~BlockLayoutPipeline() {
+    for (int i = next_ready_; i < ready_.size(); ++i)
+      delete ready_[i];
+  }
+
+  // Run on the worker thread. Makes the rows and words of each block in
+  // turn, until all are done or Stop is called.
+  void MakeBlocks() {
+    TessLogSinkScope log_scope(log_sink_);
+    bool had_to_blocks = !to_blocks_.empty();
+    while (!blocks_.empty() && !stop_) {
+      double start_msecs = ElapsedMsecs();
+      BLOCK_IT block_it(&blocks_);
+      BLOCK* block = block_it.extract();
+      BLOCK_LIST* block_list = new BLOCK_LIST;
+      BLOCK_IT(block_list).add_to_end(block);
+      // Blocks found by layout analysis come with a TO_BLOCK, without which
+      // they have no blobs to make rows of. If layout analysis made none,
+      // textord makes them from the block.
+      TO_BLOCK_LIST to_block_list;
+      bool make_rows = !had_to_blocks;
+      TO_BLOCK_IT to_it(&to_blocks_);
+      for (to_it.mark_cycle_pt(); !to_it.cycled_list(); to_it.forward()) {
+        if (to_it.data()->block == block) {
+          TO_BLOCK_IT(&to_block_list).add_to_end(to_it.extract());
+          make_rows = true;
+          break;
+        }
+      }
+      if (make_rows) {
+        LockEngine();
+        tess_->TextordBlocks(pageseg_mode_, block_list, &to_block_list);
+        UnlockEngine();
+      }
+      mutex_.Lock();
+      layout_msecs_ += ElapsedMsecs() - start_msecs;
+      ready_.push_back(block_list);
+      mutex_.Unlock();
+      block_ready_.Signal();
+    }
+    mutex_.Lock();
+    finished_ = true;
+    mutex_.Unlock();
+    block_ready_.Signal();
+  }
+
+  // Waits for the next block and returns it, or returns NULL when there
+  // are no more.
+  BLOCK_LIST* NextBlock() {
+    for (;;) {
+      mutex_.Lock();
+      if (next_ready_ < ready_.size()) {
+        BLOCK_LIST* block_list = ready_[next_ready_++];
+        mutex_.Unlock();
+        return block_list;
+      }
+      if (finished_) {
+        mutex_.Unlock();
+        return NULL;
+      }
+      block_ready_.Reset();
+      mutex_.Unlock();
+      block_ready_.Wait(-1);
+    }
+  }
+
+  // Held while the Tesseract is in use, by textord on the worker thread and
+  // by recognition on the receiving thread.
+  void LockEngine() {
+    engine_mutex_.Lock();
+  }
+  void UnlockEngine() {
+    engine_mutex_.Unlock();
+  }
+
+  // Stops making blocks after the one in progress, if any.
+  void Stop() {
+    stop_ = true;
+  }
+
+  // Moves the blocks that were never made to the end of blocks. Only valid
+  // once NextBlock has returned NULL.
+  void ReturnUnmadeBlocks(BLOCK_LIST* blocks) {
+    BLOCK_IT block_it(blocks);
+    block_it.move_to_last();
+    block_it.add_list_after(&blocks_);
+  }
+
+  // Wall-clock time spent making blocks so far.
+  double layout_msecs() {
+    mutex_.Lock();
+    double msecs = layout_msecs_;
+    mutex_.Unlock();
+    return msecs;
+  }
+
+ private:
+  Tesseract* tess_;
+  PageSegMode pageseg_mode_;
+  TessLogSink* log_sink_;
+  BLOCK_LIST blocks_;        // Blocks still to make, in reading order.
+  TO_BLOCK_LIST to_blocks_;  // Their TO_BLOCKs, if layout analysis made any.
+  volatile bool stop_;
+  CCUtilMutex engine_mutex_;
+  // The fields below are guarded by mutex_.
+  CCUtilMutex mutex_;
+  ThreadEvent block_ready_;
+  bool finished_;
+  GenericVector<BLOCK_LIST*> ready_;  // Made blocks, from next_ready_ on.
+  int next_ready_;
+  double layout_msecs_;
+};
+
+// Runs BlockLayoutPipeline::MakeBlocks on a worker thread.
+class BlockLayoutTask : public TessClosure {
+ public:
+  explicit BlockLayoutTask(BlockLayoutPipeline* pipeline)
+    : pipeline_(pipeline) {}
+  virtual void Run() {
+    pipeline_->MakeBlocks();
+  }
+
+ private:
+  BlockLayoutPipeline* pipeline_;
+};
+
+// Recognizes the page a block at a time, running block_callback on the
+// results of each block as soon as it is done.
+int TessBaseAPI::RecognizeByBlock(
+    ETEXT_DESC* monitor, TessCallback1<ResultIterator*>* block_callback) {
+  if (tesseract_ == NULL)
+    return -1;
+  // A layout from AnalyseLayout has its rows and words made already, and
+  // the other modes here need the whole page at once.
+  int psm = tesseract_->tessedit_pageseg_mode;
+  if ((!recognition_done_ && block_list_ != NULL && !block_list_->empty()) ||
+      psm == PSM_OSD_ONLY || psm == PSM_AUTO_ONLY ||
+      tesseract_->tessedit_resegment_from_boxes ||
+      tesseract_->tessedit_resegment_from_line_boxes ||
+      tesseract_->tessedit_make_boxes_from_boxes ||
+      tesseract_->tessedit_train_from_boxes ||
+      tesseract_->tessedit_ambigs_training ||
+      tesseract_->interactive_mode) {
+    if (Recognize(monitor) != 0)
+      return -1;
+    ResultIterator* it = GetIterator();
+    if (it != NULL) {
+      block_callback->Run(it);
+      delete it;
+    }
+    return 0;
+  }
+  TessLogSinkScope log_scope(log_sink_);
+  TO_BLOCK_LIST to_blocks;
+  PageSegMode pageseg_mode;
+  if (FindBlocks(&to_blocks, &pageseg_mode) != 0)
+    return -1;
+  if (monitor != NULL && monitor->cancel != NULL &&
+      (*monitor->cancel)(monitor->cancel_this, 0))
+    return -1;
+  // The pipeline takes the blocks, and gives each back to block_list_,
+  // and its results to page_res_, once it is recognized.
+  BlockLayoutPipeline pipeline(tesseract_, pageseg_mode, block_list_,
+                               &to_blocks, log_sink_);
+  if (page_res_ != NULL)
+    delete page_res_;
+  tesseract_->SetBlackAndWhitelist();
+  // The passes over the whole page are left out of the recognition of each
+  // block: the adaptive classifier is reset here, if full, as at the start
+  // of the page, and the modal font is applied once all blocks are done.
+  if (tesseract_->AdaptiveClassifierIsFull())
+    tesseract_->ResetAdaptiveClassifier();
+  recognition_done_ = true;
+  page_res_ = new PAGE_RES(block_list_, &tesseract_->prev_word_best_choice_);
+  int result = 0;
+  double recognize_msecs = 0.0;
+  {
+    // Declared after the pipeline, so its worker is joined before the
+    // pipeline goes away.
+    ThreadPool pool(1);
+    pool.Schedule(new BlockLayoutTask(&pipeline));
+    BLOCK_LIST* block_list;
+    while ((block_list = pipeline.NextBlock()) != NULL) {
+      if (result == 0) {
+        double start_msecs = ElapsedMsecs();
+        PAGE_RES* block_res =
+            new PAGE_RES(block_list, &tesseract_->prev_word_best_choice_);
+        pipeline.LockEngine();
+        tesseract_->recog_all_words(block_res, monitor, NULL, NULL, 0, false);
+        pipeline.UnlockEngine();
+        recognize_msecs += ElapsedMsecs() - start_msecs;
+        ResultIterator* it =
+            new ResultIterator(block_res, tesseract_,
+                               thresholder_->GetScaleFactor(),
+                               thresholder_->GetScaledYResolution(),
+                               rect_left_, rect_top_,
+                               rect_width_, rect_height_);
+        block_callback->Run(it);
+        delete it;
+        // Adds the results of the block to those of the page.
+        BLOCK_RES_IT block_res_it(&page_res_->block_res_list);
+        block_res_it.move_to_last();
+        block_res_it.add_list_after(&block_res->block_res_list);
+        page_res_->char_count += block_res->char_count;
+        page_res_->rej_count += block_res->rej_count;
+        page_res_->skipped_stages |= block_res->skipped_stages;
+        delete block_res;
+        if (monitor != NULL && monitor->cancel != NULL &&
+            (*monitor->cancel)(monitor->cancel_this, 0)) {
+          pipeline.Stop();
+          result = -1;
+        }
+      }
+      BLOCK_IT block_it(block_list_);
+      block_it.move_to_last();
+      block_it.add_list_after(block_list);
+      delete block_list;
+    }
+  }
+  pipeline.ReturnUnmadeBlocks(block_list_);
+  if (result == 0 && (page_res_->skipped_stages & RS_FONTS) == 0) {
+    PAGE_RES_IT page_res_it(page_res_);
+    tesseract_->modal_font_pass(page_res_it);
+  }
+  stage_times_.layout_msecs += pipeline.layout_msecs();
+  stage_times_.recognize_msecs = recognize_msecs;
+  return result;
+}
+
 // Tests the chopper by exhaustively running chop_one_blob.
 int TessBaseAPI::RecognizeForChopTest(ETEXT_DESC* monitor) {
   if (tesseract_ == NULL)
@@ -596,6 +944,32 @@ int TessBaseAPI::RecognizeForChopTest(ETEXT_DESC* monitor) {
   return 0;
 }
 
+// Trains on the page with the boxes of the given page, writing the
+// features to tr_file.
+int TessBaseAPI::TrainFromBoxes(const BoxFileIndex& boxes, int page,
+                                bool find_segmentation,
+                                const char* output_name, FILE* tr_file) {
+  if (tesseract_ == NULL)
+    return -1;
+  if (thresholder_ == NULL || thresholder_->IsEmpty()) {
+    tprintf("Please call SetImage before attempting recognition.");
+    return -1;
+  }
+  TessLogSinkScope log_scope(log_sink_);
+  if (page_res_ != NULL)
+    ClearResults();
+  if (FindLines() != 0)
+    return -1;
+  tesseract_->SetBlackAndWhitelist();
+  recognition_done_ = true;
+  page_res_ = tesseract_->ApplyBoxes(boxes, page, find_segmentation,
+                                     block_list_);
+  tesseract_->SetTrainingFile(tr_file, output_name);
+  tesseract_->ApplyBoxTraining(output_name, page_res_);
+  tesseract_->SetTrainingFile(NULL, "");
+  return 0;
+}
+
 
 // Recognizes all the pages in the named file, as a multi-page tiff or
 // list of filenames, or single image, and gets the appropriate kind of text
@@ -638,18 +1012,13 @@ bool TessBaseAPI::ProcessPages(FILE* fp,
   if (fp == NULL) {
     return false;
   }
-  // Find the number of pages if a tiff file, or zero otherwise.
-  int npages = CountTiffPages(fp);
-  //fclose(fp); // why close if it's gonna be used again?
+  // Index the pages if a tiff file. npages is zero otherwise.
+  TiffPageSource tiff_pages;
+  tiff_pages.Open(fp);
+  int npages = tiff_pages.num_pages();
 
   if (tesseract_->tessedit_create_hocr) {
-    *text_out =
-        "<!DOCTYPE html PUBLIC \"-//W3C//DTD HTML 4.01 Transitional//EN\""
-        " \"http://www.w3.org/TR/html4/loose.dtd\">\n"
-        "<html>\n<head>\n<title></title>\n"
-        "<meta http-equiv=\"Content-Type\" content=\"text/html;"
-        "charset=utf-8\" />\n<meta name='ocr-system' content='tesseract'/>\n"
-        "</head>\n<body>\n";
+    *text_out = HOCRHeader();
   } else {
     *text_out = "";
   }
@@ -657,7 +1026,7 @@ bool TessBaseAPI::ProcessPages(FILE* fp,
   bool success = true;
   Pix *pix;
   if (npages > 0) {
-    for (; page < npages && (pix = pixReadStreamTiff(fp, page)) != NULL;
+    for (; page < npages && (pix = tiff_pages.ReadPage(page)) != NULL;
          ++page) {
       if (page > 0)
         tprintf(_("Page %d\n"), page);
@@ -710,10 +1079,24 @@ bool TessBaseAPI::ProcessPages(FILE* fp,
     }
   }
   if (tesseract_->tessedit_create_hocr)
-    *text_out += "</body>\n</html>\n";
+    *text_out += HOCRFooter();
   return success;
 }
 
+const char* TessBaseAPI::HOCRHeader() {
+  return
+      "<!DOCTYPE html PUBLIC \"-//W3C//DTD HTML 4.01 Transitional//EN\""
+      " \"http://www.w3.org/TR/html4/loose.dtd\">\n"
+      "<html>\n<head>\n<title></title>\n"
+      "<meta http-equiv=\"Content-Type\" content=\"text/html;"
+      "charset=utf-8\" />\n<meta name='ocr-system' content='tesseract'/>\n"
+      "</head>\n<body>\n";
+}
+
+const char* TessBaseAPI::HOCRFooter() {
+  return "</body>\n</html>\n";
+}
+
 
 // Recognizes a single page for ProcessPages, appending the text to text_out.
 // The pix is the image processed - filename and page_index are metadata
@@ -728,8 +1111,79 @@ bool TessBaseAPI::ProcessPage(Pix* pix, int page_index,
                               const char* retry_config, int timeout_millisec,
                               STRING* text_out) {
   //SetInputName(filename);
+  // Work out which kind of text the page will produce, so the page cache
+  // can tell results for different outputs apart.
+  PageCacheFormat format = PCF_UTF8;
+  if (tesseract_->tessedit_create_boxfile ||
+      tesseract_->tessedit_make_boxes_from_boxes)
+    format = PCF_BOX;
+  else if (tesseract_->tessedit_write_unlv)
+    format = PCF_UNLV;
+  else if (tesseract_->tessedit_create_hocr)
+    format = PCF_HOCR;
+  // A page too large for layout analysis is recognized in strips. Modes
+  // that need the whole page at once still fail in FindLines.
+  if (StripRecognizer::NeedsStrips(pix, tesseract_->tessedit_target_dpi) &&
+      format != PCF_UNLV &&
+      tesseract_->tessedit_pageseg_mode != PSM_OSD_ONLY &&
+      tesseract_->tessedit_pageseg_mode != PSM_AUTO_ONLY &&
+      !tesseract_->tessedit_resegment_from_boxes &&
+      !tesseract_->tessedit_resegment_from_line_boxes &&
+      !tesseract_->tessedit_make_boxes_from_boxes &&
+      !tesseract_->tessedit_train_from_boxes &&
+      !tesseract_->tessedit_ambigs_training) {
+    if (strip_recognizer_ == NULL)
+      strip_recognizer_ = new StripRecognizer;
+    // This engine recognizes strips too, which clears the results.
+    strip_results_ = false;
+    if (!strip_recognizer_->Recognize(this, pix, timeout_millisec))
+      return false;
+    strip_results_ = true;
+    if (strip_recognizer_->skipped_stages() & RS_STRIPS)
+      TLOG_WARNING("Page %d is missing some of its strips\n", page_index);
+    if (format == PCF_BOX) {
+      strip_recognizer_->AppendBoxText(page_index, text_out);
+    } else if (format == PCF_HOCR) {
+      strip_recognizer_->AppendHOCRText(
+          page_index, input_file_ != NULL ? input_file_->string() : "",
+          text_out);
+    } else {
+      strip_recognizer_->AppendUTF8Text(text_out);
+    }
+    return true;
+  }
   SetImage(pix);
+  PageCacheKey cache_key;
+  double start_msecs = 0.0;
+  bool use_cache = page_cache_ != NULL && PageCacheable();
+  if (use_cache) {
+    // The key is made from the thresholded image, which FindLines would
+    // otherwise make, so there is no extra work on a miss.
+    if (tesseract_->pix_binary() == NULL)
+      Threshold(tesseract_->mutable_pix_binary());
+    cache_key.image_hash = PageResultCache::HashPix(tesseract_->pix_binary());
+    cache_key.config_hash =
+        PageResultCache::HashConfig(tesseract_->lang.string(),
+                                    last_oem_requested_, tesseract_->params());
+    cache_key.format = format;
+    if (format == PCF_BOX || format == PCF_HOCR)
+      cache_key.page_index = page_index;
+    if (format == PCF_HOCR && input_file_ != NULL) {
+      cache_key.config_hash = PageResultCache::HashString(
+          cache_key.config_hash, input_file_->string());
+    }
+    STRING cached_text;
+    if (page_cache_->Lookup(cache_key, &cached_text)) {
+      // Nothing was recognized, so leave no PAGE_RES behind for GetIterator
+      // or the Get*Text calls to mistake for this page.
+      ClearResults();
+      *text_out += cached_text;
+      return true;
+    }
+    start_msecs = ElapsedMsecs();
+  }
   bool failed = false;
+  bool timed_out = false;
   if (timeout_millisec > 0) {
     // Running with a timeout.
     ETEXT_DESC monitor;
@@ -738,6 +1192,7 @@ bool TessBaseAPI::ProcessPage(Pix* pix, int page_index,
     monitor.set_deadline_msecs(timeout_millisec);
     // Now run the main recognition.
     failed = Recognize(&monitor) < 0;
+    timed_out = monitor.deadline_exceeded();
   } else if (tesseract_->tessedit_pageseg_mode == PSM_OSD_ONLY ||
              tesseract_->tessedit_pageseg_mode == PSM_AUTO_ONLY) {
     // Disabled character recognition.
@@ -771,16 +1226,18 @@ bool TessBaseAPI::ProcessPage(Pix* pix, int page_index,
   // Get text only if successful.
   if (!failed) {
     char* text;
-    if (tesseract_->tessedit_create_boxfile ||
-        tesseract_->tessedit_make_boxes_from_boxes) {
+    if (format == PCF_BOX) {
       text = GetBoxText(page_index);
-    } else if (tesseract_->tessedit_write_unlv) {
+    } else if (format == PCF_UNLV) {
       text = GetUNLVText();
-    } else if (tesseract_->tessedit_create_hocr) {
+    } else if (format == PCF_HOCR) {
       text = GetHOCRText(page_index);
     } else {
       text = GetUTF8Text();
     }
+    // Pages cut short by the deadline are not representative results.
+    if (use_cache && !timed_out && GetSkippedStages() == 0)
+      page_cache_->Store(cache_key, text, ElapsedMsecs() - start_msecs);
     *text_out += text;
     delete [] text;
     return true;
@@ -808,195 +1265,18 @@ char* TessBaseAPI::GetUTF8Text() {
   if (tesseract_ == NULL ||
       (!recognition_done_ && Recognize(NULL) < 0))
     return NULL;
-  int total_length = TextLength(NULL);
-  PAGE_RES_IT   page_res_it(page_res_);
-  char* result = new char[total_length];
-  char* ptr = result;
-  for (page_res_it.restart_page(); page_res_it.word () != NULL;
-       page_res_it.forward()) {
-    WERD_RES *word = page_res_it.word();
-    WERD_CHOICE* choice = word->best_choice;
-    if (choice != NULL) {
-      strcpy(ptr, choice->unichar_string().string());
-      ptr += choice->unichar_string().length();
-      if (word->word->flag(W_EOL))
-        *ptr++ = '\n';
-      else
-        *ptr++ = ' ';
-    }
-  }
-  *ptr++ = '\n';
-  *ptr = '\0';
-  return result;
-}
-
-// Helper returns true if there is a paragraph break between bbox_cur,
-// and bbox_prev.
-// TODO(rays) improve and incorporate deeper into tesseract, so other
-// output methods get the benefit.
-static bool IsParagraphBreak(TBOX bbox_cur, TBOX bbox_prev,
-                             int right, int line_height) {
-  // Check if the distance between lines is larger than the normal leading,
-  if (fabs((float)(bbox_cur.bottom() - bbox_prev.bottom())) > line_height * 2)
-    return true;
-
-  // Check if the distance between left bounds of the two lines is nearly the
-  // same as between their right bounds (if so, then both lines probably belong
-  // to the same paragraph, maybe a centered one).
-  if (fabs((float)((bbox_cur.left() - bbox_prev.left()) -
-           (bbox_prev.right() - bbox_cur.right()))) < line_height)
-    return false;
-
-  // Check if there is a paragraph indent at this line (either -ve or +ve).
-  if (fabs((float)(bbox_cur.left() - bbox_prev.left())) > line_height)
-    return true;
-
-  // Check if both current and previous line don't reach the right bound of the
-  // block, but the distance is different. This will cause all lines in a verse
-  // to be treated as separate paragraphs, but most probably will not split
-  // block-quotes to separate lines (at least if the text is justified).
-  if (fabs((float)(bbox_cur.right() - bbox_prev.right())) > line_height &&
-      right - bbox_cur.right() > line_height &&
-      right - bbox_prev.right() > line_height)
-    return true;
-
-  return false;
-}
-
-// Helper to add the hOCR for a box to the given hocr_str.
-static void AddBoxTohOCR(const TBOX& box, int image_height, STRING* hocr_str) {
-  hocr_str->add_str_int("' title=\"bbox ", box.left());
-  hocr_str->add_str_int(" ", image_height - box.top());
-  hocr_str->add_str_int(" ", box.right());
-  hocr_str->add_str_int(" ", image_height - box.bottom());
-  *hocr_str += "\">";
+  return RenderOne(TF_UTF8, 0);
 }
 
 // Make a HTML-formatted string with hOCR markup from the internal
 // data structures.
 // page_number is 0-based but will appear in the output as 1-based.
-// STL removed from original patch submission and refactored by rays.
 char* TessBaseAPI::GetHOCRText(int page_number) {
   if (tesseract_ == NULL ||
       (page_res_ == NULL && Recognize(NULL) < 0))
     return NULL;
-
-  PAGE_RES_IT page_res_it(page_res_);
-  ROW_RES *row = NULL;           // current row
-  ROW *real_row = NULL, *prev_row = NULL;
-  BLOCK_RES *block = NULL;       // current row
-  BLOCK *real_block = NULL;
-  int lcnt = 1, bcnt = 1, wcnt = 1;
-  int page_id = page_number + 1;  // hOCR uses 1-based page numbers.
-
-  STRING hocr_str;
-
-  hocr_str.add_str_int("<div class='ocr_page' id='page_", page_id);
-  hocr_str += "' title='image \"";
-  hocr_str += *input_file_;
-  hocr_str.add_str_int("\"; bbox ", rect_left_);
-  hocr_str.add_str_int(" ", rect_top_);
-  hocr_str.add_str_int(" ", rect_width_);
-  hocr_str.add_str_int(" ", rect_height_);
-  hocr_str += "'>\n";
-
-  for (page_res_it.restart_page(); page_res_it.word () != NULL;
-       page_res_it.forward()) {
-    if (block != page_res_it.block()) {
-      if (block != NULL) {
-        hocr_str += "</span>\n</p>\n</div>\n";
-      }
-
-      block = page_res_it.block();  // current row
-      real_block = block->block;
-      real_row = NULL;
-      row = NULL;
-
-      hocr_str.add_str_int("<div class='ocr_carea' id='block_", page_id);
-      hocr_str.add_str_int("_", bcnt++);
-      AddBoxTohOCR(real_block->bounding_box(), image_height_, &hocr_str);
-      hocr_str += "\n<p class='ocr_par'>\n";
-    }
-    if (row != page_res_it.row()) {
-      if (row != NULL) {
-        hocr_str += "</span>\n";
-      }
-      prev_row = real_row;
-
-      row = page_res_it.row();  // current row
-      real_row = row->row;
-
-      if (prev_row != NULL &&
-          IsParagraphBreak(real_row->bounding_box(), prev_row->bounding_box(),
-                           real_block->bounding_box().right(),
-                           real_row->x_height() + real_row->ascenders()))
-        hocr_str += "</p>\n<p class='ocr_par'>\n";
-
-      hocr_str.add_str_int("<span class='ocr_line' id='line_", page_id);
-      hocr_str.add_str_int("_", lcnt++);
-      AddBoxTohOCR(real_row->bounding_box(), image_height_, &hocr_str);
-    }
-
-    WERD_RES *word = page_res_it.word();
-    WERD_CHOICE* choice = word->best_choice;
-    if (choice != NULL) {
-      hocr_str.add_str_int("<span class='ocr_word' id='word_", page_id);
-      hocr_str.add_str_int("_", wcnt);
-      AddBoxTohOCR(word->word->bounding_box(), image_height_, &hocr_str);
-      hocr_str.add_str_int("<span class='xocr_word' id='xword_", page_id);
-      hocr_str.add_str_int("_", wcnt++);
-      hocr_str.add_str_int("' title=\"x_wconf ", choice->certainty());
-      hocr_str += "\">";
-      if (word->bold > 0)
-        hocr_str += "<strong>";
-      if (word->italic > 0)
-        hocr_str += "<em>";
-      int i;
-      // escape special characters
-      for (i = 0; choice->unichar_string()[i] != '\0'; i++) {
-        if (choice->unichar_string()[i] == '<') hocr_str += "&lt;";
-        else if (choice->unichar_string()[i] == '>') hocr_str += "&gt;";
-        else if (choice->unichar_string()[i] == '&') hocr_str += "&amp;";
-        else if (choice->unichar_string()[i] == '"') hocr_str += "&quot;";
-        else if (choice->unichar_string()[i] == '\'') hocr_str += "&#39;";
-        else hocr_str += choice->unichar_string()[i];
-      }
-      if (word->italic > 0)
-        hocr_str += "</em>";
-      if (word->bold > 0)
-        hocr_str += "</strong>";
-      hocr_str += "</span></span>";
-      if (!word->word->flag(W_EOL))
-        hocr_str += " ";
-    }
-  }
-  if (block != NULL)
-    hocr_str += "</span>\n</p>\n</div>\n";
-  hocr_str += "</div>\n";
-
-  char *ret = new char[hocr_str.length() + 1];
-  strcpy(ret, hocr_str.string());
-  return ret;
-}
-
-// The 5 numbers output for each box (the usual 4 and a page number.)
-const int kNumbersPerBlob = 5;
-// The number of bytes taken by each number. Since we use inT16 for ICOORD,
-// assume only 5 digits max.
-const int kBytesPerNumber = 5;
-// Multiplier for max expected textlength assumes (kBytesPerNumber + space)
-// * kNumbersPerBlob plus the newline. Add to this the
-// original UTF8 characters, and one kMaxBytesPerLine for safety.
-const int kBytesPerBlob = kNumbersPerBlob * (kBytesPerNumber + 1) + 1;
-const int kBytesPerBoxFileLine = (kBytesPerNumber + 1) * kNumbersPerBlob + 1;
-// Max bytes in the decimal representation of inT64.
-const int kBytesPer64BitNumber = 20;
-// A maximal single box could occupy kNumbersPerBlob numbers at
-// kBytesPer64BitNumber digits (if someone sneaks in a 64 bit value) and a
-// space plus the newline and the maximum length of a UNICHAR.
-// Test against this on each iteration for safety.
-const int kMaxBytesPerLine = kNumbersPerBlob * (kBytesPer64BitNumber + 1) + 1 +
-    UNICHAR_LEN;
+  return RenderOne(TF_HOCR, page_number);
+}
 
 // The recognized text is returned as a char* which is coded
 // as a UTF8 box file and must be freed with the delete [] operator.
@@ -1005,49 +1285,9 @@ char* TessBaseAPI::GetBoxText(int page_number) {
   if (tesseract_ == NULL ||
       (!recognition_done_ && Recognize(NULL) < 0))
     return NULL;
-  int blob_count;
-  int utf8_length = TextLength(&blob_count);
-  int total_length = blob_count * kBytesPerBoxFileLine + utf8_length +
-      kMaxBytesPerLine;
-  char* result = new char[total_length];
-  int output_length = 0;
-  ResultIterator* it = GetIterator();
-  do {
-    int left, top, right, bottom;
-    if (it->BoundingBox(RIL_SYMBOL, &left, &top, &right, &bottom)) {
-      char* text = it->GetUTF8Text(RIL_SYMBOL);
-      // Tesseract uses space for recognition failure. Fix to a reject
-      // character, kTesseractReject so we don't create illegal box files.
-      for (int i = 0; text[i] != '\0'; ++i) {
-        if (text[i] == ' ')
-          text[i] = kTesseractReject;
-      }
-      snprintf(result + output_length, total_length - output_length,
-               "%s %d %d %d %d %d\n",
-               text, left, image_height_ - bottom,
-               right, image_height_ - top, page_number);
-      output_length += strlen(result + output_length);
-      delete [] text;
-      // Just in case...
-      if (output_length + kMaxBytesPerLine > total_length)
-        break;
-    }
-  } while (it->Next(RIL_SYMBOL));
-  delete it;
-  return result;
+  return RenderOne(TF_BOX, page_number);
 }
 
-// Conversion table for non-latin characters.
-// Maps characters out of the latin set into the latin set.
-// TODO(rays) incorporate this translation into unicharset.
-const int kUniChs[] = {
-  0x20ac, 0x201c, 0x201d, 0x2018, 0x2019, 0x2022, 0x2014, 0
-};
-// Latin chars corresponding to the unicode chars above.
-const int kLatinChs[] = {
-  0x00a2, 0x0022, 0x0022, 0x0027, 0x0027, 0x00b7, 0x002d, 0
-};
-
 // The recognized text is returned as a char* which is coded
 // as UNLV format Latin-1 with specific reject and suspect codes
 // and must be freed with the delete [] operator.
@@ -1055,101 +1295,49 @@ char* TessBaseAPI::GetUNLVText() {
   if (tesseract_ == NULL ||
       (!recognition_done_ && Recognize(NULL) < 0))
     return NULL;
-  bool tilde_crunch_written = false;
-  bool last_char_was_newline = true;
-  bool last_char_was_tilde = false;
-
-  int total_length = TextLength(NULL);
-  PAGE_RES_IT   page_res_it(page_res_);
-  char* result = new char[total_length];
-  char* ptr = result;
-  for (page_res_it.restart_page(); page_res_it.word () != NULL;
-       page_res_it.forward()) {
-    WERD_RES *word = page_res_it.word();
-    // Process the current word.
-    if (word->unlv_crunch_mode != CR_NONE) {
-      if (word->unlv_crunch_mode != CR_DELETE &&
-          (!tilde_crunch_written ||
-           (word->unlv_crunch_mode == CR_KEEP_SPACE &&
-            word->word->space() > 0 &&
-            !word->word->flag(W_FUZZY_NON) &&
-            !word->word->flag(W_FUZZY_SP)))) {
-        if (!word->word->flag(W_BOL) &&
-            word->word->space() > 0 &&
-            !word->word->flag(W_FUZZY_NON) &&
-            !word->word->flag(W_FUZZY_SP)) {
-          /* Write a space to separate from preceeding good text */
-          *ptr++ = ' ';
-          last_char_was_tilde = false;
-        }
-        if (!last_char_was_tilde) {
-          // Write a reject char.
-          last_char_was_tilde = true;
-          *ptr++ = kUNLVReject;
-          tilde_crunch_written = true;
-          last_char_was_newline = false;
-        }
-      }
-    } else {
-      // NORMAL PROCESSING of non tilde crunched words.
-      tilde_crunch_written = false;
-      tesseract_->set_unlv_suspects(word);
-      const char* wordstr = word->best_choice->unichar_string().string();
-      const STRING& lengths = word->best_choice->unichar_lengths();
-      int length = lengths.length();
-      int i = 0;
-      int offset = 0;
-
-      if (last_char_was_tilde &&
-          word->word->space() == 0 && wordstr[offset] == ' ') {
-        // Prevent adjacent tilde across words - we know that adjacent tildes
-        // within words have been removed.
-        // Skip the first character.
-        offset = lengths[i++];
-      }
-      if (i < length && wordstr[offset] != 0) {
-        if (!last_char_was_newline)
-          *ptr++ = ' ';
-        else
-          last_char_was_newline = false;
-        for (; i < length; offset += lengths[i++]) {
-          if (wordstr[offset] == ' ' ||
-              wordstr[offset] == kTesseractReject) {
-            *ptr++ = kUNLVReject;
-            last_char_was_tilde = true;
-          } else {
-            if (word->reject_map[i].rejected())
-              *ptr++ = kUNLVSuspect;
-            UNICHAR ch(wordstr + offset, lengths[i]);
-            int uni_ch = ch.first_uni();
-            for (int j = 0; kUniChs[j] != 0; ++j) {
-              if (kUniChs[j] == uni_ch) {
-                uni_ch = kLatinChs[j];
-                break;
-              }
-            }
-            if (uni_ch <= 0xff) {
-              *ptr++ = static_cast<char>(uni_ch);
-              last_char_was_tilde = false;
-            } else {
-              *ptr++ = kUNLVReject;
-              last_char_was_tilde = true;
-            }
-          }
-        }
-      }
-    }
-    if (word->word->flag(W_EOL) && !last_char_was_newline) {
-      /* Add a new line output */
-      *ptr++ = '\n';
-      tilde_crunch_written = false;
-      last_char_was_newline = true;
-      last_char_was_tilde = false;
+  return RenderOne(TF_UNLV, 0);
+}
+
+// Writes the recognized text in every format with a buffer, in one walk
+// of the page.
+bool TessBaseAPI::RenderText(int page_number, TextBuffer** buffers) {
+  if (tesseract_ == NULL ||
+      (!recognition_done_ && Recognize(NULL) < 0))
+    return false;
+  RenderFormats(page_number, buffers);
+  return true;
+}
+
+// Renders the formats with buffers, sizing each empty buffer from the
+// output of the last page, so that a page like the last one is written
+// into a single chunk.
+void TessBaseAPI::RenderFormats(int page_number, TextBuffer** buffers) {
+  for (int f = 0; f < TF_COUNT; ++f) {
+    if (buffers[f] != NULL)
+      buffers[f]->Reserve(text_size_hints_[f]);
+  }
+  TextRenderer renderer(tesseract_, page_res_,
+                        thresholder_->GetScaleFactor(), image_height_,
+                        rect_left_, rect_top_, rect_width_, rect_height_);
+  renderer.Render(page_number,
+                  input_file_ != NULL ? input_file_->string() : "",
+                  buffers);
+  for (int f = 0; f < TF_COUNT; ++f) {
+    if (buffers[f] != NULL) {
+      int length = buffers[f]->length();
+      text_size_hints_[f] = length + length / kTextSizeSlack + 1;
     }
   }
-  *ptr++ = '\n';
-  *ptr = '\0';
-  return result;
+}
+
+// Renders the single format into a new string that the caller must
+// delete [].
+char* TessBaseAPI::RenderOne(TextFormat format, int page_number) {
+  TextBuffer buffer;
+  TextBuffer* buffers[TF_COUNT] = { NULL };
+  buffers[format] = &buffer;
+  RenderFormats(page_number, buffers);
+  return buffer.Release();
 }
 
 // Returns the average word confidence for Tesseract page result.
@@ -1189,6 +1377,17 @@ int* TessBaseAPI::AllWordConfidences() {
   return conf;
 }
 
+/** Returns the RecognitionStage mask of stages skipped on the last page. */
+int TessBaseAPI::GetSkippedStages() const {
+  if (strip_results_)
+    return strip_recognizer_->skipped_stages();
+  return page_res_ != NULL ? page_res_->skipped_stages : 0;
+}
+
+const StripRecognizer* TessBaseAPI::GetStripResults() const {
+  return strip_results_ ? strip_recognizer_ : NULL;
+}
+
 /**
    * Applies the given word to the adaptive classifier if possible.
    * The word must be SPACE-DELIMITED UTF-8 - l i k e t h i s , so it can
@@ -1266,6 +1465,11 @@ void TessBaseAPI::Clear() {
 // Once End() has been used, none of the other API functions may be used
 // other than Init and anything declared above it in the class definition.
 void TessBaseAPI::End() {
+  if (strip_recognizer_ != NULL) {
+    delete strip_recognizer_;
+    strip_recognizer_ = NULL;
+  }
+  strip_results_ = false;
   if (thresholder_ != NULL) {
     delete thresholder_;
     thresholder_ = NULL;
@@ -1374,20 +1578,70 @@ bool TessBaseAPI::InternalSetImage() {
 // The usual argument to Threshold is Tesseract::mutable_pix_binary().
 void TessBaseAPI::Threshold(Pix** pix) {
   ASSERT_HOST(pix != NULL);
-  if (!thresholder_->IsBinary()) {
-    tesseract_->set_pix_grey(thresholder_->GetPixRectGrey());
-  }
   if (*pix != NULL)
     pixDestroy(pix);
+  // On a memory budget the grey image is only made if asked for, and then
+  // after the binary one, once the temporaries of thresholding are gone.
+  bool budget = tesseract_->tessedit_memory_budget;
+  bool make_grey = !thresholder_->IsBinary() &&
+                   (!budget || tesseract_->tessedit_keep_grey_image);
+  raster_bytes_ = TessRasterBytes();
+  raster_bytes_.source_bytes = thresholder_->GetSourceBytes();
+  if (make_grey && !budget)
+    tesseract_->set_pix_grey(thresholder_->GetPixRectGrey());
+  // Box files are in the coordinates of the source image, so the modes
+  // that read them must see it at its own resolution.
+  bool reads_boxes = tesseract_->tessedit_resegment_from_boxes ||
+                     tesseract_->tessedit_resegment_from_line_boxes ||
+                     tesseract_->tessedit_make_boxes_from_boxes ||
+                     tesseract_->tessedit_train_from_boxes ||
+                     tesseract_->tessedit_ambigs_training;
+  thresholder_->SetTargetResolution(
+      reads_boxes ? 0 : static_cast<int>(tesseract_->tessedit_target_dpi));
   thresholder_->ThresholdToPix(pix);
   thresholder_->GetImageSizes(&rect_left_, &rect_top_,
                               &rect_width_, &rect_height_,
                               &image_width_, &image_height_);
+  if (make_grey && budget)
+    tesseract_->set_pix_grey(thresholder_->GetPixRectGrey());
+
+  Pix* grey = tesseract_->pix_grey();
+  raster_bytes_.work_bytes = thresholder_->GetWorkBytes();
+  // A clone of an 8 bit source shares its pixels, and its reference count.
+  if (grey != NULL && pixGetRefcount(grey) == 1)
+    raster_bytes_.grey_bytes = ImageThresholder::PixBytes(grey);
+  raster_bytes_.binary_bytes = ImageThresholder::PixBytes(*pix);
+  if (budget) {
+    raster_bytes_.peak_bytes = raster_bytes_.source_bytes +
+        raster_bytes_.binary_bytes +
+        MAX(raster_bytes_.work_bytes, raster_bytes_.grey_bytes);
+    // Only the reference of the thresholder goes, so a caller that still
+    // holds the source Pix keeps it.
+    thresholder_->Clear();
+  } else {
+    raster_bytes_.peak_bytes = raster_bytes_.source_bytes +
+        raster_bytes_.work_bytes + raster_bytes_.grey_bytes +
+        raster_bytes_.binary_bytes;
+  }
 }
 
 // Find lines from the image making the BLOCK_LIST.
 int TessBaseAPI::FindLines() {
-  if (thresholder_ == NULL || thresholder_->IsEmpty()) {
+  return FindBlocks(NULL, NULL);
+}
+
+// Finds the blocks of the page, and if to_blocks is NULL their rows and
+// words too. Otherwise the rows and words are left to TextordBlocks, with
+// the TO_BLOCKs in to_blocks and the mode to use in *pageseg_mode.
+int TessBaseAPI::FindBlocks(TO_BLOCK_LIST* to_blocks,
+                            PageSegMode* pageseg_mode) {
+  TessLogSinkScope log_scope(log_sink_);
+  // On a memory budget the source is gone once thresholded, leaving only
+  // the binary image, which ClearResults frees.
+  if (thresholder_ == NULL ||
+      (thresholder_->IsEmpty() &&
+       (tesseract_ == NULL || tesseract_->pix_binary() == NULL ||
+        recognition_done_))) {
     tprintf("Please call SetImage before attempting recognition.");
     return -1;
   }
@@ -1400,8 +1654,11 @@ int TessBaseAPI::FindLines() {
     tesseract_ = new Tesseract;
     tesseract_->InitAdaptiveClassifier(false);
   }
+  stage_times_ = TessStageTimes();
+  double start_msecs = ElapsedMsecs();
   if (tesseract_->pix_binary() == NULL)
     Threshold(tesseract_->mutable_pix_binary());
+  stage_times_.threshold_msecs = ElapsedMsecs() - start_msecs;
   if (tesseract_->ImageWidth() > MAX_INT16 ||
       tesseract_->ImageHeight() > MAX_INT16) {
     tprintf("Image too large: (%d, %d)\n",
@@ -1412,12 +1669,15 @@ int TessBaseAPI::FindLines() {
   Tesseract* osd_tess = osd_tesseract_;
   OSResults osr;
   if (PSM_OSD_ENABLED(tesseract_->tessedit_pageseg_mode) && osd_tess == NULL) {
-    if (strcmp(language_->string(), "osd") == 0) {
+    // An engine from InitForAnalysePage has no language or datapath, and
+    // loads osd from the default place.
+    if (language_ != NULL && strcmp(language_->string(), "osd") == 0) {
       osd_tess = tesseract_;
     } else {
       osd_tesseract_ = new Tesseract;
       if (osd_tesseract_->init_tesseract(
-          datapath_->string(), NULL, "osd", OEM_TESSERACT_ONLY,
+          datapath_ != NULL ? datapath_->string() : NULL, NULL, "osd",
+          OEM_TESSERACT_ONLY,
           NULL, 0, false) == 0) {
         osd_tess = osd_tesseract_;
       } else {
@@ -1429,7 +1689,17 @@ int TessBaseAPI::FindLines() {
     }
   }
 
-  if (tesseract_->SegmentPage(input_file_, block_list_, osd_tess, &osr) < 0)
+  start_msecs = ElapsedMsecs();
+  int result;
+  if (to_blocks == NULL) {
+    result = tesseract_->SegmentPage(input_file_, block_list_, osd_tess,
+                                     &osr);
+  } else {
+    result = tesseract_->FindPageBlocks(input_file_, block_list_, to_blocks,
+                                        osd_tess, &osr, pageseg_mode);
+  }
+  stage_times_.layout_msecs = ElapsedMsecs() - start_msecs;
+  if (result < 0)
     return -1;
   return 0;
 }
@@ -1445,46 +1715,35 @@ void TessBaseAPI::ClearResults() {
     page_res_ = NULL;
   }
   recognition_done_ = false;
+  strip_results_ = false;
   if (block_list_ == NULL)
     block_list_ = new BLOCK_LIST;
   else
     block_list_->clear();
 }
 
-// Return the length of the output text string, as UTF8, assuming
-// one newline per line and one per block, with a terminator,
-// and assuming a single character reject marker for each rejected character.
-// Also return the number of recognized blobs in blob_count.
-int TessBaseAPI::TextLength(int* blob_count) {
-  if (tesseract_ == NULL || page_res_ == NULL)
-    return 0;
-
-  PAGE_RES_IT   page_res_it(page_res_);
-  int total_length = 2;
-  int total_blobs = 0;
-  // Iterate over the data structures to extract the recognition result.
-  for (page_res_it.restart_page(); page_res_it.word () != NULL;
-       page_res_it.forward()) {
-    WERD_RES *word = page_res_it.word();
-    WERD_CHOICE* choice = word->best_choice;
-    if (choice != NULL) {
-      total_blobs += choice->length() + 1;
-      total_length += choice->unichar_string().length() + 1;
-      for (int i = 0; i < word->reject_map.length(); ++i) {
-        if (word->reject_map[i].rejected())
-          ++total_length;
-      }
-    }
-  }
-  if (blob_count != NULL)
-    *blob_count = total_blobs;
-  return total_length;
+// Returns true if ProcessPage may use the page cache with the current
+// settings. Training, box-driven and interactive modes read or write side
+// files per page, and the layout-only modes produce no text to cache.
+bool TessBaseAPI::PageCacheable() const {
+  if (tesseract_ == NULL)
+    return false;
+  if (tesseract_->tessedit_resegment_from_boxes ||
+      tesseract_->tessedit_resegment_from_line_boxes ||
+      tesseract_->tessedit_make_boxes_from_boxes ||
+      tesseract_->tessedit_train_from_boxes ||
+      tesseract_->tessedit_ambigs_training ||
+      tesseract_->tessedit_write_images ||
+      tesseract_->interactive_mode)
+    return false;
+  int psm = tesseract_->tessedit_pageseg_mode;
+  return psm != PSM_OSD_ONLY && psm != PSM_AUTO_ONLY;
 }
 
 // Estimates the Orientation And Script of the image.
 // Returns true if the image was processed successfully.
 bool TessBaseAPI::DetectOS(OSResults* osr) {
-  if (tesseract_ == NULL)
+  if (tesseract_ == NULL || thresholder_ == NULL || thresholder_->IsEmpty())
     return false;
   ClearResults();
   if (tesseract_->pix_binary() == NULL)
@@ -1712,7 +1971,7 @@ void TessBaseAPI::AdaptToCharacter(const char *unichar_repr,
 PAGE_RES* TessBaseAPI::RecognitionPass1(BLOCK_LIST* block_list) {
   PAGE_RES *page_res = new PAGE_RES(block_list,
                                     &(tesseract_->prev_word_best_choice_));
-  tesseract_->recog_all_words(page_res, NULL, NULL, NULL, 1);
+  tesseract_->recog_all_words(page_res, NULL, NULL, NULL, 1, true);
   return page_res;
 }
 
@@ -1721,7 +1980,7 @@ PAGE_RES* TessBaseAPI::RecognitionPass2(BLOCK_LIST* block_list,
   if (!pass1_result)
     pass1_result = new PAGE_RES(block_list,
                                 &(tesseract_->prev_word_best_choice_));
-  tesseract_->recog_all_words(pass1_result, NULL, NULL, NULL, 2);
+  tesseract_->recog_all_words(pass1_result, NULL, NULL, NULL, 2, true);
   return pass1_result;
 }
 
@@ -27,6 +27,7 @@
 #include "thresholder.h"
 #include "unichar.h"
 
+class BoxFileIndex;
 class PAGE_RES;
 class PAGE_RES_IT;
 class BLOCK_LIST;
@@ -43,6 +44,8 @@ struct Boxa;
 class ETEXT_DESC;
 struct OSResults;
 class TBOX;
+class TO_BLOCK_LIST;
+template <class A1> class TessCallback1;
 
 #define MAX_NUM_INT_FEATURES 512
 struct INT_FEATURE_STRUCT;
@@ -65,7 +68,11 @@ class CubeRecoContext;
 class Dawg;
 class Dict;
 class PageIterator;
+class PageResultCache;
 class ResultIterator;
+class StripRecognizer;
+class TessLogSink;
+class TextBuffer;
 class Tesseract;
 class Trie;
 
@@ -76,6 +83,35 @@ typedef double (Dict::*ProbabilityInContextFunc)(const char* context,
                                                  const char* character,
                                                  int character_bytes);
 
+/**
+ * Wall-clock milliseconds spent in each stage of the last page processed.
+ * Stages that did not run for that page are 0.
+ */
+struct TessStageTimes {
+  TessStageTimes()
+    : threshold_msecs(0.0), layout_msecs(0.0), recognize_msecs(0.0) {}
+
+  double threshold_msecs;  ///< Thresholding to the binary image.
+  double layout_msecs;     ///< Page layout analysis, including OSD.
+  double recognize_msecs;  ///< Word recognition, all passes.
+};
+
+/**
+ * Bytes of pixel data held for the last page thresholded. Rasters the
+ * page did not have are 0, as is a grey image that shares the pixels of
+ * an 8 bit source.
+ */
+struct TessRasterBytes {
+  TessRasterBytes()
+    : source_bytes(0), work_bytes(0), grey_bytes(0), binary_bytes(0),
+      peak_bytes(0) {}
+
+  size_t source_bytes;  ///< The source, after any depth conversion.
+  size_t work_bytes;    ///< Temporaries of thresholding, eg a scaled copy.
+  size_t grey_bytes;    ///< The grey copy kept for PageIterator::GetImage.
+  size_t binary_bytes;  ///< The thresholded image.
+  size_t peak_bytes;    ///< The most of the above held at once.
+};
 
 /**
  * Base class for all tesseract APIs.
@@ -104,6 +140,14 @@ class TESSDLL_API TessBaseAPI {
   /** Set the name of the bonus output files. Needed only for debugging. */
   void SetOutputName(const char* name);
 
+  /**
+   * Send the debug and error output of this instance to the named file,
+   * or back to the process-wide tprintf destination if name is NULL.
+   * Lets each of several instances in one process log separately without
+   * the threads running them waiting on each other.
+   */
+  void SetLogFile(const char* name);
+
   /**
    * Set the value of an internal "parameter."
    * Supply the name of the parameter and the value as a string, just as
@@ -169,6 +213,18 @@ class TESSDLL_API TessBaseAPI {
     return Init(datapath, language, OEM_DEFAULT, NULL, 0, false);
   }
 
+  /**
+   * Starts tesseract with the tessdata, language and engine mode of other,
+   * which must have been initialized, and copies the values of all its
+   * variables, so this instance recognizes as other does. Used to make
+   * helpers that share the work of other on a thread of their own.
+   * Called again on a helper kept from earlier work, it only copies the
+   * variables again and resets the adaptive classifier, unless other has
+   * since changed language or engine mode.
+   * Returns zero on success and -1 on failure.
+   */
+  int InitLike(TessBaseAPI* other);
+
   /**
    * Init only the lang model component of Tesseract. The only functions
    * that work after this init are SetVariable and IsValidWord.
@@ -328,6 +384,18 @@ class TESSDLL_API TessBaseAPI {
   Boxa* GetComponentImages(PageIteratorLevel level,
                            Pixa** pixa, int** blockids);
 
+  // As GetComponentImages, but instead of an image per component, *pix is
+  // set to a clone of the thresholded image, and each box is the rectangle
+  // of a component within it, clipped to its edges. The pixels of a
+  // component are read in place at its box instead of being copied out.
+  // Unlike the images of GetComponentImages, the views of blocks are not
+  // masked by the block outline, and those of symbols hold anything else
+  // within their boxes.
+  // Can be called before or after Recognize.
+  // The caller must boxaDestroy the result and pixDestroy *pix.
+  Boxa* GetComponentViews(PageIteratorLevel level,
+                          Pix** pix, int** blockids);
+
   /**
    * Dump the internal binary image to a PGM file.
    * @deprecated Use GetThresholdedImage and write the image using pixWrite
@@ -354,6 +422,29 @@ class TESSDLL_API TessBaseAPI {
    */
   int Recognize(ETEXT_DESC* monitor);
 
+  /**
+   * Recognizes the image like Recognize, but a block at a time, so the
+   * results of the first blocks are available long before the whole page
+   * is done. Layout analysis finds the blocks of the whole page, then the
+   * rows and words of each block are made on a separate thread while the
+   * callback runs on the block before it.
+   * block_callback is run on the calling thread, in reading order, with an
+   * iterator over the results of each block as soon as that block is
+   * recognized. The iterator is deleted when the callback returns. The
+   * callback must be permanent and is not owned. Words whose own fonts are
+   * unconvincing only get the modal font of the page after the last block.
+   * After the last block the results of the whole page are kept as after
+   * Recognize. Each block is recognized on its own, so adaption in the
+   * later passes only learns from the blocks before it. Modes that need
+   * the whole page at once (box and ambigs training, interactive, layout
+   * only), or a layout from an earlier AnalyseLayout, recognize as
+   * Recognize does and run the callback once, over the whole page.
+   * Returns 0 on success, -1 on error or if monitor cancelled it, in which
+   * case the blocks not yet recognized have no results.
+   */
+  int RecognizeByBlock(ETEXT_DESC* monitor,
+                       TessCallback1<ResultIterator*>* block_callback);
+
   /**
    * Methods to retrieve information after SetAndThresholdImage(),
    * Recognize() or TesseractRect(). (Recognize is called implicitly if needed.)
@@ -362,6 +453,19 @@ class TESSDLL_API TessBaseAPI {
   /** Variant on Recognize used for testing chopper. */
   int RecognizeForChopTest(ETEXT_DESC* monitor);
 
+  /**
+   * Trains on the image from SetImage as Recognize does with
+   * tessedit_train_from_boxes, but with the boxes of the given page of
+   * boxes in place of reading the box file of the input name, and writing
+   * the features to tr_file, labelled with the font of output_name, in
+   * place of the .tr file of output_name. find_segmentation is as for
+   * tessedit_resegment_from_line_boxes. Engines on different threads can
+   * train at once, each with a tr_file of its own. Returns 0 on success.
+   */
+  int TrainFromBoxes(const BoxFileIndex& boxes, int page,
+                     bool find_segmentation, const char* output_name,
+                     FILE* tr_file);
+
   /**
    * Recognizes all the pages in the named file, as a multi-page tiff or
    * list of filenames, or single image, and gets the appropriate kind of text
@@ -401,6 +505,32 @@ class TESSDLL_API TessBaseAPI {
                    const char* retry_config, int timeout_millisec,
                    STRING* text_out);
 
+  /**
+   * The text ProcessPages puts before and after the pages of a file when
+   * tessedit_create_hocr is set, for callers that run ProcessPage on the
+   * pages themselves.
+   */
+  static const char* HOCRHeader();
+  static const char* HOCRFooter();
+
+  /**
+   * Use the given cache to avoid recognizing pages that ProcessPage has
+   * already seen. Pages are matched on their thresholded image and the
+   * current language, engine mode and parameters. On a hit the stored
+   * text is returned without running layout analysis or recognition, so
+   * there are no results behind it: GetIterator returns NULL and the
+   * Get*Text calls recognize the page again. Callers that want iterators
+   * or word detail for the page should not use a cache.
+   * The cache is not owned and may be shared by many TessBaseAPIs.
+   * Pass NULL to stop using a cache.
+   */
+  void SetPageCache(PageResultCache* cache) {
+    page_cache_ = cache;
+  }
+  PageResultCache* GetPageCache() const {
+    return page_cache_;
+  }
+
   // Get an iterator to the results of LayoutAnalysis and/or Recognize.
   // The returned iterator must be deleted after use.
   // WARNING! This class points to data held within the TessBaseAPI class, and
@@ -434,6 +564,15 @@ class TESSDLL_API TessBaseAPI {
    * and must be freed with the delete [] operator.
    */
   char* GetUNLVText();
+  /**
+   * Writes the recognized text, in one walk of the page, to each buffer of
+   * buffers, indexed by TextFormat, that is not NULL. The formats are those
+   * of GetUTF8Text, GetHOCRText, GetBoxText and GetUNLVText, and
+   * page_number is as for GetHOCRText and GetBoxText. The buffers are
+   * appended to, so several pages may be written to the same ones.
+   * Returns false if recognition failed.
+   */
+  bool RenderText(int page_number, TextBuffer** buffers);
   /** Returns the (average) confidence value between 0 and 100. */
   int MeanTextConf();
   /**
@@ -443,6 +582,33 @@ class TESSDLL_API TessBaseAPI {
    * delimited words in GetUTF8Text.
    */
   int* AllWordConfidences();
+  /**
+   * Returns a bitwise OR of the RecognitionStage values that were left out
+   * of the last recognized page to meet its deadline, or 0 if the page got
+   * the full treatment. Stages are only skipped when
+   * tessedit_degrade_on_deadline is set, except RS_STRIPS, set when some
+   * strips of a page ProcessPage recognized in strips are missing.
+   */
+  int GetSkippedStages() const;
+  /**
+   * Returns the words of the last page, if ProcessPage recognized it in
+   * strips, in which case GetIterator has nothing, or NULL otherwise.
+   * Owned by the API, and valid until the next image or End.
+   */
+  const StripRecognizer* GetStripResults() const;
+  /** Returns where the time went on the last page. */
+  TessStageTimes GetStageTimes() const {
+    return stage_times_;
+  }
+  /**
+   * Returns the memory taken by the images of the last page. With
+   * tessedit_memory_budget the source is freed as soon as it has been
+   * thresholded, so SetImage must be called again before SetRectangle or
+   * anything else that needs the source after the first recognition.
+   */
+  TessRasterBytes GetRasterBytes() const {
+    return raster_bytes_;
+  }
 
   /**
    * Applies the given word to the adaptive classifier if possible.
@@ -582,16 +748,40 @@ class TESSDLL_API TessBaseAPI {
    */
   int FindLines();
 
+  /**
+   * Finds the blocks of the page like FindLines, but if to_blocks is not
+   * NULL stops short of making their rows and words, leaving the TO_BLOCKs
+   * of the blocks in to_blocks and the mode to make them in in
+   * *pageseg_mode, for Tesseract::TextordBlocks.
+   * @return 0 on success.
+   */
+  int FindBlocks(TO_BLOCK_LIST* to_blocks, PageSegMode* pageseg_mode);
+
   /** Delete the pageres and block list ready for a new page. */
   void ClearResults();
 
   /**
-   * Return the length of the output text string, as UTF8, assuming
-   * one newline per line and one per block, with a terminator,
-   * and assuming a single character reject marker for each rejected character.
-   * Also return the number of recognized blobs in blob_count.
+   * Returns true if ProcessPage may use the page cache with the current
+   * settings, ie the output depends only on the image and parameters.
+   */
+  bool PageCacheable() const;
+
+  /**
+   * Writes the results to buffers as RenderText, once there are results,
+   * and keeps the length of each format to size the buffers of the next
+   * page.
+   */
+  void RenderFormats(int page_number, TextBuffer** buffers);
+  /** Renders a single format to a string that must be delete []d. */
+  char* RenderOne(TextFormat format, int page_number);
+
+  /**
+   * Walks the components at the given level once, for GetComponentImages
+   * and GetComponentViews. The boxes are in the thresholded image if
+   * in_binary, else in the source image. pixa and blockids may be NULL.
    */
-  int TextLength(int* blob_count);
+  Boxa* GetComponents(PageIteratorLevel level, bool in_binary,
+                      Pixa** pixa, int** blockids);
 
   /** @defgroup ocropusAddOns ocropus add-ons */
   /* @{ */
@@ -640,6 +830,15 @@ class TESSDLL_API TessBaseAPI {
   STRING*           language_;        ///< Last initialized language.
   OcrEngineMode last_oem_requested_;  ///< Last ocr language mode requested.
   bool          recognition_done_;    ///< page_res_ contains recognition data.
+  PageResultCache* page_cache_;       ///< Optional, not owned.
+  TessStageTimes stage_times_;        ///< Timings of the last page.
+  TessRasterBytes raster_bytes_;      ///< Image memory of the last page.
+  int text_size_hints_[TF_COUNT];     ///< Room to reserve for each format.
+  TessLogSink*      log_sink_;        ///< From SetLogFile. May be NULL.
+  /// Made by ProcessPage for the first page too large for FindLines, and
+  /// kept for its helper engines.
+  StripRecognizer*  strip_recognizer_;
+  bool              strip_results_;   ///< The last page was done in strips.
 
   /**
    * @defgroup ThresholderParams
@@ -0,0 +1,421 @@
+///////////////////////////////////////////////////////////////////////
+// File:        batchrecognizer.cpp
+// Description: Recognition of many image files, with the files read and
+//              decoded ahead of the engines on threads of their own.
+// Created:     Sun Oct 18 10:26:48 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include "batchrecognizer.h"
+#include "allheaders.h"
+#include "baseapi.h"
+#include "ndminx.h"
+#include "ocrclass.h"
+#include "tiffpagesource.h"
+#include "tprintf.h"
+
+namespace tesseract {
+
+// Returns the current wall clock time in milliseconds.
+static double NowMsecs() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec * 1000.0 + now.tv_usec / 1000.0;
+}
+
+static bool HasImageExtension(const char* name) {
+  static const char* kExtensions[] = {
+    ".tif", ".tiff", ".png", ".jpg", ".jpeg", ".bmp", ".gif",
+    ".pbm", ".pgm", ".ppm", ".pnm", NULL
+  };
+  const char* dot = strrchr(name, '.');
+  if (dot == NULL)
+    return false;
+  for (int i = 0; kExtensions[i] != NULL; ++i) {
+    const char* ext = kExtensions[i];
+    const char* p = dot;
+    while (*ext != '\0' && *p != '\0' && tolower(*p) == *ext) {
+      ++p;
+      ++ext;
+    }
+    if (*ext == '\0' && *p == '\0')
+      return true;
+  }
+  return false;
+}
+
+bool ListImageFiles(const char* dir, GenericVector<STRING>* files) {
+#ifdef WIN32
+  STRING pattern = dir;
+  pattern += "\\*";
+  WIN32_FIND_DATA data;
+  HANDLE find = FindFirstFile(pattern.string(), &data);
+  if (find == INVALID_HANDLE_VALUE)
+    return false;
+  do {
+    if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) &&
+        HasImageExtension(data.cFileName)) {
+      STRING name = dir;
+      name += "\\";
+      name += data.cFileName;
+      files->push_back(name);
+    }
+  } while (FindNextFile(find, &data));
+  FindClose(find);
+#else
+  struct stat info;
+  if (stat(dir, &info) != 0 || !S_ISDIR(info.st_mode))
+    return false;
+  DIR* dp = opendir(dir);
+  if (dp == NULL)
+    return false;
+  struct dirent* entry;
+  while ((entry = readdir(dp)) != NULL) {
+    if (entry->d_name[0] != '.' && HasImageExtension(entry->d_name)) {
+      STRING name = dir;
+      name += "/";
+      name += entry->d_name;
+      files->push_back(name);
+    }
+  }
+  closedir(dp);
+#endif
+  // Insertion sort, as directories are small and STRING has no operator<.
+  for (int i = 1; i < files->size(); ++i) {
+    for (int j = i; j > 0 &&
+         strcmp((*files)[j - 1].string(), (*files)[j].string()) > 0; --j) {
+      STRING tmp = (*files)[j];
+      (*files)[j] = (*files)[j - 1];
+      (*files)[j - 1] = tmp;
+    }
+  }
+  return true;
+}
+
+// Reads files until there are none left.
+class BatchReadTask : public TessClosure {
+ public:
+  explicit BatchReadTask(TessBatchRecognizer* recognizer)
+    : recognizer_(recognizer) {}
+  virtual void Run() {
+    recognizer_->ReadFiles();
+  }
+
+ private:
+  TessBatchRecognizer* recognizer_;
+};
+
+// Recognizes queued pages on one engine until there are none left.
+class BatchRecognizeTask : public TessClosure {
+ public:
+  BatchRecognizeTask(TessBatchRecognizer* recognizer, TessBaseAPI* engine)
+    : recognizer_(recognizer), engine_(engine) {}
+  virtual void Run() {
+    recognizer_->RecognizePages(engine_);
+  }
+
+ private:
+  TessBatchRecognizer* recognizer_;
+  TessBaseAPI* engine_;
+};
+
+TessBatchRecognizer::TessBatchRecognizer()
+  : reader_pool_(NULL), engine_pool_(NULL), files_(NULL), results_(NULL),
+    stats_(NULL), hocr_(false), next_file_(0), readers_running_(0),
+    queue_head_(0), queued_pages_(0), queued_bytes_(0) {
+}
+
+TessBatchRecognizer::~TessBatchRecognizer() {
+  End();
+}
+
+bool TessBatchRecognizer::Init(const char* datapath, const char* language,
+                               OcrEngineMode oem, int num_engines,
+                               const TessBatchOptions& options) {
+  End();
+  if (num_engines <= 0)
+    num_engines = ThreadPool::NumProcessors();
+  for (int i = 0; i < num_engines; ++i) {
+    TessBaseAPI* engine = new TessBaseAPI;
+    int result = engines_.empty()
+        ? engine->Init(datapath, language, oem)
+        : engine->InitLike(engines_[0]);
+    if (result < 0) {
+      delete engine;
+      End();
+      return false;
+    }
+    engines_.push_back(engine);
+  }
+  options_ = options;
+  options_.num_readers = MAX(options_.num_readers, 1);
+  options_.queue_depth = MAX(options_.queue_depth, 1);
+  reader_pool_ = new ThreadPool(options_.num_readers);
+  engine_pool_ = new ThreadPool(num_engines);
+  return true;
+}
+
+bool TessBatchRecognizer::SetVariable(const char* name, const char* value) {
+  for (int i = 0; i < engines_.size(); ++i) {
+    if (!engines_[i]->SetVariable(name, value))
+      return false;
+  }
+  return !engines_.empty();
+}
+
+bool TessBatchRecognizer::Recognize(const GenericVector<STRING>& files,
+                                    GenericVector<TessBatchResult>* results,
+                                    TessBatchStats* stats) {
+  results->clear();
+  if (engines_.empty())
+    return false;
+  TessBatchResult empty_result;
+  results->init_to_size(files.size(), empty_result);
+  for (int i = 0; i < files.size(); ++i)
+    (*results)[i].filename = files[i];
+  TessBatchStats batch_stats;
+  batch_stats.files = files.size();
+  if (!engines_[0]->GetBoolVariable("tessedit_create_hocr", &hocr_))
+    hocr_ = false;
+  files_ = &files;
+  results_ = results;
+  stats_ = &batch_stats;
+  next_file_ = 0;
+  // No more readers than files are worth scheduling. The engines are all
+  // scheduled, as one file may have many pages.
+  readers_running_ = MIN(options_.num_readers, files.size());
+  QueuedPage empty_page = { -1, -1, NULL, 0 };
+  queue_.init_to_size(options_.queue_depth, empty_page);
+  queue_head_ = 0;
+  queued_pages_ = 0;
+  queued_bytes_ = 0;
+  page_queued_.Reset();
+  page_taken_.Reset();
+  double start = NowMsecs();
+  if (readers_running_ > 0) {
+    for (int i = 0; i < readers_running_; ++i)
+      reader_pool_->Schedule(new BatchReadTask(this));
+    for (int i = 0; i < engines_.size(); ++i)
+      engine_pool_->Schedule(new BatchRecognizeTask(this, engines_[i]));
+    reader_pool_->WaitIdle();
+    engine_pool_->WaitIdle();
+  }
+  batch_stats.wall_msecs = NowMsecs() - start;
+  JoinPages();
+  queue_.clear();
+  files_ = NULL;
+  results_ = NULL;
+  stats_ = NULL;
+  if (stats != NULL)
+    *stats = batch_stats;
+  return true;
+}
+
+bool TessBatchRecognizer::RecognizeDirectory(
+    const char* dir, GenericVector<TessBatchResult>* results,
+    TessBatchStats* stats) {
+  GenericVector<STRING> files;
+  if (!ListImageFiles(dir, &files)) {
+    results->clear();
+    return false;
+  }
+  return Recognize(files, results, stats);
+}
+
+void TessBatchRecognizer::End() {
+  delete reader_pool_;
+  reader_pool_ = NULL;
+  delete engine_pool_;
+  engine_pool_ = NULL;
+  for (int i = 0; i < engines_.size(); ++i) {
+    engines_[i]->End();
+    delete engines_[i];
+  }
+  engines_.clear();
+}
+
+void TessBatchRecognizer::ReadFiles() {
+  for (;;) {
+    mutex_.Lock();
+    int file = next_file_ < files_->size() ? next_file_++ : -1;
+    mutex_.Unlock();
+    if (file < 0)
+      break;
+    ReadFile(file);
+  }
+  // The last reader out closes the queue, waking the engines waiting on it.
+  mutex_.Lock();
+  --readers_running_;
+  mutex_.Unlock();
+  page_queued_.Signal();
+}
+
+void TessBatchRecognizer::ReadFile(int file) {
+  const char* filename = (*files_)[file].string();
+  double start = NowMsecs();
+  double read_msecs = 0.0;
+  int pages = 0;
+  bool ok = false;
+  FILE* fp = fopen(filename, "rb");
+  if (fp != NULL) {
+    // Index the pages if a tiff file. npages is zero otherwise.
+    TiffPageSource tiff_pages;
+    tiff_pages.Open(fp);
+    int npages = tiff_pages.num_pages();
+    ok = true;
+    for (int page = 0; page < MAX(npages, 1) && ok; ++page) {
+      Pix* pix = npages > 0 ? tiff_pages.ReadPage(page)
+                            : pixReadStream(fp, 0);
+      if (pix != NULL && pixGetColormap(pix) != NULL) {
+        Pix* decoded = pixRemoveColormap(pix, REMOVE_CMAP_BASED_ON_SRC);
+        pixDestroy(&pix);
+        pix = decoded;
+      }
+      ok = pix != NULL;
+      if (pix != NULL) {
+        // The time spent waiting for room is the stall of the reader, not
+        // part of its read time.
+        read_msecs += NowMsecs() - start;
+        PushPage(file, page, pix);
+        start = NowMsecs();
+        ++pages;
+      }
+    }
+    tiff_pages.Close();
+    fclose(fp);
+  }
+  read_msecs += NowMsecs() - start;
+  if (!ok)
+    tprintf("Can't read page %d of %s\n", pages, filename);
+  mutex_.Lock();
+  TessBatchResult* result = &(*results_)[file];
+  result->ok = ok;
+  result->pages = pages;
+  result->read_msecs = read_msecs;
+  stats_->read_msecs += read_msecs;
+  mutex_.Unlock();
+}
+
+void TessBatchRecognizer::PushPage(int file, int page, Pix* pix) {
+  inT64 bytes = static_cast<inT64>(pixGetWpl(pix)) * 4 * pixGetHeight(pix);
+  mutex_.Lock();
+  double stall_start = NowMsecs();
+  while (queued_pages_ >= options_.queue_depth ||
+         (queued_pages_ > 0 && options_.max_queued_bytes > 0 &&
+          queued_bytes_ + bytes > options_.max_queued_bytes)) {
+    page_taken_.Reset();
+    mutex_.Unlock();
+    page_taken_.Wait(-1);
+    mutex_.Lock();
+  }
+  stats_->reader_stall_msecs += NowMsecs() - stall_start;
+  QueuedPage* slot =
+      &queue_[(queue_head_ + queued_pages_) % options_.queue_depth];
+  slot->file = file;
+  slot->page = page;
+  slot->pix = pix;
+  slot->bytes = bytes;
+  ++queued_pages_;
+  queued_bytes_ += bytes;
+  stats_->peak_queued_pages = MAX(stats_->peak_queued_pages, queued_pages_);
+  stats_->peak_queued_bytes = MAX(stats_->peak_queued_bytes, queued_bytes_);
+  mutex_.Unlock();
+  page_queued_.Signal();
+}
+
+bool TessBatchRecognizer::PopPage(QueuedPage* page) {
+  mutex_.Lock();
+  double stall_start = NowMsecs();
+  while (queued_pages_ == 0 && readers_running_ > 0) {
+    page_queued_.Reset();
+    mutex_.Unlock();
+    page_queued_.Wait(-1);
+    mutex_.Lock();
+  }
+  stats_->engine_stall_msecs += NowMsecs() - stall_start;
+  bool got_page = queued_pages_ > 0;
+  if (got_page) {
+    *page = queue_[queue_head_];
+    queue_[queue_head_].pix = NULL;
+    queue_head_ = (queue_head_ + 1) % options_.queue_depth;
+    --queued_pages_;
+    queued_bytes_ -= page->bytes;
+  }
+  mutex_.Unlock();
+  if (got_page)
+    page_taken_.Signal();
+  return got_page;
+}
+
+void TessBatchRecognizer::RecognizePages(TessBaseAPI* engine) {
+  QueuedPage page;
+  while (PopPage(&page)) {
+    double start = NowMsecs();
+    PageText* page_text = new PageText;
+    page_text->file = page.file;
+    page_text->page = page.page;
+    // hOCR takes the file name from the engine.
+    engine->SetInputName((*files_)[page.file].string());
+    page_text->ok = engine->ProcessPage(page.pix, page.page, NULL,
+                                        options_.timeout_msecs,
+                                        &page_text->text);
+    pixDestroy(&page.pix);
+    double msecs = NowMsecs() - start;
+    mutex_.Lock();
+    page_texts_.push_back(page_text);
+    (*results_)[page.file].recognize_msecs += msecs;
+    stats_->recognize_msecs += msecs;
+    ++stats_->pages;
+    mutex_.Unlock();
+  }
+}
+
+int TessBatchRecognizer::ComparePageTexts(const void* t1, const void* t2) {
+  const PageText* text1 = *reinterpret_cast<PageText* const*>(t1);
+  const PageText* text2 = *reinterpret_cast<PageText* const*>(t2);
+  if (text1->file != text2->file)
+    return text1->file - text2->file;
+  return text1->page - text2->page;
+}
+
+void TessBatchRecognizer::JoinPages() {
+  page_texts_.sort(&ComparePageTexts);
+  int next = 0;
+  for (int file = 0; file < results_->size(); ++file) {
+    TessBatchResult* result = &(*results_)[file];
+    if (hocr_)
+      result->text = TessBaseAPI::HOCRHeader();
+    for (; next < page_texts_.size() && page_texts_[next]->file == file;
+         ++next) {
+      result->text += page_texts_[next]->text;
+      if (!page_texts_[next]->ok)
+        result->ok = false;
+    }
+    if (hocr_)
+      result->text += TessBaseAPI::HOCRFooter();
+  }
+  page_texts_.delete_data_pointers();
+  page_texts_.clear();
+}
+
+}  // namespace tesseract.
@@ -0,0 +1,196 @@
+///////////////////////////////////////////////////////////////////////
+// File:        batchrecognizer.h
+// Description: Recognition of many image files, with the files read and
+//              decoded ahead of the engines on threads of their own.
+// Created:     Sun Oct 18 10:26:48 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_API_BATCHRECOGNIZER_H__
+#define TESSERACT_API_BATCHRECOGNIZER_H__
+
+#include "apitypes.h"
+#include "ccutil.h"
+#include "genericvector.h"
+#include "host.h"
+#include "strngs.h"
+#include "threadpool.h"
+
+struct Pix;
+
+namespace tesseract {
+
+class TessBaseAPI;
+
+// Sets files to the image files in dir, by extension, sorted by name so
+// runs are repeatable. Returns false if dir is not a directory.
+bool ListImageFiles(const char* dir, GenericVector<STRING>* files);
+
+// How far TessBatchRecognizer reads ahead of its engines.
+struct TessBatchOptions {
+  TessBatchOptions()
+    : num_readers(1), queue_depth(4), max_queued_bytes(256 << 20),
+      timeout_msecs(0) {}
+
+  int num_readers;          // Threads reading and decoding files.
+  int queue_depth;          // Most decoded pages waiting for an engine.
+  // Most bytes of decoded pages waiting for an engine, 0 for no limit. A
+  // larger page is still let in when no other is waiting.
+  inT64 max_queued_bytes;
+  int timeout_msecs;        // Per page, as for ProcessPage. 0 for none.
+};
+
+// The text of one file.
+struct TessBatchResult {
+  TessBatchResult() : ok(false), pages(0), read_msecs(0.0),
+                      recognize_msecs(0.0) {}
+
+  STRING filename;
+  // False if the file could not be read or decoded, or a page failed.
+  // The text of the pages that were recognized is kept.
+  bool ok;
+  int pages;
+  STRING text;              // All its pages, as ProcessPages gives.
+  double read_msecs;        // Reading and decoding all its pages.
+  double recognize_msecs;   // Recognizing all its pages.
+};
+
+// Where the time of a batch went. The busy times are summed over the
+// threads of a stage, so they can exceed the wall time. A stage stalls
+// when it has to wait for the other: the readers when the queue is full,
+// the engines when it is empty. Stalled engines mean recognition is
+// waiting on the disk or the decoder, so more readers may help; stalled
+// readers mean the engines are the bottleneck.
+struct TessBatchStats {
+  TessBatchStats()
+    : files(0), pages(0), wall_msecs(0.0), read_msecs(0.0),
+      recognize_msecs(0.0), reader_stall_msecs(0.0),
+      engine_stall_msecs(0.0), peak_queued_pages(0),
+      peak_queued_bytes(0) {}
+
+  int files;
+  int pages;
+  double wall_msecs;
+  double read_msecs;            // Busy time of the readers.
+  double recognize_msecs;       // Busy time of the engines.
+  double reader_stall_msecs;    // Readers waiting for room in the queue.
+  double engine_stall_msecs;    // Engines waiting for a page.
+  int peak_queued_pages;
+  inT64 peak_queued_bytes;
+};
+
+// ProcessPages reads and decodes each file on the thread that then
+// recognizes it, so the processor idles while the disk seeks and the
+// engine idles while a page decompresses. TessBatchRecognizer reads,
+// decodes and removes the colormap of pages on reader threads, and hands
+// them to a pool of engines set up alike, one per thread, through a queue
+// bounded in pages and bytes, so the decoded pages never take more memory
+// than allowed however far the readers get ahead. Each page is recognized
+// as ProcessPage does, in the output format the variables select.
+class TessBatchRecognizer {
+ public:
+  TessBatchRecognizer();
+  ~TessBatchRecognizer();
+
+  // Makes num_engines engines (one per processor if <= 0) with the
+  // arguments of TessBaseAPI::Init. Further engines share the classifier
+  // of the first. Returns false, with no engines, if any could not be
+  // made.
+  bool Init(const char* datapath, const char* language, OcrEngineMode oem,
+            int num_engines, const TessBatchOptions& options);
+  // Sets a variable on every engine. Only call between batches.
+  bool SetVariable(const char* name, const char* value);
+
+  // Recognizes every page of the files, multi-page tiffs included, and
+  // gives results one per file, in order. Returns false if the engine has
+  // not been initialized.
+  bool Recognize(const GenericVector<STRING>& files,
+                 GenericVector<TessBatchResult>* results,
+                 TessBatchStats* stats);
+  // As Recognize, on the image files of dir. Returns false if dir is not
+  // a directory.
+  bool RecognizeDirectory(const char* dir,
+                          GenericVector<TessBatchResult>* results,
+                          TessBatchStats* stats);
+
+  int num_engines() const {
+    return engines_.size();
+  }
+
+  // Stops the workers and frees the engines.
+  void End();
+
+ private:
+  friend class BatchReadTask;
+  friend class BatchRecognizeTask;
+
+  // A decoded page, waiting for an engine.
+  struct QueuedPage {
+    int file;
+    int page;
+    Pix* pix;
+    inT64 bytes;
+  };
+  // The text of a recognized page, till the batch is done.
+  struct PageText {
+    int file;
+    int page;
+    bool ok;
+    STRING text;
+  };
+
+  // Run on the reader threads. Reads files until there are none left,
+  // then closes the queue after the last reader.
+  void ReadFiles();
+  // Decodes the pages of file and queues them.
+  void ReadFile(int file);
+  // Waits for room and queues the page. Takes over pix.
+  void PushPage(int file, int page, Pix* pix);
+  // Run on the engine threads. Recognizes pages until the queue is closed
+  // and empty.
+  void RecognizePages(TessBaseAPI* engine);
+  // Waits for a page. Returns false when there will be no more.
+  bool PopPage(QueuedPage* page);
+  // Joins the text of the pages of each file into its result.
+  void JoinPages();
+  // Orders PageText pointers by file, then by page, for sort.
+  static int ComparePageTexts(const void* t1, const void* t2);
+
+  GenericVector<TessBaseAPI*> engines_;
+  TessBatchOptions options_;
+  ThreadPool* reader_pool_;
+  ThreadPool* engine_pool_;
+  // Only valid in Recognize.
+  const GenericVector<STRING>* files_;
+  GenericVector<TessBatchResult>* results_;
+  TessBatchStats* stats_;
+  bool hocr_;                       // The engines make hOCR.
+  // The fields below are guarded by mutex_.
+  CCUtilMutex mutex_;
+  ThreadEvent page_queued_;         // Signalled when a page is queued or
+                                    // the queue is closed.
+  ThreadEvent page_taken_;          // Signalled when a page is taken.
+  int next_file_;
+  int readers_running_;
+  // A ring of queue_depth slots, with queued_pages_ pages waiting from
+  // queue_head_ on.
+  GenericVector<QueuedPage> queue_;
+  int queue_head_;
+  int queued_pages_;
+  inT64 queued_bytes_;
+  GenericVector<PageText*> page_texts_;
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_API_BATCHRECOGNIZER_H__
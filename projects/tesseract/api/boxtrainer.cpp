@@ -0,0 +1,262 @@
+///////////////////////////////////////////////////////////////////////
+// File:        boxtrainer.cpp
+// Description: Box file training of many images at once, on a pool of
+//              engines in one process.
+// Created:     Sun Oct 18 09:41:37 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include "boxtrainer.h"
+#include "allheaders.h"
+#include "baseapi.h"
+#include "boxread.h"
+#include "ndminx.h"
+#include "ocrclass.h"
+#include "threadpool.h"
+#include "tiffpagesource.h"
+#include "tprintf.h"
+
+namespace tesseract {
+
+// Buffer of the feature file of each engine. A page writes a few hundred
+// kilobytes of features in thousands of small writes.
+const int kTrainingBufferBytes = 1 << 20;
+// Bytes copied at a time from the feature files to the .tr files.
+const int kTrainingCopyBytes = 1 << 16;
+
+// Returns the current wall clock time in milliseconds.
+static double NowMsecs() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec * 1000.0 + now.tv_usec / 1000.0;
+}
+
+// Trains on jobs with one engine until there are none left.
+class BoxTrainingTask : public TessClosure {
+ public:
+  BoxTrainingTask(TessBoxTrainer* trainer, int engine)
+    : trainer_(trainer), engine_(engine) {}
+  virtual void Run() {
+    int job;
+    while ((job = trainer_->NextJob()) >= 0) {
+      trainer_->TrainJob(engine_, (*trainer_->jobs_)[job],
+                         &(*trainer_->results_)[job]);
+    }
+  }
+
+ private:
+  TessBoxTrainer* trainer_;
+  int engine_;
+};
+
+TessBoxTrainer::TessBoxTrainer()
+  : pool_(NULL), jobs_(NULL), results_(NULL), find_segmentation_(false),
+    next_job_(0) {
+}
+
+TessBoxTrainer::~TessBoxTrainer() {
+  End();
+}
+
+bool TessBoxTrainer::Init(const char* datapath, const char* language,
+                          char** configs, int configs_size,
+                          int num_engines) {
+  End();
+  if (num_engines <= 0)
+    num_engines = ThreadPool::NumProcessors();
+  for (int i = 0; i < num_engines; ++i) {
+    TessBaseAPI* engine = new TessBaseAPI;
+    int result;
+    if (engines_.empty()) {
+      result = engine->Init(datapath, language, OEM_TESSERACT_ONLY,
+                            configs, configs_size, false);
+      // Box files are in the coordinates of the source image, so it must
+      // not be rescaled. InitLike copies this to the other engines.
+      if (result >= 0)
+        engine->SetVariable("tessedit_train_from_boxes", "1");
+    } else {
+      result = engine->InitLike(engines_[0]);
+    }
+    if (result < 0) {
+      delete engine;
+      End();
+      return false;
+    }
+    engines_.push_back(engine);
+  }
+  pool_ = new ThreadPool(num_engines);
+  return true;
+}
+
+bool TessBoxTrainer::Train(const GenericVector<TessTrainingJob>& jobs,
+                           bool find_segmentation, const char* tr_name,
+                           GenericVector<TessTrainingResult>* results) {
+  results->clear();
+  if (engines_.empty())
+    return false;
+  results->init_to_size(jobs.size(), TessTrainingResult());
+  // Each task keeps its engine until the jobs run out, so no more tasks
+  // than jobs are worth scheduling.
+  int num_tasks = MIN(engines_.size(), jobs.size());
+  bool ok = true;
+  for (int i = 0; i < num_tasks; ++i) {
+    FILE* tr_file = tmpfile();
+    if (tr_file == NULL) {
+      tprintf("Can't make a temporary feature file\n");
+      ok = false;
+      break;
+    }
+    setvbuf(tr_file, NULL, _IOFBF, kTrainingBufferBytes);
+    tr_files_.push_back(tr_file);
+  }
+  if (ok) {
+    jobs_ = &jobs;
+    results_ = results;
+    find_segmentation_ = find_segmentation;
+    next_job_ = 0;
+    if (num_tasks == 1) {
+      BoxTrainingTask task(this, 0);
+      task.Run();
+    } else {
+      for (int i = 0; i < num_tasks; ++i)
+        pool_->Schedule(new BoxTrainingTask(this, i));
+      pool_->WaitIdle();
+    }
+    ok = WriteFeatures(tr_name);
+    jobs_ = NULL;
+    results_ = NULL;
+  }
+  for (int i = 0; i < tr_files_.size(); ++i)
+    fclose(tr_files_[i]);
+  tr_files_.clear();
+  return ok;
+}
+
+void TessBoxTrainer::End() {
+  delete pool_;
+  pool_ = NULL;
+  for (int i = 0; i < engines_.size(); ++i) {
+    engines_[i]->End();
+    delete engines_[i];
+  }
+  engines_.clear();
+}
+
+int TessBoxTrainer::NextJob() {
+  mutex_.Lock();
+  int job = next_job_ < jobs_->size() ? next_job_++ : -1;
+  mutex_.Unlock();
+  return job;
+}
+
+void TessBoxTrainer::TrainJob(int engine, const TessTrainingJob& job,
+                              TessTrainingResult* result) {
+  double start = NowMsecs();
+  FILE* tr_file = tr_files_[engine];
+  BoxFileIndex boxes;
+  if (!boxes.Load(job.image)) {
+    tprintf("Can't open box file %s\n", BoxFileName(job.image).string());
+    return;
+  }
+  FILE* fp = fopen(job.image.string(), "rb");
+  if (fp == NULL) {
+    tprintf("Can't open %s\n", job.image.string());
+    return;
+  }
+  result->engine = engine;
+  result->tr_start = ftell(tr_file);
+  TessBaseAPI* api = engines_[engine];
+  api->SetInputName(job.image.string());
+  // Index the pages if a tiff file. npages is zero otherwise.
+  TiffPageSource tiff_pages;
+  tiff_pages.Open(fp);
+  int npages = tiff_pages.num_pages();
+  result->ok = true;
+  for (int page = 0; page < MAX(npages, 1) && result->ok; ++page) {
+    Pix* pix = npages > 0 ? tiff_pages.ReadPage(page) : pixReadStream(fp, 0);
+    result->ok = pix != NULL;
+    if (pix != NULL) {
+      api->SetImage(pix);
+      result->ok = api->TrainFromBoxes(boxes, page, find_segmentation_,
+                                       job.output.string(), tr_file) >= 0;
+      if (result->ok) {
+        ++result->pages;
+        result->boxes += boxes.num_boxes(page);
+      }
+      api->Clear();
+      pixDestroy(&pix);
+    }
+  }
+  tiff_pages.Close();
+  fclose(fp);
+  if (!result->ok)
+    tprintf("Training on page %d of %s failed\n", result->pages,
+            job.image.string());
+  result->tr_end = ftell(tr_file);
+  result->msecs = NowMsecs() - start;
+}
+
+// Copies the bytes from start to end of from to the end of to.
+static bool CopyFeatures(FILE* from, long start, long end, FILE* to) {
+  char buffer[kTrainingCopyBytes];
+  if (fseek(from, start, SEEK_SET) != 0)
+    return false;
+  while (start < end) {
+    size_t size = MIN(end - start, kTrainingCopyBytes);
+    if (fread(buffer, 1, size, from) != size ||
+        fwrite(buffer, 1, size, to) != size)
+      return false;
+    start += size;
+  }
+  return true;
+}
+
+bool TessBoxTrainer::WriteFeatures(const char* tr_name) {
+  FILE* tr_file = NULL;
+  if (tr_name != NULL) {
+    tr_file = fopen(tr_name, "w");
+    if (tr_file == NULL) {
+      tprintf("Can't open %s\n", tr_name);
+      return false;
+    }
+  }
+  bool ok = true;
+  for (int i = 0; i < results_->size(); ++i) {
+    const TessTrainingResult& result = (*results_)[i];
+    if (result.engine < 0)
+      continue;
+    FILE* out_file = tr_file;
+    STRING out_name = tr_name != NULL ? STRING(tr_name)
+                                      : (*jobs_)[i].output + ".tr";
+    if (out_file == NULL)
+      out_file = fopen(out_name.string(), "w");
+    if (out_file == NULL) {
+      tprintf("Can't open %s\n", out_name.string());
+      ok = false;
+      continue;
+    }
+    if (!CopyFeatures(tr_files_[result.engine], result.tr_start,
+                      result.tr_end, out_file)) {
+      tprintf("Can't write the features of %s to %s\n",
+              (*jobs_)[i].image.string(), out_name.string());
+      ok = false;
+    }
+    if (tr_file == NULL && fclose(out_file) != 0)
+      ok = false;
+  }
+  if (tr_file != NULL && fclose(tr_file) != 0)
+    ok = false;
+  return ok;
+}
+
+}  // namespace tesseract.
@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////
+// File:        boxtrainer.h
+// Description: Box file training of many images at once, on a pool of
+//              engines in one process.
+// Created:     Sun Oct 18 09:41:37 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_API_BOXTRAINER_H__
+#define TESSERACT_API_BOXTRAINER_H__
+
+#include <stdio.h>
+#include "ccutil.h"
+#include "genericvector.h"
+#include "strngs.h"
+
+namespace tesseract {
+
+class TessBaseAPI;
+class ThreadPool;
+
+// An image, single page or multi-page tiff, with its box file beside it
+// as tesseract expects, to train on.
+struct TessTrainingJob {
+  TessTrainingJob() {}
+  TessTrainingJob(const char* image_name, const char* output_name)
+    : image(image_name), output(output_name) {}
+
+  STRING image;
+  // The features go to output.tr, and are labelled with the font of
+  // output, as tesseract image output box.train would do.
+  STRING output;
+};
+
+// What training on a job did.
+struct TessTrainingResult {
+  TessTrainingResult()
+    : ok(false), pages(0), boxes(0), msecs(0.0),
+      engine(-1), tr_start(0), tr_end(0) {}
+
+  // False if the image or its box file could not be read, or a page could
+  // not be segmented. The features of the pages before are still written.
+  bool ok;
+  int pages;             // Pages trained on.
+  int boxes;             // Boxes read for those pages.
+  double msecs;          // Time taken by the job.
+  // Where the features are, in the feature file of the engine. engine is
+  // -1 if the image or its box file could not be opened.
+  int engine;
+  long tr_start;
+  long tr_end;
+};
+
+// Training on box files with tesseract image output box.train handles one
+// image per process, each loading the language, and reads the whole box
+// file again for every page of a multi-page tiff. TessBoxTrainer trains on
+// many images at once, on a pool of engines set up alike, one per thread.
+// The box file of each image is read once, into a BoxFileIndex. Each
+// engine writes the features of its jobs to a buffered temporary file of
+// its own, and when all the jobs are done the features of each are copied
+// out to its .tr file, in the order of the jobs, so the output is the same
+// however many engines there are.
+class TessBoxTrainer {
+ public:
+  TessBoxTrainer();
+  ~TessBoxTrainer();
+
+  // Makes num_engines engines (one per processor if <= 0) for language,
+  // initialized with the given configs, such as box.train, as by
+  // TessBaseAPI::Init. Returns false, with no engines, if any could not be
+  // made.
+  bool Init(const char* datapath, const char* language,
+            char** configs, int configs_size, int num_engines);
+
+  // Trains on all the jobs, in parallel, each job on one engine.
+  // find_segmentation is as for tessedit_resegment_from_line_boxes.
+  // Writes the features of each job to its output.tr or, if tr_name is
+  // not NULL, those of all the jobs to tr_name, one after another. The
+  // outputs of different jobs must differ. results gets one per job, in
+  // order. Returns false if the engine has not been initialized or the
+  // features could not all be written.
+  bool Train(const GenericVector<TessTrainingJob>& jobs,
+             bool find_segmentation, const char* tr_name,
+             GenericVector<TessTrainingResult>* results);
+
+  int num_engines() const {
+    return engines_.size();
+  }
+
+  // Stops the workers and frees the engines.
+  void End();
+
+ private:
+  friend class BoxTrainingTask;
+
+  // Takes the index of the next job to train on, or returns -1 if there
+  // are none left.
+  int NextJob();
+  // Trains on job with the given engine. Called on a worker thread.
+  void TrainJob(int engine, const TessTrainingJob& job,
+                TessTrainingResult* result);
+  // Copies the features of each job from the files of the engines to the
+  // .tr files. Returns false if any could not be written.
+  bool WriteFeatures(const char* tr_name);
+
+  GenericVector<TessBaseAPI*> engines_;
+  ThreadPool* pool_;
+  // The temporary feature file of each engine. Only open in Train.
+  GenericVector<FILE*> tr_files_;
+  const GenericVector<TessTrainingJob>* jobs_;  // Only valid in Train.
+  GenericVector<TessTrainingResult>* results_;
+  bool find_segmentation_;
+  CCUtilMutex mutex_;               // Guards next_job_.
+  int next_job_;
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_API_BOXTRAINER_H__
@@ -0,0 +1,178 @@
+///////////////////////////////////////////////////////////////////////
+// File:        compiletessdata.cpp
+// Description: Adds compiled, parse-free copies of the text components
+//              of a traineddata file.
+// Created:     Sun Oct 18 09:41:27 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+//
+// Usage:
+//   compile_tessdata lang.traineddata [output.traineddata]
+//
+// Reads the unicharset, unicharambigs and pffmtable components of
+// lang.traineddata and writes their compiled forms (unicharset-bin,
+// unicharambigs-bin and pffmtable-bin) into output.traineddata, or back into
+// lang.traineddata if no output is given. The compiled unicharset includes
+// the unichars that loading the ambigs adds to it, so that the compiled
+// ambigs load without changing it.
+// The engine loads the compiled components instead of parsing the text
+// ones, as long as the text ones have not been replaced since; rerun
+// compile_tessdata after combine_tessdata -o.
+
+#include "mfcpch.h"
+#ifdef HAVE_CONFIG_H
+#include "config_auto.h"
+#endif
+#include <stdio.h>
+#include "ambigs.h"
+#include "cutoffs.h"
+#include "genericvector.h"
+#include "strngs.h"
+#include "tessdatamanager.h"
+#include "unicharset.h"
+
+namespace tesseract {
+
+// Opens a component file for the compiled form of type, named after
+// output_file, and writes the header recording the size and checksum of
+// its source, source_type in manager.
+static FILE* OpenCompiledComponent(TessdataManager* manager,
+                                   TessdataType source_type,
+                                   const char* output_file,
+                                   TessdataType type,
+                                   GenericVector<STRING>* names) {
+  inT64 source_size = manager->GetComponentSize(source_type);
+  uinT32 source_checksum = 0;
+  if (source_size < 0 ||
+      !manager->GetComponentChecksum(source_type, &source_checksum)) {
+    fprintf(stderr, "Can't read the %s\n",
+            kTessdataFileSuffixes[source_type]);
+    return NULL;
+  }
+  STRING name = output_file;
+  name += ".";
+  name += kTessdataFileSuffixes[type];
+  FILE* fp = fopen(name.string(), "wb");
+  if (fp == NULL) {
+    fprintf(stderr, "Can't write %s\n", name.string());
+    return NULL;
+  }
+  names->push_back(name);
+  TessdataManager::WriteCompiledHeader(source_size, source_checksum, fp);
+  return fp;
+}
+
+// Writes the compiled components of the data loaded into manager to files
+// named after output_file, adding their names to names.
+static bool CompileComponents(TessdataManager* manager,
+                              const char* output_file,
+                              GenericVector<STRING>* names) {
+  UNICHARSET unicharset;
+  if (!manager->SeekToStart(TESSDATA_UNICHARSET) ||
+      !unicharset.load_from_file(manager->GetDataFilePtr())) {
+    fprintf(stderr, "Can't read the unicharset\n");
+    return false;
+  }
+  int num_loaded = unicharset.size();
+
+  // The ambigs go first, as they insert their ngrams and fragments into the
+  // unicharset.
+  if (manager->SeekToStart(TESSDATA_AMBIGS)) {
+    UnicharAmbigs ambigs;
+    ambigs.LoadUnicharAmbigs(manager->GetDataFilePtr(),
+                             manager->GetEndOffset(TESSDATA_AMBIGS), 0, true,
+                             &unicharset);
+    FILE* fp = OpenCompiledComponent(manager, TESSDATA_AMBIGS, output_file,
+                                     TESSDATA_AMBIGS_BIN, names);
+    if (fp == NULL)
+      return false;
+    bool ok = ambigs.SaveCompiledAmbigs(fp, unicharset);
+    fclose(fp);
+    if (!ok)
+      return false;
+    printf("Compiled unicharambigs\n");
+  }
+
+  FILE* fp = OpenCompiledComponent(manager, TESSDATA_UNICHARSET,
+                                   output_file, TESSDATA_UNICHARSET_BIN,
+                                   names);
+  if (fp == NULL)
+    return false;
+  bool ok = unicharset.save_to_binary(fp, num_loaded);
+  fclose(fp);
+  if (!ok)
+    return false;
+  printf("Compiled unicharset of %d unichars, %d from ambigs\n",
+         unicharset.size(), unicharset.size() - num_loaded);
+
+  // Only traineddata with a static classifier has a pffmtable. Its class
+  // count includes the unichars of the ambigs, as in the engine.
+  if (manager->SeekToStart(TESSDATA_PFFMTABLE)) {
+    CLASS_CUTOFF_ARRAY cutoffs;
+    ReadCutoffs(manager->GetDataFilePtr(),
+                manager->GetEndOffset(TESSDATA_PFFMTABLE), unicharset,
+                cutoffs);
+    fp = OpenCompiledComponent(manager, TESSDATA_PFFMTABLE, output_file,
+                               TESSDATA_PFFMTABLE_BIN, names);
+    if (fp == NULL)
+      return false;
+    WriteCompiledCutoffs(fp, unicharset.size(), cutoffs);
+    ok = !ferror(fp);
+    fclose(fp);
+    if (!ok)
+      return false;
+    printf("Compiled pffmtable\n");
+  }
+  return true;
+}
+
+}  // namespace tesseract.
+
+int main(int argc, char **argv) {
+  if (argc != 2 && argc != 3) {
+    fprintf(stderr, "Usage: %s lang.traineddata [output.traineddata]\n",
+            argv[0]);
+    return 2;
+  }
+  const char* input_file = argv[1];
+  // OverwriteComponents reads the input as it writes the output, so an
+  // in-place compile goes through a temporary file.
+  STRING output_file = argc == 3 ? argv[2] : input_file;
+  if (argc == 2)
+    output_file += ".tmp";
+
+  tesseract::TessdataManager manager;
+  if (!manager.Init(input_file, 0))
+    return 1;
+  GenericVector<STRING> names;
+  bool ok = tesseract::CompileComponents(&manager, output_file.string(),
+                                         &names);
+  if (ok) {
+    GenericVector<char*> component_files;
+    for (int i = 0; i < names.size(); ++i)
+      component_files.push_back(const_cast<char*>(names[i].string()));
+    ok = manager.OverwriteComponents(output_file.string(),
+                                     &component_files[0],
+                                     component_files.size());
+  }
+  manager.End();
+  for (int i = 0; i < names.size(); ++i)
+    remove(names[i].string());
+  if (ok && argc == 2) {
+    remove(input_file);
+    ok = rename(output_file.string(), input_file) == 0;
+    if (!ok)
+      fprintf(stderr, "Can't replace %s\n", input_file);
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+///////////////////////////////////////////////////////////////////////
+// File:        layoutengine.cpp
+// Description: Layout analysis of batches of pages on engines that load
+//              no recognition models.
+// Created:     Sun Oct 18 23:58:14 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include "layoutengine.h"
+#include "allheaders.h"
+#include "baseapi.h"
+#include "ndminx.h"
+#include "ocrclass.h"
+#include "osdetect.h"
+#include "pageiterator.h"
+#include "threadpool.h"
+#include "unicharset.h"
+
+namespace tesseract {
+
+// Returns the current wall clock time in milliseconds.
+static double NowMsecs() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec * 1000.0 + now.tv_usec / 1000.0;
+}
+
+// Analyses pages on one engine until there are none left.
+class LayoutTask : public TessClosure {
+ public:
+  LayoutTask(TessLayoutEngine* layout_engine, TessBaseAPI* engine)
+    : layout_engine_(layout_engine), engine_(engine) {}
+  virtual void Run() {
+    int page;
+    while ((page = layout_engine_->NextPage()) >= 0) {
+      layout_engine_->AnalysePage(engine_, layout_engine_->pages_[page],
+                                  &(*layout_engine_->layouts_)[page]);
+    }
+  }
+
+ private:
+  TessLayoutEngine* layout_engine_;
+  TessBaseAPI* engine_;
+};
+
+TessLayoutEngine::TessLayoutEngine()
+  : pool_(NULL), detect_osd_(false), pages_(NULL), num_pages_(0),
+    layouts_(NULL), next_page_(0) {
+}
+
+TessLayoutEngine::~TessLayoutEngine() {
+  End();
+}
+
+bool TessLayoutEngine::Init(const char* datapath, bool detect_osd,
+                            int num_engines) {
+  End();
+  detect_osd_ = detect_osd;
+  if (num_engines <= 0)
+    num_engines = ThreadPool::NumProcessors();
+  for (int i = 0; i < num_engines; ++i) {
+    TessBaseAPI* engine = new TessBaseAPI;
+    if (detect_osd) {
+      // The osd language holds only the orientation and script classifier.
+      // DetectOS needs it in the engine itself.
+      int result = engines_.empty()
+          ? engine->Init(datapath, "osd", OEM_TESSERACT_ONLY)
+          : engine->InitLike(engines_[0]);
+      if (result < 0) {
+        delete engine;
+        End();
+        return false;
+      }
+    } else {
+      engine->InitForAnalysePage();
+    }
+    engine->SetPageSegMode(PSM_AUTO_ONLY);
+    engines_.push_back(engine);
+  }
+  pool_ = new ThreadPool(num_engines);
+  return true;
+}
+
+bool TessLayoutEngine::AnalyseLayout(Pix** pages, int num_pages,
+                                     GenericVector<TessPageLayout>* layouts) {
+  layouts->clear();
+  if (engines_.empty())
+    return false;
+  layouts->init_to_size(num_pages, TessPageLayout());
+  pages_ = pages;
+  num_pages_ = num_pages;
+  layouts_ = layouts;
+  next_page_ = 0;
+  // Each task keeps its engine until the pages run out, so no more tasks
+  // than pages are worth scheduling.
+  int num_tasks = MIN(engines_.size(), num_pages);
+  if (num_tasks == 1) {
+    LayoutTask task(this, engines_[0]);
+    task.Run();
+  } else {
+    for (int i = 0; i < num_tasks; ++i)
+      pool_->Schedule(new LayoutTask(this, engines_[i]));
+    pool_->WaitIdle();
+  }
+  pages_ = NULL;
+  layouts_ = NULL;
+  return true;
+}
+
+void TessLayoutEngine::End() {
+  delete pool_;
+  pool_ = NULL;
+  for (int i = 0; i < engines_.size(); ++i) {
+    engines_[i]->End();
+    delete engines_[i];
+  }
+  engines_.clear();
+}
+
+int TessLayoutEngine::NextPage() {
+  mutex_.Lock();
+  int page = next_page_ < num_pages_ ? next_page_++ : -1;
+  mutex_.Unlock();
+  return page;
+}
+
+void TessLayoutEngine::AnalysePage(TessBaseAPI* engine, Pix* pix,
+                                   TessPageLayout* layout) {
+  double start = NowMsecs();
+  engine->SetImage(pix);
+  if (detect_osd_) {
+    // DetectOS leaves the thresholded image for AnalyseLayout.
+    OSResults osr;
+    if (engine->DetectOS(&osr)) {
+      layout->has_osd = true;
+      layout->orientation_id = osr.best_result.orientation_id;
+      layout->orientation_confidence = osr.best_result.oconfidence;
+      layout->script = osr.unicharset->get_script_from_script_id(
+          osr.best_result.script_id);
+      layout->script_confidence = osr.best_result.sconfidence;
+    }
+  }
+  // NULL for an empty page as well as a failure.
+  PageIterator* it = engine->AnalyseLayout();
+  if (it != NULL) {
+    TessLayoutBox box;
+    do {
+      if (!it->BoundingBox(RIL_BLOCK, &box.left, &box.top, &box.right,
+                           &box.bottom))
+        continue;
+      box.block = layout->blocks.size();
+      box.type = it->BlockType();
+      layout->blocks.push_back(box);
+      // The lines of the block, leaving the iterator on the last of them.
+      while (PTIsTextType(box.type)) {
+        TessLayoutBox line = box;
+        if (it->BoundingBox(RIL_TEXTLINE, &line.left, &line.top,
+                            &line.right, &line.bottom))
+          layout->lines.push_back(line);
+        if (it->IsAtFinalElement(RIL_BLOCK, RIL_TEXTLINE) ||
+            !it->Next(RIL_TEXTLINE))
+          break;
+      }
+    } while (it->Next(RIL_BLOCK));
+    delete it;
+  }
+  engine->Clear();
+  layout->msecs = NowMsecs() - start;
+}
+
+}  // namespace tesseract.
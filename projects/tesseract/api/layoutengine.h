@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////
+// File:        layoutengine.h
+// Description: Layout analysis of batches of pages on engines that load
+//              no recognition models.
+// Created:     Sun Oct 18 23:58:14 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_API_LAYOUTENGINE_H__
+#define TESSERACT_API_LAYOUTENGINE_H__
+
+#include "apitypes.h"
+#include "ccutil.h"
+#include "genericvector.h"
+#include "strngs.h"
+
+struct Pix;
+
+namespace tesseract {
+
+class TessBaseAPI;
+class ThreadPool;
+
+// A block or text line, in page pixels as PageIterator::BoundingBox.
+struct TessLayoutBox {
+  TessLayoutBox()
+    : left(0), top(0), right(0), bottom(0), block(0), type(PT_UNKNOWN) {}
+
+  int left, top, right, bottom;
+  int block;             // Index of the block, or of the block of a line.
+  PolyBlockType type;    // Of the block.
+};
+
+// The layout of one page.
+struct TessPageLayout {
+  TessPageLayout()
+    : has_osd(false), orientation_id(0), orientation_confidence(0.0f),
+      script_confidence(0.0f), msecs(0.0) {}
+
+  // In reading order. The lines of a block are consecutive. Non-text
+  // blocks have no lines. An empty page, or one layout analysis failed on,
+  // has no blocks.
+  GenericVector<TessLayoutBox> blocks;
+  GenericVector<TessLayoutBox> lines;
+  // Orientation and script, if the engine detects them and the page has
+  // enough text to tell. orientation_id is as in OSBestResult: 0, 1, 2 or
+  // 3 for a page that needs turning 0, 270, 180 or 90 degrees clockwise to
+  // be upright.
+  bool has_osd;
+  int orientation_id;
+  float orientation_confidence;
+  STRING script;
+  float script_confidence;
+  double msecs;          // Time taken by the page.
+};
+
+// Engines made by TessBaseAPI::InitForAnalysePage start in a few
+// milliseconds, as they load no classifier, dictionary or cube models.
+// TessLayoutEngine keeps a pool of them, one per thread, to find the
+// blocks and lines of many pages in parallel, in the triage before OCR.
+// With orientation and script detection, each engine loads the small osd
+// language instead.
+class TessLayoutEngine {
+ public:
+  TessLayoutEngine();
+  ~TessLayoutEngine();
+
+  // Makes num_engines engines (one per processor if <= 0). If detect_osd,
+  // they load osd.traineddata from datapath (the default if NULL) and
+  // find the orientation and script of each page. Returns false, with no
+  // engines, if any could not be made.
+  bool Init(const char* datapath, bool detect_osd, int num_engines);
+
+  // Finds the layout of each of the num_pages pages, in parallel, in page
+  // segmentation mode PSM_AUTO_ONLY. layouts gets one per page, in order.
+  // Returns false if the engine has not been initialized.
+  bool AnalyseLayout(Pix** pages, int num_pages,
+                     GenericVector<TessPageLayout>* layouts);
+
+  int num_engines() const {
+    return engines_.size();
+  }
+
+  // Stops the workers and frees the engines.
+  void End();
+
+ private:
+  friend class LayoutTask;
+
+  // Takes the index of the next page to analyse, or returns -1 if there
+  // are none left.
+  int NextPage();
+  // Finds the layout of pix with engine. Called on a worker thread.
+  void AnalysePage(TessBaseAPI* engine, Pix* pix, TessPageLayout* layout);
+
+  GenericVector<TessBaseAPI*> engines_;
+  ThreadPool* pool_;
+  bool detect_osd_;
+  Pix** pages_;                     // Not owned. Only valid in AnalyseLayout.
+  int num_pages_;
+  GenericVector<TessPageLayout>* layouts_;
+  CCUtilMutex mutex_;               // Guards next_page_.
+  int next_page_;
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_API_LAYOUTENGINE_H__
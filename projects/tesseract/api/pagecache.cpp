@@ -0,0 +1,434 @@
+///////////////////////////////////////////////////////////////////////
+// File:        pagecache.cpp
+// Description: Result cache for pages that repeat exactly after
+//              thresholding (cover sheets, boilerplate, fax headers).
+// Created:     Mon Oct 12 10:14:27 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+// Include automatically generated configuration file if running autoconf.
+#ifdef HAVE_CONFIG_H
+#include "config_auto.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "allheaders.h"
+#include "pagecache.h"
+#include "params.h"
+
+namespace tesseract {
+
+// Number of hash buckets in the in-memory table. Entries are chained, so
+// this only needs to be of the same order as the expected entry count.
+const int kNumCacheBuckets = 1021;
+// FNV-1a 64 bit parameters.
+const uinT64 kFnvOffsetBasis = 14695981039346656037ULL;
+const uinT64 kFnvPrime = 1099511628211ULL;
+// First line of every file in the disk store, followed by the recognition
+// time in msecs. Bump the version if the stored format changes.
+const char* kDiskEntryMagic = "tesspagecache 1";
+// Parameters that change from page to page without affecting the text of
+// any page, so must be left out of the config fingerprint.
+const char* kUnhashedParams[] = {
+  "applybox_page", "tessedit_page_number", NULL
+};
+
+// Mixes len bytes of data into the FNV-1a hash.
+static uinT64 HashBytes(uinT64 hash, const void* data, int len) {
+  const uinT8* bytes = static_cast<const uinT8*>(data);
+  for (int i = 0; i < len; ++i) {
+    hash ^= bytes[i];
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+// Returns true if the named parameter should be part of the fingerprint.
+static bool IsHashedParam(const char* name) {
+  for (int i = 0; kUnhashedParams[i] != NULL; ++i) {
+    if (strcmp(name, kUnhashedParams[i]) == 0)
+      return false;
+  }
+  return true;
+}
+
+// Mixes the names and values of a set of parameters into the hash.
+static uinT64 HashParamsVectors(uinT64 hash, const ParamsVectors* params) {
+  int i;
+  for (i = 0; i < params->int_params.size(); ++i) {
+    IntParam* p = params->int_params[i];
+    if (!IsHashedParam(p->name_str())) continue;
+    hash = PageResultCache::HashString(hash, p->name_str());
+    inT32 value = *p;
+    hash = HashBytes(hash, &value, sizeof(value));
+  }
+  for (i = 0; i < params->bool_params.size(); ++i) {
+    BoolParam* p = params->bool_params[i];
+    if (!IsHashedParam(p->name_str())) continue;
+    hash = PageResultCache::HashString(hash, p->name_str());
+    BOOL8 value = *p;
+    hash = HashBytes(hash, &value, sizeof(value));
+  }
+  for (i = 0; i < params->double_params.size(); ++i) {
+    DoubleParam* p = params->double_params[i];
+    if (!IsHashedParam(p->name_str())) continue;
+    hash = PageResultCache::HashString(hash, p->name_str());
+    double value = *p;
+    hash = HashBytes(hash, &value, sizeof(value));
+  }
+  for (i = 0; i < params->string_params.size(); ++i) {
+    StringParam* p = params->string_params[i];
+    if (!IsHashedParam(p->name_str())) continue;
+    hash = PageResultCache::HashString(hash, p->name_str());
+    hash = PageResultCache::HashString(hash, p->string());
+  }
+  return hash;
+}
+
+PageResultCache::PageResultCache(int max_entries, inT64 max_bytes,
+                                 const char* disk_dir)
+  : max_entries_(max_entries), max_bytes_(max_bytes),
+    lru_head_(NULL), lru_tail_(NULL) {
+  if (disk_dir != NULL && disk_dir[0] != '\0') {
+    disk_dir_ = disk_dir;
+    int len = disk_dir_.length();
+    if (disk_dir_[len - 1] != '/' && disk_dir_[len - 1] != '\\')
+      disk_dir_ += "/";
+  }
+  buckets_.init_to_size(kNumCacheBuckets, NULL);
+}
+
+PageResultCache::~PageResultCache() {
+  Clear();
+}
+
+// Returns a hash of the visible pixels of pix, ignoring the padding bits
+// at the end of each raster line.
+uinT64 PageResultCache::HashPix(const Pix* pix) {
+  Pix* src = const_cast<Pix*>(pix);
+  inT32 width = pixGetWidth(src);
+  inT32 height = pixGetHeight(src);
+  inT32 depth = pixGetDepth(src);
+  int wpl = pixGetWpl(src);
+  uinT64 hash = kFnvOffsetBasis;
+  hash = HashBytes(hash, &width, sizeof(width));
+  hash = HashBytes(hash, &height, sizeof(height));
+  hash = HashBytes(hash, &depth, sizeof(depth));
+  // Words wholly covered by the image, and the bits used in the last one.
+  int line_bits = width * depth;
+  int full_words = line_bits / 32;
+  int spare_bits = line_bits % 32;
+  // Leptonica packs pixels MSB first, so the padding is at the low end.
+  l_uint32 last_mask = spare_bits > 0 ? ~0U << (32 - spare_bits) : 0;
+  const l_uint32* line = pixGetData(src);
+  for (int y = 0; y < height; ++y, line += wpl) {
+    hash = HashBytes(hash, line, full_words * sizeof(*line));
+    if (spare_bits > 0) {
+      l_uint32 last = line[full_words] & last_mask;
+      hash = HashBytes(hash, &last, sizeof(last));
+    }
+  }
+  return hash;
+}
+
+// Returns a fingerprint of the language, engine mode, and the values of
+// all the given member and global parameters that can affect the output.
+uinT64 PageResultCache::HashConfig(const char* language, int oem,
+                                   const ParamsVectors* member_params) {
+  uinT64 hash = HashString(kFnvOffsetBasis, language);
+  hash = HashBytes(hash, &oem, sizeof(oem));
+  hash = HashParamsVectors(hash, GlobalParams());
+  if (member_params != NULL)
+    hash = HashParamsVectors(hash, member_params);
+  return hash;
+}
+
+// Mixes a string into an existing hash value. The terminator is included,
+// so that consecutive strings cannot run into each other.
+uinT64 PageResultCache::HashString(uinT64 hash, const char* str) {
+  if (str == NULL)
+    str = "";
+  return HashBytes(hash, str, strlen(str) + 1);
+}
+
+// Returns true and fills text if a result is available for the key.
+bool PageResultCache::Lookup(const PageCacheKey& key, STRING* text) {
+  mutex_.Lock();
+  ++stats_.lookups;
+  Entry* entry = FindEntry(key);
+  if (entry != NULL) {
+    UnlinkLru(entry);
+    PushLruFront(entry);
+    *text = entry->text;
+    ++stats_.hits;
+    stats_.saved_msecs += entry->recog_msecs;
+    mutex_.Unlock();
+    return true;
+  }
+  mutex_.Unlock();
+  if (disk_dir_.length() == 0)
+    return false;
+  // The disk read is done without the lock so other engines are not held
+  // up by file IO. Racing readers of the same page just both insert it.
+  double recog_msecs = 0.0;
+  if (!ReadDiskEntry(key, text, &recog_msecs))
+    return false;
+  mutex_.Lock();
+  ++stats_.hits;
+  ++stats_.disk_hits;
+  stats_.saved_msecs += recog_msecs;
+  if (FindEntry(key) == NULL)
+    InsertEntry(key, text->string(), recog_msecs);
+  mutex_.Unlock();
+  return true;
+}
+
+// Adds a result to the cache.
+void PageResultCache::Store(const PageCacheKey& key, const char* text,
+                            double recog_msecs) {
+  if (text == NULL)
+    return;
+  mutex_.Lock();
+  ++stats_.stores;
+  Entry* entry = FindEntry(key);
+  if (entry != NULL) {
+    // Replace the existing result, which can only differ if the adaptive
+    // classifier has changed its mind. It may be longer, so the byte limit
+    // has to be enforced again, as for a new entry.
+    stats_.bytes_used -= entry->text.length();
+    entry->text = text;
+    entry->recog_msecs = recog_msecs;
+    stats_.bytes_used += entry->text.length();
+    UnlinkLru(entry);
+    PushLruFront(entry);
+    if (max_bytes_ > 0 && entry->text.length() > max_bytes_) {
+      RemoveEntry(entry);
+    } else {
+      while (max_bytes_ > 0 && stats_.bytes_used > max_bytes_)
+        EvictLeastRecent();
+    }
+  } else {
+    InsertEntry(key, text, recog_msecs);
+  }
+  mutex_.Unlock();
+  if (disk_dir_.length() > 0)
+    WriteDiskEntry(key, text, recog_msecs);
+}
+
+// Empties the in-memory cache. The disk store is not touched.
+void PageResultCache::Clear() {
+  mutex_.Lock();
+  while (lru_head_ != NULL) {
+    Entry* entry = lru_head_;
+    lru_head_ = entry->lru_next;
+    delete entry;
+  }
+  lru_tail_ = NULL;
+  for (int i = 0; i < buckets_.size(); ++i)
+    buckets_[i] = NULL;
+  stats_.entries = 0;
+  stats_.bytes_used = 0;
+  mutex_.Unlock();
+}
+
+void PageResultCache::GetStats(PageCacheStats* stats) {
+  mutex_.Lock();
+  *stats = stats_;
+  mutex_.Unlock();
+}
+
+int PageResultCache::BucketIndex(const PageCacheKey& key) const {
+  uinT64 hash = key.image_hash ^ (key.config_hash * kFnvPrime);
+  hash ^= static_cast<uinT64>(key.format) << 32;
+  hash ^= static_cast<uinT32>(key.page_index);
+  return static_cast<int>(hash % buckets_.size());
+}
+
+PageResultCache::Entry* PageResultCache::FindEntry(const PageCacheKey& key) {
+  for (Entry* entry = buckets_[BucketIndex(key)]; entry != NULL;
+       entry = entry->hash_next) {
+    if (entry->key == key)
+      return entry;
+  }
+  return NULL;
+}
+
+// Makes a new entry, evicting old ones first to stay within the limits.
+// A single result bigger than max_bytes_ is not kept in memory at all.
+void PageResultCache::InsertEntry(const PageCacheKey& key, const char* text,
+                                  double recog_msecs) {
+  inT64 text_bytes = strlen(text);
+  if (max_bytes_ > 0 && text_bytes > max_bytes_)
+    return;
+  while (lru_tail_ != NULL &&
+         ((max_entries_ > 0 && stats_.entries >= max_entries_) ||
+          (max_bytes_ > 0 && stats_.bytes_used + text_bytes > max_bytes_)))
+    EvictLeastRecent();
+  Entry* entry = new Entry;
+  entry->key = key;
+  entry->text = text;
+  entry->recog_msecs = recog_msecs;
+  int bucket = BucketIndex(key);
+  entry->hash_next = buckets_[bucket];
+  buckets_[bucket] = entry;
+  PushLruFront(entry);
+  ++stats_.entries;
+  stats_.bytes_used += text_bytes;
+}
+
+void PageResultCache::UnlinkLru(Entry* entry) {
+  if (entry->lru_prev != NULL)
+    entry->lru_prev->lru_next = entry->lru_next;
+  else
+    lru_head_ = entry->lru_next;
+  if (entry->lru_next != NULL)
+    entry->lru_next->lru_prev = entry->lru_prev;
+  else
+    lru_tail_ = entry->lru_prev;
+  entry->lru_prev = NULL;
+  entry->lru_next = NULL;
+}
+
+void PageResultCache::PushLruFront(Entry* entry) {
+  entry->lru_prev = NULL;
+  entry->lru_next = lru_head_;
+  if (lru_head_ != NULL)
+    lru_head_->lru_prev = entry;
+  lru_head_ = entry;
+  if (lru_tail_ == NULL)
+    lru_tail_ = entry;
+}
+
+void PageResultCache::EvictLeastRecent() {
+  ++stats_.evictions;
+  RemoveEntry(lru_tail_);
+}
+
+void PageResultCache::RemoveEntry(Entry* entry) {
+  UnlinkLru(entry);
+  Entry** link = &buckets_[BucketIndex(entry->key)];
+  while (*link != entry)
+    link = &(*link)->hash_next;
+  *link = entry->hash_next;
+  --stats_.entries;
+  stats_.bytes_used -= entry->text.length();
+  delete entry;
+}
+
+// The file name is the hex key, which is unique per entry.
+void PageResultCache::MakeDiskName(const PageCacheKey& key,
+                                   STRING* name) const {
+  char buf[80];
+  snprintf(buf, sizeof(buf), "%08x%08x%08x%08x_%d_%d.tpc",
+           static_cast<uinT32>(key.image_hash >> 32),
+           static_cast<uinT32>(key.image_hash),
+           static_cast<uinT32>(key.config_hash >> 32),
+           static_cast<uinT32>(key.config_hash),
+           key.format, key.page_index);
+  *name = disk_dir_;
+  *name += buf;
+}
+
+bool PageResultCache::ReadDiskEntry(const PageCacheKey& key, STRING* text,
+                                    double* recog_msecs) const {
+  STRING name;
+  MakeDiskName(key, &name);
+  FILE* fp = fopen(name.string(), "rb");
+  if (fp == NULL)
+    return false;
+  char header[64];
+  bool ok = fgets(header, sizeof(header), fp) != NULL &&
+            strncmp(header, kDiskEntryMagic, strlen(kDiskEntryMagic)) == 0 &&
+            sscanf(header + strlen(kDiskEntryMagic), "%lf", recog_msecs) == 1;
+  if (ok) {
+    long start = ftell(fp);
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp) - start;
+    fseek(fp, start, SEEK_SET);
+    char* buffer = new char[size + 1];
+    ok = fread(buffer, 1, size, fp) == static_cast<size_t>(size);
+    buffer[size] = '\0';
+    if (ok)
+      *text = buffer;
+    delete [] buffer;
+  }
+  fclose(fp);
+  return ok;
+}
+
+// Opens a new temporary file beside name for writing, setting tmp_name to
+// its name. The name is unique to the caller, so engines in this or other
+// processes writing the same entry at once cannot mix their writes.
+static FILE* OpenTempFile(const STRING& name, STRING* tmp_name) {
+#ifdef WIN32
+  char suffix[64];
+  snprintf(suffix, sizeof(suffix), ".%lu.%lu.tmp",
+           static_cast<unsigned long>(GetCurrentProcessId()),
+           static_cast<unsigned long>(GetCurrentThreadId()));
+  *tmp_name = name;
+  *tmp_name += suffix;
+  return fopen(tmp_name->string(), "wb");
+#else
+  int len = name.length();
+  char* path = new char[len + 8];
+  snprintf(path, len + 8, "%s.XXXXXX", name.string());
+  int fd = mkstemp(path);
+  *tmp_name = path;
+  delete [] path;
+  if (fd < 0)
+    return NULL;
+  // mkstemp makes the file private, but other processes sharing the
+  // directory must be able to read the entry once it is renamed.
+  fchmod(fd, 0644);
+  FILE* fp = fdopen(fd, "wb");
+  if (fp == NULL) {
+    close(fd);
+    remove(tmp_name->string());
+  }
+  return fp;
+#endif
+}
+
+// Writes to a temporary name and renames, so a concurrent reader in another
+// process never sees a partial entry.
+void PageResultCache::WriteDiskEntry(const PageCacheKey& key, const char* text,
+                                     double recog_msecs) const {
+  STRING name;
+  MakeDiskName(key, &name);
+  STRING tmp_name;
+  FILE* fp = OpenTempFile(name, &tmp_name);
+  if (fp == NULL)
+    return;
+  fprintf(fp, "%s %.3f\n", kDiskEntryMagic, recog_msecs);
+  size_t len = strlen(text);
+  bool ok = fwrite(text, 1, len, fp) == len;
+  ok &= fclose(fp) == 0;
+  if (!ok) {
+    remove(tmp_name.string());
+    return;
+  }
+  remove(name.string());  // rename will not replace on Windows.
+  if (rename(tmp_name.string(), name.string()) != 0)
+    remove(tmp_name.string());
+}
+
+}  // namespace tesseract.
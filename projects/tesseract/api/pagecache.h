@@ -0,0 +1,156 @@
+///////////////////////////////////////////////////////////////////////
+// File:        pagecache.h
+// Description: Result cache for pages that repeat exactly after
+//              thresholding (cover sheets, boilerplate, fax headers).
+// Created:     Mon Oct 12 10:14:27 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_API_PAGECACHE_H__
+#define TESSERACT_API_PAGECACHE_H__
+
+#include "ccutil.h"
+#include "genericvector.h"
+#include "host.h"
+#include "strngs.h"
+
+struct Pix;
+
+namespace tesseract {
+
+// The kinds of text that ProcessPage can produce for a page. A cached
+// result is only valid for the kind it was made for.
+enum PageCacheFormat {
+  PCF_UTF8,
+  PCF_HOCR,
+  PCF_BOX,
+  PCF_UNLV
+};
+
+// Identifies a page result. The image hash covers the thresholded bits
+// only, so noise in the colour or grey source that thresholds identically
+// still hits. The config hash covers everything else that can change the
+// output: language, engine mode and parameter values.
+struct PageCacheKey {
+  PageCacheKey() : image_hash(0), config_hash(0), format(PCF_UTF8),
+                   page_index(-1) {}
+
+  bool operator==(const PageCacheKey& other) const {
+    return image_hash == other.image_hash &&
+           config_hash == other.config_hash &&
+           format == other.format && page_index == other.page_index;
+  }
+
+  uinT64 image_hash;
+  uinT64 config_hash;
+  inT32 format;      // PageCacheFormat.
+  // hOCR and box output embed the page number, so those results are keyed
+  // by page as well. -1 for formats that do not depend on the page.
+  inT32 page_index;
+};
+
+// Counters for monitoring the effectiveness of the cache.
+struct PageCacheStats {
+  PageCacheStats()
+    : lookups(0), hits(0), disk_hits(0), stores(0), evictions(0),
+      entries(0), bytes_used(0), saved_msecs(0.0) {}
+
+  // Fraction of lookups that were satisfied from memory or disk.
+  double hit_rate() const {
+    return lookups > 0 ? static_cast<double>(hits) / lookups : 0.0;
+  }
+
+  inT64 lookups;
+  inT64 hits;          // Includes disk_hits.
+  inT64 disk_hits;
+  inT64 stores;
+  inT64 evictions;
+  inT32 entries;       // Currently in memory.
+  inT64 bytes_used;    // Text bytes currently in memory.
+  // Sum of the recognition times originally spent on the pages that hit.
+  double saved_msecs;
+};
+
+// A bounded LRU of page results, optionally backed by a directory on disk
+// that survives the process. All methods are thread-safe, so a single cache
+// may be shared by any number of TessBaseAPI instances via SetPageCache.
+class PageResultCache {
+ public:
+  // max_entries and max_bytes bound the in-memory part of the cache. Either
+  // may be 0 for no limit on that dimension. If disk_dir is not NULL or
+  // empty, results are also written to and read from that directory, which
+  // must already exist.
+  PageResultCache(int max_entries, inT64 max_bytes, const char* disk_dir);
+  ~PageResultCache();
+
+  // Returns a hash of the visible pixels of pix, ignoring the padding bits
+  // at the end of each raster line.
+  static uinT64 HashPix(const Pix* pix);
+  // Returns a fingerprint of the language, engine mode, and the values of
+  // all the given member and global parameters that can affect the output.
+  static uinT64 HashConfig(const char* language, int oem,
+                           const ParamsVectors* member_params);
+  // Mixes a string into an existing hash value.
+  static uinT64 HashString(uinT64 hash, const char* str);
+
+  // Returns true and fills text if a result is available for the key.
+  // Memory is searched first, then the disk store, if there is one.
+  bool Lookup(const PageCacheKey& key, STRING* text);
+  // Adds a result to the cache. recog_msecs is the time spent producing it,
+  // credited to saved_msecs each time the result is used.
+  void Store(const PageCacheKey& key, const char* text, double recog_msecs);
+
+  // Empties the in-memory cache. The disk store is not touched.
+  void Clear();
+  void GetStats(PageCacheStats* stats);
+
+ private:
+  struct Entry {
+    PageCacheKey key;
+    STRING text;
+    double recog_msecs;
+    Entry* lru_prev;   // Towards most recently used.
+    Entry* lru_next;   // Towards least recently used.
+    Entry* hash_next;  // Chain within a hash bucket.
+  };
+
+  // The following must be called with mutex_ held.
+  Entry* FindEntry(const PageCacheKey& key);
+  void InsertEntry(const PageCacheKey& key, const char* text,
+                   double recog_msecs);
+  void UnlinkLru(Entry* entry);
+  void PushLruFront(Entry* entry);
+  void EvictLeastRecent();
+  void RemoveEntry(Entry* entry);
+  int BucketIndex(const PageCacheKey& key) const;
+
+  // Disk store helpers. They do not touch the in-memory state.
+  void MakeDiskName(const PageCacheKey& key, STRING* name) const;
+  bool ReadDiskEntry(const PageCacheKey& key, STRING* text,
+                     double* recog_msecs) const;
+  void WriteDiskEntry(const PageCacheKey& key, const char* text,
+                      double recog_msecs) const;
+
+  int max_entries_;
+  inT64 max_bytes_;
+  STRING disk_dir_;
+  GenericVector<Entry*> buckets_;
+  Entry* lru_head_;
+  Entry* lru_tail_;
+  PageCacheStats stats_;
+  CCUtilMutex mutex_;
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_API_PAGECACHE_H__
@@ -19,6 +19,7 @@
 ///////////////////////////////////////////////////////////////////////
 
 #include "pageiterator.h"
+#include <math.h>
 #include "allheaders.h"
 #include "helpers.h"
 #include "pageres.h"
@@ -27,7 +28,7 @@
 namespace tesseract {
 
 PageIterator::PageIterator(PAGE_RES* page_res, Tesseract* tesseract,
-                           int scale, int scaled_yres,
+                           float scale, int scaled_yres,
                            int rect_left, int rect_top,
                            int rect_width, int rect_height)
   : page_res_(page_res), tesseract_(tesseract),
@@ -207,19 +208,38 @@ bool PageIterator::BoundingBox(PageIteratorLevel level,
   if (level != RIL_SYMBOL || cblob_it_ != NULL)
     box.rotate(it_->block()->block->re_rotation());
   // Now we have a box in tesseract coordinates relative to the image rectangle,
-  // we have to convert the coords to global page coords in a top-down system.
-  *left = ClipToRange(box.left() / scale_ + rect_left_,
+  // we have to convert the coords to global page coords in a top-down system,
+  // rounding outwards if the thresholder scaled the rectangle.
+  int box_left = static_cast<int>(floor(box.left() / scale_));
+  int box_top = static_cast<int>(ceil(box.top() / scale_));
+  int box_right = static_cast<int>(ceil(box.right() / scale_));
+  int box_bottom = static_cast<int>(floor(box.bottom() / scale_));
+  *left = ClipToRange(box_left + rect_left_,
                       rect_left_, rect_left_ + rect_width_);
-  *top = ClipToRange((rect_height_ - box.top()) / scale_ + rect_top_,
+  *top = ClipToRange(rect_height_ - box_top + rect_top_,
                      rect_top_, rect_top_ + rect_height_);
-  *right = ClipToRange((box.right() + scale_ - 1) / scale_ + rect_left_,
+  *right = ClipToRange(box_right + rect_left_,
                        *left, rect_left_ + rect_width_);
-  *bottom = ClipToRange((rect_height_ - box.bottom() + scale_ - 1) / scale_
-                           + rect_top_,
+  *bottom = ClipToRange(rect_height_ - box_bottom + rect_top_,
                         *top, rect_top_ + rect_height_);
   return true;
 }
 
+// As BoundingBox, but in the coordinates of the thresholded image.
+bool PageIterator::BinaryImageBox(PageIteratorLevel level,
+                                  int* left, int* top,
+                                  int* right, int* bottom) const {
+  if (!BoundingBox(level, left, top, right, bottom))
+    return false;
+  // The binary image is of the image rectangle, at the scale of the
+  // thresholder.
+  *left = static_cast<int>(floor((*left - rect_left_) * scale_));
+  *top = static_cast<int>(floor((*top - rect_top_) * scale_));
+  *right = static_cast<int>(ceil((*right - rect_left_) * scale_));
+  *bottom = static_cast<int>(ceil((*bottom - rect_top_) * scale_));
+  return true;
+}
+
 // Returns the type of the current block. See apitypes.h for PolyBlockType.
 PolyBlockType PageIterator::BlockType() const {
   if (it_->block() == NULL || it_->block()->block == NULL)
@@ -250,7 +270,7 @@ PolyBlockType PageIterator::BlockType() const {
 // components.
 Pix* PageIterator::GetBinaryImage(PageIteratorLevel level) const {
   int left, top, right, bottom;
-  if (!BoundingBox(level, &left, &top, &right, &bottom))
+  if (!BinaryImageBox(level, &left, &top, &right, &bottom))
     return NULL;
   Pix* pix = NULL;
   switch (level) {
@@ -294,6 +314,8 @@ Pix* PageIterator::GetImage(PageIteratorLevel level, int padding,
     return GetBinaryImage(level);
 
   // Expand the box.
+  int mask_left = *left;
+  int mask_top = *top;
   *left = MAX(*left - padding, 0);
   *top = MAX(*top - padding, 0);
   right = MIN(right + padding, rect_width_);
@@ -303,8 +325,15 @@ Pix* PageIterator::GetImage(PageIteratorLevel level, int padding,
   boxDestroy(&box);
   if (level == RIL_BLOCK || level == RIL_PARA) {
     Pix* mask = it_->block()->block->render_mask();
+    // The mask is at the scale of the thresholder, and the grey image is
+    // not.
+    if (scale_ != 1.0f) {
+      Pix* scaled_mask = pixScale(mask, 1.0f / scale_, 1.0f / scale_);
+      pixDestroy(&mask);
+      mask = scaled_mask;
+    }
     Pix* expanded_mask = pixCreate(right - *left, bottom - *top, 1);
-    pixRasterop(expanded_mask, padding, padding,
+    pixRasterop(expanded_mask, mask_left - *left, mask_top - *top,
                 pixGetWidth(mask), pixGetHeight(mask),
                 PIX_SRC, mask, 0, 0);
     pixDestroy(&mask);
@@ -335,10 +364,12 @@ bool PageIterator::Baseline(PageIteratorLevel level,
   // Rotate to image coordinates and convert to global image coords.
   startpt.rotate(it_->block()->block->re_rotation());
   endpt.rotate(it_->block()->block->re_rotation());
-  *x1 = startpt.x() / scale_ + rect_left_;
-  *y1 = (rect_height_ - startpt.y()) / scale_ + rect_top_;
-  *x2 = endpt.x() / scale_ + rect_left_;
-  *y2 = (rect_height_ - endpt.y()) / scale_ + rect_top_;
+  *x1 = static_cast<int>(floor(startpt.x() / scale_ + 0.5)) + rect_left_;
+  *y1 = rect_height_ - static_cast<int>(floor(startpt.y() / scale_ + 0.5)) +
+        rect_top_;
+  *x2 = static_cast<int>(floor(endpt.x() / scale_ + 0.5)) + rect_left_;
+  *y2 = rect_height_ - static_cast<int>(floor(endpt.y() / scale_ + 0.5)) +
+        rect_top_;
   return true;
 }
 
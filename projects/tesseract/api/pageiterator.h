@@ -60,7 +60,7 @@ class PageIterator {
   // that tesseract has been given by the Thresholder.
   // After the constructor, Begin has already been called.
   PageIterator(PAGE_RES* page_res, Tesseract* tesseract,
-               int scale, int scaled_yres,
+               float scale, int scaled_yres,
                int rect_left, int rect_top,
                int rect_width, int rect_height);
   virtual ~PageIterator();
@@ -121,6 +121,13 @@ class PageIterator {
   bool BoundingBox(PageIteratorLevel level,
                    int* left, int* top, int* right, int* bottom) const;
 
+  // As BoundingBox, but in the coordinates of the thresholded image, which
+  // differ if an image rectangle has been set or the Thresholder scaled the
+  // image. This is the rectangle GetBinaryImage cuts out. It may reach past
+  // the edges of the thresholded image.
+  bool BinaryImageBox(PageIteratorLevel level,
+                      int* left, int* top, int* right, int* bottom) const;
+
   // Returns the type of the current block. See apitypes.h for PolyBlockType.
   PolyBlockType BlockType() const;
 
@@ -171,7 +178,7 @@ class PageIterator {
   // Owned by this ResultIterator.
   C_BLOB_IT* cblob_it_;
   // Parameters saved from the Thresholder. Needed to rebuild coordinates.
-  int scale_;
+  float scale_;
   int scaled_yres_;
   int rect_left_;
   int rect_top_;
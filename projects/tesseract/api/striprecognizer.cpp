@@ -0,0 +1,572 @@
+///////////////////////////////////////////////////////////////////////
+// File:        striprecognizer.cpp
+// Description: Recognizes pages too large for the 16 bit coordinates of
+//              layout analysis as overlapping strips, on several engines.
+// Created:     Sun Oct 18 17:26:13 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+
+#include "striprecognizer.h"
+#include "allheaders.h"
+#include "baseapi.h"
+#include "ndminx.h"
+#include "ocrclass.h"
+#include "publictypes.h"
+#include "resultiterator.h"
+#include "threadpool.h"
+#include "thresholder.h"
+
+namespace tesseract {
+
+// Words this close to an edge shared with another strip may be cut short.
+const int kClipMargin = 2;
+// Words from two strips are the same word if the intersection of their
+// boxes is at least this fraction of the union.
+const double kMinDuplicateIoU = 0.5;
+// A cut short word is part of a word of the other strip if at least this
+// fraction of it lies inside that word.
+const double kMinClippedCover = 0.8;
+// Character used by GetBoxText for a recognition failure.
+const char kStripReject = '~';
+// Enough chars for any inT64 in decimal, with sign and terminator.
+const int kMaxInt64Chars = 22;
+
+// Recognizes strips on one engine until there are none left.
+class StripTask : public TessClosure {
+ public:
+  StripTask(StripRecognizer* recognizer, TessBaseAPI* engine)
+    : recognizer_(recognizer), engine_(engine) {}
+  virtual void Run() {
+    StripRecognizer::Strip* strip;
+    while ((strip = recognizer_->NextStrip()) != NULL)
+      recognizer_->RecognizeStrip(engine_, strip);
+  }
+
+ private:
+  StripRecognizer* recognizer_;
+  TessBaseAPI* engine_;
+};
+
+// A word to be checked for duplicates, sortable by top with qsort.
+struct OverlapWord {
+  inT64 top;
+  int strip;
+  int index;                       // In the words of the strip.
+};
+
+static int SortByTop(const void* v1, const void* v2) {
+  const OverlapWord* w1 = reinterpret_cast<const OverlapWord*>(v1);
+  const OverlapWord* w2 = reinterpret_cast<const OverlapWord*>(v2);
+  if (w1->top != w2->top)
+    return w1->top < w2->top ? -1 : 1;
+  return 0;
+}
+
+// Fills starts with the start of each of the pieces into which size pixels
+// are cut, so that no piece is longer than max_size and neighbours share
+// overlap pixels. The pieces are as near the same length as they can be.
+static void CutIntoPieces(int size, int max_size, int overlap,
+                          GenericVector<int>* starts) {
+  int num_pieces = 1;
+  if (size > max_size) {
+    int step = max_size - overlap;
+    num_pieces = (size - overlap + step - 1) / step;
+  }
+  int length = (size + (num_pieces - 1) * overlap + num_pieces - 1) /
+      num_pieces;
+  for (int i = 0; i < num_pieces; ++i)
+    starts->push_back(i * (length - overlap));
+}
+
+// Appends prefix and the decimal value to str. STRING::add_str_int only
+// takes an int.
+static void AddInt64(const char* prefix, inT64 value, STRING* str) {
+  char number[kMaxInt64Chars];
+  snprintf(number, kMaxInt64Chars, INT64FORMAT, value);
+  *str += prefix;
+  *str += number;
+}
+
+// Appends the hOCR title of a box, as AddBoxTohOCR in baseapi.cpp.
+static void AddBox64TohOCR(inT64 left, inT64 top, inT64 right, inT64 bottom,
+                           STRING* hocr) {
+  AddInt64("' title=\"bbox ", left, hocr);
+  AddInt64(" ", top, hocr);
+  AddInt64(" ", right, hocr);
+  AddInt64(" ", bottom, hocr);
+  *hocr += "\">";
+}
+
+// Appends text to hocr with the HTML special characters escaped.
+static void AddEscapedTohOCR(const STRING& text, STRING* hocr) {
+  for (int i = 0; text[i] != '\0'; ++i) {
+    if (text[i] == '<') *hocr += "&lt;";
+    else if (text[i] == '>') *hocr += "&gt;";
+    else if (text[i] == '&') *hocr += "&amp;";
+    else if (text[i] == '"') *hocr += "&quot;";
+    else if (text[i] == '\'') *hocr += "&#39;";
+    else *hocr += text[i];
+  }
+}
+
+// Returns the scale the thresholder of an engine with the given
+// tessedit_target_dpi would recognize pix at.
+static float PageScaleFactor(const Pix* pix, int target_dpi) {
+  Pix* page = const_cast<Pix*>(pix);
+  return ImageThresholder::TargetScaleFactor(pixGetDepth(page) == 1,
+                                             pixGetYRes(page), target_dpi);
+}
+
+// Returns size scaled as the thresholder scales the sizes of an image.
+static int ScaledSize(int size, float scale) {
+  return MAX(static_cast<int>(size * scale + 0.5f), 1);
+}
+
+StripRecognizer::StripRecognizer()
+  : pix_(NULL), page_width_(0), page_height_(0), deadline_(NULL),
+    skipped_stages_(0), next_strip_(0) {
+}
+
+StripRecognizer::~StripRecognizer() {
+  for (int i = 0; i < helpers_.size(); ++i) {
+    helpers_[i]->End();
+    delete helpers_[i];
+  }
+  strips_.delete_data_pointers();
+  delete deadline_;
+}
+
+bool StripRecognizer::NeedsStrips(const Pix* pix, int target_dpi) {
+  Pix* page = const_cast<Pix*>(pix);
+  float scale = PageScaleFactor(pix, target_dpi);
+  return ScaledSize(pixGetWidth(page), scale) > MAX_INT16 ||
+         ScaledSize(pixGetHeight(page), scale) > MAX_INT16;
+}
+
+bool StripRecognizer::Recognize(TessBaseAPI* api, Pix* pix,
+                                int timeout_msecs) {
+  strips_.delete_data_pointers();
+  strips_.clear();
+  words_.clear();
+  skipped_stages_ = 0;
+  pix_ = pix;
+  page_width_ = pixGetWidth(pix);
+  page_height_ = pixGetHeight(pix);
+  int strip_size = MAX_INT16;
+  int overlap = 0;
+  int num_engines = 0;
+  int target_dpi = 0;
+  api->GetIntVariable("tessedit_strip_size", &strip_size);
+  api->GetIntVariable("tessedit_strip_overlap", &overlap);
+  api->GetIntVariable("tessedit_strip_threads", &num_engines);
+  api->GetIntVariable("tessedit_target_dpi", &target_dpi);
+  if (strip_size > MAX_INT16 || strip_size <= 0)
+    strip_size = MAX_INT16;
+  if (overlap < 0)
+    overlap = 0;
+  if (overlap > strip_size / 2)
+    overlap = strip_size / 2;
+  MakeStrips(strip_size, overlap, PageScaleFactor(pix, target_dpi));
+
+  delete deadline_;
+  deadline_ = new ETEXT_DESC;
+  if (timeout_msecs > 0)
+    deadline_->set_deadline_msecs(timeout_msecs);
+  if (num_engines <= 0)
+    num_engines = ThreadPool::NumProcessors();
+  if (num_engines > strips_.size())
+    num_engines = strips_.size();
+  // The caller's engine does a share of the strips, with helpers made
+  // like it for the rest. Helpers kept from an earlier page are started
+  // like it again, which only copies its variables unless its language or
+  // engine mode changed. If a helper can't be made, fewer run at once.
+  int num_helpers = 0;
+  while (num_helpers + 1 < num_engines) {
+    if (num_helpers == helpers_.size())
+      helpers_.push_back(new TessBaseAPI);
+    if (helpers_[num_helpers]->InitLike(api) < 0) {
+      helpers_[num_helpers]->End();
+      delete helpers_[num_helpers];
+      helpers_.remove(num_helpers);
+      break;
+    }
+    ++num_helpers;
+  }
+  next_strip_ = 0;
+  if (num_helpers == 0) {
+    StripTask task(this, api);
+    task.Run();
+  } else {
+    ThreadPool pool(num_helpers + 1);
+    pool.Schedule(new StripTask(this, api));
+    for (int i = 0; i < num_helpers; ++i)
+      pool.Schedule(new StripTask(this, helpers_[i]));
+    pool.WaitIdle();
+  }
+  pix_ = NULL;
+
+  int num_done = 0;
+  for (int s = 0; s < strips_.size(); ++s) {
+    if (strips_[s]->done) {
+      ++num_done;
+      skipped_stages_ |= strips_[s]->skipped_stages;
+    }
+  }
+  if (num_done > 0)
+    JoinStrips();
+  if (num_done < strips_.size())
+    skipped_stages_ |= RS_STRIPS;
+  strips_.delete_data_pointers();
+  strips_.clear();
+  return num_done > 0;
+}
+
+// Dimensions that fit in an inT16 are not cut, so a tall page is cut into
+// strips the full width of the page, and only a page that is too large
+// both ways is cut into tiles.
+void StripRecognizer::MakeStrips(int strip_size, int overlap, float scale) {
+  GenericVector<int> x_starts, y_starts;
+  int width = static_cast<int>(page_width_);
+  int height = static_cast<int>(page_height_);
+  // The pieces are cut in page pixels.
+  int page_strip_size = static_cast<int>(strip_size / scale);
+  int page_overlap = static_cast<int>(overlap / scale + 0.5f);
+  CutIntoPieces(width,
+                ScaledSize(width, scale) > MAX_INT16 ? page_strip_size
+                                                     : width,
+                page_overlap, &x_starts);
+  CutIntoPieces(height,
+                ScaledSize(height, scale) > MAX_INT16 ? page_strip_size
+                                                      : height,
+                page_overlap, &y_starts);
+  for (int y = 0; y < y_starts.size(); ++y) {
+    for (int x = 0; x < x_starts.size(); ++x) {
+      Strip* strip = new Strip;
+      strip->left = x_starts[x];
+      strip->top = y_starts[y];
+      strip->width = (x + 1 < x_starts.size()
+                      ? x_starts[x + 1] + page_overlap : width) - strip->left;
+      strip->height = (y + 1 < y_starts.size()
+                       ? y_starts[y + 1] + page_overlap : height) - strip->top;
+      strips_.push_back(strip);
+    }
+  }
+}
+
+StripRecognizer::Strip* StripRecognizer::NextStrip() {
+  mutex_.Lock();
+  Strip* strip = next_strip_ < strips_.size() ? strips_[next_strip_++] : NULL;
+  mutex_.Unlock();
+  return strip;
+}
+
+void StripRecognizer::RecognizeStrip(TessBaseAPI* engine, Strip* strip) {
+  if (deadline_->deadline_exceeded())
+    return;
+  Box* box = boxCreate(strip->left, strip->top, strip->width, strip->height);
+  Pix* strip_pix = pixClipRectangle(pix_, box, NULL);
+  boxDestroy(&box);
+  if (strip_pix == NULL)
+    return;
+  ETEXT_DESC monitor;
+  monitor.end_time = deadline_->end_time;
+  engine->SetImage(strip_pix);
+  ResultIterator* it = NULL;
+  if (engine->Recognize(&monitor) >= 0)
+    it = engine->GetIterator();
+  if (it == NULL) {
+    engine->Clear();
+    pixDestroy(&strip_pix);
+    return;
+  }
+  // Edges of the strip that are not edges of the page.
+  bool inner_left = strip->left > 0;
+  bool inner_top = strip->top > 0;
+  bool inner_right = strip->left + strip->width < page_width_;
+  bool inner_bottom = strip->top + strip->height < page_height_;
+  int block = -1, line = -1;
+  bool in_word = false;
+  do {
+    int left, top, right, bottom;
+    if (it->IsAtBeginningOf(RIL_BLOCK))
+      ++block;
+    if (it->IsAtBeginningOf(RIL_TEXTLINE))
+      ++line;
+    if (it->IsAtBeginningOf(RIL_WORD)) {
+      in_word = it->BoundingBox(RIL_WORD, &left, &top, &right, &bottom);
+      if (in_word) {
+        StripWord word;
+        char* text = it->GetUTF8Text(RIL_WORD);
+        word.text = text;
+        delete [] text;
+        word.confidence = it->Confidence(RIL_WORD);
+        word.left = strip->left + left;
+        word.top = strip->top + top;
+        word.right = strip->left + right;
+        word.bottom = strip->top + bottom;
+        bool bold, italic, underlined, monospace, serif, smallcaps;
+        if (it->WordFontAttributes(&bold, &italic, &underlined, &monospace,
+                                   &serif, &smallcaps, &word.pointsize,
+                                   &word.font_id) != NULL) {
+          word.bold = bold;
+          word.italic = italic;
+        } else {
+          word.font_id = -1;
+          word.pointsize = 0;
+        }
+        word.block = block;
+        word.line = line;
+        word.clipped = (inner_left && left <= kClipMargin) ||
+                       (inner_top && top <= kClipMargin) ||
+                       (inner_right && right >= strip->width - kClipMargin) ||
+                       (inner_bottom && bottom >= strip->height - kClipMargin);
+        strip->words.push_back(word);
+      }
+    }
+    if (in_word &&
+        it->BoundingBox(RIL_SYMBOL, &left, &top, &right, &bottom)) {
+      StripSymbol symbol;
+      char* text = it->GetUTF8Text(RIL_SYMBOL);
+      symbol.text = text;
+      delete [] text;
+      symbol.confidence = it->Confidence(RIL_SYMBOL);
+      symbol.left = strip->left + left;
+      symbol.top = strip->top + top;
+      symbol.right = strip->left + right;
+      symbol.bottom = strip->top + bottom;
+      strip->words[strip->words.size() - 1].symbols.push_back(symbol);
+    }
+  } while (it->Next(RIL_SYMBOL));
+  delete it;
+  strip->skipped_stages = engine->GetSkippedStages();
+  engine->Clear();
+  pixDestroy(&strip_pix);
+  strip->done = true;
+}
+
+// Returns how far the box is from the nearest edge the strip shares with
+// another strip, or a large value if it shares none.
+static inT64 InnerEdgeDistance(const StripWord& word, int strip_left,
+                               int strip_top, int strip_right,
+                               int strip_bottom, inT64 page_width,
+                               inT64 page_height) {
+  inT64 distance = MAX_INT32;
+  if (strip_left > 0 && word.left - strip_left < distance)
+    distance = word.left - strip_left;
+  if (strip_top > 0 && word.top - strip_top < distance)
+    distance = word.top - strip_top;
+  if (strip_right < page_width && strip_right - word.right < distance)
+    distance = strip_right - word.right;
+  if (strip_bottom < page_height && strip_bottom - word.bottom < distance)
+    distance = strip_bottom - word.bottom;
+  return distance;
+}
+
+void StripRecognizer::JoinStrips() {
+  GenericVector<OverlapWord> overlap_words;
+  // Only words that reach into a neighbour can have a duplicate there.
+  for (int s = 0; s < strips_.size(); ++s) {
+    Strip* strip = strips_[s];
+    strip->keep.init_to_size(strip->words.size(), true);
+    for (int w = 0; w < strip->words.size(); ++w) {
+      const StripWord& word = strip->words[w];
+      for (int n = 0; n < strips_.size(); ++n) {
+        const Strip* other = strips_[n];
+        if (n != s && word.left < other->left + other->width &&
+            word.right > other->left &&
+            word.top < other->top + other->height &&
+            word.bottom > other->top) {
+          OverlapWord overlap_word;
+          overlap_word.top = word.top;
+          overlap_word.strip = s;
+          overlap_word.index = w;
+          overlap_words.push_back(overlap_word);
+          break;
+        }
+      }
+    }
+  }
+  overlap_words.sort(&SortByTop);
+  for (int i = 0; i < overlap_words.size(); ++i) {
+    const OverlapWord& a = overlap_words[i];
+    const StripWord& word_a = strips_[a.strip]->words[a.index];
+    for (int j = i + 1; j < overlap_words.size() &&
+         overlap_words[j].top < word_a.bottom; ++j) {
+      const OverlapWord& b = overlap_words[j];
+      if (a.strip == b.strip || !strips_[a.strip]->keep[a.index] ||
+          !strips_[b.strip]->keep[b.index])
+        continue;
+      const StripWord& word_b = strips_[b.strip]->words[b.index];
+      inT64 overlap_width = MIN(word_a.right, word_b.right) -
+          MAX(word_a.left, word_b.left);
+      inT64 overlap_height = MIN(word_a.bottom, word_b.bottom) -
+          MAX(word_a.top, word_b.top);
+      if (overlap_width <= 0 || overlap_height <= 0)
+        continue;
+      double area_a = static_cast<double>(word_a.right - word_a.left) *
+          (word_a.bottom - word_a.top);
+      double area_b = static_cast<double>(word_b.right - word_b.left) *
+          (word_b.bottom - word_b.top);
+      double intersection = static_cast<double>(overlap_width) *
+          overlap_height;
+      bool duplicate =
+          intersection >= kMinDuplicateIoU *
+                          (area_a + area_b - intersection) ||
+          (word_a.clipped && intersection >= kMinClippedCover * area_a) ||
+          (word_b.clipped && intersection >= kMinClippedCover * area_b);
+      if (!duplicate)
+        continue;
+      // Keep the whole word, or failing that the one further from the
+      // edge of its strip.
+      bool drop_a;
+      if (word_a.clipped != word_b.clipped) {
+        drop_a = word_a.clipped;
+      } else {
+        const Strip* strip_a = strips_[a.strip];
+        const Strip* strip_b = strips_[b.strip];
+        drop_a = InnerEdgeDistance(word_a, strip_a->left, strip_a->top,
+                                   strip_a->left + strip_a->width,
+                                   strip_a->top + strip_a->height,
+                                   page_width_, page_height_) <
+                 InnerEdgeDistance(word_b, strip_b->left, strip_b->top,
+                                   strip_b->left + strip_b->width,
+                                   strip_b->top + strip_b->height,
+                                   page_width_, page_height_);
+      }
+      if (drop_a)
+        strips_[a.strip]->keep[a.index] = false;
+      else
+        strips_[b.strip]->keep[b.index] = false;
+    }
+  }
+  // Number the blocks and lines over the page as the words are moved out.
+  int block = -1, line = -1;
+  for (int s = 0; s < strips_.size(); ++s) {
+    const GenericVector<StripWord>& words = strips_[s]->words;
+    int prev_block = -1, prev_line = -1;
+    for (int w = 0; w < words.size(); ++w) {
+      if (!strips_[s]->keep[w])
+        continue;
+      if (words[w].block != prev_block) {
+        ++block;
+        prev_block = words[w].block;
+      }
+      if (words[w].line != prev_line) {
+        ++line;
+        prev_line = words[w].line;
+      }
+      words_.push_back(words[w]);
+      words_[words_.size() - 1].block = block;
+      words_[words_.size() - 1].line = line;
+    }
+  }
+}
+
+void StripRecognizer::AppendUTF8Text(STRING* text) const {
+  for (int w = 0; w < words_.size(); ++w) {
+    *text += words_[w].text;
+    bool end_of_line = w + 1 == words_.size() ||
+                       words_[w + 1].line != words_[w].line;
+    *text += end_of_line ? "\n" : " ";
+  }
+  *text += "\n";
+}
+
+// The blocks and lines have no boxes of their own here, so they are given
+// the union of the boxes of their words.
+void StripRecognizer::AppendHOCRText(int page_number, const char* input_name,
+                                     STRING* hocr) const {
+  int page_id = page_number + 1;  // hOCR uses 1-based page numbers.
+  hocr->add_str_int("<div class='ocr_page' id='page_", page_id);
+  *hocr += "' title='image \"";
+  *hocr += input_name;
+  *hocr += "\"; bbox 0 0";
+  AddInt64(" ", page_width_, hocr);
+  AddInt64(" ", page_height_, hocr);
+  *hocr += "'>\n";
+  for (int w = 0; w < words_.size(); ++w) {
+    const StripWord& word = words_[w];
+    bool start_of_block = w == 0 || words_[w - 1].block != word.block;
+    bool start_of_line = w == 0 || words_[w - 1].line != word.line;
+    if (start_of_block) {
+      inT64 left = word.left, top = word.top;
+      inT64 right = word.right, bottom = word.bottom;
+      for (int b = w + 1; b < words_.size() && words_[b].block == word.block;
+           ++b) {
+        left = MIN(left, words_[b].left);
+        top = MIN(top, words_[b].top);
+        right = MAX(right, words_[b].right);
+        bottom = MAX(bottom, words_[b].bottom);
+      }
+      hocr->add_str_int("<div class='ocr_carea' id='block_", page_id);
+      hocr->add_str_int("_", word.block + 1);
+      AddBox64TohOCR(left, top, right, bottom, hocr);
+      *hocr += "\n<p class='ocr_par'>\n";
+    }
+    if (start_of_line) {
+      inT64 left = word.left, top = word.top;
+      inT64 right = word.right, bottom = word.bottom;
+      for (int l = w + 1; l < words_.size() && words_[l].line == word.line;
+           ++l) {
+        left = MIN(left, words_[l].left);
+        top = MIN(top, words_[l].top);
+        right = MAX(right, words_[l].right);
+        bottom = MAX(bottom, words_[l].bottom);
+      }
+      hocr->add_str_int("<span class='ocr_line' id='line_", page_id);
+      hocr->add_str_int("_", word.line + 1);
+      AddBox64TohOCR(left, top, right, bottom, hocr);
+    }
+    hocr->add_str_int("<span class='ocr_word' id='word_", page_id);
+    hocr->add_str_int("_", w + 1);
+    AddBox64TohOCR(word.left, word.top, word.right, word.bottom, hocr);
+    hocr->add_str_int("<span class='xocr_word' id='xword_", page_id);
+    hocr->add_str_int("_", w + 1);
+    // GetHOCRText gives the certainty the confidence was made from.
+    hocr->add_str_int("' title=\"x_wconf ",
+                      static_cast<int>((word.confidence - 100.0f) / 5.0f));
+    *hocr += "\">";
+    AddEscapedTohOCR(word.text, hocr);
+    *hocr += "</span></span>";
+    bool end_of_line = w + 1 == words_.size() ||
+                       words_[w + 1].line != word.line;
+    bool end_of_block = w + 1 == words_.size() ||
+                        words_[w + 1].block != word.block;
+    *hocr += end_of_line ? "</span>\n" : " ";
+    if (end_of_block)
+      *hocr += "</p>\n</div>\n";
+  }
+  *hocr += "</div>\n";
+}
+
+void StripRecognizer::AppendBoxText(int page_number, STRING* text) const {
+  for (int w = 0; w < words_.size(); ++w) {
+    const GenericVector<StripSymbol>& symbols = words_[w].symbols;
+    for (int s = 0; s < symbols.size(); ++s) {
+      const StripSymbol& symbol = symbols[s];
+      // Spaces would make an illegal box file.
+      for (int i = 0; symbol.text[i] != '\0'; ++i)
+        *text += symbol.text[i] == ' ' ? kStripReject : symbol.text[i];
+      AddInt64(" ", symbol.left, text);
+      AddInt64(" ", page_height_ - symbol.bottom, text);
+      AddInt64(" ", symbol.right, text);
+      AddInt64(" ", page_height_ - symbol.top, text);
+      text->add_str_int(" ", page_number);
+      *text += "\n";
+    }
+  }
+}
+
+}  // namespace tesseract.
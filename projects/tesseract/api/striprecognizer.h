@@ -0,0 +1,167 @@
+///////////////////////////////////////////////////////////////////////
+// File:        striprecognizer.h
+// Description: Recognizes pages too large for the 16 bit coordinates of
+//              layout analysis as overlapping strips, on several engines.
+// Created:     Sun Oct 18 17:26:13 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_API_STRIPRECOGNIZER_H__
+#define TESSERACT_API_STRIPRECOGNIZER_H__
+
+#include "ccutil.h"
+#include "genericvector.h"
+#include "host.h"
+#include "strngs.h"
+
+class ETEXT_DESC;
+struct Pix;
+
+namespace tesseract {
+
+class TessBaseAPI;
+
+// A recognized symbol, in the coordinates of the whole page.
+struct StripSymbol {
+  StripSymbol() : confidence(0.0f), left(0), top(0), right(0), bottom(0) {}
+
+  STRING text;           // UTF-8.
+  float confidence;      // 0-100, as ResultIterator::Confidence.
+  // Page pixels, with y down, right and bottom exclusive, as PageIterator.
+  inT64 left, top, right, bottom;
+};
+
+// A recognized word, in the coordinates of the whole page.
+struct StripWord {
+  StripWord()
+    : confidence(0.0f), left(0), top(0), right(0), bottom(0),
+      font_id(-1), pointsize(0), bold(false), italic(false),
+      block(0), line(0), clipped(false) {}
+
+  STRING text;           // UTF-8.
+  float confidence;      // 0-100, as ResultIterator::Confidence.
+  inT64 left, top, right, bottom;
+  // As ResultIterator::WordFontAttributes, with -1 for no font.
+  int font_id;
+  int pointsize;
+  bool bold;
+  bool italic;
+  // Index of the block and line of the word, counted over the whole page.
+  // Words of the same line are consecutive.
+  int block;
+  int line;
+  // True if the word touches an edge its strip shares with another, so it
+  // may have been cut short.
+  bool clipped;
+  GenericVector<StripSymbol> symbols;
+};
+
+// TBOX and ICOORD hold inT16s, so layout analysis can't work on a page
+// wider or taller than MAX_INT16. StripRecognizer splits such a page into
+// strips (tiles, if the page is too large both ways) that overlap by more
+// than the largest word, recognizes them in parallel on engines set up like
+// the caller's, and joins the results, offset back to page coordinates.
+// A word in an overlap is seen by both strips, so of every pair of words
+// from neighbouring strips whose boxes overlap enough to be the same word,
+// only the one less likely to have been cut short is kept.
+// The text of each strip is in reading order, and strips are output a row
+// at a time, top to bottom, so a line cut by an edge between tiles is
+// output as two lines.
+// The helper engines are kept from one page to the next, so a recognizer
+// should live as long as the engine it helps, as TessBaseAPI keeps its own.
+class StripRecognizer {
+ public:
+  StripRecognizer();
+  ~StripRecognizer();
+
+  // Returns true if pix is too large for TessBaseAPI::Recognize, once
+  // scaled down to target_dpi as the thresholder would.
+  static bool NeedsStrips(const Pix* pix, int target_dpi);
+
+  // Recognizes pix using api, which must be initialized, and as many extra
+  // engines, made by TessBaseAPI::InitLike, as tessedit_strip_threads
+  // allows. The strip size and overlap, in pixels after any scaling to
+  // tessedit_target_dpi, come from the variables of api.
+  // If timeout_msecs > 0, it is the deadline for the whole page.
+  // A strip that fails, or is not reached by the deadline, is left out, and
+  // skipped_stages then includes RS_STRIPS. Returns false, with no words,
+  // only if every strip failed.
+  bool Recognize(TessBaseAPI* api, Pix* pix, int timeout_msecs);
+
+  // The words found by Recognize, in output order.
+  const GenericVector<StripWord>& words() const {
+    return words_;
+  }
+  inT64 page_width() const {
+    return page_width_;
+  }
+  inT64 page_height() const {
+    return page_height_;
+  }
+  // The stages left out of the page, as TessBaseAPI::GetSkippedStages: those
+  // skipped by any strip, and RS_STRIPS if any strip was left out.
+  int skipped_stages() const {
+    return skipped_stages_;
+  }
+
+  // Append the results in the formats of TessBaseAPI::GetUTF8Text,
+  // GetHOCRText and GetBoxText. page_number is 0-based.
+  void AppendUTF8Text(STRING* text) const;
+  void AppendHOCRText(int page_number, const char* input_name,
+                      STRING* hocr) const;
+  void AppendBoxText(int page_number, STRING* text) const;
+
+ private:
+  friend class StripTask;
+
+  // A rectangle of the page and the words recognized in it.
+  struct Strip {
+    Strip()
+      : left(0), top(0), width(0), height(0), done(false),
+        skipped_stages(0) {}
+
+    int left, top, width, height;
+    bool done;                     // Recognized without error.
+    int skipped_stages;            // As TessBaseAPI::GetSkippedStages.
+    GenericVector<StripWord> words;
+    GenericVector<bool> keep;      // Per word, false for a duplicate.
+  };
+
+  // Splits the page into strips of at most strip_size each way, sharing
+  // overlap pixels with their neighbours, where sizes are of the page once
+  // scaled by scale. Only a dimension too large at that scale is cut.
+  void MakeStrips(int strip_size, int overlap, float scale);
+  // Takes the next strip to recognize, or returns NULL if there are none.
+  Strip* NextStrip();
+  // Recognizes the strip with engine, filling in its words. Called on a
+  // worker thread.
+  void RecognizeStrip(TessBaseAPI* engine, Strip* strip);
+  // Drops the duplicate words of overlapping strips and moves the rest
+  // into words_.
+  void JoinStrips();
+
+  Pix* pix_;                       // Not owned. Only valid in Recognize.
+  inT64 page_width_;
+  inT64 page_height_;
+  ETEXT_DESC* deadline_;           // Owned. The end time of the page.
+  GenericVector<TessBaseAPI*> helpers_;  // Owned. Kept between pages.
+  GenericVector<Strip*> strips_;
+  GenericVector<StripWord> words_;
+  int skipped_stages_;
+  CCUtilMutex mutex_;              // Guards next_strip_.
+  int next_strip_;
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_API_STRIPRECOGNIZER_H__
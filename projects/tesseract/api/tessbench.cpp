@@ -0,0 +1,1843 @@
+///////////////////////////////////////////////////////////////////////
+// File:        tessbench.cpp
+// Description: Throughput and latency benchmark over a corpus of pages.
+// Created:     Wed Oct 14 11:20:52 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+//
+// Usage:
+//   tessbench [options] corpus...
+//
+// Each corpus argument is an image file, a multi-page tiff, or a directory
+// of them. All pages are decoded up front and every engine is initialized
+// once, so only recognition is measured. Options:
+//   -l lang           Language (default eng).
+//   -tessdata dir     Parent directory of tessdata.
+//   -psm n            Page segmentation mode (default 3, PSM_AUTO).
+//   -oem n            OCR engine mode (default 3, OEM_DEFAULT).
+//   -threads n        Engines run in parallel (default 1).
+//   -iterations n     Timed passes over the corpus (default 3).
+//   -warmup n         Untimed passes first (default 1).
+//   -json file        Write the report to file instead of stdout.
+//   -baseline file    Compare against a report saved earlier, and exit
+//                     with status 1 on a regression.
+//   -tolerance pct    Allowed slowdown against the baseline (default 5).
+//   -budget           Set tessedit_memory_budget on every engine. The
+//                     report gives the image memory of the largest page.
+//
+//   tessbench -allocs image iterations
+//
+// instead counts the alloc_mem and alloc_string calls made recognizing
+// image that many times, per recognized word. The STRINGs kept inline,
+// which took a heap buffer each before short strings were stored in
+// place, are counted too, to give the count from before that change.
+//
+//   tessbench -containers n
+//
+// instead times GenericVector growth, insertion and sorting with n elements
+// of the element types the engine stores in them.
+//
+//   tessbench -cluster n threads
+//
+// instead clusters n random samples, and times prototype generation by
+// ClusterSamples against ClusterSamplesInParallel on that many threads.
+// It exits with status 1 if the two make different prototypes.
+//
+//   tessbench -load lang.traineddata iterations
+//
+// instead times loading the unicharset, unicharambigs and pffmtable
+// components from their text and compiled forms, as written by
+// compile_tessdata. It exits with
+// status 1 if the two forms load differently.
+//
+//   tessbench -classify image iterations
+//
+// instead cuts the symbols of the layout of image (such as phototest.tif)
+// into blobs, and times the adaptive classifier on each of them, printing
+// the time per blob and a checksum of the choices to compare builds by.
+//
+//   tessbench -engines lang n
+//
+// instead initializes n engines for lang and prints the memory the first
+// and each further one takes. Further engines share the classifier of the
+// first, so they should take much less.
+//
+//   tessbench -blocks image iterations
+//
+// instead times how soon RecognizeByBlock hands out the first block of
+// image, and the whole page, against the latency of Recognize.
+//
+//   tessbench -tiff image pages
+//
+// instead writes a tiff of that many copies of image and times reading
+// its pages by page number against reading them through the directory
+// index of TiffPageSource, as ProcessPages does.
+//
+//   tessbench -render image expected iterations
+//
+// instead recognizes image once and times writing its UTF-8, hOCR, box and
+// UNLV text with a call per format against one RenderText of all four. The
+// expected text is read from expected.txt, expected.html, expected.box and
+// expected.unlv, which must hold what GetUTF8Text, GetHOCRText(0),
+// GetBoxText(0) and GetUNLVText returned for image, with image as the input
+// name, in a build from before RenderText. It exits with status 1 if either
+// way of writing the text differs from them.
+//
+//   tessbench -worker tessworker image iterations
+//
+// instead times recognizing image in this process against recognizing it
+// in a TessWorkerPool of one tessworker process, started from the given
+// path, to show what shipping the page and the results costs. It exits
+// with status 1 if the two texts differ.
+//
+//   tessbench -components image iterations
+//
+// instead times GetComponentImages of the words of image against
+// GetComponentViews, and GetRegions, whose block masks are kept after the
+// first call. It exits with status 1 if a view differs from its image.
+//
+//   tessbench -layout image pages
+//
+// instead times starting a layout-only TessLayoutEngine against a full
+// engine for eng, then the layout of that many copies of image on one
+// engine against one per processor. It exits with status 1 if the layouts
+// differ.
+//
+//   tessbench -train image jobs
+//
+// instead trains on that many copies of image, whose box file must be
+// beside it, with a TessBoxTrainer of one engine against one per
+// processor. It exits with status 1 if their features differ.
+//
+//   tessbench -prefetch dir readers
+//
+// instead recognizes the image files of dir one after another with
+// ProcessPages, against a TessBatchRecognizer of one engine and one per
+// processor, fed by that many reader threads, and prints where the time of
+// each batch went. It exits with status 1 if the texts differ.
+
+#include "mfcpch.h"
+#ifdef HAVE_CONFIG_H
+#include "config_auto.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef WIN32
+#include <windows.h>
+#include <psapi.h>
+#include "gettimeofday.h"
+#else
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+#include "allheaders.h"
+#include "ambigs.h"
+#include "baseapi.h"
+#include "batchrecognizer.h"
+#include "blobs.h"
+#include "boxtrainer.h"
+#include "ccutil.h"
+#include "cluster.h"
+#include "cutoffs.h"
+#include "genericvector.h"
+#include "layoutengine.h"
+#include "normalis.h"
+#include "ocrrow.h"
+#include "pageiterator.h"
+#include "resultiterator.h"
+#include "strngs.h"
+#include "tesscallback.h"
+#include "tessdatamanager.h"
+#include "textrenderer.h"
+#include "threadpool.h"
+#include "tiffpagesource.h"
+#include "unicharset.h"
+#include "workerpool.h"
+
+namespace tesseract {
+
+// Timings of one recognition of one page, in milliseconds, and the memory
+// taken by its images.
+struct PageRun {
+  double latency_msecs;
+  TessStageTimes stages;
+  TessRasterBytes rasters;
+};
+
+struct BenchOptions {
+  BenchOptions()
+    : lang("eng"), datapath(NULL), psm(PSM_AUTO), oem(OEM_DEFAULT),
+      threads(1), iterations(3), warmup(1), json_file(NULL),
+      baseline_file(NULL), tolerance_pct(5.0), memory_budget(false) {}
+
+  const char* lang;
+  const char* datapath;
+  int psm;
+  int oem;
+  int threads;
+  int iterations;
+  int warmup;
+  const char* json_file;
+  const char* baseline_file;
+  double tolerance_pct;
+  bool memory_budget;   // Sets tessedit_memory_budget on every engine.
+};
+
+static double NowMsecs() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec * 1000.0 + now.tv_usec / 1000.0;
+}
+
+// Returns the peak resident set size of this process in kilobytes.
+static inT64 PeakRssKb() {
+#ifdef WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return counters.PeakWorkingSetSize / 1024;
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;  // Bytes on OS X.
+#else
+  return usage.ru_maxrss;
+#endif
+#endif
+}
+
+// Decodes every page of the given image file onto the end of pages.
+static bool LoadImageFile(const char* filename, GenericVector<Pix*>* pages) {
+  FILE* fp = fopen(filename, "rb");
+  if (fp == NULL)
+    return false;
+  TiffPageSource tiff_pages;
+  if (tiff_pages.Open(fp)) {
+    bool ok = true;
+    for (int page = 0; page < tiff_pages.num_pages() && ok; ++page) {
+      Pix* pix = tiff_pages.ReadPage(page);
+      ok = pix != NULL;
+      if (ok)
+        pages->push_back(pix);
+    }
+    tiff_pages.Close();
+    fclose(fp);
+    return ok;
+  }
+  fclose(fp);
+  Pix* pix = pixRead(filename);
+  if (pix == NULL)
+    return false;
+  pages->push_back(pix);
+  return true;
+}
+
+class Bench;
+
+// Recognizes one page on whichever engine is free.
+class BenchTask : public TessClosure {
+ public:
+  BenchTask(Bench* bench, int page, bool timed)
+    : bench_(bench), page_(page), timed_(timed) {}
+  virtual void Run();
+
+ private:
+  Bench* bench_;
+  int page_;
+  bool timed_;
+};
+
+class Bench {
+ public:
+  explicit Bench(const BenchOptions& options) : options_(options) {}
+  ~Bench() {
+    for (int i = 0; i < engines_.size(); ++i) {
+      engines_[i]->End();
+      delete engines_[i];
+    }
+    for (int i = 0; i < pages_.size(); ++i)
+      pixDestroy(&pages_[i]);
+  }
+
+  bool LoadCorpus(const char* path) {
+    GenericVector<STRING> files;
+    if (!ListImageFiles(path, &files))
+      files.push_back(STRING(path));
+    for (int i = 0; i < files.size(); ++i) {
+      if (!LoadImageFile(files[i].string(), &pages_)) {
+        fprintf(stderr, "Failed to read %s\n", files[i].string());
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool InitEngines() {
+    for (int i = 0; i < options_.threads; ++i) {
+      TessBaseAPI* api = new TessBaseAPI;
+      if (api->Init(options_.datapath, options_.lang,
+                    static_cast<OcrEngineMode>(options_.oem)) < 0) {
+        delete api;
+        return false;
+      }
+      api->SetPageSegMode(static_cast<PageSegMode>(options_.psm));
+      if (options_.memory_budget)
+        api->SetVariable("tessedit_memory_budget", "1");
+      engines_.push_back(api);
+      free_engines_.push_back(api);
+    }
+    return true;
+  }
+
+  // Runs the warm-up and timed passes. Returns the wall time of the timed
+  // passes in milliseconds.
+  double Run() {
+    ThreadPool pool(options_.threads);
+    for (int i = 0; i < options_.warmup; ++i) {
+      for (int page = 0; page < pages_.size(); ++page)
+        pool.Schedule(new BenchTask(this, page, false));
+    }
+    pool.WaitIdle();
+    double start_msecs = NowMsecs();
+    for (int i = 0; i < options_.iterations; ++i) {
+      for (int page = 0; page < pages_.size(); ++page)
+        pool.Schedule(new BenchTask(this, page, true));
+    }
+    pool.WaitIdle();
+    return NowMsecs() - start_msecs;
+  }
+
+  void RunPage(int page, bool timed) {
+    mutex_.Lock();
+    TessBaseAPI* api = free_engines_[free_engines_.size() - 1];
+    free_engines_.truncate(free_engines_.size() - 1);
+    mutex_.Unlock();
+
+    PageRun run;
+    double start_msecs = NowMsecs();
+    api->SetImage(pages_[page]);
+    char* text = api->GetUTF8Text();
+    run.latency_msecs = NowMsecs() - start_msecs;
+    run.stages = api->GetStageTimes();
+    run.rasters = api->GetRasterBytes();
+    delete [] text;
+    api->Clear();
+
+    mutex_.Lock();
+    free_engines_.push_back(api);
+    if (timed)
+      runs_.push_back(run);
+    mutex_.Unlock();
+  }
+
+  int num_pages() const {
+    return pages_.size();
+  }
+  const GenericVector<PageRun>& runs() const {
+    return runs_;
+  }
+
+ private:
+  BenchOptions options_;
+  GenericVector<Pix*> pages_;
+  GenericVector<TessBaseAPI*> engines_;
+  CCUtilMutex mutex_;   // Guards free_engines_ and runs_.
+  GenericVector<TessBaseAPI*> free_engines_;
+  GenericVector<PageRun> runs_;
+};
+
+void BenchTask::Run() {
+  bench_->RunPage(page_, timed_);
+}
+
+// The figures written to the report and compared against a baseline.
+struct BenchReport {
+  BenchReport()
+    : pages(0), runs(0), wall_msecs(0.0), pages_per_sec(0.0),
+      p50_msecs(0.0), p95_msecs(0.0), p99_msecs(0.0), peak_rss_kb(0),
+      threshold_msecs(0.0), layout_msecs(0.0), recognize_msecs(0.0),
+      other_msecs(0.0) {}
+
+  int pages;
+  int runs;
+  double wall_msecs;
+  double pages_per_sec;
+  double p50_msecs;
+  double p95_msecs;
+  double p99_msecs;
+  inT64 peak_rss_kb;
+  // Mean per page.
+  double threshold_msecs;
+  double layout_msecs;
+  double recognize_msecs;
+  double other_msecs;       // Image setup and text output.
+  // Of the page with the most image memory at once.
+  TessRasterBytes rasters;
+};
+
+// Nearest-rank percentile of sorted values.
+static double Percentile(const GenericVector<double>& sorted, double pct) {
+  if (sorted.empty())
+    return 0.0;
+  int rank = static_cast<int>(pct / 100.0 * sorted.size() + 0.999999);
+  if (rank < 1)
+    rank = 1;
+  if (rank > sorted.size())
+    rank = sorted.size();
+  return sorted[rank - 1];
+}
+
+static void MakeReport(const Bench& bench, double wall_msecs,
+                       BenchReport* report) {
+  const GenericVector<PageRun>& runs = bench.runs();
+  report->pages = bench.num_pages();
+  report->runs = runs.size();
+  report->wall_msecs = wall_msecs;
+  if (wall_msecs > 0.0)
+    report->pages_per_sec = runs.size() * 1000.0 / wall_msecs;
+  GenericVector<double> latencies;
+  double total_latency = 0.0;
+  for (int i = 0; i < runs.size(); ++i) {
+    latencies.push_back(runs[i].latency_msecs);
+    total_latency += runs[i].latency_msecs;
+    report->threshold_msecs += runs[i].stages.threshold_msecs;
+    report->layout_msecs += runs[i].stages.layout_msecs;
+    report->recognize_msecs += runs[i].stages.recognize_msecs;
+    if (runs[i].rasters.peak_bytes > report->rasters.peak_bytes)
+      report->rasters = runs[i].rasters;
+  }
+  latencies.sort();
+  report->p50_msecs = Percentile(latencies, 50.0);
+  report->p95_msecs = Percentile(latencies, 95.0);
+  report->p99_msecs = Percentile(latencies, 99.0);
+  report->peak_rss_kb = PeakRssKb();
+  if (!runs.empty()) {
+    report->threshold_msecs /= runs.size();
+    report->layout_msecs /= runs.size();
+    report->recognize_msecs /= runs.size();
+    report->other_msecs = total_latency / runs.size() -
+        report->threshold_msecs - report->layout_msecs -
+        report->recognize_msecs;
+  }
+}
+
+static void WriteReport(const BenchOptions& options,
+                        const BenchReport& report, FILE* fp) {
+  fprintf(fp, "{\n");
+  fprintf(fp, "  \"version\": \"%s\",\n", TessBaseAPI::Version());
+  fprintf(fp, "  \"lang\": \"%s\",\n", options.lang);
+  fprintf(fp, "  \"psm\": %d,\n", options.psm);
+  fprintf(fp, "  \"oem\": %d,\n", options.oem);
+  fprintf(fp, "  \"threads\": %d,\n", options.threads);
+  fprintf(fp, "  \"iterations\": %d,\n", options.iterations);
+  fprintf(fp, "  \"pages\": %d,\n", report.pages);
+  fprintf(fp, "  \"runs\": %d,\n", report.runs);
+  fprintf(fp, "  \"wall_msecs\": %.3f,\n", report.wall_msecs);
+  fprintf(fp, "  \"pages_per_sec\": %.4f,\n", report.pages_per_sec);
+  fprintf(fp, "  \"p50_msecs\": %.3f,\n", report.p50_msecs);
+  fprintf(fp, "  \"p95_msecs\": %.3f,\n", report.p95_msecs);
+  fprintf(fp, "  \"p99_msecs\": %.3f,\n", report.p99_msecs);
+  fprintf(fp, "  \"peak_rss_kb\": %lld,\n",
+          static_cast<long long>(report.peak_rss_kb));
+  fprintf(fp, "  \"stages_msecs\": {\n");
+  fprintf(fp, "    \"threshold\": %.3f,\n", report.threshold_msecs);
+  fprintf(fp, "    \"layout\": %.3f,\n", report.layout_msecs);
+  fprintf(fp, "    \"recognize\": %.3f,\n", report.recognize_msecs);
+  fprintf(fp, "    \"other\": %.3f\n", report.other_msecs);
+  fprintf(fp, "  },\n");
+  fprintf(fp, "  \"raster_bytes\": {\n");
+  fprintf(fp, "    \"source\": %lld,\n",
+          static_cast<long long>(report.rasters.source_bytes));
+  fprintf(fp, "    \"work\": %lld,\n",
+          static_cast<long long>(report.rasters.work_bytes));
+  fprintf(fp, "    \"grey\": %lld,\n",
+          static_cast<long long>(report.rasters.grey_bytes));
+  fprintf(fp, "    \"binary\": %lld,\n",
+          static_cast<long long>(report.rasters.binary_bytes));
+  fprintf(fp, "    \"peak\": %lld\n",
+          static_cast<long long>(report.rasters.peak_bytes));
+  fprintf(fp, "  }\n");
+  fprintf(fp, "}\n");
+}
+
+// Finds "key": number in a report written by WriteReport. This is not a
+// general JSON parser, only enough to read our own output back.
+static bool ReadReportValue(const STRING& json, const char* key,
+                            double* value) {
+  STRING quoted = "\"";
+  quoted += key;
+  quoted += "\":";
+  const char* pos = strstr(json.string(), quoted.string());
+  return pos != NULL &&
+         sscanf(pos + quoted.length(), "%lf", value) == 1;
+}
+
+// Reads the whole of a text file into text. Returns false if it can't be
+// opened.
+static bool ReadTextFile(const char* filename, STRING* text) {
+  FILE* fp = fopen(filename, "rb");
+  if (fp == NULL)
+    return false;
+  char buffer[1024];
+  size_t bytes;
+  while ((bytes = fread(buffer, 1, sizeof(buffer) - 1, fp)) > 0) {
+    buffer[bytes] = '\0';
+    *text += buffer;
+  }
+  fclose(fp);
+  return true;
+}
+
+// Returns false if report is slower than the baseline in baseline_file by
+// more than tolerance_pct on throughput or tail latency.
+static bool CompareToBaseline(const char* baseline_file, double tolerance_pct,
+                              const BenchReport& report) {
+  STRING json;
+  if (!ReadTextFile(baseline_file, &json)) {
+    fprintf(stderr, "Can't open baseline %s\n", baseline_file);
+    return false;
+  }
+
+  double base_throughput, base_p95, base_p99;
+  if (!ReadReportValue(json, "pages_per_sec", &base_throughput) ||
+      !ReadReportValue(json, "p95_msecs", &base_p95) ||
+      !ReadReportValue(json, "p99_msecs", &base_p99)) {
+    fprintf(stderr, "Baseline %s is not a tessbench report\n",
+            baseline_file);
+    return false;
+  }
+  double slack = tolerance_pct / 100.0;
+  bool ok = true;
+  if (report.pages_per_sec < base_throughput * (1.0 - slack)) {
+    fprintf(stderr, "REGRESSION: %.3f pages/sec vs baseline %.3f\n",
+            report.pages_per_sec, base_throughput);
+    ok = false;
+  }
+  if (report.p95_msecs > base_p95 * (1.0 + slack)) {
+    fprintf(stderr, "REGRESSION: p95 %.1f ms vs baseline %.1f ms\n",
+            report.p95_msecs, base_p95);
+    ok = false;
+  }
+  if (report.p99_msecs > base_p99 * (1.0 + slack)) {
+    fprintf(stderr, "REGRESSION: p99 %.1f ms vs baseline %.1f ms\n",
+            report.p99_msecs, base_p99);
+    ok = false;
+  }
+  if (ok) {
+    fprintf(stderr, "Within %.1f%% of baseline: %.3f pages/sec (was %.3f),"
+            " p95 %.1f ms (was %.1f)\n", tolerance_pct,
+            report.pages_per_sec, base_throughput,
+            report.p95_msecs, base_p95);
+  }
+  return ok;
+}
+
+// Allocation count benchmark. The first recognition loads the dictionaries
+// and is not counted. The words are counted outside the counted span.
+static bool RunAllocsBench(const char* image_file, int iterations) {
+  Pix* pix = pixRead(image_file);
+  if (pix == NULL) {
+    fprintf(stderr, "Failed to read %s\n", image_file);
+    return false;
+  }
+  TessBaseAPI api;
+  if (api.Init(NULL, "eng") < 0) {
+    pixDestroy(&pix);
+    return false;
+  }
+  bool ok = true;
+  inT64 allocs = 0;
+  inT64 inline_strings = 0;
+  int words = 0;
+  for (int i = 0; i <= iterations && ok; ++i) {
+    api.SetImage(pix);
+    mem_counts.allocs = 0;
+    mem_counts.inline_strings = 0;
+    mem_counting_on = i > 0;
+    ok = api.Recognize(NULL) == 0;
+    char* text = ok ? api.GetUTF8Text() : NULL;
+    mem_counting_on = false;
+    ok = text != NULL;
+    delete [] text;
+    if (!ok || i == 0)
+      continue;
+    allocs += mem_counts.allocs;
+    inline_strings += mem_counts.inline_strings;
+    ResultIterator* it = api.GetIterator();
+    if (it != NULL) {
+      int left, top, right, bottom;
+      do {
+        if (it->BoundingBox(RIL_WORD, &left, &top, &right, &bottom))
+          ++words;
+      } while (it->Next(RIL_WORD));
+      delete it;
+    }
+  }
+  if (ok && words > 0) {
+    printf("%d words: %.1f allocations per word,"
+           " %.1f with every STRING on the heap\n", words / iterations,
+           static_cast<double>(allocs) / words,
+           static_cast<double>(allocs + inline_strings) / words);
+  } else {
+    fprintf(stderr, "Failed to recognize %s, or it has no words\n",
+            image_file);
+    ok = false;
+  }
+  api.End();
+  pixDestroy(&pix);
+  return ok;
+}
+
+// Container microbenchmarks.
+
+// Element values for the container benchmarks, sized like the engine's own:
+// a word's correct_text entry, or an ambiguity's UnicharIdVector.
+static void MakeElement(int i, int* value) {
+  *value = i;
+}
+static void MakeElement(int i, STRING* value) {
+  *value = "";
+  value->add_str_int("w", i);
+}
+static void MakeElement(int i, GenericVector<int>* value) {
+  value->clear();
+  for (int j = 0; j < 4; ++j)
+    value->push_back(i + j);
+}
+
+// Times pushing n elements onto an empty vector, then inserting n / 16 at
+// the front, and prints both.
+template <typename T>
+static void TimeVectorOps(const char* name, int n) {
+  T value;
+  MakeElement(n, &value);
+  double start = NowMsecs();
+  GenericVector<T> vector;
+  for (int i = 0; i < n; ++i)
+    vector.push_back(value);
+  double grow_msecs = NowMsecs() - start;
+  start = NowMsecs();
+  for (int i = 0; i < n / 16; ++i)
+    vector.insert(value, 0);
+  double insert_msecs = NowMsecs() - start;
+  printf("%-28s push_back %10.3f msecs  insert %10.3f msecs\n",
+         name, grow_msecs, insert_msecs);
+}
+
+// Times sort() against the qsort comparator overload on n random ints.
+static void TimeSort(int n) {
+  GenericVector<int> values;
+  for (int i = 0; i < n; ++i)
+    values.push_back(rand());
+  GenericVector<int> copy(values);
+  double start = NowMsecs();
+  values.sort();
+  double sort_msecs = NowMsecs() - start;
+  start = NowMsecs();
+  copy.sort(&sort_cmp<int>);
+  double qsort_msecs = NowMsecs() - start;
+  printf("%-28s sort      %10.3f msecs  qsort  %10.3f msecs\n",
+         "GenericVector<int>", sort_msecs, qsort_msecs);
+}
+
+static void RunContainerBench(int n) {
+  TimeVectorOps<int>("GenericVector<int>", n);
+  TimeVectorOps<STRING>("GenericVector<STRING>", n);
+  TimeVectorOps<GenericVector<int> >("GenericVector<UnicharIdVector>", n);
+  TimeSort(n);
+}
+
+// Clustering benchmark.
+
+const int kClusterDims = 4;
+const int kClusterClumps = 64;
+
+// Makes a clusterer holding n samples in clumps, the same ones every time.
+static CLUSTERER* MakeBenchClusterer(int n, const PARAM_DESC* desc) {
+  CLUSTERER* clusterer = MakeClusterer(kClusterDims, desc);
+  srand(n);
+  FLOAT32 feature[kClusterDims];
+  for (int i = 0; i < n; ++i) {
+    int clump = rand() % kClusterClumps;
+    for (int d = 0; d < kClusterDims; ++d) {
+      feature[d] = (clump + d * 7) % kClusterClumps / FLOAT32(kClusterClumps) +
+                   (rand() % 1000) / 64000.0f;
+    }
+    // Three samples per character, as from the features of a glyph.
+    MakeSample(clusterer, feature, i / 3);
+  }
+  return clusterer;
+}
+
+// Returns true if the lists hold the same prototypes in the same order.
+static bool SamePrototypes(LIST list1, LIST list2) {
+  for (; list1 != NIL_LIST && list2 != NIL_LIST;
+       list1 = list_rest(list1), list2 = list_rest(list2)) {
+    PROTOTYPE* proto1 = reinterpret_cast<PROTOTYPE*>(first_node(list1));
+    PROTOTYPE* proto2 = reinterpret_cast<PROTOTYPE*>(first_node(list2));
+    if (proto1->Significant != proto2->Significant ||
+        proto1->Style != proto2->Style ||
+        proto1->NumSamples != proto2->NumSamples ||
+        proto1->TotalMagnitude != proto2->TotalMagnitude ||
+        memcmp(proto1->Mean, proto2->Mean,
+               kClusterDims * sizeof(*proto1->Mean)) != 0)
+      return false;
+  }
+  return list1 == NIL_LIST && list2 == NIL_LIST;
+}
+
+static bool RunClusterBench(int n, int threads) {
+  PARAM_DESC desc[kClusterDims];
+  for (int d = 0; d < kClusterDims; ++d) {
+    desc[d].Circular = FALSE;
+    desc[d].NonEssential = FALSE;
+    desc[d].Min = 0.0f;
+    desc[d].Max = 1.0f;
+    desc[d].Range = 1.0f;
+    desc[d].HalfRange = 0.5f;
+    desc[d].MidRange = 0.5f;
+  }
+  // The settings of mftraining.
+  CLUSTERCONFIG config = { elliptical, 0.625, 0.05, 1.0, 1e-6, 0 };
+
+  // The first ClusterSamples also builds the cluster tree, so only the
+  // second one of each clusterer is prototype generation alone.
+  CLUSTERER* serial = MakeBenchClusterer(n, desc);
+  double start = NowMsecs();
+  ClusterSamples(serial, &config);
+  double tree_msecs = NowMsecs() - start;
+  start = NowMsecs();
+  LIST serial_protos = ClusterSamples(serial, &config);
+  double serial_msecs = NowMsecs() - start;
+
+  CLUSTERER* parallel = MakeBenchClusterer(n, desc);
+  ClusterSamples(parallel, &config);
+  start = NowMsecs();
+  LIST parallel_protos = ClusterSamplesInParallel(parallel, &config, threads);
+  double parallel_msecs = NowMsecs() - start;
+
+  bool same = SamePrototypes(serial_protos, parallel_protos);
+  printf("%d samples: tree %.1f msecs, prototypes serial %.1f msecs,"
+         " %d threads %.1f msecs, %d prototypes %s\n",
+         n, tree_msecs, serial_msecs, threads, parallel_msecs,
+         count(serial_protos), same ? "identical" : "DIFFERENT");
+  // FreeClusterer detaches the prototypes, so it must go first.
+  FreeClusterer(serial);
+  FreeClusterer(parallel);
+  FreeProtoList(&serial_protos);
+  FreeProtoList(&parallel_protos);
+  return same;
+}
+
+// Load time benchmark.
+
+static bool SameUnicharsets(const UNICHARSET& set1, const UNICHARSET& set2) {
+  if (set1.size() != set2.size() ||
+      set1.get_script_table_size() != set2.get_script_table_size() ||
+      set1.default_sid() != set2.default_sid() ||
+      set1.script_has_upper_lower() != set2.script_has_upper_lower() ||
+      set1.script_has_xheight() != set2.script_has_xheight())
+    return false;
+  for (int id = 0; id < set1.size(); ++id) {
+    int bottom1, bottom2, bottom3, bottom4, top1, top2, top3, top4;
+    set1.get_top_bottom(id, &bottom1, &bottom2, &top1, &top2);
+    set2.get_top_bottom(id, &bottom3, &bottom4, &top3, &top4);
+    if (strcmp(set1.id_to_unichar(id), set2.id_to_unichar(id)) != 0 ||
+        set1.get_properties(id) != set2.get_properties(id) ||
+        set1.get_script(id) != set2.get_script(id) ||
+        set1.get_other_case(id) != set2.get_other_case(id) ||
+        set1.get_isngram(id) != set2.get_isngram(id) ||
+        bottom1 != bottom3 || bottom2 != bottom4 ||
+        top1 != top3 || top2 != top4)
+      return false;
+  }
+  return true;
+}
+
+// Returns true if the two vectors hold the same ids, treating NULL as
+// empty.
+static bool SameIds(const UnicharIdVector* ids1, const UnicharIdVector* ids2) {
+  int size1 = ids1 == NULL ? 0 : ids1->size();
+  int size2 = ids2 == NULL ? 0 : ids2->size();
+  if (size1 != size2)
+    return false;
+  for (int i = 0; i < size1; ++i) {
+    if ((*ids1)[i] != (*ids2)[i])
+      return false;
+  }
+  return true;
+}
+
+static bool SameAmbigTables(const UnicharAmbigsVector& table1,
+                            const UnicharAmbigsVector& table2, int size) {
+  for (int id = 0; id < size; ++id) {
+    AmbigSpec_LIST* list1 = id < table1.size() ? table1[id] : NULL;
+    AmbigSpec_LIST* list2 = id < table2.size() ? table2[id] : NULL;
+    if ((list1 == NULL ? 0 : list1->length()) !=
+        (list2 == NULL ? 0 : list2->length()))
+      return false;
+    if (list1 == NULL || list2 == NULL)
+      continue;
+    AmbigSpec_IT it1(list1);
+    AmbigSpec_IT it2(list2);
+    for (it1.mark_cycle_pt(); !it1.cycled_list();
+         it1.forward(), it2.forward()) {
+      const AmbigSpec* spec1 = it1.data();
+      const AmbigSpec* spec2 = it2.data();
+      if (spec1->type != spec2->type ||
+          spec1->correct_ngram_id != spec2->correct_ngram_id ||
+          UnicharIdArrayUtils::compare(spec1->wrong_ngram,
+                                       spec2->wrong_ngram) != 0 ||
+          UnicharIdArrayUtils::compare(spec1->correct_fragments,
+                                       spec2->correct_fragments) != 0)
+        return false;
+    }
+  }
+  return true;
+}
+
+static bool SameAmbigs(const UnicharAmbigs& ambigs1,
+                       const UnicharAmbigs& ambigs2, int size) {
+  if (!SameAmbigTables(ambigs1.replace_ambigs(), ambigs2.replace_ambigs(),
+                       size) ||
+      !SameAmbigTables(ambigs1.dang_ambigs(), ambigs2.dang_ambigs(), size))
+    return false;
+  for (int id = 0; id < ambigs1.dang_ambigs().size(); ++id) {
+    const UNICHAR_ID* definite1;
+    const UNICHAR_ID* definite2;
+    int count = ambigs1.OneToOneDefiniteAmbigs(id, &definite1);
+    if (ambigs2.OneToOneDefiniteAmbigs(id, &definite2) != count ||
+        (count > 0 &&
+         memcmp(definite1, definite2, count * sizeof(*definite1)) != 0) ||
+        !SameIds(ambigs1.AmbigsForAdaption(id),
+                 ambigs2.AmbigsForAdaption(id)) ||
+        !SameIds(ambigs1.ReverseAmbigsForAdaption(id),
+                 ambigs2.ReverseAmbigsForAdaption(id)))
+      return false;
+  }
+  return true;
+}
+
+static bool RunLoadBench(const char* traineddata, int iterations) {
+  TessdataManager manager;
+  if (!manager.Init(traineddata, 0))
+    return false;
+  FILE* fp = manager.GetDataFilePtr();
+  bool has_ambigs = manager.GetComponentSize(TESSDATA_AMBIGS) >= 0;
+  // The ambigs are timed with the unicharset, as loading them from text
+  // inserts into it.
+  UNICHARSET text_set, compiled_set;
+  UnicharAmbigs text_ambigs, compiled_ambigs;
+  double start = NowMsecs();
+  for (int i = 0; i < iterations; ++i) {
+    manager.SeekToStart(TESSDATA_UNICHARSET);
+    text_set.load_from_file(fp);
+    if (has_ambigs) {
+      manager.SeekToStart(TESSDATA_AMBIGS);
+      text_ambigs.LoadUnicharAmbigs(fp, manager.GetEndOffset(TESSDATA_AMBIGS),
+                                    0, true, &text_set);
+    }
+  }
+  double text_msecs = (NowMsecs() - start) / iterations;
+  if (!manager.SeekToCompiledStart(TESSDATA_UNICHARSET_BIN,
+                                   TESSDATA_UNICHARSET) ||
+      (has_ambigs && !manager.SeekToCompiledStart(TESSDATA_AMBIGS_BIN,
+                                                  TESSDATA_AMBIGS))) {
+    fprintf(stderr, "%s has no up to date compiled unicharset or ambigs,"
+            " run compile_tessdata on it\n", traineddata);
+    manager.End();
+    return false;
+  }
+  bool read = true;
+  start = NowMsecs();
+  for (int i = 0; i < iterations; ++i) {
+    manager.SeekToCompiledStart(TESSDATA_UNICHARSET_BIN, TESSDATA_UNICHARSET);
+    read = compiled_set.load_from_binary(fp, false) && read;
+    if (has_ambigs) {
+      manager.SeekToCompiledStart(TESSDATA_AMBIGS_BIN, TESSDATA_AMBIGS);
+      read = compiled_ambigs.LoadCompiledAmbigs(fp, true, compiled_set) &&
+             read;
+    }
+  }
+  double compiled_msecs = (NowMsecs() - start) / iterations;
+  bool same = read && SameUnicharsets(text_set, compiled_set) &&
+      SameAmbigs(text_ambigs, compiled_ambigs, text_set.size());
+  printf("unicharset of %d%s: text %.3f msecs, compiled %.3f msecs, %s\n",
+         text_set.size(), has_ambigs ? " with ambigs" : "", text_msecs,
+         compiled_msecs, same ? "identical" : "DIFFERENT");
+
+  if (manager.SeekToCompiledStart(TESSDATA_PFFMTABLE_BIN,
+                                  TESSDATA_PFFMTABLE)) {
+    CLASS_CUTOFF_ARRAY text_cutoffs, compiled_cutoffs;
+    start = NowMsecs();
+    for (int i = 0; i < iterations; ++i) {
+      manager.SeekToStart(TESSDATA_PFFMTABLE);
+      ReadCutoffs(fp, manager.GetEndOffset(TESSDATA_PFFMTABLE), text_set,
+                  text_cutoffs);
+    }
+    text_msecs = (NowMsecs() - start) / iterations;
+    bool read = true;
+    start = NowMsecs();
+    for (int i = 0; i < iterations; ++i) {
+      manager.SeekToCompiledStart(TESSDATA_PFFMTABLE_BIN, TESSDATA_PFFMTABLE);
+      read = ReadCompiledCutoffs(fp, text_set.size(), compiled_cutoffs) &&
+             read;
+    }
+    compiled_msecs = (NowMsecs() - start) / iterations;
+    bool same_cutoffs = read &&
+        memcmp(text_cutoffs, compiled_cutoffs, sizeof(text_cutoffs)) == 0;
+    printf("pffmtable: text %.3f msecs, compiled %.3f msecs, %s\n",
+           text_msecs, compiled_msecs,
+           same_cutoffs ? "identical" : "DIFFERENT");
+    same = same && same_cutoffs;
+  }
+  manager.End();
+  return same;
+}
+
+// A blob of the page layout, baseline normalized for the classifier.
+struct BenchBlob {
+  TBLOB* blob;
+  ROW* row;        // The denorm refers to it.
+  DENORM* denorm;
+};
+
+// The layout gives no x-height, so the row of a blob takes this fraction of
+// the height of its textline above the baseline.
+const double kBenchXHeightFraction = 0.7;
+
+// Cuts the symbols of the layout of the image set in api into blobs, each
+// normalized against an approximation of its textline.
+static void MakeBenchBlobs(TessBaseAPI* api, GenericVector<BenchBlob>* blobs) {
+  PageIterator* it = api->AnalyseLayout();
+  if (it == NULL)
+    return;
+  do {
+    int left, top, right, bottom;
+    int line_left, line_top, line_right, line_bottom;
+    int x1, y1, x2, y2;
+    if (!it->BoundingBox(RIL_SYMBOL, &left, &top, &right, &bottom) ||
+        !it->BoundingBox(RIL_TEXTLINE, &line_left, &line_top,
+                         &line_right, &line_bottom) ||
+        !it->Baseline(RIL_TEXTLINE, &x1, &y1, &x2, &y2))
+      continue;
+    Pix* pix = it->GetBinaryImage(RIL_SYMBOL);
+    if (pix == NULL)
+      continue;
+    TBLOB* blob = TessBaseAPI::MakeTBLOB(pix);
+    pixDestroy(&pix);
+    if (blob == NULL)
+      continue;
+    // The blob coordinates go up from the bottom of the symbol.
+    double x = (left + right) / 2.0;
+    double baseline_y = x2 != x1 ? y1 + (y2 - y1) * (x - x1) / (x2 - x1)
+                                 : y1;
+    float baseline = bottom - baseline_y;
+    float ascender = bottom - line_top;
+    float descender = bottom - line_bottom;
+    float xheight = (ascender - baseline) * kBenchXHeightFraction;
+    BenchBlob bench_blob;
+    bench_blob.blob = blob;
+    bench_blob.row = TessBaseAPI::MakeTessOCRRow(baseline, xheight,
+                                                 descender, ascender);
+    bench_blob.denorm = new DENORM;
+    TessBaseAPI::NormalizeTBLOB(blob, bench_blob.row, false,
+                                bench_blob.denorm);
+    blobs->push_back(bench_blob);
+  } while (it->Next(RIL_SYMBOL));
+  delete it;
+}
+
+// Per-blob classifier benchmark.
+static bool RunClassifyBench(const char* image_file, int iterations) {
+  Pix* pix = pixRead(image_file);
+  if (pix == NULL) {
+    fprintf(stderr, "Failed to read %s\n", image_file);
+    return false;
+  }
+  TessBaseAPI api;
+  if (api.Init(NULL, "eng") < 0) {
+    pixDestroy(&pix);
+    return false;
+  }
+  api.SetImage(pix);
+  GenericVector<BenchBlob> blobs;
+  MakeBenchBlobs(&api, &blobs);
+
+  const int kMaxMatches = 10;
+  int unichar_ids[kMaxMatches];
+  char configs[kMaxMatches];
+  float ratings[kMaxMatches];
+  int num_matches;
+  // The first pass is untimed, and its top choices are a checksum that
+  // must not change when the classifier only gets faster.
+  uinT32 checksum = 0;
+  for (int b = 0; b < blobs.size(); ++b) {
+    api.RunAdaptiveClassifier(blobs[b].blob, *blobs[b].denorm, kMaxMatches,
+                              unichar_ids, configs, ratings, &num_matches);
+    for (int m = 0; m < num_matches; ++m) {
+      checksum = checksum * 31 + unichar_ids[m];
+      checksum = checksum * 31 + static_cast<uinT32>(ratings[m] * 1000.0f);
+    }
+  }
+  GenericVector<double> blob_msecs;
+  double start = NowMsecs();
+  for (int i = 0; i < iterations; ++i) {
+    for (int b = 0; b < blobs.size(); ++b) {
+      double blob_start = NowMsecs();
+      api.RunAdaptiveClassifier(blobs[b].blob, *blobs[b].denorm, kMaxMatches,
+                                unichar_ids, configs, ratings, &num_matches);
+      blob_msecs.push_back(NowMsecs() - blob_start);
+    }
+  }
+  double total_msecs = NowMsecs() - start;
+  blob_msecs.sort();
+  int runs = blob_msecs.size();
+  printf("%d blobs: %.1f usecs per blob, p50 %.1f usecs, p99 %.1f usecs,"
+         " checksum %08x\n", blobs.size(),
+         runs > 0 ? total_msecs * 1000.0 / runs : 0.0,
+         Percentile(blob_msecs, 50.0) * 1000.0,
+         Percentile(blob_msecs, 99.0) * 1000.0, checksum);
+
+  for (int b = 0; b < blobs.size(); ++b) {
+    delete blobs[b].blob;
+    delete blobs[b].denorm;
+    delete blobs[b].row;
+  }
+  api.End();
+  pixDestroy(&pix);
+  return !blobs.empty();
+}
+
+// Engine memory benchmark. Peak RSS only grows, and nothing is freed until
+// the end, so it measures what each engine adds.
+static bool RunEnginesBench(const char* lang, int n) {
+  GenericVector<TessBaseAPI*> engines;
+  inT64 start_kb = PeakRssKb();
+  inT64 first_kb = start_kb;
+  bool ok = true;
+  for (int i = 0; i < n && ok; ++i) {
+    TessBaseAPI* api = new TessBaseAPI;
+    ok = api->Init(NULL, lang) >= 0;
+    engines.push_back(api);
+    if (i == 0)
+      first_kb = PeakRssKb();
+  }
+  inT64 end_kb = PeakRssKb();
+  if (ok) {
+    printf("%d engines of %s: first %lld KB, each further %lld KB,"
+           " total %lld KB\n", n, lang,
+           static_cast<long long>(first_kb - start_kb),
+           static_cast<long long>(n > 1 ? (end_kb - first_kb) / (n - 1) : 0),
+           static_cast<long long>(end_kb - start_kb));
+  } else {
+    fprintf(stderr, "Failed to initialize language %s\n", lang);
+  }
+  for (int i = 0; i < engines.size(); ++i) {
+    engines[i]->End();
+    delete engines[i];
+  }
+  return ok;
+}
+
+// Records when each block of a page is handed out by RecognizeByBlock.
+class BlockLatencyRecorder {
+ public:
+  BlockLatencyRecorder() : start_msecs_(0.0), first_msecs_(0.0), blocks_(0) {}
+
+  void Start() {
+    start_msecs_ = NowMsecs();
+    first_msecs_ = 0.0;
+    blocks_ = 0;
+  }
+  void BlockDone(ResultIterator* it) {
+    if (blocks_++ == 0)
+      first_msecs_ = NowMsecs() - start_msecs_;
+  }
+
+  double first_msecs() const {
+    return first_msecs_;
+  }
+  int blocks() const {
+    return blocks_;
+  }
+
+ private:
+  double start_msecs_;
+  double first_msecs_;
+  int blocks_;
+};
+
+// Block streaming benchmark. Compares the time to the first results, and
+// to the whole page, of RecognizeByBlock against those of Recognize.
+static bool RunBlocksBench(const char* image_file, int iterations) {
+  Pix* pix = pixRead(image_file);
+  if (pix == NULL) {
+    fprintf(stderr, "Failed to read %s\n", image_file);
+    return false;
+  }
+  TessBaseAPI api;
+  if (api.Init(NULL, "eng") < 0) {
+    pixDestroy(&pix);
+    return false;
+  }
+  BlockLatencyRecorder recorder;
+  TessCallback1<ResultIterator*>* block_done =
+      NewPermanentTessCallback(&recorder, &BlockLatencyRecorder::BlockDone);
+  GenericVector<double> page_msecs;
+  GenericVector<double> first_block_msecs;
+  GenericVector<double> blocks_msecs;
+  bool ok = true;
+  // The first iteration of each warms up the engine and is not timed.
+  for (int i = 0; i <= iterations && ok; ++i) {
+    api.SetImage(pix);
+    double start = NowMsecs();
+    ok = api.Recognize(NULL) == 0;
+    if (i > 0)
+      page_msecs.push_back(NowMsecs() - start);
+    api.SetImage(pix);
+    recorder.Start();
+    start = NowMsecs();
+    ok = ok && api.RecognizeByBlock(NULL, block_done) == 0;
+    if (i > 0) {
+      blocks_msecs.push_back(NowMsecs() - start);
+      first_block_msecs.push_back(recorder.first_msecs());
+    }
+  }
+  if (ok) {
+    page_msecs.sort();
+    first_block_msecs.sort();
+    blocks_msecs.sort();
+    printf("Recognize: page %.1f msecs\n"
+           "RecognizeByBlock: %d blocks, first block %.1f msecs,"
+           " page %.1f msecs\n",
+           Percentile(page_msecs, 50.0), recorder.blocks(),
+           Percentile(first_block_msecs, 50.0),
+           Percentile(blocks_msecs, 50.0));
+  } else {
+    fprintf(stderr, "Failed to recognize %s\n", image_file);
+  }
+  delete block_done;
+  api.End();
+  pixDestroy(&pix);
+  return ok;
+}
+
+// Multi-page tiff reading benchmark. Writes a tiff of num_pages copies of
+// image, then times reading every page by page number, which walks the
+// directory chain from the start for each page, against reading them
+// through a TiffPageSource.
+static bool RunTiffBench(const char* image_file, int num_pages) {
+  Pix* pix = pixRead(image_file);
+  if (pix == NULL) {
+    fprintf(stderr, "Failed to read %s\n", image_file);
+    return false;
+  }
+  Pix* pix1 = pixConvertTo1(pix, 128);
+  pixDestroy(&pix);
+  if (pix1 == NULL)
+    return false;
+  STRING tiff_file = "tessbench_pages.tif";
+  bool ok = true;
+  for (int page = 0; page < num_pages && ok; ++page) {
+    ok = pixWriteTiff(tiff_file.string(), pix1, IFF_TIFF_G4,
+                      page == 0 ? "w" : "a") == 0;
+  }
+  FILE* fp = ok ? fopen(tiff_file.string(), "rb") : NULL;
+  if (fp == NULL) {
+    fprintf(stderr, "Failed to write %s\n", tiff_file.string());
+    pixDestroy(&pix1);
+    return false;
+  }
+  double start = NowMsecs();
+  for (int page = 0; page < num_pages && ok; ++page) {
+    Pix* page_pix = pixReadStreamTiff(fp, page);
+    ok = page_pix != NULL;
+    pixDestroy(&page_pix);
+  }
+  double by_number_msecs = NowMsecs() - start;
+
+  start = NowMsecs();
+  TiffPageSource tiff_pages;
+  ok = ok && tiff_pages.Open(fp) && tiff_pages.num_pages() == num_pages;
+  for (int page = 0; page < num_pages && ok; ++page) {
+    Pix* page_pix = tiff_pages.ReadPage(page);
+    l_int32 same = 0;
+    ok = page_pix != NULL && pixEqual(page_pix, pix1, &same) == 0 && same;
+    pixDestroy(&page_pix);
+  }
+  double indexed_msecs = NowMsecs() - start;
+  tiff_pages.Close();
+  fclose(fp);
+  remove(tiff_file.string());
+  pixDestroy(&pix1);
+  if (ok) {
+    printf("%d pages: by page number %.1f msecs, indexed %.1f msecs\n",
+           num_pages, by_number_msecs, indexed_msecs);
+  } else {
+    fprintf(stderr, "Pages read by the index differ from those written\n");
+  }
+  return ok;
+}
+
+// Text output benchmark. Recognizes image once, then times writing the
+// UTF-8, hOCR, box and UNLV text of the page with a call per format against
+// a single RenderText of all four, and checks both against the text saved
+// in the files named expected and the extension of each format.
+static bool RunRenderBench(const char* image_file, const char* expected,
+                           int iterations) {
+  const char* kExtensions[TF_COUNT] = { ".txt", ".html", ".box", ".unlv" };
+  STRING expected_texts[TF_COUNT];
+  for (int f = 0; f < TF_COUNT; ++f) {
+    STRING filename = expected;
+    filename += kExtensions[f];
+    if (!ReadTextFile(filename.string(), &expected_texts[f])) {
+      fprintf(stderr, "Can't open expected text %s\n", filename.string());
+      return false;
+    }
+  }
+  Pix* pix = pixRead(image_file);
+  if (pix == NULL) {
+    fprintf(stderr, "Failed to read %s\n", image_file);
+    return false;
+  }
+  TessBaseAPI api;
+  if (api.Init(NULL, "eng") < 0) {
+    pixDestroy(&pix);
+    return false;
+  }
+  api.SetImage(pix);
+  api.SetInputName(image_file);
+  bool ok = api.Recognize(NULL) == 0;
+  bool same = true;
+  GenericVector<double> separate_msecs;
+  GenericVector<double> single_msecs;
+  int bytes = 0;
+  // The first iteration warms up and is not timed.
+  for (int i = 0; i <= iterations && ok && same; ++i) {
+    char* texts[TF_COUNT];
+    double start = NowMsecs();
+    texts[TF_UTF8] = api.GetUTF8Text();
+    texts[TF_HOCR] = api.GetHOCRText(0);
+    texts[TF_BOX] = api.GetBoxText(0);
+    texts[TF_UNLV] = api.GetUNLVText();
+    if (i > 0)
+      separate_msecs.push_back(NowMsecs() - start);
+
+    TextBuffer buffers[TF_COUNT];
+    TextBuffer* formats[TF_COUNT];
+    for (int f = 0; f < TF_COUNT; ++f)
+      formats[f] = &buffers[f];
+    start = NowMsecs();
+    ok = api.RenderText(0, formats);
+    if (i > 0)
+      single_msecs.push_back(NowMsecs() - start);
+    bytes = 0;
+    for (int f = 0; f < TF_COUNT; ++f) {
+      char* rendered = buffers[f].Release();
+      const char* want = expected_texts[f].string();
+      if (texts[f] == NULL || strcmp(texts[f], want) != 0) {
+        fprintf(stderr, "A call for %s differs from the expected text\n",
+                kExtensions[f]);
+        same = false;
+      }
+      if (ok && strcmp(rendered, want) != 0) {
+        fprintf(stderr, "RenderText of %s differs from the expected text\n",
+                kExtensions[f]);
+        same = false;
+      }
+      bytes += strlen(rendered);
+      delete [] rendered;
+      delete [] texts[f];
+    }
+  }
+  if (ok && same) {
+    separate_msecs.sort();
+    single_msecs.sort();
+    printf("%d bytes: a call per format %.3f msecs, RenderText %.3f msecs\n",
+           bytes, Percentile(separate_msecs, 50.0),
+           Percentile(single_msecs, 50.0));
+  } else if (!ok) {
+    fprintf(stderr, "Failed to recognize %s\n", image_file);
+  }
+  api.End();
+  pixDestroy(&pix);
+  return ok && same;
+}
+
+// Worker benchmark. Times Recognize and GetUTF8Text of image in this
+// process against TessWorkerPool::Recognize with a single worker, which
+// adds the copy into shared memory and the round trip to the worker.
+static bool RunWorkerBench(const char* worker_path, const char* image_file,
+                           int iterations) {
+  Pix* pix = pixRead(image_file);
+  if (pix == NULL) {
+    fprintf(stderr, "Failed to read %s\n", image_file);
+    return false;
+  }
+  TessBaseAPI api;
+  TessWorkerPool pool;
+  if (api.Init(NULL, "eng") < 0 ||
+      !pool.Start(worker_path, NULL, "eng", OEM_DEFAULT, 1)) {
+    fprintf(stderr, "Failed to start an engine or the worker %s\n",
+            worker_path);
+    pixDestroy(&pix);
+    return false;
+  }
+  TessJobOptions options;
+  GenericVector<double> local_msecs;
+  GenericVector<double> worker_msecs;
+  bool ok = true;
+  // The first iteration warms up and is not timed.
+  for (int i = 0; i <= iterations && ok; ++i) {
+    double start = NowMsecs();
+    api.SetImage(pix);
+    char* text = api.Recognize(NULL) == 0 ? api.GetUTF8Text() : NULL;
+    api.Clear();
+    if (i > 0)
+      local_msecs.push_back(NowMsecs() - start);
+
+    TessWorkerResult result;
+    start = NowMsecs();
+    TessWorkerStatus status = pool.Recognize(pix, options, false, &result);
+    if (i > 0)
+      worker_msecs.push_back(NowMsecs() - start);
+    ok = text != NULL && status == TWS_OK &&
+         strcmp(text, result.text.string()) == 0;
+    delete [] text;
+  }
+  if (ok) {
+    local_msecs.sort();
+    worker_msecs.sort();
+    printf("In process %.3f msecs, in a worker %.3f msecs, %d restarts\n",
+           Percentile(local_msecs, 50.0), Percentile(worker_msecs, 50.0),
+           pool.restarts());
+  } else {
+    fprintf(stderr, "Failed to recognize %s, or the texts differ\n",
+            image_file);
+  }
+  pool.Stop();
+  api.End();
+  pixDestroy(&pix);
+  return ok;
+}
+
+// Returns true if the images in pixa are the pixels of view at the boxes
+// in boxa.
+static bool SameComponents(Pixa* pixa, Boxa* boxa, Pix* view) {
+  int count = boxaGetCount(boxa);
+  if (pixaGetCount(pixa) != count)
+    return false;
+  for (int i = 0; i < count; ++i) {
+    Box* box = boxaGetBox(boxa, i, L_CLONE);
+    Pix* clipped = pixClipRectangle(view, box, NULL);
+    Pix* image = pixaGetPix(pixa, i, L_CLONE);
+    l_int32 same = 0;
+    pixEqual(clipped, image, &same);
+    boxDestroy(&box);
+    pixDestroy(&clipped);
+    pixDestroy(&image);
+    if (!same)
+      return false;
+  }
+  return true;
+}
+
+// Component image benchmark. Recognizes image once, then times a copy of
+// every word against views of them all in the thresholded image, and the
+// masked images of the blocks.
+static bool RunComponentsBench(const char* image_file, int iterations) {
+  Pix* pix = pixRead(image_file);
+  if (pix == NULL) {
+    fprintf(stderr, "Failed to read %s\n", image_file);
+    return false;
+  }
+  TessBaseAPI api;
+  if (api.Init(NULL, "eng") < 0) {
+    pixDestroy(&pix);
+    return false;
+  }
+  api.SetImage(pix);
+  bool ok = api.Recognize(NULL) == 0;
+  GenericVector<double> image_msecs;
+  GenericVector<double> view_msecs;
+  GenericVector<double> region_msecs;
+  int words = 0;
+  // The first iteration checks the views and is not timed.
+  for (int i = 0; i <= iterations && ok; ++i) {
+    Pixa* pixa = NULL;
+    double start = NowMsecs();
+    Boxa* image_boxes = api.GetComponentImages(RIL_WORD, &pixa, NULL);
+    if (i > 0)
+      image_msecs.push_back(NowMsecs() - start);
+    Pix* view = NULL;
+    start = NowMsecs();
+    Boxa* view_boxes = api.GetComponentViews(RIL_WORD, &view, NULL);
+    if (i > 0)
+      view_msecs.push_back(NowMsecs() - start);
+    ok = image_boxes != NULL && view_boxes != NULL;
+    if (ok && i == 0)
+      ok = SameComponents(pixa, view_boxes, view);
+    if (ok)
+      words = boxaGetCount(view_boxes);
+    boxaDestroy(&image_boxes);
+    boxaDestroy(&view_boxes);
+    pixaDestroy(&pixa);
+    pixDestroy(&view);
+
+    start = NowMsecs();
+    Boxa* regions = api.GetRegions(&pixa);
+    if (i > 0)
+      region_msecs.push_back(NowMsecs() - start);
+    ok = ok && regions != NULL;
+    boxaDestroy(&regions);
+    pixaDestroy(&pixa);
+  }
+  if (ok) {
+    image_msecs.sort();
+    view_msecs.sort();
+    region_msecs.sort();
+    printf("%d words: images %.3f msecs, views %.3f msecs;"
+           " regions %.3f msecs\n", words,
+           Percentile(image_msecs, 50.0), Percentile(view_msecs, 50.0),
+           Percentile(region_msecs, 50.0));
+  } else {
+    fprintf(stderr, "Failed to recognize %s, or a view differs\n",
+            image_file);
+  }
+  api.End();
+  pixDestroy(&pix);
+  return ok;
+}
+
+// Returns true if the two layouts have the same blocks and lines.
+static bool SameLayouts(const TessPageLayout& layout1,
+                        const TessPageLayout& layout2) {
+  if (layout1.blocks.size() != layout2.blocks.size() ||
+      layout1.lines.size() != layout2.lines.size())
+    return false;
+  for (int i = 0; i < layout1.lines.size(); ++i) {
+    const TessLayoutBox& box1 = layout1.lines[i];
+    const TessLayoutBox& box2 = layout2.lines[i];
+    if (box1.left != box2.left || box1.top != box2.top ||
+        box1.right != box2.right || box1.bottom != box2.bottom ||
+        box1.block != box2.block)
+      return false;
+  }
+  return true;
+}
+
+// Layout-only benchmark. Times starting a TessLayoutEngine against
+// TessBaseAPI::Init, then AnalyseLayout of num_pages copies of image on
+// one engine against one per processor.
+static bool RunLayoutBench(const char* image_file, int num_pages) {
+  Pix* pix = pixRead(image_file);
+  if (pix == NULL) {
+    fprintf(stderr, "Failed to read %s\n", image_file);
+    return false;
+  }
+  double start = NowMsecs();
+  TessBaseAPI api;
+  bool ok = api.Init(NULL, "eng") >= 0;
+  double full_init_msecs = NowMsecs() - start;
+  api.End();
+  start = NowMsecs();
+  TessLayoutEngine single;
+  ok = ok && single.Init(NULL, false, 1);
+  double layout_init_msecs = NowMsecs() - start;
+  TessLayoutEngine parallel;
+  ok = ok && parallel.Init(NULL, false, 0);
+
+  GenericVector<Pix*> pages;
+  for (int i = 0; i < num_pages; ++i)
+    pages.push_back(pixClone(pix));
+  GenericVector<TessPageLayout> single_layouts;
+  GenericVector<TessPageLayout> parallel_layouts;
+  double single_msecs = 0.0;
+  double parallel_msecs = 0.0;
+  if (ok) {
+    start = NowMsecs();
+    single.AnalyseLayout(&pages[0], num_pages, &single_layouts);
+    single_msecs = NowMsecs() - start;
+    start = NowMsecs();
+    parallel.AnalyseLayout(&pages[0], num_pages, &parallel_layouts);
+    parallel_msecs = NowMsecs() - start;
+    for (int i = 0; i < num_pages && ok; ++i)
+      ok = SameLayouts(single_layouts[i], parallel_layouts[i]);
+  }
+  if (ok) {
+    printf("Init: full %.1f msecs, layout only %.1f msecs\n"
+           "%d pages of %d blocks, %d lines: 1 engine %.1f msecs,"
+           " %d engines %.1f msecs\n",
+           full_init_msecs, layout_init_msecs, num_pages,
+           single_layouts[0].blocks.size(), single_layouts[0].lines.size(),
+           single_msecs, parallel.num_engines(), parallel_msecs);
+  } else {
+    fprintf(stderr, "Failed to initialize, or the layouts differ\n");
+  }
+  for (int i = 0; i < pages.size(); ++i)
+    pixDestroy(&pages[i]);
+  pixDestroy(&pix);
+  return ok;
+}
+
+// Returns true if the two files have the same contents.
+static bool SameFiles(const char* name1, const char* name2) {
+  FILE* fp1 = fopen(name1, "rb");
+  FILE* fp2 = fopen(name2, "rb");
+  bool same = fp1 != NULL && fp2 != NULL;
+  int ch;
+  while (same && (ch = fgetc(fp1)) != EOF)
+    same = fgetc(fp2) == ch;
+  same = same && fgetc(fp2) == EOF;
+  if (fp1 != NULL)
+    fclose(fp1);
+  if (fp2 != NULL)
+    fclose(fp2);
+  return same;
+}
+
+// Box training benchmark. Trains on num_jobs copies of image, with the box
+// file beside it, with a TessBoxTrainer of one engine against one of an
+// engine per processor, each writing all the features to one file.
+static bool RunTrainBench(const char* image_file, int num_jobs) {
+  // The features are labelled with the font of the image name, as when
+  // training with tesseract image image box.train.
+  STRING output = image_file;
+  const char* lastdot = strrchr(output.string(), '.');
+  if (lastdot != NULL)
+    output[lastdot - output.string()] = '\0';
+  GenericVector<TessTrainingJob> jobs;
+  for (int i = 0; i < num_jobs; ++i)
+    jobs.push_back(TessTrainingJob(image_file, output.string()));
+
+  char config[] = "box.train";
+  char* configs[] = { config };
+  const char* single_tr = "tessbench_train1.tr";
+  const char* parallel_tr = "tessbench_train2.tr";
+  TessBoxTrainer single;
+  bool ok = single.Init(NULL, "eng", configs, 1, 1);
+  TessBoxTrainer parallel;
+  ok = ok && parallel.Init(NULL, "eng", configs, 1, 0);
+  GenericVector<TessTrainingResult> single_results;
+  GenericVector<TessTrainingResult> parallel_results;
+  double single_msecs = 0.0;
+  double parallel_msecs = 0.0;
+  if (ok) {
+    double start = NowMsecs();
+    ok = single.Train(jobs, false, single_tr, &single_results);
+    single_msecs = NowMsecs() - start;
+    start = NowMsecs();
+    ok = ok && parallel.Train(jobs, false, parallel_tr, &parallel_results);
+    parallel_msecs = NowMsecs() - start;
+    for (int i = 0; i < num_jobs && ok; ++i)
+      ok = single_results[i].ok && parallel_results[i].ok;
+    ok = ok && SameFiles(single_tr, parallel_tr);
+  }
+  if (ok) {
+    printf("%d jobs of %d pages, %d boxes: 1 engine %.1f msecs,"
+           " %d engines %.1f msecs\n",
+           num_jobs, single_results[0].pages, single_results[0].boxes,
+           single_msecs, parallel.num_engines(), parallel_msecs);
+  } else {
+    fprintf(stderr, "Failed to train, or the features differ\n");
+  }
+  remove(single_tr);
+  remove(parallel_tr);
+  return ok;
+}
+
+// Prints the stats of a batch, and how much of it the stages stalled.
+static void PrintBatchStats(const char* name, int num_engines,
+                            const TessBatchStats& stats) {
+  printf("%s, %d engines: %d files, %d pages in %.1f msecs\n"
+         "  read %.1f msecs, reader stall %.1f msecs\n"
+         "  recognize %.1f msecs, engine stall %.1f msecs\n"
+         "  peak queue %d pages, %.1f MB\n",
+         name, num_engines, stats.files, stats.pages, stats.wall_msecs,
+         stats.read_msecs, stats.reader_stall_msecs, stats.recognize_msecs,
+         stats.engine_stall_msecs, stats.peak_queued_pages,
+         stats.peak_queued_bytes / 1048576.0);
+}
+
+// Prefetch benchmark. Recognizes the image files of dir with ProcessPages
+// on one engine, reading each file on the thread that recognizes it,
+// against TessBatchRecognizers of one engine and of one per processor with
+// num_readers readers ahead of them.
+static bool RunPrefetchBench(const char* dir, int num_readers) {
+  GenericVector<STRING> files;
+  if (!ListImageFiles(dir, &files) || files.empty()) {
+    fprintf(stderr, "No image files in %s\n", dir);
+    return false;
+  }
+  TessBaseAPI api;
+  bool ok = api.Init(NULL, "eng") >= 0;
+  TessBatchOptions options;
+  options.num_readers = num_readers;
+  TessBatchRecognizer single;
+  ok = ok && single.Init(NULL, "eng", OEM_DEFAULT, 1, options);
+  TessBatchRecognizer parallel;
+  ok = ok && parallel.Init(NULL, "eng", OEM_DEFAULT, 0, options);
+  if (!ok) {
+    fprintf(stderr, "Failed to initialize\n");
+    return false;
+  }
+  GenericVector<STRING> texts;
+  double start = NowMsecs();
+  for (int i = 0; i < files.size() && ok; ++i) {
+    STRING text;
+    ok = api.ProcessPages(files[i].string(), NULL, 0, &text);
+    texts.push_back(text);
+  }
+  double serial_msecs = NowMsecs() - start;
+  GenericVector<TessBatchResult> single_results;
+  GenericVector<TessBatchResult> parallel_results;
+  TessBatchStats single_stats;
+  TessBatchStats parallel_stats;
+  ok = ok && single.Recognize(files, &single_results, &single_stats);
+  ok = ok && parallel.Recognize(files, &parallel_results, &parallel_stats);
+  for (int i = 0; i < files.size() && ok; ++i) {
+    ok = single_results[i].ok && parallel_results[i].ok &&
+         single_results[i].text == texts[i] &&
+         parallel_results[i].text == texts[i];
+  }
+  if (ok) {
+    printf("ProcessPages, 1 engine: %d files in %.1f msecs\n",
+           files.size(), serial_msecs);
+    PrintBatchStats("Batch", single.num_engines(), single_stats);
+    PrintBatchStats("Batch", parallel.num_engines(), parallel_stats);
+  } else {
+    fprintf(stderr, "Failed to recognize, or the texts differ\n");
+  }
+  api.End();
+  return ok;
+}
+
+}  // namespace tesseract.
+
+static void Usage(const char* program) {
+  fprintf(stderr,
+          "Usage: %s [-l lang] [-tessdata dir] [-psm n] [-oem n]"
+          " [-threads n] [-iterations n] [-warmup n] [-json file]"
+          " [-baseline file] [-tolerance pct] [-budget] corpus...\n"
+          "       %s -allocs image iterations\n"
+          "       %s -containers n\n"
+          "       %s -cluster n threads\n"
+          "       %s -load lang.traineddata iterations\n"
+          "       %s -classify image iterations\n"
+          "       %s -engines lang n\n"
+          "       %s -blocks image iterations\n"
+          "       %s -tiff image pages\n"
+          "       %s -render image expected iterations\n"
+          "       %s -worker tessworker image iterations\n"
+          "       %s -components image iterations\n"
+          "       %s -layout image pages\n"
+          "       %s -train image jobs\n"
+          "       %s -prefetch dir readers\n",
+          program, program, program, program, program, program, program,
+          program, program, program, program, program, program, program,
+          program);
+}
+
+int main(int argc, char **argv) {
+  if (argc == 4 && strcmp(argv[1], "-allocs") == 0) {
+    int iterations = atoi(argv[3]);
+    if (iterations < 1) {
+      Usage(argv[0]);
+      return 2;
+    }
+    return tesseract::RunAllocsBench(argv[2], iterations) ? 0 : 1;
+  }
+  if (argc == 3 && strcmp(argv[1], "-containers") == 0) {
+    int n = atoi(argv[2]);
+    if (n < 1) {
+      Usage(argv[0]);
+      return 2;
+    }
+    tesseract::RunContainerBench(n);
+    return 0;
+  }
+  if (argc == 4 && strcmp(argv[1], "-cluster") == 0) {
+    int n = atoi(argv[2]);
+    if (n < 1) {
+      Usage(argv[0]);
+      return 2;
+    }
+    return tesseract::RunClusterBench(n, atoi(argv[3])) ? 0 : 1;
+  }
+  if (argc == 4 && strcmp(argv[1], "-load") == 0) {
+    int iterations = atoi(argv[3]);
+    if (iterations < 1) {
+      Usage(argv[0]);
+      return 2;
+    }
+    return tesseract::RunLoadBench(argv[2], iterations) ? 0 : 1;
+  }
+  if (argc == 4 && strcmp(argv[1], "-classify") == 0) {
+    int iterations = atoi(argv[3]);
+    if (iterations < 1) {
+      Usage(argv[0]);
+      return 2;
+    }
+    return tesseract::RunClassifyBench(argv[2], iterations) ? 0 : 1;
+  }
+  if (argc == 4 && strcmp(argv[1], "-engines") == 0) {
+    int n = atoi(argv[3]);
+    if (n < 1) {
+      Usage(argv[0]);
+      return 2;
+    }
+    return tesseract::RunEnginesBench(argv[2], n) ? 0 : 1;
+  }
+  if (argc == 4 && strcmp(argv[1], "-blocks") == 0) {
+    int iterations = atoi(argv[3]);
+    if (iterations < 1) {
+      Usage(argv[0]);
+      return 2;
+    }
+    return tesseract::RunBlocksBench(argv[2], iterations) ? 0 : 1;
+  }
+  if (argc == 4 && strcmp(argv[1], "-tiff") == 0) {
+    int num_pages = atoi(argv[3]);
+    if (num_pages < 1) {
+      Usage(argv[0]);
+      return 2;
+    }
+    return tesseract::RunTiffBench(argv[2], num_pages) ? 0 : 1;
+  }
+  if (argc == 5 && strcmp(argv[1], "-render") == 0) {
+    int iterations = atoi(argv[4]);
+    if (iterations < 1) {
+      Usage(argv[0]);
+      return 2;
+    }
+    return tesseract::RunRenderBench(argv[2], argv[3], iterations) ? 0 : 1;
+  }
+  if (argc == 5 && strcmp(argv[1], "-worker") == 0) {
+    int iterations = atoi(argv[4]);
+    if (iterations < 1) {
+      Usage(argv[0]);
+      return 2;
+    }
+    return tesseract::RunWorkerBench(argv[2], argv[3], iterations) ? 0 : 1;
+  }
+  if (argc == 4 && strcmp(argv[1], "-components") == 0) {
+    int iterations = atoi(argv[3]);
+    if (iterations < 1) {
+      Usage(argv[0]);
+      return 2;
+    }
+    return tesseract::RunComponentsBench(argv[2], iterations) ? 0 : 1;
+  }
+  if (argc == 4 && strcmp(argv[1], "-layout") == 0) {
+    int num_pages = atoi(argv[3]);
+    if (num_pages < 1) {
+      Usage(argv[0]);
+      return 2;
+    }
+    return tesseract::RunLayoutBench(argv[2], num_pages) ? 0 : 1;
+  }
+  if (argc == 4 && strcmp(argv[1], "-train") == 0) {
+    int num_jobs = atoi(argv[3]);
+    if (num_jobs < 1) {
+      Usage(argv[0]);
+      return 2;
+    }
+    return tesseract::RunTrainBench(argv[2], num_jobs) ? 0 : 1;
+  }
+  if (argc == 4 && strcmp(argv[1], "-prefetch") == 0) {
+    int num_readers = atoi(argv[3]);
+    if (num_readers < 1) {
+      Usage(argv[0]);
+      return 2;
+    }
+    return tesseract::RunPrefetchBench(argv[2], num_readers) ? 0 : 1;
+  }
+  tesseract::BenchOptions options;
+  GenericVector<const char*> corpus;
+  for (int arg = 1; arg < argc; ++arg) {
+    bool has_value = arg + 1 < argc;
+    if (strcmp(argv[arg], "-l") == 0 && has_value) {
+      options.lang = argv[++arg];
+    } else if (strcmp(argv[arg], "-tessdata") == 0 && has_value) {
+      options.datapath = argv[++arg];
+    } else if (strcmp(argv[arg], "-psm") == 0 && has_value) {
+      options.psm = atoi(argv[++arg]);
+    } else if (strcmp(argv[arg], "-oem") == 0 && has_value) {
+      options.oem = atoi(argv[++arg]);
+    } else if (strcmp(argv[arg], "-threads") == 0 && has_value) {
+      options.threads = atoi(argv[++arg]);
+    } else if (strcmp(argv[arg], "-iterations") == 0 && has_value) {
+      options.iterations = atoi(argv[++arg]);
+    } else if (strcmp(argv[arg], "-warmup") == 0 && has_value) {
+      options.warmup = atoi(argv[++arg]);
+    } else if (strcmp(argv[arg], "-json") == 0 && has_value) {
+      options.json_file = argv[++arg];
+    } else if (strcmp(argv[arg], "-baseline") == 0 && has_value) {
+      options.baseline_file = argv[++arg];
+    } else if (strcmp(argv[arg], "-tolerance") == 0 && has_value) {
+      options.tolerance_pct = atof(argv[++arg]);
+    } else if (strcmp(argv[arg], "-budget") == 0) {
+      options.memory_budget = true;
+    } else if (argv[arg][0] == '-') {
+      Usage(argv[0]);
+      return 2;
+    } else {
+      corpus.push_back(argv[arg]);
+    }
+  }
+  if (corpus.empty() || options.iterations < 1) {
+    Usage(argv[0]);
+    return 2;
+  }
+  if (options.threads < 1)
+    options.threads = tesseract::ThreadPool::NumProcessors();
+
+  tesseract::Bench bench(options);
+  for (int i = 0; i < corpus.size(); ++i) {
+    if (!bench.LoadCorpus(corpus[i]))
+      return 2;
+  }
+  if (bench.num_pages() == 0) {
+    fprintf(stderr, "No pages found\n");
+    return 2;
+  }
+  if (!bench.InitEngines()) {
+    fprintf(stderr, "Failed to initialize language %s\n", options.lang);
+    return 2;
+  }
+  double wall_msecs = bench.Run();
+
+  tesseract::BenchReport report;
+  tesseract::MakeReport(bench, wall_msecs, &report);
+  FILE* out = stdout;
+  if (options.json_file != NULL) {
+    out = fopen(options.json_file, "w");
+    if (out == NULL) {
+      fprintf(stderr, "Can't write %s\n", options.json_file);
+      return 2;
+    }
+  }
+  tesseract::WriteReport(options, report, out);
+  if (out != stdout)
+    fclose(out);
+
+  if (options.baseline_file != NULL &&
+      !tesseract::CompareToBaseline(options.baseline_file,
+                                    options.tolerance_pct, report))
+    return 1;
+  return 0;
+}
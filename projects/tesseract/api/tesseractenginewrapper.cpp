@@ -28,6 +28,7 @@ limitations under the License.
 #include "..\classify\speckle.h"
 #include "..\dict\permute.h"
 #include "..\ccstruct\publictypes.h"
+#include "..\api\striprecognizer.h"
 #include "leptprotos.h"
 
 
@@ -45,6 +46,7 @@ TesseractProcessor::TesseractProcessor()
 	InitializeWorkingSpace();
 
 	_doMonitor = true;
+	_timeoutMilliseconds = 0;
 }
 
 TesseractProcessor::~TesseractProcessor()
@@ -104,6 +106,10 @@ void TesseractProcessor::InitializeMonitor()
 
 void TesseractProcessor::InternalFinally()
 {
+	this->DisableAsync();
+	this->DisableLayout();
+	this->DisableBatch();
+
 	if (_apiInstance != NULL)
 	{
 		TessBaseAPI* api = (TessBaseAPI*)_apiInstance.ToPointer();
@@ -123,6 +129,14 @@ void TesseractProcessor::InternalFinally()
 		monitor = null;
 		_monitorInstance = null;
 	}
+
+	if (_pageCacheInstance != null)
+	{
+		PageResultCache* cache = (PageResultCache*)_pageCacheInstance.ToPointer();
+		delete cache;
+		cache = null;
+		_pageCacheInstance = null;
+	}
 }
 // ===============================================================
 
@@ -281,6 +295,380 @@ bool TesseractProcessor::SetVariable(System::String* name, System::String* value
 
 
 
+// ===============================================================
+// PAGE RESULT CACHE
+void TesseractProcessor::EnablePageCache(int maxEntries, int maxMegabytes, String* diskDir)
+{
+	if (_apiInstance == null)
+		return;
+
+	this->DisablePageCache();
+
+	PageResultCache* cache = new PageResultCache(
+		maxEntries, (inT64)maxMegabytes * 1024 * 1024,
+		Helper::StringToPointer(diskDir));
+	_pageCacheInstance = cache;
+
+	TessBaseAPI* api = (TessBaseAPI*)_apiInstance.ToPointer();
+	api->SetPageCache(cache);
+}
+
+void TesseractProcessor::DisablePageCache()
+{
+	if (_apiInstance != null)
+	{
+		TessBaseAPI* api = (TessBaseAPI*)_apiInstance.ToPointer();
+		api->SetPageCache(null);
+	}
+
+	if (_pageCacheInstance != null)
+	{
+		PageResultCache* cache = (PageResultCache*)_pageCacheInstance.ToPointer();
+		delete cache;
+		cache = null;
+		_pageCacheInstance = null;
+	}
+}
+
+double TesseractProcessor::get_PageCacheHitRate()
+{
+	if (_pageCacheInstance == null)
+		return 0;
+
+	PageCacheStats stats;
+	((PageResultCache*)_pageCacheInstance.ToPointer())->GetStats(&stats);
+	return stats.hit_rate();
+}
+
+Int64 TesseractProcessor::get_PageCacheHits()
+{
+	if (_pageCacheInstance == null)
+		return 0;
+
+	PageCacheStats stats;
+	((PageResultCache*)_pageCacheInstance.ToPointer())->GetStats(&stats);
+	return stats.hits;
+}
+
+Int64 TesseractProcessor::get_PageCacheLookups()
+{
+	if (_pageCacheInstance == null)
+		return 0;
+
+	PageCacheStats stats;
+	((PageResultCache*)_pageCacheInstance.ToPointer())->GetStats(&stats);
+	return stats.lookups;
+}
+
+double TesseractProcessor::get_PageCacheSavedMilliseconds()
+{
+	if (_pageCacheInstance == null)
+		return 0;
+
+	PageCacheStats stats;
+	((PageResultCache*)_pageCacheInstance.ToPointer())->GetStats(&stats);
+	return stats.saved_msecs;
+}
+
+int TesseractProcessor::get_TimeoutMilliseconds()
+{
+	return _timeoutMilliseconds;
+}
+
+void TesseractProcessor::set_TimeoutMilliseconds(int timeoutMilliseconds)
+{
+	_timeoutMilliseconds = (timeoutMilliseconds > 0 ? timeoutMilliseconds : 0);
+}
+
+bool TesseractProcessor::EnableAsync(int numEngines)
+{
+	this->DisableAsync();
+
+	TessAsyncEngine* engine = new TessAsyncEngine();
+	if (!engine->Init(
+		Helper::StringToPointer(_dataPath), 
+		Helper::StringToPointer(_lang),
+		Helper::ParseOcrEngineMode(_ocrEngineMode), numEngines))
+	{
+		delete engine;
+		return false;
+	}
+
+	_asyncEngineInstance = engine;
+	return true;
+}
+
+void TesseractProcessor::DisableAsync()
+{
+	if (_asyncEngineInstance != null)
+	{
+		// Cancels whatever is still queued or running.
+		TessAsyncEngine* engine = (TessAsyncEngine*)_asyncEngineInstance.ToPointer();
+		delete engine;
+		engine = null;
+		_asyncEngineInstance = null;
+	}
+}
+
+TesseractAsyncJob* TesseractProcessor::Submit(System::Drawing::Image* image, bool hocr, int timeoutMillisec)
+{
+	if (_asyncEngineInstance == null || image == null)
+		return null;
+
+	Pix* pix = null;
+	TessAsyncJob* job = null;
+
+	try
+	{
+		pix = this->PixFromImage(image);
+
+		TessJobOptions options;
+		options.hocr = hocr;
+		options.input_name = "none";
+		options.timeout_msecs = timeoutMillisec;
+
+		// The engine takes its own copy of the page.
+		TessAsyncEngine* engine = (TessAsyncEngine*)_asyncEngineInstance.ToPointer();
+		job = engine->Submit(pix, options, null);
+	}
+	catch (System::Exception* exp)
+	{
+		throw exp;
+	}
+	__finally
+	{
+		if (pix != null)
+		{
+			pixDestroy(&pix);
+			pix = null;
+		}
+	}
+
+	if (job == null)
+		return null;
+
+	return new TesseractAsyncJob(job);
+}
+
+bool TesseractProcessor::EnableLayout(String* dataPath, bool detectOsd, int numEngines)
+{
+	this->DisableLayout();
+
+	TessLayoutEngine* engine = new TessLayoutEngine();
+	if (!engine->Init(Helper::StringToPointer(dataPath), detectOsd, numEngines))
+	{
+		delete engine;
+		return false;
+	}
+
+	_layoutEngineInstance = engine;
+	return true;
+}
+
+void TesseractProcessor::DisableLayout()
+{
+	if (_layoutEngineInstance != null)
+	{
+		TessLayoutEngine* engine = (TessLayoutEngine*)_layoutEngineInstance.ToPointer();
+		delete engine;
+		engine = null;
+		_layoutEngineInstance = null;
+	}
+}
+
+List<PageLayout*>* TesseractProcessor::AnalyseLayout(List<System::Drawing::Image*>* images)
+{
+	if (_layoutEngineInstance == null || images == null)
+		return null;
+
+	int numPages = images->Count;
+	Pix** pages = new Pix*[numPages];
+	for (int i = 0; i < numPages; i++)
+		pages[i] = null;
+
+	GenericVector<TessPageLayout> layouts;
+	try
+	{
+		for (int i = 0; i < numPages; i++)
+			pages[i] = this->PixFromImage(images->get_Item(i));
+
+		TessLayoutEngine* engine = (TessLayoutEngine*)_layoutEngineInstance.ToPointer();
+		engine->AnalyseLayout(pages, numPages, &layouts);
+	}
+	catch (System::Exception* exp)
+	{
+		throw exp;
+	}
+	__finally
+	{
+		for (int i = 0; i < numPages; i++)
+		{
+			if (pages[i] != null)
+				pixDestroy(&pages[i]);
+		}
+		delete [] pages;
+		pages = null;
+	}
+
+	// OSBestResult orientation ids 0-3 are 0, 270, 180 and 90 degrees.
+	const int kDegrees[] = { 0, 270, 180, 90 };
+	List<PageLayout*>* result = new List<PageLayout*>(layouts.size());
+	for (int i = 0; i < layouts.size(); i++)
+	{
+		const TessPageLayout& layout = layouts[i];
+		PageLayout* page = new PageLayout();
+
+		for (int b = 0; b < layout.blocks.size(); b++)
+		{
+			const TessLayoutBox& box = layout.blocks[b];
+			page->Blocks->Add(new LayoutRegion(
+				box.left, box.top, box.right, box.bottom, box.block, box.type));
+		}
+		for (int l = 0; l < layout.lines.size(); l++)
+		{
+			const TessLayoutBox& box = layout.lines[l];
+			page->Lines->Add(new LayoutRegion(
+				box.left, box.top, box.right, box.bottom, box.block, box.type));
+		}
+
+		page->HasOsd = layout.has_osd;
+		if (layout.has_osd)
+		{
+			page->Orientation = kDegrees[layout.orientation_id & 3];
+			page->OrientationConfidence = layout.orientation_confidence;
+			page->Script = Helper::PointerToString(layout.script.string());
+			page->ScriptConfidence = layout.script_confidence;
+		}
+		page->Milliseconds = layout.msecs;
+
+		result->Add(page);
+	}
+
+	return result;
+}
+
+bool TesseractProcessor::EnableBatch(int numEngines, int numReaders, int queueDepth, int maxMegabytes)
+{
+	this->DisableBatch();
+
+	TessBatchOptions options;
+	options.num_readers = numReaders;
+	options.queue_depth = queueDepth;
+	options.max_queued_bytes = (maxMegabytes > 0 ? (inT64)maxMegabytes << 20 : 0);
+	options.timeout_msecs = _timeoutMilliseconds;
+
+	TessBatchRecognizer* recognizer = new TessBatchRecognizer();
+	if (!recognizer->Init(
+		Helper::StringToPointer(_dataPath), 
+		Helper::StringToPointer(_lang),
+		Helper::ParseOcrEngineMode(_ocrEngineMode), numEngines, options))
+	{
+		delete recognizer;
+		return false;
+	}
+
+	_batchRecognizerInstance = recognizer;
+	return true;
+}
+
+void TesseractProcessor::DisableBatch()
+{
+	if (_batchRecognizerInstance != null)
+	{
+		TessBatchRecognizer* recognizer = (TessBatchRecognizer*)_batchRecognizerInstance.ToPointer();
+		delete recognizer;
+		recognizer = null;
+		_batchRecognizerInstance = null;
+	}
+}
+
+List<BatchResult*>* TesseractProcessor::RecognizeBatch(List<String*>* filePaths, bool hocr)
+{
+	if (_batchRecognizerInstance == null || filePaths == null)
+		return null;
+
+	GenericVector<STRING> files;
+	for (int i = 0; i < filePaths->Count; i++)
+	{
+		char* path = Helper::StringToPointer(filePaths->get_Item(i));
+		files.push_back(STRING(path != null ? path : ""));
+		if (path != null)
+			System::Runtime::InteropServices::Marshal::FreeHGlobal(System::IntPtr(path));
+	}
+
+	return this->RecognizeBatch(files, hocr);
+}
+
+List<BatchResult*>* TesseractProcessor::RecognizeDirectory(String* dirPath, bool hocr)
+{
+	if (_batchRecognizerInstance == null || dirPath == null)
+		return null;
+
+	char* dir = Helper::StringToPointer(dirPath);
+	GenericVector<STRING> files;
+	bool isDirectory = (dir != null && ListImageFiles(dir, &files));
+	if (dir != null)
+		System::Runtime::InteropServices::Marshal::FreeHGlobal(System::IntPtr(dir));
+	if (!isDirectory)
+		return null;
+
+	return this->RecognizeBatch(files, hocr);
+}
+
+List<BatchResult*>* TesseractProcessor::RecognizeBatch(const GenericVector<STRING>& files, bool hocr)
+{
+	TessBatchRecognizer* recognizer = (TessBatchRecognizer*)_batchRecognizerInstance.ToPointer();
+	recognizer->SetVariable("tessedit_create_hocr", hocr ? "1" : "0");
+
+	GenericVector<TessBatchResult> results;
+	TessBatchStats stats;
+	if (!recognizer->Recognize(files, &results, &stats))
+		return null;
+
+	List<BatchResult*>* result = new List<BatchResult*>(results.size());
+	for (int i = 0; i < results.size(); i++)
+	{
+		const TessBatchResult& file = results[i];
+		BatchResult* item = new BatchResult();
+		item->FilePath = Helper::PointerToString(file.filename.string());
+		item->Succeeded = file.ok;
+		item->Pages = file.pages;
+		item->Text = new String(file.text.string());
+		item->ReadMilliseconds = file.read_msecs;
+		item->RecognizeMilliseconds = file.recognize_msecs;
+		result->Add(item);
+	}
+
+	_lastBatchStats = new BatchStats();
+	_lastBatchStats->Files = stats.files;
+	_lastBatchStats->Pages = stats.pages;
+	_lastBatchStats->WallMilliseconds = stats.wall_msecs;
+	_lastBatchStats->ReadMilliseconds = stats.read_msecs;
+	_lastBatchStats->RecognizeMilliseconds = stats.recognize_msecs;
+	_lastBatchStats->ReaderStallMilliseconds = stats.reader_stall_msecs;
+	_lastBatchStats->EngineStallMilliseconds = stats.engine_stall_msecs;
+	_lastBatchStats->PeakQueuedPages = stats.peak_queued_pages;
+	_lastBatchStats->PeakQueuedBytes = stats.peak_queued_bytes;
+
+	return result;
+}
+
+BatchStats* TesseractProcessor::get_LastBatchStats()
+{
+	return _lastBatchStats;
+}
+
+int TesseractProcessor::get_SkippedStages()
+{
+	if (_apiInstance == null)
+		return 0;
+
+	return ((TessBaseAPI*)_apiInstance.ToPointer())->GetSkippedStages();
+}
+// ===============================================================
+
+
+
 
 
 
@@ -396,7 +784,7 @@ String* TesseractProcessor::Apply(String* filePath)
 
 	STRING text_out;
 	bool succed = api->ProcessPages(
-		Helper::StringToPointer(filePath), null, 0, &text_out);
+		Helper::StringToPointer(filePath), null, _timeoutMilliseconds, &text_out);
 
 	result = new String(text_out.string());
 
@@ -416,7 +804,7 @@ String* TesseractProcessor::Apply(System::Drawing::Image* image, bool hocr)
 		pix = this->PixFromImage(image);
 
 		TessBaseAPI* api = (TessBaseAPI*)_apiInstance.ToPointer();
-		result = this->Process(api, pix, hocr);
+		result = this->Process(api, &pix, hocr);
 	}
 	catch (System::Exception* exp)
 	{
@@ -450,20 +838,42 @@ String* TesseractProcessor::Apply(System::Drawing::Image* image, bool hocr)
 
 String* TesseractProcessor::Process(Pix* pix)
 {
+	if (pix == null)
+		return null;
+
 	TessBaseAPI* api = (TessBaseAPI*)_apiInstance.ToPointer();
-	return this->Process(api, pix, false);
+	Pix* clone = pixClone(pix);
+	String* result = this->Process(api, &clone, false);
+	if (clone != null)
+		pixDestroy(&clone);
+	return result;
 }
 
-String* TesseractProcessor::Process(TessBaseAPI* api, Pix* pix, bool hocr)
+String* TesseractProcessor::Process(TessBaseAPI* api, Pix** pix, bool hocr)
 {
-	if (api == null || pix == null)
+	if (api == null || pix == null || *pix == null)
 		return null;
 
 	this->InitializeMonitor();
 	ETEXT_DESC* monitor = (_doMonitor ? (ETEXT_DESC*)_monitorInstance.ToPointer() : null);
 
-	api->SetImage(pix);
+	api->SetImage(*pix);
+	// The api holds its own reference, so with tessedit_memory_budget the
+	// converted bitmap is freed as soon as it has been thresholded.
+	pixDestroy(pix);
+	*pix = null;
 	//bool succed = api->Recognize(monitor) >= 0;  // this is done twice!!!
+
+	if (_timeoutMilliseconds > 0)
+	{
+		// Recognize up front so the deadline applies; the Get*Text calls
+		// below then reuse the result. On failure there is no result to
+		// reuse, and they would recognize the page again with no deadline.
+		ETEXT_DESC deadline;
+		deadline.set_deadline_msecs(_timeoutMilliseconds);
+		if (api->Recognize(&deadline) < 0)
+			return null;
+	}
 	
 	char* text = NULL;
 	
@@ -477,7 +887,7 @@ String* TesseractProcessor::Process(TessBaseAPI* api, Pix* pix, bool hocr)
 
 	String* result = new String(text);
 
-	delete text;
+	delete [] text;
 	
 	return result;
 }
@@ -486,6 +896,14 @@ String* TesseractProcessor::Process(TessBaseAPI* api, Pix* pix, bool hocr)
 
 System::Collections::Generic::List<Word*>* TesseractProcessor::RetriveResultDetail()
 {
+	if (_apiInstance != null)
+	{
+		TessBaseAPI* api = (TessBaseAPI*)_apiInstance.ToPointer();
+		const StripRecognizer* strips = api->GetStripResults();
+		if (strips != null)
+			return this->RetriveStripResultDetail(strips);
+	}
+
 	if (!_doMonitor || _monitorInstance == null)
 		return null;
 	
@@ -574,6 +992,55 @@ System::Collections::Generic::List<Word*>* TesseractProcessor::RetriveResultDeta
 
 	return wordList;
 }
+
+List<Word*>* TesseractProcessor::RetriveStripResultDetail(
+	const StripRecognizer* strips)
+{
+	List<Word*>* wordList = new List<Word*>();
+	const GenericVector<StripWord>& words = strips->words();
+	for (int w = 0; w < words.size(); w++)
+	{
+		const StripWord& word = words[w];
+		Word* currentWord = new Word();
+		currentWord->LineIndex = word.line;
+		currentWord->FontIndex = word.font_id;
+		currentWord->PointSize = word.pointsize;
+		currentWord->Formating = (word.bold ? EUC_BOLD : 0) |
+			(word.italic ? EUC_ITALIC : 0);
+		currentWord->Text = new String(word.text.string());
+		currentWord->Left = (int)word.left;
+		currentWord->Top = (int)word.top;
+		currentWord->Right = (int)word.right;
+		currentWord->Bottom = (int)word.bottom;
+
+		/* one Character per byte, as the monitor holds them, with its
+		   confidence of 0 for perfect and 100 for reject */
+		for (int s = 0; s < word.symbols.size(); s++)
+		{
+			const StripSymbol& symbol = word.symbols[s];
+			double confidence = 100.0 - symbol.confidence;
+			for (int i = 0; symbol.text[i] != '\0'; i++)
+			{
+				Character* c = new Character(
+					symbol.text[i], confidence,
+					(int)symbol.left, (int)symbol.top,
+					(int)symbol.right, (int)symbol.bottom);
+				currentWord->CharList->Add(c);
+				currentWord->Confidence += confidence;
+			}
+		}
+
+		if (currentWord->CharList->Count > 0)
+			wordList = currentWord->UpdateConfidenceAndInsertTo(wordList);
+		else
+		{
+			currentWord->Confidence = 100.0 - word.confidence;
+			wordList->Add(currentWord);
+		}
+	}
+
+	return wordList;
+}
 // ===============================================================
 
 
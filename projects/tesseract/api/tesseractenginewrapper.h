@@ -38,6 +38,10 @@ limitations under the License.
 #include "..\ccstruct\ocrblock.h"
 #include "..\ccutil\ocrclass.h"
 #include "..\ccstruct\pageres.h"
+#include "..\api\pagecache.h"
+#include "..\api\asyncapi.h"
+#include "..\api\layoutengine.h"
+#include "..\api\batchrecognizer.h"
 
 BEGIN_NAMSPACE
 
@@ -48,6 +52,9 @@ __gc public class RectBound;
 __gc public class SimpleRecoginitionItem;
 __gc public class Character;
 __gc public class Word;
+__gc public class PageLayout;
+__gc public class BatchResult;
+__gc public class BatchStats;
 
 
 __gc public class BlockList
@@ -105,6 +112,85 @@ public:
 };
 
 
+// Managed handle on a page queued with TesseractProcessor::Submit. The
+// .NET 3.5 runtime has no Task or CancellationToken, so callers poll
+// Progress/IsCompleted or block in Wait, and call Cancel to abandon a page.
+__gc public class TesseractAsyncJob
+{
+private:
+	System::IntPtr _jobInstance;
+
+public:
+	TesseractAsyncJob(System::IntPtr job)
+	{
+		_jobInstance = job;
+	}
+
+	~TesseractAsyncJob()
+	{
+		if (_jobInstance != NULL)
+		{
+			TessAsyncJob* job = (TessAsyncJob*)_jobInstance.ToPointer();
+			job->Release();
+			_jobInstance = NULL;
+		}
+	}
+
+public:
+	void Cancel()
+	{
+		if (_jobInstance != NULL)
+			((TessAsyncJob*)_jobInstance.ToPointer())->Cancel();
+	}
+
+	bool Wait(int timeoutMillisec)
+	{
+		if (_jobInstance == NULL)
+			return true;
+
+		return ((TessAsyncJob*)_jobInstance.ToPointer())->Wait(timeoutMillisec);
+	}
+
+	// 0-100
+	__property int get_Progress()
+	{
+		if (_jobInstance == NULL)
+			return 0;
+
+		return ((TessAsyncJob*)_jobInstance.ToPointer())->Progress();
+	}
+
+	__property bool get_IsCompleted()
+	{
+		if (_jobInstance == NULL)
+			return true;
+
+		return ((TessAsyncJob*)_jobInstance.ToPointer())->IsFinal();
+	}
+
+	__property bool get_IsCancelled()
+	{
+		if (_jobInstance == NULL)
+			return false;
+
+		return ((TessAsyncJob*)_jobInstance.ToPointer())->state() == TJS_CANCELLED;
+	}
+
+	// The recognized text, or null if the job is not done or did not succeed.
+	__property String* get_Result()
+	{
+		if (_jobInstance == NULL)
+			return null;
+
+		TessAsyncJob* job = (TessAsyncJob*)_jobInstance.ToPointer();
+		if (job->state() != TJS_DONE)
+			return null;
+
+		return new String(job->text().string());
+	}
+};
+
+
 __gc public class TesseractProcessor
 {	
 private:
@@ -129,6 +215,12 @@ public:
 private:
 	System::IntPtr _apiInstance;
 	System::IntPtr _monitorInstance;
+	System::IntPtr _pageCacheInstance;
+	System::IntPtr _asyncEngineInstance;
+	System::IntPtr _layoutEngineInstance;
+	System::IntPtr _batchRecognizerInstance;
+	BatchStats* _lastBatchStats;
+	int _timeoutMilliseconds;
 
 public:	
 	TesseractProcessor();
@@ -154,6 +246,66 @@ public:
 
 	bool SetVariable(System::String* nam, System::String* value);
 
+public:
+	// Page result cache: pages of Apply(filePath) whose thresholded image and
+	// settings match an earlier page return the stored text directly.
+	// maxEntries/maxMegabytes of 0 mean no limit; diskDir may be null.
+	void EnablePageCache(int maxEntries, int maxMegabytes, String* diskDir);
+	void DisablePageCache();
+
+	__property double get_PageCacheHitRate();
+	__property Int64 get_PageCacheHits();
+	__property Int64 get_PageCacheLookups();
+	__property double get_PageCacheSavedMilliseconds();
+
+public:
+	// Per-page time budget for Apply, 0 for none. With the variable
+	// tessedit_degrade_on_deadline set, pages that run short skip their
+	// optional stages instead of being cut off; SkippedStages then reports
+	// which (RS_PASS2 = 1, RS_FUZZY_SPACES = 2, RS_CUBE = 4, RS_FONTS = 8).
+	// A page too large for one pass, recognized in strips, also reports
+	// RS_STRIPS = 16 if some strips are missing from it.
+	__property int get_TimeoutMilliseconds();
+	__property void set_TimeoutMilliseconds(int timeoutMilliseconds);
+	__property int get_SkippedStages();
+
+public:
+	// Starts numEngines background engines (one per processor if <= 0) with
+	// the settings of the last Init. Pages given to Submit are recognized on
+	// them without blocking the caller.
+	bool EnableAsync(int numEngines);
+	void DisableAsync();
+	// Requires EnableAsync. Returns null if it has not been called.
+	TesseractAsyncJob* Submit(Image* image, bool hocr, int timeoutMillisec);
+
+public:
+	// Layout-only triage, independent of Init: starts numEngines engines (one
+	// per processor if <= 0) that load no recognition models, or only
+	// osd.traineddata from dataPath if detectOsd, and start in milliseconds.
+	bool EnableLayout(String* dataPath, bool detectOsd, int numEngines);
+	void DisableLayout();
+	// Finds the blocks, lines and, with detectOsd, the orientation and script
+	// of each image, in parallel. Requires EnableLayout. Returns null if it
+	// has not been called.
+	List<PageLayout*>* AnalyseLayout(List<Image*>* images);
+
+public:
+	// Batch folder OCR: starts numEngines engines (one per processor if <= 0)
+	// with the settings of the last Init, fed by numReaders threads that read
+	// and decode the files ahead of them. At most queueDepth decoded pages,
+	// and maxMegabytes of them (0 for no limit), wait for an engine at once.
+	// Pages are cut off after the TimeoutMilliseconds set when this is called.
+	bool EnableBatch(int numEngines, int numReaders, int queueDepth, int maxMegabytes);
+	void DisableBatch();
+	// Recognizes every page of the files, giving a result per file, in order.
+	// Requires EnableBatch. Returns null if it has not been called.
+	List<BatchResult*>* RecognizeBatch(List<String*>* filePaths, bool hocr);
+	// As RecognizeBatch, on the image files of a directory, by name. Also
+	// returns null if dirPath is not a directory.
+	List<BatchResult*>* RecognizeDirectory(String* dirPath, bool hocr);
+	// Where the time of the last batch went, or null if there has been none.
+	__property BatchStats* get_LastBatchStats();
+
 private:
 	void InitializeWorkingSpace();
 	void InitializeEngineAPI();
@@ -176,7 +328,12 @@ private:
 	Pix* PixFromImage(Image* image);
 	BlockList* DetectBlocks(TessBaseAPI* api, Pix* pix);
 	String* Process(Pix* pix);
-	String* Process(TessBaseAPI* api, Pix* pix, bool hocr);
+	// Takes over the reference in *pix, which it destroys once api has its own.
+	String* Process(TessBaseAPI* api, Pix** pix, bool hocr);
+	List<BatchResult*>* RecognizeBatch(const GenericVector<STRING>& files, bool hocr);
+	// The words of a page recognized in strips, which the monitor can't
+	// hold, as RetriveResultDetail.
+	List<Word*>* RetriveStripResultDetail(const StripRecognizer* strips);
 };
 
 
@@ -366,4 +523,113 @@ public:
 };
 
 
+// A block or text line found by TesseractProcessor::AnalyseLayout.
+__gc public class LayoutRegion : public RectBound
+{
+public:
+	// Index of the block in PageLayout::Blocks, or of the block of a line.
+	int Block;
+	// PolyBlockType of the block (see publictypes.h).
+	int Type;
+
+public:
+	LayoutRegion(int left, int top, int right, int bottom, int block, int type)
+		: RectBound(left, top, right, bottom)
+	{
+		Block = block;
+		Type = type;
+	}
+};
+
+__gc public class PageLayout
+{
+public:
+	// In reading order. Non-text blocks have no lines, and an empty page none
+	// of either.
+	List<LayoutRegion*>* Blocks;
+	List<LayoutRegion*>* Lines;
+
+	// Orientation and script, if detected: Orientation is the clockwise
+	// rotation, in degrees, that makes the page upright.
+	bool HasOsd;
+	int Orientation;
+	float OrientationConfidence;
+	String* Script;
+	float ScriptConfidence;
+
+	double Milliseconds;
+
+public:
+	PageLayout()
+	{
+		Blocks = new List<LayoutRegion*>();
+		Lines = new List<LayoutRegion*>();
+		HasOsd = false;
+		Orientation = 0;
+		OrientationConfidence = 0;
+		Script = null;
+		ScriptConfidence = 0;
+		Milliseconds = 0;
+	}
+};
+
+
+// The text of one file from TesseractProcessor::RecognizeBatch.
+__gc public class BatchResult
+{
+public:
+	String* FilePath;
+	// False if the file could not be read, or a page failed. The text of the
+	// pages that were recognized is kept.
+	bool Succeeded;
+	int Pages;
+	String* Text;
+	double ReadMilliseconds;
+	double RecognizeMilliseconds;
+
+public:
+	BatchResult()
+	{
+		FilePath = null;
+		Succeeded = false;
+		Pages = 0;
+		Text = null;
+		ReadMilliseconds = 0;
+		RecognizeMilliseconds = 0;
+	}
+};
+
+// Where the time of a batch went. Busy and stall times are summed over the
+// threads of each stage. Stalled engines mean the batch waits on the disk or
+// the decoder, and more readers may help; stalled readers mean the engines
+// are the bottleneck.
+__gc public class BatchStats
+{
+public:
+	int Files;
+	int Pages;
+	double WallMilliseconds;
+	double ReadMilliseconds;
+	double RecognizeMilliseconds;
+	double ReaderStallMilliseconds;
+	double EngineStallMilliseconds;
+	int PeakQueuedPages;
+	Int64 PeakQueuedBytes;
+
+public:
+	BatchStats()
+	{
+		Files = 0;
+		Pages = 0;
+		WallMilliseconds = 0;
+		ReadMilliseconds = 0;
+		RecognizeMilliseconds = 0;
+		ReaderStallMilliseconds = 0;
+		EngineStallMilliseconds = 0;
+		PeakQueuedPages = 0;
+		PeakQueuedBytes = 0;
+	}
+};
+
+
 END_NAMESPACE
\ No newline at end of file
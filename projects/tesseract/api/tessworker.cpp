@@ -0,0 +1,288 @@
+///////////////////////////////////////////////////////////////////////
+// File:        tessworker.cpp
+// Description: Worker process of TessWorkerPool. Recognizes the pages its
+//              pool sends it with one engine.
+// Created:     Sun Oct 18 23:12:06 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+//
+// Usage:
+//   tessworker -fd n [-tessdata dir] [-l lang] [-oem n]
+//
+// Not for running by hand: TessWorkerPool starts it with one end of a
+// socket pair as descriptor n. The engine is initialized with the other
+// arguments, a WorkerReply says whether that worked, and then requests
+// are answered, as workerprotocol.h describes, until WMT_QUIT or until the
+// pool closes its end.
+
+#include "mfcpch.h"
+#ifdef HAVE_CONFIG_H
+#include "config_auto.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+#include "allheaders.h"
+#include "baseapi.h"
+#include "genericvector.h"
+#include "ocrclass.h"
+#include "resultiterator.h"
+#include "strngs.h"
+#include "textrenderer.h"
+#include "workerprotocol.h"
+
+#ifndef WIN32
+
+namespace tesseract {
+
+// Longest variable name, value or input name accepted.
+const int kMaxWorkerStringBytes = 1 << 16;
+
+static double NowMsecs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// Answers the requests of a pool on socket with api.
+class WorkerHost {
+ public:
+  WorkerHost(TessBaseAPI* api, int socket)
+    : api_(api), socket_(socket), segment_(NULL), segment_bytes_(0) {}
+  ~WorkerHost() {
+    if (segment_ != NULL)
+      munmap(segment_, segment_bytes_);
+  }
+
+  // Answers requests until told to quit or the pool goes. Returns false if
+  // the stream was garbled.
+  bool Serve();
+
+ private:
+  // Maps the segment passed as fd in place of any earlier one.
+  bool MapSegment(int fd, inT64 segment_bytes);
+  // Recognizes the page in the segment and replies with the results.
+  bool Recognize(const WorkerRequest& request, const STRING& input_name);
+  bool Reply(WorkerReplyStatus status);
+
+  TessBaseAPI* api_;
+  int socket_;
+  void* segment_;
+  size_t segment_bytes_;
+  GenericVector<char> name_;    // Reused for the strings of requests.
+  GenericVector<char> value_;
+};
+
+// Reads a string of size bytes into buffer and null-terminates it.
+static bool ReadWorkerString(int socket, int size,
+                             GenericVector<char>* buffer) {
+  if (size < 0 || size > kMaxWorkerStringBytes)
+    return false;
+  buffer->init_to_size(size + 1, '\0');
+  return WorkerRead(socket, &(*buffer)[0], size, -1) == WIO_OK;
+}
+
+bool WorkerHost::Serve() {
+  while (true) {
+    WorkerRequest request;
+    int fd;
+    if (WorkerReadWithFd(socket_, &request, sizeof(request), &fd) != WIO_OK)
+      return true;  // The pool has gone.
+    if (fd >= 0) {
+      bool mapped = MapSegment(fd, request.segment_bytes);
+      close(fd);
+      if (!mapped)
+        return false;
+    }
+    // Without a valid header there is no telling where the next one
+    // starts, so the pool has to restart the worker.
+    if (request.magic != kWorkerMagic ||
+        !ReadWorkerString(socket_, request.name_bytes, &name_) ||
+        !ReadWorkerString(socket_, request.value_bytes, &value_))
+      return false;
+    switch (request.type) {
+      case WMT_QUIT:
+        return true;
+      case WMT_SET_VARIABLE:
+        if (!Reply(api_->SetVariable(&name_[0], &value_[0]) ? WRS_OK
+                                                            : WRS_FAILED))
+          return true;
+        break;
+      case WMT_RECOGNIZE:
+        if (!Recognize(request, STRING(&name_[0])))
+          return true;
+        break;
+      default:
+        if (!Reply(WRS_BAD_REQUEST))
+          return true;
+        break;
+    }
+  }
+}
+
+bool WorkerHost::MapSegment(int fd, inT64 segment_bytes) {
+  if (segment_ != NULL)
+    munmap(segment_, segment_bytes_);
+  segment_ = NULL;
+  segment_bytes_ = 0;
+  if (segment_bytes <= 0)
+    return false;
+  // Shared, so the pages the pool writes later are seen here.
+  void* mapping = mmap(NULL, segment_bytes, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED)
+    return false;
+  segment_ = mapping;
+  segment_bytes_ = segment_bytes;
+  return true;
+}
+
+bool WorkerHost::Recognize(const WorkerRequest& request,
+                           const STRING& input_name) {
+  double start = NowMsecs();
+  size_t page_bytes = static_cast<size_t>(request.wpl) * sizeof(l_uint32) *
+                      request.height;
+  Pix* pix = NULL;
+  if (segment_ != NULL && request.width > 0 && request.height > 0 &&
+      request.wpl > 0 && page_bytes <= segment_bytes_) {
+    pix = pixCreateHeader(request.width, request.height, request.depth);
+    if (pix != NULL && pixGetWpl(pix) != request.wpl)
+      pixDestroy(&pix);
+  }
+  if (pix == NULL)
+    return Reply(WRS_BAD_REQUEST);
+  // The pixels stay in the segment, and are taken back before the Pix goes.
+  pixSetData(pix, static_cast<l_uint32*>(segment_));
+  pixSetResolution(pix, request.xres, request.yres);
+
+  ETEXT_DESC monitor;
+  if (request.timeout_msecs > 0)
+    monitor.set_deadline_msecs(request.timeout_msecs);
+  api_->SetPageSegMode(static_cast<PageSegMode>(request.pageseg_mode));
+  api_->SetImage(pix);
+  bool ok = api_->Recognize(&monitor) >= 0;
+  TextBuffer text;
+  if (ok) {
+    TextBuffer* buffers[TF_COUNT] = { NULL };
+    if (request.flags & WRF_HOCR) {
+      api_->SetInputName(input_name.string());
+      buffers[TF_HOCR] = &text;
+    } else {
+      buffers[TF_UTF8] = &text;
+    }
+    ok = api_->RenderText(request.page_number, buffers);
+  }
+  GenericVector<WorkerWord> words;
+  if (ok && (request.flags & WRF_WORDS)) {
+    ResultIterator* it = api_->GetIterator();
+    if (it != NULL) {
+      do {
+        WorkerWord word;
+        if (!it->BoundingBox(RIL_WORD, &word.left, &word.top, &word.right,
+                             &word.bottom))
+          continue;
+        word.confidence = it->Confidence(RIL_WORD);
+        words.push_back(word);
+      } while (it->Next(RIL_WORD));
+      delete it;
+    }
+  }
+  api_->Clear();
+  pixSetData(pix, NULL);
+  pixDestroy(&pix);
+
+  WorkerReply reply;
+  reply.status = ok ? WRS_OK : WRS_FAILED;
+  reply.text_bytes = ok ? text.length() : 0;
+  reply.num_words = ok ? words.size() : 0;
+  reply.recognize_msecs = NowMsecs() - start;
+  if (!WorkerWrite(socket_, &reply, sizeof(reply)))
+    return false;
+  // The chunks are written as they are, without joining them.
+  for (int i = 0; i < text.num_chunks() && reply.text_bytes > 0; ++i) {
+    if (!WorkerWrite(socket_, text.chunk(i), text.chunk_length(i)))
+      return false;
+  }
+  return reply.num_words == 0 ||
+         WorkerWrite(socket_, &words[0], words.size() * sizeof(WorkerWord));
+}
+
+bool WorkerHost::Reply(WorkerReplyStatus status) {
+  WorkerReply reply;
+  reply.status = status;
+  return WorkerWrite(socket_, &reply, sizeof(reply));
+}
+
+}  // namespace tesseract.
+
+#endif  // WIN32
+
+static void Usage(const char* program) {
+  fprintf(stderr,
+          "Usage: %s -fd n [-tessdata dir] [-l lang] [-oem n]\n"
+          "Started by TessWorkerPool, not by hand.\n",
+          program);
+}
+
+int main(int argc, char **argv) {
+#ifdef WIN32
+  fprintf(stderr, "%s needs POSIX\n", argv[0]);
+  return 1;
+#else
+  int socket = -1;
+  const char* datapath = NULL;
+  const char* lang = "eng";
+  int oem = tesseract::OEM_DEFAULT;
+  for (int arg = 1; arg < argc; ++arg) {
+    bool has_value = arg + 1 < argc;
+    if (strcmp(argv[arg], "-fd") == 0 && has_value) {
+      socket = atoi(argv[++arg]);
+    } else if (strcmp(argv[arg], "-tessdata") == 0 && has_value) {
+      datapath = argv[++arg];
+    } else if (strcmp(argv[arg], "-l") == 0 && has_value) {
+      lang = argv[++arg];
+    } else if (strcmp(argv[arg], "-oem") == 0 && has_value) {
+      oem = atoi(argv[++arg]);
+    } else {
+      Usage(argv[0]);
+      return 2;
+    }
+  }
+  if (socket < 0) {
+    Usage(argv[0]);
+    return 2;
+  }
+
+  tesseract::TessBaseAPI api;
+  tesseract::WorkerReply ready;
+  if (api.Init(datapath, lang,
+               static_cast<tesseract::OcrEngineMode>(oem)) < 0)
+    ready.status = tesseract::WRS_FAILED;
+  if (!tesseract::WorkerWrite(socket, &ready, sizeof(ready)) ||
+      ready.status != tesseract::WRS_OK)
+    return 1;
+  bool ok;
+  {
+    tesseract::WorkerHost host(&api, socket);
+    ok = host.Serve();
+  }
+  api.End();
+  close(socket);
+  return ok ? 0 : 1;
+#endif
+}
@@ -0,0 +1,534 @@
+///////////////////////////////////////////////////////////////////////
+// File:        textrenderer.cpp
+// Description: Writes the recognized text of a page as UTF-8, hOCR, box
+//              file and UNLV text in a single walk of the results.
+// Created:     Sun Oct 18 21:05:42 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <string.h>
+
+#include "textrenderer.h"
+#include "boxword.h"
+#include "helpers.h"
+#include "ndminx.h"
+#include "pageres.h"
+#include "strngs.h"
+#include "tesseractclass.h"
+#include "unichar.h"
+
+namespace tesseract {
+
+// Size of the first chunk of a buffer nothing was reserved for.
+const int kMinChunkSize = 4096;
+// Character returned when Tesseract couldn't recognize as anything.
+const char kTesseractReject = '~';
+// Character used by UNLV error counter as a reject.
+const char kUNLVReject = '~';
+// Character used by UNLV as a suspect marker.
+const char kUNLVSuspect = '^';
+// Max bytes in the decimal representation of an inT64, with its sign.
+const int kMaxInt64Chars = 20;
+
+// The two digits of each number from 0 to 99.
+static const char kDigitPairs[] =
+    "00010203040506070809101112131415161718192021222324"
+    "25262728293031323334353637383940414243444546474849"
+    "50515253545556575859606162636465666768697071727374"
+    "75767778798081828384858687888990919293949596979899";
+
+// The XML entities of the characters that must be escaped in hOCR text,
+// indexed by kXmlEscapeIndex.
+static const char* const kXmlEntities[] = {
+  "", "&quot;", "&amp;", "&#39;", "&lt;", "&gt;"
+};
+static const int kXmlEntityLengths[] = { 0, 6, 5, 5, 4, 4 };
+// Index in kXmlEntities of the entity of each byte, or 0 to copy the byte.
+static const uinT8 kXmlEscapeIndex[256] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 1, 0, 0, 0, 2, 3, 0, 0, 0, 0, 0, 0, 0, 0,   // " & '
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 0, 5, 0,   // < >
+  // The rest are all 0.
+};
+
+// Conversion table for non-latin characters.
+// Maps characters out of the latin set into the latin set.
+// TODO(rays) incorporate this translation into unicharset.
+const int kUniChs[] = {
+  0x20ac, 0x201c, 0x201d, 0x2018, 0x2019, 0x2022, 0x2014, 0
+};
+// Latin chars corresponding to the unicode chars above.
+const int kLatinChs[] = {
+  0x00a2, 0x0022, 0x0022, 0x0027, 0x0027, 0x00b7, 0x002d, 0
+};
+
+TextBuffer::TextBuffer()
+  : pos_(NULL), end_(NULL), length_(0), reserved_(0) {
+}
+
+TextBuffer::~TextBuffer() {
+  Clear();
+}
+
+void TextBuffer::Reserve(int size) {
+  if (chunks_.empty() && size > reserved_)
+    reserved_ = size;
+}
+
+// Every chunk but the last is full, as a chunk is only added when the last
+// has no room left.
+int TextBuffer::chunk_length(int index) const {
+  if (index < chunks_.size() - 1)
+    return chunk_sizes_[index];
+  return pos_ - chunks_[index];
+}
+
+void TextBuffer::Append(const char* str, int length) {
+  while (length > 0) {
+    if (pos_ == end_)
+      NewChunk(length);
+    int count = MIN(length, static_cast<int>(end_ - pos_));
+    memcpy(pos_, str, count);
+    pos_ += count;
+    str += count;
+    length -= count;
+    length_ += count;
+  }
+}
+
+void TextBuffer::Append(const char* str) {
+  Append(str, strlen(str));
+}
+
+// Writes the digits backwards from the end of a small array, two at a time.
+void TextBuffer::AppendInt(inT64 value) {
+  char digits[kMaxInt64Chars];
+  char* start = digits + kMaxInt64Chars;
+  // The magnitude of the most negative inT64 only fits unsigned.
+  uinT64 magnitude = value < 0 ? 0 - static_cast<uinT64>(value) : value;
+  while (magnitude >= 100) {
+    int pair = static_cast<int>(magnitude % 100) * 2;
+    magnitude /= 100;
+    *--start = kDigitPairs[pair + 1];
+    *--start = kDigitPairs[pair];
+  }
+  if (magnitude >= 10) {
+    int pair = static_cast<int>(magnitude) * 2;
+    *--start = kDigitPairs[pair + 1];
+    *--start = kDigitPairs[pair];
+  } else {
+    *--start = static_cast<char>('0' + magnitude);
+  }
+  if (value < 0)
+    *--start = '-';
+  Append(start, digits + kMaxInt64Chars - start);
+}
+
+// Copies runs of bytes that need no escaping in one go.
+void TextBuffer::AppendEscaped(const char* str, int length) {
+  const char* end = str + length;
+  const char* run = str;
+  for (const char* ch = str; ch < end; ++ch) {
+    int entity = kXmlEscapeIndex[static_cast<uinT8>(*ch)];
+    if (entity != 0) {
+      Append(run, ch - run);
+      Append(kXmlEntities[entity], kXmlEntityLengths[entity]);
+      run = ch + 1;
+    }
+  }
+  Append(run, end - run);
+}
+
+void TextBuffer::AppendTo(STRING* str) const {
+  str->ensure(str->length() + length_ + 1);
+  for (int i = 0; i < chunks_.size(); ++i) {
+    int length = chunk_length(i);
+    // STRING has no append of a length, so terminate the chunk in the byte
+    // kept for the null.
+    chunks_[i][length] = '\0';
+    *str += chunks_[i];
+  }
+}
+
+char* TextBuffer::Release() {
+  char* result;
+  if (chunks_.size() == 1) {
+    *pos_ = '\0';
+    result = chunks_[0];
+    chunks_.clear();
+    chunk_sizes_.clear();
+  } else {
+    result = new char[length_ + 1];
+    char* dest = result;
+    for (int i = 0; i < chunks_.size(); ++i) {
+      int length = chunk_length(i);
+      memcpy(dest, chunks_[i], length);
+      dest += length;
+    }
+    *dest = '\0';
+  }
+  Clear();
+  return result;
+}
+
+void TextBuffer::Clear() {
+  for (int i = 0; i < chunks_.size(); ++i)
+    delete [] chunks_[i];
+  chunks_.clear();
+  chunk_sizes_.clear();
+  pos_ = NULL;
+  end_ = NULL;
+  length_ = 0;
+}
+
+void TextBuffer::NewChunk(int min_size) {
+  int size = chunks_.empty() ? MAX(reserved_, kMinChunkSize)
+                             : chunk_sizes_[chunk_sizes_.size() - 1] * 2;
+  if (size < min_size)
+    size = min_size;
+  // One more byte, for the null written by Release and AppendTo.
+  char* chunk = new char[size + 1];
+  chunks_.push_back(chunk);
+  chunk_sizes_.push_back(size);
+  pos_ = chunk;
+  end_ = chunk + size;
+}
+
+// Helper returns true if there is a paragraph break between bbox_cur,
+// and bbox_prev.
+// TODO(rays) improve and incorporate deeper into tesseract, so other
+// output methods get the benefit.
+static bool IsParagraphBreak(TBOX bbox_cur, TBOX bbox_prev,
+                             int right, int line_height) {
+  // Check if the distance between lines is larger than the normal leading,
+  if (fabs((float)(bbox_cur.bottom() - bbox_prev.bottom())) > line_height * 2)
+    return true;
+
+  // Check if the distance between left bounds of the two lines is nearly the
+  // same as between their right bounds (if so, then both lines probably belong
+  // to the same paragraph, maybe a centered one).
+  if (fabs((float)((bbox_cur.left() - bbox_prev.left()) -
+           (bbox_prev.right() - bbox_cur.right()))) < line_height)
+    return false;
+
+  // Check if there is a paragraph indent at this line (either -ve or +ve).
+  if (fabs((float)(bbox_cur.left() - bbox_prev.left())) > line_height)
+    return true;
+
+  // Check if both current and previous line don't reach the right bound of the
+  // block, but the distance is different. This will cause all lines in a verse
+  // to be treated as separate paragraphs, but most probably will not split
+  // block-quotes to separate lines (at least if the text is justified).
+  if (fabs((float)(bbox_cur.right() - bbox_prev.right())) > line_height &&
+      right - bbox_cur.right() > line_height &&
+      right - bbox_prev.right() > line_height)
+    return true;
+
+  return false;
+}
+
+TextRenderer::TextRenderer(Tesseract* tesseract, PAGE_RES* page_res,
+                           float scale, int image_height,
+                           int rect_left, int rect_top,
+                           int rect_width, int rect_height)
+  : tesseract_(tesseract), page_res_(page_res), scale_(scale),
+    image_height_(image_height), rect_left_(rect_left), rect_top_(rect_top),
+    rect_width_(rect_width), rect_height_(rect_height), page_number_(0),
+    hocr_block_(NULL), hocr_row_(NULL), hocr_prev_row_(NULL),
+    block_count_(0), line_count_(0), word_count_(0),
+    tilde_crunch_written_(false), last_char_was_newline_(true),
+    last_char_was_tilde_(false) {
+}
+
+void TextRenderer::Render(int page_number, const char* input_name,
+                          TextBuffer** buffers) {
+  page_number_ = page_number;
+  TextBuffer* utf8 = buffers[TF_UTF8];
+  TextBuffer* hocr = buffers[TF_HOCR];
+  TextBuffer* box = buffers[TF_BOX];
+  TextBuffer* unlv = buffers[TF_UNLV];
+  if (hocr != NULL)
+    BeginHOCR(input_name, hocr);
+  tilde_crunch_written_ = false;
+  last_char_was_newline_ = true;
+  last_char_was_tilde_ = false;
+  PAGE_RES_IT page_res_it(page_res_);
+  for (page_res_it.restart_page(); page_res_it.word() != NULL;
+       page_res_it.forward()) {
+    if (utf8 != NULL)
+      WordToUTF8(page_res_it, utf8);
+    if (hocr != NULL)
+      WordToHOCR(page_res_it, hocr);
+    if (box != NULL)
+      WordToBox(page_res_it, box);
+    // Last, as it marks suspect characters in the reject map of the word.
+    if (unlv != NULL)
+      WordToUNLV(page_res_it, unlv);
+  }
+  if (utf8 != NULL)
+    utf8->Append('\n');
+  if (hocr != NULL)
+    EndHOCR(hocr);
+  if (unlv != NULL)
+    unlv->Append('\n');
+}
+
+void TextRenderer::WordToUTF8(const PAGE_RES_IT& it, TextBuffer* out) const {
+  WERD_RES* word = it.word();
+  WERD_CHOICE* choice = word->best_choice;
+  if (choice == NULL)
+    return;
+  const STRING& text = choice->unichar_string();
+  out->Append(text.string(), text.length());
+  out->Append(word->word->flag(W_EOL) ? '\n' : ' ');
+}
+
+void TextRenderer::BeginHOCR(const char* input_name, TextBuffer* out) {
+  hocr_block_ = NULL;
+  hocr_row_ = NULL;
+  hocr_prev_row_ = NULL;
+  block_count_ = 1;
+  line_count_ = 1;
+  word_count_ = 1;
+  out->Append("<div class='ocr_page' id='page_");
+  out->AppendInt(page_number_ + 1);  // hOCR uses 1-based page numbers.
+  out->Append("' title='image \"");
+  out->Append(input_name);
+  out->Append("\"; bbox ");
+  out->AppendInt(rect_left_);
+  out->Append(' ');
+  out->AppendInt(rect_top_);
+  out->Append(' ');
+  out->AppendInt(rect_width_);
+  out->Append(' ');
+  out->AppendInt(rect_height_);
+  out->Append("'>\n");
+}
+
+// The box is in the thresholded image, which is the source image scaled by
+// scale_.
+void TextRenderer::BoxToHOCR(const TBOX& box, TextBuffer* out) const {
+  out->Append("' title=\"bbox ");
+  out->AppendInt(static_cast<int>(floor(box.left() / scale_)));
+  out->Append(' ');
+  out->AppendInt(image_height_ - static_cast<int>(ceil(box.top() / scale_)));
+  out->Append(' ');
+  out->AppendInt(static_cast<int>(ceil(box.right() / scale_)));
+  out->Append(' ');
+  out->AppendInt(image_height_ -
+                 static_cast<int>(floor(box.bottom() / scale_)));
+  out->Append("\">");
+}
+
+// STL removed from original patch submission and refactored by rays.
+void TextRenderer::WordToHOCR(const PAGE_RES_IT& it, TextBuffer* out) {
+  int page_id = page_number_ + 1;
+  BLOCK* real_block = it.block()->block;
+  if (hocr_block_ != it.block()) {
+    if (hocr_block_ != NULL)
+      out->Append("</span>\n</p>\n</div>\n");
+    hocr_block_ = it.block();
+    hocr_row_ = NULL;
+    hocr_prev_row_ = NULL;
+    out->Append("<div class='ocr_carea' id='block_");
+    out->AppendInt(page_id);
+    out->Append('_');
+    out->AppendInt(block_count_++);
+    BoxToHOCR(real_block->bounding_box(), out);
+    out->Append("\n<p class='ocr_par'>\n");
+  }
+  if (hocr_row_ != it.row()) {
+    if (hocr_row_ != NULL) {
+      out->Append("</span>\n");
+      hocr_prev_row_ = hocr_row_->row;
+    }
+    hocr_row_ = it.row();
+    ROW* real_row = hocr_row_->row;
+    if (hocr_prev_row_ != NULL &&
+        IsParagraphBreak(real_row->bounding_box(),
+                         hocr_prev_row_->bounding_box(),
+                         real_block->bounding_box().right(),
+                         real_row->x_height() + real_row->ascenders()))
+      out->Append("</p>\n<p class='ocr_par'>\n");
+    out->Append("<span class='ocr_line' id='line_");
+    out->AppendInt(page_id);
+    out->Append('_');
+    out->AppendInt(line_count_++);
+    BoxToHOCR(real_row->bounding_box(), out);
+  }
+
+  WERD_RES* word = it.word();
+  WERD_CHOICE* choice = word->best_choice;
+  if (choice == NULL)
+    return;
+  out->Append("<span class='ocr_word' id='word_");
+  out->AppendInt(page_id);
+  out->Append('_');
+  out->AppendInt(word_count_);
+  BoxToHOCR(word->word->bounding_box(), out);
+  out->Append("<span class='xocr_word' id='xword_");
+  out->AppendInt(page_id);
+  out->Append('_');
+  out->AppendInt(word_count_++);
+  out->Append("' title=\"x_wconf ");
+  out->AppendInt(static_cast<int>(choice->certainty()));
+  out->Append("\">");
+  if (word->bold > 0)
+    out->Append("<strong>");
+  if (word->italic > 0)
+    out->Append("<em>");
+  const STRING& text = choice->unichar_string();
+  out->AppendEscaped(text.string(), text.length());
+  if (word->italic > 0)
+    out->Append("</em>");
+  if (word->bold > 0)
+    out->Append("</strong>");
+  out->Append("</span></span>");
+  if (!word->word->flag(W_EOL))
+    out->Append(' ');
+}
+
+void TextRenderer::EndHOCR(TextBuffer* out) {
+  if (hocr_block_ != NULL)
+    out->Append("</span>\n</p>\n</div>\n");
+  out->Append("</div>\n");
+}
+
+// Boxes are those of PageIterator::BoundingBox at RIL_SYMBOL, flipped to
+// the bottom-up coordinates of a box file.
+void TextRenderer::WordToBox(const PAGE_RES_IT& it, TextBuffer* out) const {
+  WERD_RES* word = it.word();
+  WERD_CHOICE* choice = word->best_choice;
+  if (choice == NULL)
+    return;
+  for (int i = 0; i < choice->length(); ++i) {
+    const TBOX& box = word->box_word->BlobBox(i);
+    int left = ClipToRange(
+        static_cast<int>(floor(box.left() / scale_)) + rect_left_,
+        rect_left_, rect_left_ + rect_width_);
+    int top = ClipToRange(
+        rect_height_ - static_cast<int>(ceil(box.top() / scale_)) + rect_top_,
+        rect_top_, rect_top_ + rect_height_);
+    int right = ClipToRange(
+        static_cast<int>(ceil(box.right() / scale_)) + rect_left_,
+        left, rect_left_ + rect_width_);
+    int bottom = ClipToRange(
+        rect_height_ - static_cast<int>(floor(box.bottom() / scale_)) +
+        rect_top_, top, rect_top_ + rect_height_);
+    // Tesseract uses space for recognition failure. Fix to a reject
+    // character, kTesseractReject so we don't create illegal box files.
+    const char* text =
+        tesseract_->unicharset.id_to_unichar(choice->unichar_id(i));
+    for (; *text != '\0'; ++text)
+      out->Append(*text == ' ' ? kTesseractReject : *text);
+    out->Append(' ');
+    out->AppendInt(left);
+    out->Append(' ');
+    out->AppendInt(image_height_ - bottom);
+    out->Append(' ');
+    out->AppendInt(right);
+    out->Append(' ');
+    out->AppendInt(image_height_ - top);
+    out->Append(' ');
+    out->AppendInt(page_number_);
+    out->Append('\n');
+  }
+}
+
+void TextRenderer::WordToUNLV(const PAGE_RES_IT& it, TextBuffer* out) {
+  WERD_RES *word = it.word();
+  // Process the current word.
+  if (word->unlv_crunch_mode != CR_NONE) {
+    if (word->unlv_crunch_mode != CR_DELETE &&
+        (!tilde_crunch_written_ ||
+         (word->unlv_crunch_mode == CR_KEEP_SPACE &&
+          word->word->space() > 0 &&
+          !word->word->flag(W_FUZZY_NON) &&
+          !word->word->flag(W_FUZZY_SP)))) {
+      if (!word->word->flag(W_BOL) &&
+          word->word->space() > 0 &&
+          !word->word->flag(W_FUZZY_NON) &&
+          !word->word->flag(W_FUZZY_SP)) {
+        /* Write a space to separate from preceeding good text */
+        out->Append(' ');
+        last_char_was_tilde_ = false;
+      }
+      if (!last_char_was_tilde_) {
+        // Write a reject char.
+        last_char_was_tilde_ = true;
+        out->Append(kUNLVReject);
+        tilde_crunch_written_ = true;
+        last_char_was_newline_ = false;
+      }
+    }
+  } else {
+    // NORMAL PROCESSING of non tilde crunched words.
+    tilde_crunch_written_ = false;
+    tesseract_->set_unlv_suspects(word);
+    const char* wordstr = word->best_choice->unichar_string().string();
+    const STRING& lengths = word->best_choice->unichar_lengths();
+    int length = lengths.length();
+    int i = 0;
+    int offset = 0;
+
+    if (last_char_was_tilde_ &&
+        word->word->space() == 0 && wordstr[offset] == ' ') {
+      // Prevent adjacent tilde across words - we know that adjacent tildes
+      // within words have been removed.
+      // Skip the first character.
+      offset = lengths[i++];
+    }
+    if (i < length && wordstr[offset] != 0) {
+      if (!last_char_was_newline_)
+        out->Append(' ');
+      else
+        last_char_was_newline_ = false;
+      for (; i < length; offset += lengths[i++]) {
+        if (wordstr[offset] == ' ' ||
+            wordstr[offset] == kTesseractReject) {
+          out->Append(kUNLVReject);
+          last_char_was_tilde_ = true;
+        } else {
+          if (word->reject_map[i].rejected())
+            out->Append(kUNLVSuspect);
+          UNICHAR ch(wordstr + offset, lengths[i]);
+          int uni_ch = ch.first_uni();
+          for (int j = 0; kUniChs[j] != 0; ++j) {
+            if (kUniChs[j] == uni_ch) {
+              uni_ch = kLatinChs[j];
+              break;
+            }
+          }
+          if (uni_ch <= 0xff) {
+            out->Append(static_cast<char>(uni_ch));
+            last_char_was_tilde_ = false;
+          } else {
+            out->Append(kUNLVReject);
+            last_char_was_tilde_ = true;
+          }
+        }
+      }
+    }
+  }
+  if (word->word->flag(W_EOL) && !last_char_was_newline_) {
+    /* Add a new line output */
+    out->Append('\n');
+    tilde_crunch_written_ = false;
+    last_char_was_newline_ = true;
+    last_char_was_tilde_ = false;
+  }
+}
+
+}  // namespace tesseract.
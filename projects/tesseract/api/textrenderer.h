@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////
+// File:        textrenderer.h
+// Description: Writes the recognized text of a page as UTF-8, hOCR, box
+//              file and UNLV text in a single walk of the results.
+// Created:     Sun Oct 18 21:05:42 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_API_TEXTRENDERER_H__
+#define TESSERACT_API_TEXTRENDERER_H__
+
+#include "genericvector.h"
+#include "host.h"
+#include "publictypes.h"
+
+class BLOCK_RES;
+class PAGE_RES;
+class PAGE_RES_IT;
+class ROW;
+class ROW_RES;
+class STRING;
+class TBOX;
+
+namespace tesseract {
+
+class Tesseract;
+
+// A text buffer that grows by adding chunks, so what has been written is
+// never moved. Each chunk is twice the size of the one before, and the
+// first is as large as the size reserved before writing. A buffer that
+// stays in one chunk is handed over by Release without a copy.
+class TextBuffer {
+ public:
+  TextBuffer();
+  ~TextBuffer();
+
+  // Makes the first chunk at least size bytes. Does nothing once something
+  // has been written.
+  void Reserve(int size);
+
+  // Total number of bytes written.
+  int length() const {
+    return length_;
+  }
+  // The chunks, in order, for writing out without joining them.
+  int num_chunks() const {
+    return chunks_.size();
+  }
+  const char* chunk(int index) const {
+    return chunks_[index];
+  }
+  int chunk_length(int index) const;
+
+  void Append(char ch) {
+    if (pos_ == end_)
+      NewChunk(1);
+    *pos_++ = ch;
+    ++length_;
+  }
+  void Append(const char* str, int length);
+  void Append(const char* str);
+  // Writes value in decimal.
+  void AppendInt(inT64 value);
+  // Writes str with <, >, &, " and ' replaced by XML entities.
+  void AppendEscaped(const char* str, int length);
+
+  // Appends everything written to str.
+  void AppendTo(STRING* str) const;
+  // Returns everything written as a null-terminated string, which the
+  // caller must delete [], and empties the buffer.
+  char* Release();
+  // Empties the buffer, keeping the reserved size.
+  void Clear();
+
+ private:
+  // Adds a chunk with room for at least min_size bytes.
+  void NewChunk(int min_size);
+
+  GenericVector<char*> chunks_;
+  GenericVector<int> chunk_sizes_;   // Room in each chunk, less the null.
+  char* pos_;                        // Next byte of the last chunk.
+  char* end_;                        // End of the room in the last chunk.
+  int length_;
+  int reserved_;                     // Size of the first chunk.
+};
+
+// Writes the results of a recognized page in any of the TextFormats. The
+// words are visited once, whatever the number of formats.
+class TextRenderer {
+ public:
+  // The results are those of tesseract in page_res, in a thresholded image
+  // of the rectangle (rect_left, rect_top, rect_width, rect_height) of a
+  // source image_height high, scaled by scale.
+  TextRenderer(Tesseract* tesseract, PAGE_RES* page_res, float scale,
+               int image_height, int rect_left, int rect_top,
+               int rect_width, int rect_height);
+
+  // Writes the page to each of buffers, indexed by TextFormat, that is not
+  // NULL. page_number is 0-based, and is written by the hOCR and box
+  // formats. input_name is the image named by hOCR.
+  void Render(int page_number, const char* input_name,
+              TextBuffer** buffers);
+
+ private:
+  void BeginHOCR(const char* input_name, TextBuffer* out);
+  void WordToHOCR(const PAGE_RES_IT& it, TextBuffer* out);
+  void EndHOCR(TextBuffer* out);
+  // Writes the box in hOCR, in source image coordinates, rounded outwards.
+  void BoxToHOCR(const TBOX& box, TextBuffer* out) const;
+  void WordToUTF8(const PAGE_RES_IT& it, TextBuffer* out) const;
+  void WordToBox(const PAGE_RES_IT& it, TextBuffer* out) const;
+  void WordToUNLV(const PAGE_RES_IT& it, TextBuffer* out);
+
+  Tesseract* tesseract_;
+  PAGE_RES* page_res_;
+  float scale_;
+  int image_height_;
+  int rect_left_;
+  int rect_top_;
+  int rect_width_;
+  int rect_height_;
+  int page_number_;
+  // State of the hOCR output.
+  BLOCK_RES* hocr_block_;
+  ROW_RES* hocr_row_;
+  ROW* hocr_prev_row_;
+  int block_count_;
+  int line_count_;
+  int word_count_;
+  // State of the UNLV output.
+  bool tilde_crunch_written_;
+  bool last_char_was_newline_;
+  bool last_char_was_tilde_;
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_API_TEXTRENDERER_H__
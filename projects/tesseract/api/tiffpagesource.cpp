@@ -0,0 +1,285 @@
+///////////////////////////////////////////////////////////////////////
+// File:        tiffpagesource.cpp
+// Description: Reads the pages of a multi-page tiff through an index of
+//              its image directories, built in a single pass.
+// Created:     Sun Oct 18 15:02:44 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+// Include automatically generated configuration file if running autoconf.
+#ifdef HAVE_CONFIG_H
+#include "config_auto.h"
+#endif
+
+#include <string.h>
+
+#include "allheaders.h"
+#include "tiffpagesource.h"
+
+#ifdef HAVE_LIBTIFF
+#include "tiffio.h"
+#endif
+
+namespace tesseract {
+
+// Bytes in a tiff header: byte order mark, magic number, first offset.
+const int kTiffHeaderSize = 8;
+// Bytes in one entry of a directory.
+const int kTiffDirEntrySize = 12;
+// The magic number of a classic tiff. BigTIFF, with 64 bit offsets, is 43
+// and is left to pixReadStreamTiff.
+const uinT16 kTiffMagic = 42;
+// Smallest possible directory: an entry count and a next offset. A file
+// can hold no more pages than its size over this, which stops the walk of
+// a damaged chain that loops.
+const int kMinTiffDirSize = 6;
+
+TiffPageSource::TiffPageSource()
+  : fp_(NULL), big_endian_(false), tiff_(NULL) {
+}
+
+TiffPageSource::~TiffPageSource() {
+  Close();
+}
+
+bool TiffPageSource::ReadUint16(uinT16* value) {
+  unsigned char bytes[2];
+  if (fread(bytes, 1, 2, fp_) != 2)
+    return false;
+  *value = big_endian_ ? (bytes[0] << 8) | bytes[1]
+                       : (bytes[1] << 8) | bytes[0];
+  return true;
+}
+
+bool TiffPageSource::ReadUint32(uinT32* value) {
+  unsigned char bytes[4];
+  if (fread(bytes, 1, 4, fp_) != 4)
+    return false;
+  if (big_endian_) {
+    *value = (static_cast<uinT32>(bytes[0]) << 24) | (bytes[1] << 16) |
+             (bytes[2] << 8) | bytes[3];
+  } else {
+    *value = (static_cast<uinT32>(bytes[3]) << 24) | (bytes[2] << 16) |
+             (bytes[1] << 8) | bytes[0];
+  }
+  return true;
+}
+
+#ifdef HAVE_LIBTIFF
+// Lets libtiff read through the FILE* of the source, so the index and the
+// decoder share one open file. The source owns the FILE*, so closing the
+// TIFF leaves it open.
+static tsize_t TiffRead(thandle_t handle, tdata_t data, tsize_t size) {
+  return fread(data, 1, size, reinterpret_cast<FILE*>(handle));
+}
+
+static tsize_t TiffWrite(thandle_t handle, tdata_t data, tsize_t size) {
+  return 0;
+}
+
+static toff_t TiffSeek(thandle_t handle, toff_t offset, int whence) {
+  FILE* fp = reinterpret_cast<FILE*>(handle);
+  if (fseek(fp, offset, whence) != 0)
+    return static_cast<toff_t>(-1);
+  return ftell(fp);
+}
+
+static int TiffClose(thandle_t handle) {
+  return 0;
+}
+
+static toff_t TiffSize(thandle_t handle) {
+  FILE* fp = reinterpret_cast<FILE*>(handle);
+  long pos = ftell(fp);
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fseek(fp, pos, SEEK_SET);
+  return size;
+}
+
+static int TiffMap(thandle_t handle, tdata_t* data, toff_t* size) {
+  return 0;
+}
+
+static void TiffUnmap(thandle_t handle, tdata_t data, toff_t size) {
+}
+
+// Decodes the current directory of tif. Bilevel and grey images are
+// copied a row at a time at their own depth. Everything else goes
+// through libtiff's RGBA conversion to 32 bit colour.
+static Pix* ReadTiffDirectory(TIFF* tif) {
+  uint32 width = 0, height = 0;
+  uint16 bits_per_sample = 1, samples_per_pixel = 1;
+  uint16 photometric = PHOTOMETRIC_MINISWHITE;
+  TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+  TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+  TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &bits_per_sample);
+  TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &samples_per_pixel);
+  TIFFGetField(tif, TIFFTAG_PHOTOMETRIC, &photometric);
+  if (width == 0 || height == 0)
+    return NULL;
+  Pix* pix = NULL;
+  if (samples_per_pixel == 1 && !TIFFIsTiled(tif) &&
+      (bits_per_sample == 1 || bits_per_sample == 8) &&
+      (photometric == PHOTOMETRIC_MINISWHITE ||
+       photometric == PHOTOMETRIC_MINISBLACK)) {
+    pix = pixCreate(width, height, bits_per_sample);
+    if (pix == NULL)
+      return NULL;
+    l_uint32* data = pixGetData(pix);
+    int wpl = pixGetWpl(pix);
+    tsize_t line_bytes = TIFFScanlineSize(tif);
+    if (line_bytes > wpl * 4) {
+      pixDestroy(&pix);
+      return NULL;
+    }
+    for (uint32 y = 0; y < height; ++y) {
+      if (TIFFReadScanline(tif, data + y * wpl, y, 0) < 0) {
+        pixDestroy(&pix);
+        return NULL;
+      }
+    }
+    // The rows are in file byte order, and pix words are big-endian.
+    pixEndianByteSwap(pix);
+    // A pix bit of 1 is black, but a grey value of 0 is.
+    if ((bits_per_sample == 1) == (photometric == PHOTOMETRIC_MINISBLACK))
+      pixInvert(pix, pix);
+    pixSetPadBits(pix, 0);
+  } else {
+    // The size is worked out in 64 bits, as width * height alone can
+    // overflow 32, and pages too big for a tsize_t or size_t are refused.
+    uinT64 raster_bytes = static_cast<uinT64>(width) * height;
+    if (raster_bytes > static_cast<size_t>(-1) / sizeof(uint32))
+      return NULL;
+    raster_bytes *= sizeof(uint32);
+    tsize_t raster_size = static_cast<tsize_t>(raster_bytes);
+    if (raster_size <= 0 || static_cast<uinT64>(raster_size) != raster_bytes)
+      return NULL;
+    uint32* raster = reinterpret_cast<uint32*>(_TIFFmalloc(raster_size));
+    if (raster == NULL)
+      return NULL;
+    if (TIFFReadRGBAImageOriented(tif, width, height, raster,
+                                  ORIENTATION_TOPLEFT, 0)) {
+      pix = pixCreate(width, height, 32);
+    }
+    if (pix != NULL) {
+      l_uint32* data = pixGetData(pix);
+      int wpl = pixGetWpl(pix);
+      for (uint32 y = 0; y < height; ++y) {
+        l_uint32* line = data + y * wpl;
+        const uint32* pixels = raster + y * width;
+        for (uint32 x = 0; x < width; ++x) {
+          composeRGBPixel(TIFFGetR(pixels[x]), TIFFGetG(pixels[x]),
+                          TIFFGetB(pixels[x]), line + x);
+        }
+      }
+    }
+    _TIFFfree(raster);
+  }
+  float x_res = 0.0f, y_res = 0.0f;
+  uint16 res_unit = RESUNIT_INCH;
+  if (pix != NULL && TIFFGetField(tif, TIFFTAG_XRESOLUTION, &x_res) &&
+      TIFFGetField(tif, TIFFTAG_YRESOLUTION, &y_res)) {
+    TIFFGetFieldDefaulted(tif, TIFFTAG_RESOLUTIONUNIT, &res_unit);
+    if (res_unit == RESUNIT_CENTIMETER) {
+      x_res *= 2.54f;
+      y_res *= 2.54f;
+    }
+    pixSetResolution(pix, static_cast<l_int32>(x_res + 0.5f),
+                     static_cast<l_int32>(y_res + 0.5f));
+  }
+  return pix;
+}
+#endif  // HAVE_LIBTIFF
+
+// Walks the directory chain once, recording where each page starts. A
+// chain that comes back to a directory it has already been through is
+// cut short there.
+bool TiffPageSource::Open(FILE* fp) {
+  Close();
+  fp_ = fp;
+  unsigned char order[2];
+  uinT16 magic;
+  uinT32 offset;
+  bool ok = fseek(fp_, 0, SEEK_SET) == 0 &&
+            fread(order, 1, 2, fp_) == 2 &&
+            order[0] == order[1] && (order[0] == 'I' || order[0] == 'M');
+  if (ok) {
+    big_endian_ = order[0] == 'M';
+    ok = ReadUint16(&magic) && magic == kTiffMagic && ReadUint32(&offset);
+  }
+  uinT32 max_offset = 0;
+  long max_pages = 0;
+  if (ok && fseek(fp_, 0, SEEK_END) == 0)
+    max_pages = ftell(fp_) / kMinTiffDirSize;
+  while (ok && offset >= kTiffHeaderSize &&
+         ifd_offsets_.size() < max_pages) {
+    uinT16 num_entries;
+    if (fseek(fp_, offset, SEEK_SET) != 0 || !ReadUint16(&num_entries))
+      break;
+    ifd_offsets_.push_back(offset);
+    uinT32 next_offset;
+    if (fseek(fp_, num_entries * kTiffDirEntrySize, SEEK_CUR) != 0 ||
+        !ReadUint32(&next_offset))
+      break;
+    // Directories mostly follow one another through the file, so only a
+    // chain that goes back before the furthest one yet needs the search
+    // for a repeat.
+    if (offset > max_offset)
+      max_offset = offset;
+    if (next_offset <= max_offset && ifd_offsets_.contains(next_offset))
+      break;
+    offset = next_offset;
+  }
+  if (ifd_offsets_.empty()) {
+    Close();
+    fseek(fp, 0, SEEK_SET);
+    return false;
+  }
+#ifdef HAVE_LIBTIFF
+  fseek(fp_, 0, SEEK_SET);
+  tiff_ = TIFFClientOpen("tiffpagesource", "rm",
+                         reinterpret_cast<thandle_t>(fp_), TiffRead,
+                         TiffWrite, TiffSeek, TiffClose, TiffSize,
+                         TiffMap, TiffUnmap);
+#endif
+  return true;
+}
+
+void TiffPageSource::Close() {
+#ifdef HAVE_LIBTIFF
+  if (tiff_ != NULL)
+    TIFFClose(reinterpret_cast<TIFF*>(tiff_));
+#endif
+  tiff_ = NULL;
+  fp_ = NULL;
+  ifd_offsets_.clear();
+}
+
+Pix* TiffPageSource::ReadPage(int page) {
+  if (page < 0 || page >= ifd_offsets_.size())
+    return NULL;
+#ifdef HAVE_LIBTIFF
+  if (tiff_ != NULL) {
+    TIFF* tif = reinterpret_cast<TIFF*>(tiff_);
+    // Seeks straight to the directory, where TIFFSetDirectory would walk
+    // the chain from the first.
+    if (!TIFFSetSubDirectory(tif, ifd_offsets_[page]))
+      return NULL;
+    return ReadTiffDirectory(tif);
+  }
+#endif
+  return pixReadStreamTiff(fp_, page);
+}
+
+}  // namespace tesseract.
@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////
+// File:        tiffpagesource.h
+// Description: Reads the pages of a multi-page tiff through an index of
+//              its image directories, built in a single pass.
+// Created:     Sun Oct 18 15:02:44 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_API_TIFFPAGESOURCE_H__
+#define TESSERACT_API_TIFFPAGESOURCE_H__
+
+#include <stdio.h>
+#include "genericvector.h"
+#include "host.h"
+
+struct Pix;
+
+namespace tesseract {
+
+// A tiff keeps its pages as a chain of image directories (IFDs), each of
+// which holds the offset of the next. Reading page n by page number, as
+// pixReadStreamTiff does, walks the chain from the start every time, so
+// reading every page of an n page file costs O(n^2) seeks. TiffPageSource
+// walks the chain once when opened, keeping the offset of every
+// directory, and then goes straight to the directory of any page asked
+// for, in any order.
+// Without libtiff, pages are decoded by pixReadStreamTiff, and only the
+// page count comes from the index.
+class TiffPageSource {
+ public:
+  TiffPageSource();
+  ~TiffPageSource();
+
+  // Indexes the pages of the tiff open in fp, which is not owned and must
+  // stay open until Close. Returns false, with fp rewound, if fp is not a
+  // tiff or its first directory is damaged. A damaged directory later in
+  // the chain ends the index at the page before it.
+  bool Open(FILE* fp);
+  // Forgets the file opened by Open.
+  void Close();
+
+  // Returns the number of pages found by Open.
+  int num_pages() const {
+    return ifd_offsets_.size();
+  }
+
+  // Decodes the given page, 0-based. Returns NULL if it can't be decoded.
+  // The caller must pixDestroy the result.
+  Pix* ReadPage(int page);
+
+ private:
+  // Reads an unsigned 16 or 32 bit value in the byte order of the file.
+  bool ReadUint16(uinT16* value);
+  bool ReadUint32(uinT32* value);
+
+  FILE* fp_;                          // Not owned.
+  bool big_endian_;                   // Byte order of the file.
+  GenericVector<uinT32> ifd_offsets_; // Offset of the directory of each page.
+  void* tiff_;                        // The libtiff TIFF*, if open.
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_API_TIFFPAGESOURCE_H__
@@ -0,0 +1,438 @@
+///////////////////////////////////////////////////////////////////////
+// File:        workerpool.cpp
+// Description: Runs recognition in supervised tessworker processes, so a
+//              crash in an engine does not take down the caller.
+// Created:     Sun Oct 18 23:12:06 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#ifndef WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "workerpool.h"
+#include "allheaders.h"
+#include "ndminx.h"
+
+namespace tesseract {
+
+// Time a worker gets to load its engine, or to set a variable.
+const int kWorkerStartMsecs = 60000;
+// Default time after which a worker with a page and no timeout has hung.
+const int kDefaultHangMsecs = 300000;
+// Time a worker gets after the timeout of its page, to write the results
+// it has.
+const int kWorkerGraceMsecs = 5000;
+// Time a worker gets to quit before it is killed.
+const int kWorkerQuitMsecs = 1000;
+// Smallest page segment. Larger ones are made half as big again as the
+// page that needed them, so a run of growing pages does not remap each.
+const size_t kMinSegmentBytes = 4 << 20;
+// Longest text or word list taken from a worker. Longer means the stream
+// is garbled.
+const int kMaxReplyBytes = 1 << 28;
+const int kWorkerWordBytes = sizeof(WorkerWord);
+
+TessWorkerPool::TessWorkerPool()
+  : has_datapath_(false), oem_(OEM_DEFAULT),
+    hang_msecs_(kDefaultHangMsecs), variable_serial_(0), restarts_(0) {
+}
+
+TessWorkerPool::~TessWorkerPool() {
+  Stop();
+}
+
+bool TessWorkerPool::Start(const char* worker_path, const char* datapath,
+                           const char* language, OcrEngineMode oem,
+                           int num_workers) {
+  Stop();
+  worker_path_ = worker_path;
+  has_datapath_ = datapath != NULL;
+  if (has_datapath_)
+    datapath_ = datapath;
+  language_ = language != NULL ? language : "eng";
+  oem_ = oem;
+  if (num_workers <= 0)
+    num_workers = ThreadPool::NumProcessors();
+  for (int i = 0; i < num_workers; ++i) {
+    Worker* worker = new Worker;
+    workers_.push_back(worker);
+    if (!StartWorker(worker)) {
+      Stop();
+      return false;
+    }
+  }
+  mutex_.Lock();
+  for (int i = 0; i < workers_.size(); ++i)
+    free_workers_.push_back(workers_[i]);
+  mutex_.Unlock();
+  return true;
+}
+
+bool TessWorkerPool::SetVariable(const char* name, const char* value) {
+  mutex_.Lock();
+  int index = 0;
+  while (index < variable_names_.size() &&
+         strcmp(variable_names_[index].string(), name) != 0)
+    ++index;
+  if (index == variable_names_.size()) {
+    variable_names_.push_back(STRING(name));
+    variable_values_.push_back(STRING(value));
+    variable_serials_.push_back(0);
+  } else {
+    variable_values_[index] = value;
+  }
+  variable_serials_[index] = ++variable_serial_;
+  // The idle workers are taken while they are sent the variable. Busy ones
+  // are brought up to date by AcquireWorker before their next page.
+  GenericVector<Worker*> idle_workers = free_workers_;
+  free_workers_.clear();
+  mutex_.Unlock();
+  bool ok = true;
+  for (int i = 0; i < idle_workers.size(); ++i) {
+    Worker* worker = idle_workers[i];
+    if (worker->pid >= 0 && !SendVariables(worker, false))
+      ok = false;
+    ReleaseWorker(worker);
+  }
+  return ok;
+}
+
+TessWorkerStatus TessWorkerPool::Recognize(const Pix* pix,
+                                           const TessJobOptions& options,
+                                           bool want_words,
+                                           TessWorkerResult* result) {
+  result->text = "";
+  result->words.clear();
+  result->worker_msecs = 0.0;
+  Worker* worker = AcquireWorker();
+  if (worker == NULL)
+    return TWS_NO_WORKER;
+  if (worker->pid < 0 && !StartWorker(worker)) {
+    ReleaseWorker(worker);
+    return TWS_NO_WORKER;
+  }
+  // Only the pixels are sent, so a colormap has to be applied first.
+  Pix* page = const_cast<Pix*>(pix);
+  Pix* uncolored = NULL;
+  if (pixGetColormap(page) != NULL) {
+    uncolored = pixRemoveColormap(page, REMOVE_CMAP_BASED_ON_SRC);
+    page = uncolored;
+  }
+  size_t page_bytes = page == NULL ? 0 :
+      static_cast<size_t>(pixGetWpl(page)) * sizeof(l_uint32) *
+      pixGetHeight(page);
+  if (page == NULL || !EnsureSegment(worker, page_bytes)) {
+    pixDestroy(&uncolored);
+    ReleaseWorker(worker);
+    return TWS_FAILED;
+  }
+  memcpy(worker->segment, pixGetData(page), page_bytes);
+
+  WorkerRequest request;
+  request.type = WMT_RECOGNIZE;
+  request.flags = (options.hocr ? WRF_HOCR : 0) |
+                  (want_words ? WRF_WORDS : 0);
+  request.width = pixGetWidth(page);
+  request.height = pixGetHeight(page);
+  request.depth = pixGetDepth(page);
+  request.wpl = pixGetWpl(page);
+  request.xres = pixGetXRes(page);
+  request.yres = pixGetYRes(page);
+  request.pageseg_mode = options.pageseg_mode;
+  request.page_number = options.page_number;
+  request.timeout_msecs = options.timeout_msecs;
+  request.name_bytes = options.input_name.length();
+  pixDestroy(&uncolored);
+  // A worker that died while idle has not seen the page, so it is
+  // restarted and given the page once more.
+  bool sent = SendPage(worker, &request, options.input_name);
+  if (!sent) {
+    RestartWorker(worker);
+    sent = worker->pid >= 0 && SendPage(worker, &request, options.input_name);
+    if (worker->pid < 0) {
+      ReleaseWorker(worker);
+      return TWS_NO_WORKER;
+    }
+  }
+
+  int wait_msecs = options.timeout_msecs > 0
+                 ? options.timeout_msecs + kWorkerGraceMsecs : hang_msecs_;
+  WorkerReply reply;
+  WorkerIoResult io = sent ? WorkerRead(worker->socket, &reply,
+                                        sizeof(reply), wait_msecs)
+                           : WIO_CLOSED;
+  if (io == WIO_OK &&
+      (reply.magic != kWorkerMagic || reply.text_bytes < 0 ||
+       reply.text_bytes > kMaxReplyBytes || reply.num_words < 0 ||
+       reply.num_words > kMaxReplyBytes / kWorkerWordBytes))
+    io = WIO_CLOSED;  // Garbled, so the worker can't be trusted.
+  if (io == WIO_OK) {
+    worker->text.init_to_size(reply.text_bytes + 1, '\0');
+    io = WorkerRead(worker->socket, &worker->text[0], reply.text_bytes,
+                    wait_msecs);
+    result->text = &worker->text[0];
+  }
+  if (io == WIO_OK && reply.num_words > 0) {
+    result->words.init_to_size(reply.num_words, WorkerWord());
+    io = WorkerRead(worker->socket, &result->words[0],
+                    reply.num_words * sizeof(WorkerWord), wait_msecs);
+  }
+  if (io != WIO_OK) {
+    result->text = "";
+    result->words.clear();
+    RestartWorker(worker);
+    ReleaseWorker(worker);
+    return io == WIO_TIMEOUT ? TWS_TIMED_OUT : TWS_CRASHED;
+  }
+  ReleaseWorker(worker);
+  result->worker_msecs = reply.recognize_msecs;
+  return reply.status == WRS_OK ? TWS_OK : TWS_FAILED;
+}
+
+int TessWorkerPool::restarts() {
+  mutex_.Lock();
+  int restarts = restarts_;
+  mutex_.Unlock();
+  return restarts;
+}
+
+void TessWorkerPool::Stop() {
+  for (int i = 0; i < workers_.size(); ++i) {
+    Worker* worker = workers_[i];
+    StopWorker(worker, true);
+#ifndef WIN32
+    if (worker->segment != NULL) {
+      munmap(worker->segment, worker->segment_bytes);
+      close(worker->segment_fd);
+    }
+#endif
+    delete worker;
+  }
+  workers_.clear();
+  mutex_.Lock();
+  free_workers_.clear();
+  // Anyone still waiting for a worker finds there are none.
+  worker_freed_.Signal();
+  mutex_.Unlock();
+}
+
+bool TessWorkerPool::StartWorker(Worker* worker) {
+#ifdef WIN32
+  return false;
+#else
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+    return false;
+  // Only the end of the child survives its exec, so workers started later
+  // do not hold the sockets of this one open.
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+  int on = 1;
+  setsockopt(fds[0], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+  // The arguments are made before the fork, as the child of a threaded
+  // process may do little but exec.
+  char fd_arg[16];
+  snprintf(fd_arg, sizeof(fd_arg), "%d", fds[1]);
+  char oem_arg[16];
+  snprintf(oem_arg, sizeof(oem_arg), "%d", oem_);
+  const char* argv[10];
+  int argc = 0;
+  argv[argc++] = worker_path_.string();
+  argv[argc++] = "-fd";
+  argv[argc++] = fd_arg;
+  argv[argc++] = "-l";
+  argv[argc++] = language_.string();
+  argv[argc++] = "-oem";
+  argv[argc++] = oem_arg;
+  if (has_datapath_) {
+    argv[argc++] = "-tessdata";
+    argv[argc++] = datapath_.string();
+  }
+  argv[argc] = NULL;
+  pid_t pid = fork();
+  if (pid < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  if (pid == 0) {
+    execvp(argv[0], const_cast<char* const*>(argv));
+    _exit(127);
+  }
+  close(fds[1]);
+  worker->pid = pid;
+  worker->socket = fds[0];
+  worker->segment_sent = false;
+  WorkerReply ready;
+  if (WorkerRead(worker->socket, &ready, sizeof(ready),
+                 kWorkerStartMsecs) != WIO_OK ||
+      ready.magic != kWorkerMagic || ready.status != WRS_OK) {
+    StopWorker(worker, false);
+    return false;
+  }
+  if (!SendVariables(worker, true)) {
+    StopWorker(worker, false);
+    return false;
+  }
+  return true;
+#endif
+}
+
+void TessWorkerPool::StopWorker(Worker* worker, bool polite) {
+#ifndef WIN32
+  if (worker->pid < 0)
+    return;
+  bool exited = false;
+  if (polite) {
+    WorkerRequest request;
+    request.type = WMT_QUIT;
+    // The worker closes its end as it exits.
+    char byte;
+    exited = WorkerWrite(worker->socket, &request, sizeof(request)) &&
+             WorkerRead(worker->socket, &byte, 1,
+                        kWorkerQuitMsecs) == WIO_CLOSED;
+  }
+  if (!exited)
+    kill(worker->pid, SIGKILL);
+  waitpid(worker->pid, NULL, 0);
+  close(worker->socket);
+  worker->pid = -1;
+  worker->socket = -1;
+  worker->segment_sent = false;
+#endif
+}
+
+void TessWorkerPool::RestartWorker(Worker* worker) {
+  StopWorker(worker, false);
+  mutex_.Lock();
+  ++restarts_;
+  mutex_.Unlock();
+  // If this fails, the next page given to the worker tries again.
+  StartWorker(worker);
+}
+
+bool TessWorkerPool::SendPage(Worker* worker, WorkerRequest* request,
+                              const STRING& input_name) {
+  bool sent;
+  if (worker->segment_sent) {
+    request->segment_bytes = 0;
+    sent = WorkerWrite(worker->socket, request, sizeof(*request));
+  } else {
+    request->segment_bytes = worker->segment_bytes;
+    sent = WorkerWriteWithFd(worker->socket, request, sizeof(*request),
+                             worker->segment_fd);
+  }
+  sent = sent && WorkerWrite(worker->socket, input_name.string(),
+                             request->name_bytes);
+  worker->segment_sent = sent;
+  return sent;
+}
+
+bool TessWorkerPool::SendVariable(Worker* worker, const char* name,
+                                  const char* value) {
+  WorkerRequest request;
+  request.type = WMT_SET_VARIABLE;
+  request.name_bytes = strlen(name);
+  request.value_bytes = strlen(value);
+  WorkerReply reply;
+  return WorkerWrite(worker->socket, &request, sizeof(request)) &&
+         WorkerWrite(worker->socket, name, request.name_bytes) &&
+         WorkerWrite(worker->socket, value, request.value_bytes) &&
+         WorkerRead(worker->socket, &reply, sizeof(reply),
+                    kWorkerStartMsecs) == WIO_OK &&
+         reply.magic == kWorkerMagic && reply.status == WRS_OK;
+}
+
+bool TessWorkerPool::SendVariables(Worker* worker, bool all) {
+  GenericVector<STRING> names;
+  GenericVector<STRING> values;
+  mutex_.Lock();
+  for (int i = 0; i < variable_names_.size(); ++i) {
+    if (all || variable_serials_[i] > worker->variable_serial) {
+      names.push_back(variable_names_[i]);
+      values.push_back(variable_values_[i]);
+    }
+  }
+  // A refused variable is not sent again, as it would be refused again.
+  worker->variable_serial = variable_serial_;
+  mutex_.Unlock();
+  for (int i = 0; i < names.size(); ++i) {
+    if (!SendVariable(worker, names[i].string(), values[i].string()))
+      return false;
+  }
+  return true;
+}
+
+bool TessWorkerPool::EnsureSegment(Worker* worker, size_t size) {
+  if (size <= worker->segment_bytes)
+    return true;
+#ifndef WIN32
+  if (worker->segment != NULL) {
+    munmap(worker->segment, worker->segment_bytes);
+    close(worker->segment_fd);
+  }
+#endif
+  worker->segment = NULL;
+  worker->segment_bytes = 0;
+  worker->segment_sent = false;
+  size_t segment_bytes = MAX(size + size / 2, kMinSegmentBytes);
+  worker->segment_fd = CreateWorkerSegment(segment_bytes, &worker->segment);
+  if (worker->segment_fd < 0)
+    return false;
+  worker->segment_bytes = segment_bytes;
+  return true;
+}
+
+// The event is reset under the mutex while the free list is empty, and
+// signalled under it when a worker is freed, so no wake-up is lost.
+TessWorkerPool::Worker* TessWorkerPool::AcquireWorker() {
+  mutex_.Lock();
+  while (free_workers_.empty()) {
+    if (workers_.empty()) {
+      mutex_.Unlock();
+      return NULL;
+    }
+    worker_freed_.Reset();
+    mutex_.Unlock();
+    worker_freed_.Wait(-1);
+    mutex_.Lock();
+  }
+  Worker* worker = free_workers_[free_workers_.size() - 1];
+  free_workers_.truncate(free_workers_.size() - 1);
+  mutex_.Unlock();
+  // A worker that died taking a variable is restarted, with all of them,
+  // when its page is sent. One that refused it goes on without it, as
+  // SetVariable could not report the refusal to anyone by now.
+  if (worker->pid >= 0)
+    SendVariables(worker, false);
+  return worker;
+}
+
+void TessWorkerPool::ReleaseWorker(Worker* worker) {
+  mutex_.Lock();
+  free_workers_.push_back(worker);
+  worker_freed_.Signal();
+  mutex_.Unlock();
+}
+
+}  // namespace tesseract.
@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////
+// File:        workerpool.h
+// Description: Runs recognition in supervised tessworker processes, so a
+//              crash in an engine does not take down the caller.
+// Created:     Sun Oct 18 23:12:06 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_API_WORKERPOOL_H__
+#define TESSERACT_API_WORKERPOOL_H__
+
+#include <stddef.h>
+
+#include "apitypes.h"
+#include "asyncapi.h"
+#include "ccutil.h"
+#include "genericvector.h"
+#include "strngs.h"
+#include "threadpool.h"
+#include "workerprotocol.h"
+
+struct Pix;
+
+namespace tesseract {
+
+enum TessWorkerStatus {
+  TWS_OK,
+  TWS_FAILED,      // The worker could not recognize the page.
+  TWS_CRASHED,     // The worker died on the page. It has been restarted.
+  TWS_TIMED_OUT,   // The worker hung on the page and was killed and
+                   // restarted.
+  TWS_NO_WORKER    // The pool is not running, or a worker would not start.
+};
+
+struct TessWorkerResult {
+  TessWorkerResult() : worker_msecs(0.0) {}
+
+  STRING text;                    // UTF-8 or hOCR, as asked for.
+  GenericVector<WorkerWord> words;
+  double worker_msecs;            // Time spent on the page in the worker.
+};
+
+// An ASSERT_HOST in an engine aborts its process. TessWorkerPool keeps
+// initialized engines in tessworker processes instead, one per process,
+// and restarts any that die or hang, so the caller only loses the page.
+// Pages go to the workers through shared memory, and results come back
+// in the binary messages of workerprotocol.h. Recognize may be called from
+// several threads at once; each call takes a free worker, waiting for one
+// if need be. Workers need POSIX: on Windows Start always fails.
+class TessWorkerPool {
+ public:
+  TessWorkerPool();
+  // Stops the workers.
+  ~TessWorkerPool();
+
+  // Starts num_workers (one per processor if <= 0) processes of the
+  // tessworker executable at worker_path, which is looked for on the PATH
+  // if it has no slash, each with an engine initialized with the arguments
+  // of TessBaseAPI::Init. Returns false, with no workers running, if any
+  // fails to start.
+  bool Start(const char* worker_path, const char* datapath,
+             const char* language, OcrEngineMode oem, int num_workers);
+  // Sets a variable on every worker, and on any started later. Idle workers
+  // get it at once; busy ones get it before their next page. Returns false
+  // if an idle worker would not take it.
+  bool SetVariable(const char* name, const char* value);
+  // Workers given a page with no timeout that take longer than this are
+  // taken to have hung. Pages with a timeout get a grace period after it.
+  void set_hang_msecs(int hang_msecs) {
+    hang_msecs_ = hang_msecs;
+  }
+
+  // Recognizes pix in a worker, putting the text and, if want_words, the
+  // words into result. The page number, hOCR choice, input name, page
+  // segmentation mode and timeout come from options.
+  TessWorkerStatus Recognize(const Pix* pix, const TessJobOptions& options,
+                             bool want_words, TessWorkerResult* result);
+
+  int num_workers() const {
+    return workers_.size();
+  }
+  // The number of times a worker has been restarted after a crash or hang.
+  int restarts();
+
+  // Asks every worker to quit, and kills any that do not.
+  void Stop();
+
+ private:
+  struct Worker {
+    Worker() : pid(-1), socket(-1), segment_fd(-1), segment(NULL),
+               segment_bytes(0), segment_sent(false), variable_serial(0) {}
+
+    int pid;              // -1 if not running.
+    int socket;
+    int segment_fd;       // The shared memory for pages.
+    void* segment;
+    size_t segment_bytes;
+    bool segment_sent;    // The worker has the current segment mapped.
+    int variable_serial;  // The worker has the variables set up to here.
+    GenericVector<char> text;  // Reused for the text of replies.
+  };
+
+  // Starts the process of worker and waits for its engine to be ready.
+  bool StartWorker(Worker* worker);
+  // Stops the process of worker, politely if polite, else by killing it.
+  void StopWorker(Worker* worker, bool polite);
+  // Kills and restarts a worker that crashed or hung.
+  void RestartWorker(Worker* worker);
+  // Sends the request for the page in the segment of worker, with the
+  // segment itself if the worker does not have it yet.
+  bool SendPage(Worker* worker, WorkerRequest* request,
+                const STRING& input_name);
+  // Sends a variable to worker and waits for the answer.
+  bool SendVariable(Worker* worker, const char* name, const char* value);
+  // Sends worker the variables it does not have yet, or all of them if all.
+  // Returns false if any was refused or the worker died.
+  bool SendVariables(Worker* worker, bool all);
+  // Makes the segment of worker at least size bytes.
+  bool EnsureSegment(Worker* worker, size_t size);
+  // Takes a free worker, waiting for one if all are busy, and brings its
+  // variables up to date. Returns NULL if the pool is not running.
+  Worker* AcquireWorker();
+  void ReleaseWorker(Worker* worker);
+
+  STRING worker_path_;
+  STRING datapath_;
+  bool has_datapath_;
+  STRING language_;
+  OcrEngineMode oem_;
+  int hang_msecs_;
+  GenericVector<Worker*> workers_;
+
+  // Guards the variables, free_workers_ and restarts_.
+  CCUtilMutex mutex_;
+  // Variables set so far, replayed on restarted workers. Each SetVariable
+  // takes the next serial, so a worker needs those above its own.
+  GenericVector<STRING> variable_names_;
+  GenericVector<STRING> variable_values_;
+  GenericVector<int> variable_serials_;
+  int variable_serial_;
+  GenericVector<Worker*> free_workers_;
+  ThreadEvent worker_freed_;
+  int restarts_;
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_API_WORKERPOOL_H__
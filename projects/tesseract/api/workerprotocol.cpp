@@ -0,0 +1,209 @@
+///////////////////////////////////////////////////////////////////////
+// File:        workerprotocol.cpp
+// Description: Messages between TessWorkerPool and the tessworker
+//              processes it supervises.
+// Created:     Sun Oct 18 23:12:06 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include "workerprotocol.h"
+
+#ifndef WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace tesseract {
+
+#ifndef WIN32
+
+// Send flag that stops a write to a closed socket raising SIGPIPE. Where
+// there is none, the pool sets SO_NOSIGPIPE on its sockets instead.
+#ifdef MSG_NOSIGNAL
+const int kNoSigPipe = MSG_NOSIGNAL;
+#else
+const int kNoSigPipe = 0;
+#endif
+
+static double NowMsecs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+bool WorkerWrite(int socket, const void* data, size_t size) {
+  const char* bytes = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t written = send(socket, bytes, size, kNoSigPipe);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    bytes += written;
+    size -= written;
+  }
+  return true;
+}
+
+bool WorkerWriteWithFd(int socket, const void* data, size_t size, int fd) {
+  if (size == 0)
+    return false;  // The descriptor has to go with at least one byte.
+  struct iovec iov;
+  iov.iov_base = const_cast<void*>(data);
+  iov.iov_len = size;
+  char control[CMSG_SPACE(sizeof(int))];
+  memset(control, 0, sizeof(control));
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+  ssize_t written;
+  do {
+    written = sendmsg(socket, &msg, kNoSigPipe);
+  } while (written < 0 && errno == EINTR);
+  if (written <= 0)
+    return false;
+  return WorkerWrite(socket, static_cast<const char*>(data) + written,
+                     size - written);
+}
+
+WorkerIoResult WorkerRead(int socket, void* data, size_t size,
+                          int timeout_msecs) {
+  char* bytes = static_cast<char*>(data);
+  double deadline = NowMsecs() + timeout_msecs;
+  while (size > 0) {
+    if (timeout_msecs >= 0) {
+      int wait_msecs = static_cast<int>(deadline - NowMsecs());
+      if (wait_msecs < 0)
+        return WIO_TIMEOUT;
+      struct pollfd pfd;
+      pfd.fd = socket;
+      pfd.events = POLLIN;
+      pfd.revents = 0;
+      int ready = poll(&pfd, 1, wait_msecs);
+      if (ready < 0 && errno == EINTR)
+        continue;
+      if (ready < 0)
+        return WIO_CLOSED;
+      if (ready == 0)
+        return WIO_TIMEOUT;
+    }
+    ssize_t count = recv(socket, bytes, size, 0);
+    if (count < 0 && errno == EINTR)
+      continue;
+    if (count <= 0)
+      return WIO_CLOSED;
+    bytes += count;
+    size -= count;
+  }
+  return WIO_OK;
+}
+
+WorkerIoResult WorkerReadWithFd(int socket, void* data, size_t size,
+                                int* fd) {
+  *fd = -1;
+  struct iovec iov;
+  iov.iov_base = data;
+  iov.iov_len = size;
+  char control[CMSG_SPACE(sizeof(int))];
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  ssize_t count;
+  do {
+    count = recvmsg(socket, &msg, 0);
+  } while (count < 0 && errno == EINTR);
+  if (count <= 0)
+    return WIO_CLOSED;
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
+       cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+      memcpy(fd, CMSG_DATA(cmsg), sizeof(int));
+  }
+  return WorkerRead(socket, static_cast<char*>(data) + count, size - count,
+                    -1);
+}
+
+int CreateWorkerSegment(size_t size, void** memory) {
+  // /dev/shm is tmpfs on Linux, so the pages never touch a disk. Elsewhere
+  // the temporary directory is the best there is.
+  const char* dir = "/dev/shm";
+  if (access(dir, W_OK) != 0)
+    dir = getenv("TMPDIR");
+  if (dir == NULL)
+    dir = "/tmp";
+  char path[256];
+  snprintf(path, sizeof(path), "%s/tessworker-XXXXXX", dir);
+  int fd = mkstemp(path);
+  if (fd < 0)
+    return -1;
+  unlink(path);
+  fcntl(fd, F_SETFD, FD_CLOEXEC);
+  if (ftruncate(fd, size) != 0) {
+    close(fd);
+    return -1;
+  }
+  void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       fd, 0);
+  if (mapping == MAP_FAILED) {
+    close(fd);
+    return -1;
+  }
+  *memory = mapping;
+  return fd;
+}
+
+#else  // WIN32
+
+// Workers need fork, descriptor passing and Unix domain sockets.
+bool WorkerWrite(int socket, const void* data, size_t size) {
+  return false;
+}
+bool WorkerWriteWithFd(int socket, const void* data, size_t size, int fd) {
+  return false;
+}
+WorkerIoResult WorkerRead(int socket, void* data, size_t size,
+                          int timeout_msecs) {
+  return WIO_CLOSED;
+}
+WorkerIoResult WorkerReadWithFd(int socket, void* data, size_t size,
+                                int* fd) {
+  *fd = -1;
+  return WIO_CLOSED;
+}
+int CreateWorkerSegment(size_t size, void** memory) {
+  return -1;
+}
+
+#endif  // WIN32
+
+}  // namespace tesseract.
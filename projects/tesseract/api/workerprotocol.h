@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////
+// File:        workerprotocol.h
+// Description: Messages between TessWorkerPool and the tessworker
+//              processes it supervises.
+// Created:     Sun Oct 18 23:12:06 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_API_WORKERPROTOCOL_H__
+#define TESSERACT_API_WORKERPROTOCOL_H__
+
+#include <stddef.h>
+
+#include "host.h"
+
+// A worker is a child process that talks to its pool over one end of a
+// Unix domain socket pair. Requests and replies are the structs below,
+// written raw, as both ends are the same build on the same machine, each
+// followed by the variable length data it counts. The pixels of a page go
+// through a shared memory segment instead: an unlinked file on tmpfs
+// (/dev/shm where there is one) that the pool maps, and passes to the
+// worker as a file descriptor in the control message of a request.
+
+namespace tesseract {
+
+// Starts every message. Changes whenever the layout of a message does.
+const uinT32 kWorkerMagic = 0x314b5754;  // "TWK1"
+
+enum WorkerMessageType {
+  WMT_RECOGNIZE,     // Recognize the page in the shared memory.
+  WMT_SET_VARIABLE,  // TessBaseAPI::SetVariable.
+  WMT_QUIT           // Exit cleanly.
+};
+
+// Flags of a WMT_RECOGNIZE request.
+enum WorkerRequestFlags {
+  WRF_HOCR = 1,      // hOCR text instead of UTF-8.
+  WRF_WORDS = 2      // Add the box and confidence of every word.
+};
+
+struct WorkerRequest {
+  WorkerRequest()
+    : magic(kWorkerMagic), type(WMT_RECOGNIZE), flags(0),
+      segment_bytes(0), width(0), height(0), depth(0), wpl(0), xres(0),
+      yres(0), pageseg_mode(0), page_number(0), timeout_msecs(0),
+      name_bytes(0), value_bytes(0) {}
+
+  uinT32 magic;
+  inT32 type;           // WorkerMessageType.
+  inT32 flags;          // WorkerRequestFlags.
+  // Size of the new shared memory segment whose descriptor comes with the
+  // request, or 0 to keep using the last one.
+  inT64 segment_bytes;
+  // The page, whose pixels are at the start of the segment, as in a Pix.
+  inT32 width, height, depth, wpl, xres, yres;
+  inT32 pageseg_mode;
+  inT32 page_number;
+  inT32 timeout_msecs;  // Deadline for recognition, 0 for none.
+  // Followed by name_bytes of the hOCR input name or the variable name,
+  // then value_bytes of the variable value.
+  inT32 name_bytes;
+  inT32 value_bytes;
+};
+
+enum WorkerReplyStatus {
+  WRS_OK,
+  WRS_FAILED,        // Init, SetVariable or Recognize failed.
+  WRS_BAD_REQUEST    // A request the worker could not make sense of.
+};
+
+// Sent once by a worker when its engine is initialized, and in answer to
+// every request but WMT_QUIT.
+struct WorkerReply {
+  WorkerReply()
+    : magic(kWorkerMagic), status(WRS_OK), text_bytes(0), num_words(0),
+      recognize_msecs(0.0) {}
+
+  uinT32 magic;
+  inT32 status;         // WorkerReplyStatus.
+  // Followed by text_bytes of text, without a null, then num_words
+  // WorkerWords.
+  inT32 text_bytes;
+  inT32 num_words;
+  double recognize_msecs;  // Time spent on the page in the worker.
+};
+
+// A recognized word, as ResultIterator gives it.
+struct WorkerWord {
+  inT32 left, top, right, bottom;
+  float confidence;
+};
+
+// Outcome of a read from a worker socket.
+enum WorkerIoResult {
+  WIO_OK,
+  WIO_CLOSED,        // The other end has gone, or there was an error.
+  WIO_TIMEOUT
+};
+
+// Writes all size bytes of data to socket. Never raises SIGPIPE.
+bool WorkerWrite(int socket, const void* data, size_t size);
+// As WorkerWrite, with fd passed along in the control message.
+bool WorkerWriteWithFd(int socket, const void* data, size_t size, int fd);
+// Reads exactly size bytes into data, waiting at most timeout_msecs in all,
+// or forever if it is negative.
+WorkerIoResult WorkerRead(int socket, void* data, size_t size,
+                          int timeout_msecs);
+// As WorkerRead with no timeout, also taking any file descriptor passed
+// with the data. *fd is -1 if there was none.
+WorkerIoResult WorkerReadWithFd(int socket, void* data, size_t size,
+                                int* fd);
+
+// Creates a shared memory segment of size bytes, maps it writable into
+// *memory and returns its descriptor, or -1 on failure. The segment has no
+// name, so it goes when the last descriptor and mapping go.
+int CreateWorkerSegment(size_t size, void** memory);
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_API_WORKERPROTOCOL_H__
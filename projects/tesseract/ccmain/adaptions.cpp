@@ -35,7 +35,6 @@
 #include          "memry.h"
 #include          "charcut.h"
 #include          "imgs.h"
-#include          "scaleimg.h"
 #include          "reject.h"
 #include          "control.h"
 #include          "stopper.h"
@@ -107,38 +107,37 @@ static void clear_any_old_text(BLOCK_LIST *block_list) {
 PAGE_RES* Tesseract::ApplyBoxes(const STRING& fname,
                                 bool find_segmentation,
                                 BLOCK_LIST *block_list) {
+  BoxFileIndex boxes;
+  boxes.ReadBoxes(OpenBoxFile(fname));
+  return ApplyBoxes(boxes, applybox_page, find_segmentation, block_list);
+}
+
+// As ApplyBoxes above, but with the boxes of the given page of boxes, so a
+// box file read once can serve all the pages of its image. page -1 applies
+// the boxes of all the pages.
+PAGE_RES* Tesseract::ApplyBoxes(const BoxFileIndex& boxes, int page,
+                                bool find_segmentation,
+                                BLOCK_LIST *block_list) {
   // In word mode, we use the boxes to make a word for each box, but
   // in blob mode we use the existing words and maximally chop them first.
   PAGE_RES* page_res = find_segmentation ? NULL : SetupApplyBoxes(block_list);
-  int box_count = 0;
+  int box_count = boxes.num_boxes(page);
   int box_failures = 0;
 
-  FILE* box_file = OpenBoxFile(fname);
   clear_any_old_text(block_list);
-  TBOX prev_box, box, next_box;
-  bool found_box = false;
-  char text[kBoxReadBufSize];
-  do {
-    prev_box = box;
-    box = next_box;
-    int line_number = 0;           // Line number of the box file.
-    int x_min;
-    int y_min;
-    int x_max;
-    int y_max;
-    char next_text[kBoxReadBufSize];
-    // Keep a look-ahead box, so we can pass the next box into the resegment
-    // functions.
-    found_box = read_next_box(applybox_page, &line_number, box_file, next_text,
-                              &x_min, &y_min, &x_max, &y_max);
-    if (found_box) {
-      next_box = TBOX(ICOORD(x_min, y_min), ICOORD (x_max, y_max));
-      ++box_count;
-    } else {
-      next_box = TBOX();
-      next_text[0] = '\0';
+  for (int i = 0; i < box_count; ++i) {
+    const BoxFileBox& box_file_box = boxes.box(page, i);
+    TBOX box(ICOORD(box_file_box.x_min, box_file_box.y_min),
+             ICOORD(box_file_box.x_max, box_file_box.y_max));
+    // The next box is passed into the resegment functions too.
+    TBOX next_box;
+    if (i + 1 < box_count) {
+      const BoxFileBox& next = boxes.box(page, i + 1);
+      next_box = TBOX(ICOORD(next.x_min, next.y_min),
+                      ICOORD(next.x_max, next.y_max));
     }
     if (!box.null_box()) {
+      const char* text = box_file_box.text.string();
       bool foundit = false;
       if (page_res != NULL)
         foundit = ResegmentCharBox(page_res, box, next_box, text);
@@ -146,12 +145,11 @@ PAGE_RES* Tesseract::ApplyBoxes(const STRING& fname,
         foundit = ResegmentWordBox(block_list, box, next_box, text);
       if (!foundit) {
         box_failures++;
-        ReportFailedBox(box_count, box, text,
+        ReportFailedBox(box_file_box.line_number, box, text,
                         "FAILURE! Couldn't find a matching blob");
       }
     }
-    strcpy(text, next_text);
-  } while (found_box);
+  }
   if (page_res == NULL) {
     // In word/line mode, we now maximally chop all the words and resegment
     // them with the classifier.
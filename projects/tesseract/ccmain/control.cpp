@@ -154,6 +154,24 @@ bool Tesseract::ProcessTargetWord(const TBOX& word_box,
   return true;
 }
 
+/**
+ * SkipOptionalStage()
+ *
+ * Returns true, and records the stage in page_res->skipped_stages, if the
+ * time left before the monitor's deadline is within
+ * tessedit_degrade_reserve_ms, so the given stage should be left out.
+ */
+bool Tesseract::SkipOptionalStage(ETEXT_DESC* monitor, RecognitionStage stage,
+                                  PAGE_RES* page_res) {
+  if (monitor == NULL ||
+      monitor->remaining_msecs() > tessedit_degrade_reserve_ms)
+    return false;
+  if (tessedit_debug_quality_metrics)
+    TLOG_DEBUG("Deadline near: skipping recognition stage %d\n", stage);
+  page_res->skipped_stages |= stage;
+  return true;
+}
+
 /**
  * recog_all_words()
  *
@@ -171,13 +189,17 @@ bool Tesseract::ProcessTargetWord(const TBOX& word_box,
  * @param monitor progress monitor
  * @param target_word_box specifies just to extract a rectangle
  * @param dopasses 0 - all, 1 just pass 1, 2 passes 2 and higher
+ * @param page_passes false if page_res is just one block of the page, in
+ * which case the passes that look at the whole page, the adaptive classifier
+ * reset and the modal font, are left to the caller.
  */
 
 void Tesseract::recog_all_words(PAGE_RES* page_res,
                                 ETEXT_DESC* monitor,
                                 const TBOX* target_word_box,
                                 const char* word_config,
-                                int dopasses) {
+                                int dopasses,
+                                bool page_passes) {
                                  // reset page iterator
   // If we only intend to run cube - run it and return.
   if (tessedit_ocr_engine_mode == OEM_CUBE_ONLY) {
@@ -197,6 +219,10 @@ void Tesseract::recog_all_words(PAGE_RES* page_res,
   inT16 accepted_all_char_quality;
   inT32 word_index;              // current word
   int i;
+  // In degrade mode the deadline no longer aborts the page. Pass 1 always
+  // completes, and the optional stages after it are dropped instead.
+  bool degrade = monitor != NULL && tessedit_degrade_on_deadline;
+  page_res->skipped_stages = 0;
 
   if (tessedit_minimal_rej_pass1) {
     tessedit_test_adaption.set_value (TRUE);
@@ -214,8 +240,9 @@ void Tesseract::recog_all_words(PAGE_RES* page_res,
     // classifier is not reset at an arbitraty point while processing the page,
     // which would cripple Passes 2+ if the reset happens towards the end of
     // Pass 1 on a page with very difficul text.
-    // TODO(daria): preemptively clear the classifier if it is almost full.
-    if (AdaptiveClassifierIsFull()) 
+    // Full classes normally make room by evicting their least recently
+    // used temp configs, so this only happens when that was impossible.
+    if (page_passes && AdaptiveClassifierIsFull())
 		ResetAdaptiveClassifier();
 
     stats_.word_count = 0;
@@ -249,7 +276,7 @@ void Tesseract::recog_all_words(PAGE_RES* page_res,
       if (monitor != NULL) {
         monitor->ocr_alive = TRUE;
         monitor->progress = 30 + 50 * word_index / stats_.word_count;
-        if (monitor->deadline_exceeded() ||
+        if ((!degrade && monitor->deadline_exceeded()) ||
             (monitor->cancel != NULL && (*monitor->cancel)(monitor->cancel_this,
                                                            stats_.dict_words)))
           return;
@@ -269,10 +296,10 @@ void Tesseract::recog_all_words(PAGE_RES* page_res,
       }
       if (tessedit_dump_choices) {
         word_dumper(NULL, page_res_it.row()->row, page_res_it.word());
-        tprintf("Pass1: %s [%s]\n",
-                page_res_it.word()->best_choice->unichar_string().string(),
-                page_res_it.word()->best_choice->
-                  debug_string(unicharset).string());
+        TLOG_DEBUG("Pass1: %s [%s]\n",
+                   page_res_it.word()->best_choice->unichar_string().string(),
+                   page_res_it.word()->best_choice->
+                     debug_string(unicharset).string());
       }
 
       // tessedit_test_adaption enables testing of the accuracy of the
@@ -311,10 +338,13 @@ void Tesseract::recog_all_words(PAGE_RES* page_res,
     if (monitor != NULL) {
       monitor->ocr_alive = TRUE;
       monitor->progress = 80 + 10 * word_index / stats_.word_count;
-      if (monitor->deadline_exceeded() ||
+      if ((!degrade && monitor->deadline_exceeded()) ||
           (monitor->cancel != NULL && (*monitor->cancel)(monitor->cancel_this,
                                                          stats_.dict_words)))
         return;
+      // The remaining words keep their pass 1 results.
+      if (degrade && SkipOptionalStage(monitor, RS_PASS2, page_res))
+        break;
     }
 
     // changed by jetsoft
@@ -337,10 +367,10 @@ void Tesseract::recog_all_words(PAGE_RES* page_res,
     }
     if (tessedit_dump_choices) {
       word_dumper(NULL, page_res_it.row()->row, page_res_it.word());
-      tprintf("Pass2: %s [%s]\n",
-              page_res_it.word()->best_choice->unichar_string().string(),
-              page_res_it.word()->best_choice->
-                debug_string(unicharset).string());
+      TLOG_DEBUG("Pass2: %s [%s]\n",
+                 page_res_it.word()->best_choice->unichar_string().string(),
+                 page_res_it.word()->best_choice->
+                   debug_string(unicharset).string());
     }
     page_res_it.forward();
   }
@@ -350,7 +380,8 @@ void Tesseract::recog_all_words(PAGE_RES* page_res,
   set_global_loc_code(LOC_FUZZY_SPACE);
 
   if (!tessedit_test_adaption && tessedit_fix_fuzzy_spaces
-      && !tessedit_word_for_word && !right_to_left())
+      && !tessedit_word_for_word && !right_to_left() &&
+      !(degrade && SkipOptionalStage(monitor, RS_FUZZY_SPACES, page_res)))
     fix_fuzzy_spaces(monitor, stats_.word_count, page_res);
 
   // ****************** Pass 4 *******************
@@ -406,7 +437,8 @@ void Tesseract::recog_all_words(PAGE_RES* page_res,
 
   // ****************** Pass 5 *******************
   // If cube is loaded and its combiner is present, run it.
-  if (tessedit_ocr_engine_mode == OEM_TESSERACT_CUBE_COMBINED) {
+  if (tessedit_ocr_engine_mode == OEM_TESSERACT_CUBE_COMBINED &&
+      !(degrade && SkipOptionalStage(monitor, RS_CUBE, page_res))) {
     run_cube(page_res);
   }
 
@@ -445,7 +477,12 @@ void Tesseract::recog_all_words(PAGE_RES* page_res,
   }
 
   // ****************** Pass 7 *******************
-  font_recognition_pass(page_res_it);
+  if (!(degrade && SkipOptionalStage(monitor, RS_FONTS, page_res))) {
+    if (page_passes)
+      font_recognition_pass(page_res_it);
+    else
+      word_font_pass(page_res_it);
+  }
 
   // Write results pass.
   set_global_loc_code(LOC_WRITE_RESULTS);
@@ -1303,12 +1340,12 @@ void Tesseract::set_word_fonts(WERD_RES *word,
     word->best_choice_fontinfo_ids.push_back(word->font1);
   }
   if (word->font1_count > 0) {
-    FontInfo fi = fontinfo_table_.get(word->font1);
+    FontInfo fi = get_fontinfo_table().get(word->font1);
     if (tessedit_debug_fonts) {
       if (word->font2_count > 0) {
         tprintf("Word modal font=%s, score=%d, 2nd choice %s/%d\n",
                 fi.name, word->font1_count,
-                fontinfo_table_.get(word->font2).name, word->font2_count);
+                get_fontinfo_table().get(word->font2).name, word->font2_count);
       } else {
         tprintf("Word modal font=%s, score=%d. No 2nd choice\n",
                 fi.name, word->font1_count);
@@ -1329,6 +1366,36 @@ void Tesseract::set_word_fonts(WERD_RES *word,
 
 void Tesseract::font_recognition_pass(  //good chars in word
                                       PAGE_RES_IT &page_res_it) {
+  word_font_pass(page_res_it);
+  modal_font_pass(page_res_it);
+}
+
+/**
+ * word_font_pass
+ *
+ * Sets the fonts of each word from its own blob choices.
+ */
+void Tesseract::word_font_pass(PAGE_RES_IT &page_res_it) {
+  WERD_RES *word;                //current word
+
+  page_res_it.restart_page();
+  while (page_res_it.word() != NULL) {
+    word = page_res_it.word();
+    set_word_fonts(word, word->best_choice->blob_choices());
+    if (!save_best_choices) {  // set_blob_choices() does a deep clear
+      word->best_choice->set_blob_choices(NULL);
+    }
+    page_res_it.forward();
+  }
+}
+
+/**
+ * modal_font_pass
+ *
+ * Gives the words whose own fonts are not convincing the modal font of
+ * the page, from the fonts set by word_font_pass.
+ */
+void Tesseract::modal_font_pass(PAGE_RES_IT &page_res_it) {
   inT32 length;                  //of word
   inT32 count;                   //of a feature
   inT8 doc_font;                 //modal font
@@ -1340,10 +1407,6 @@ void Tesseract::font_recognition_pass(  //good chars in word
   page_res_it.restart_page();
   while (page_res_it.word() != NULL) {
     word = page_res_it.word();
-    set_word_fonts(word, word->best_choice->blob_choices());
-    if (!save_best_choices) {  // set_blob_choices() does a deep clear
-      word->best_choice->set_blob_choices(NULL);
-    }
     doc_fonts.add(word->font1, word->font1_count);
     doc_fonts.add(word->font2, word->font2_count);
     page_res_it.forward();
@@ -1351,7 +1414,7 @@ void Tesseract::font_recognition_pass(  //good chars in word
   find_modal_font(&doc_fonts, &doc_font, &doc_font_count);
   if (doc_font_count == 0)
     return;
-  FontInfo fi = fontinfo_table_.get(doc_font);
+  FontInfo fi = get_fontinfo_table().get(doc_font);
 
   page_res_it.restart_page ();
   while (page_res_it.word () != NULL) {
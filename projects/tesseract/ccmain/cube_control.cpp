@@ -21,9 +21,40 @@
 #include "cube_reco_context.h"
 #include "tesseractclass.h"
 #include "tesseract_cube_combiner.h"
+#include "threadpool.h"
 
 namespace tesseract {
 
+// A word that passed the combiner gate and is waiting for, or has had,
+// its cube recognition. The CubeObject is created by the worker that
+// recognizes the word, from that worker's own CubeRecoContext.
+struct CubeWordJob {
+  WERD_RES* word;
+  TBOX word_box;
+  CubeObject* cube_obj;
+  WordAltList* alt_list;  // Owned by cube_obj.
+};
+
+// Runs Tesseract::cube_recognize_jobs on a worker thread.
+class CubeWorkerTask : public TessClosure {
+ public:
+  CubeWorkerTask(Tesseract* tess, CubeRecoContext* cntxt,
+                 GenericVector<CubeWordJob>* jobs, int* next_job,
+                 CCUtilMutex* job_mutex)
+    : tess_(tess), cntxt_(cntxt), jobs_(jobs), next_job_(next_job),
+      job_mutex_(job_mutex) {}
+  virtual void Run() {
+    tess_->cube_recognize_jobs(cntxt_, jobs_, next_job_, job_mutex_);
+  }
+
+ private:
+  Tesseract* tess_;
+  CubeRecoContext* cntxt_;
+  GenericVector<CubeWordJob>* jobs_;
+  int* next_job_;
+  CCUtilMutex* job_mutex_;
+};
+
 /**********************************************************************
  * convert_prob_to_tess_certainty
  *
@@ -215,6 +246,21 @@ bool Tesseract::init_cube_objects(bool load_combiner,
     return false;
   }
 
+  // Load a private context for each extra cube worker. Running with fewer
+  // workers than asked for is not an error.
+  for (int i = 1; i < cube_num_threads; ++i) {
+    CubeRecoContext* worker_cntxt =
+        CubeRecoContext::Create(this, tessdata_manager, &unicharset);
+    if (worker_cntxt == NULL) {
+      if (cube_debug_level > 0) {
+        tprintf("Cube WARNING (Tesseract::init_cube_objects()): Failed to "
+                "instantiate worker CubeRecoContext %d\n", i);
+      }
+      break;
+    }
+    cube_worker_cntxts_.push_back(worker_cntxt);
+  }
+
   // Create the combiner object and load the combiner net for target languages.
   if (load_combiner) {
     tess_cube_combiner_ = new tesseract::TesseractCubeCombiner(cube_cntxt_);
@@ -239,6 +285,11 @@ bool Tesseract::init_cube_objects(bool load_combiner,
  * Iterate through tesseract's results and call cube on each word.
  * If the combiner is present, optionally run the tesseract-cube
  * combiner on each word.
+ *
+ * Words that tesseract is already sure of are filtered out first, so they
+ * never touch the image. The rest are recognized by cube on up to
+ * cube_num_threads threads, and the results are then combined and applied
+ * to the page_res in page order.
  **********************************************************************/
 void Tesseract::run_cube(
                          PAGE_RES *page_res  // page structure
@@ -254,8 +305,8 @@ void Tesseract::run_cube(
   PAGE_RES_IT page_res_it(page_res);
   page_res_it.restart_page();
 
-  // Iterate through the word results and call cube on each word.
-  CubeObject *cube_obj;
+  // Gather the words that need cube.
+  GenericVector<CubeWordJob> jobs;
   for (page_res_it.restart_page(); page_res_it.word () != NULL;
        page_res_it.forward()) {
     WERD_RES* word = page_res_it.word();
@@ -274,15 +325,99 @@ void Tesseract::run_cube(
         page_res_it.DeleteCurrentWord();  // Nobody has an answer.
       continue;
     }
-    cube_obj = new tesseract::CubeObject(cube_cntxt_, pix_binary_,
-                                         word_box.left(),
-                                         pix_binary_->h - word_box.top(),
-                                         word_box.width(), word_box.height());
-    cube_recognize(cube_obj, &page_res_it);
-    delete cube_obj;
+    if (!cube_word_needed(word))
+      continue;
+    CubeWordJob job;
+    job.word = word;
+    job.word_box = word_box;
+    job.cube_obj = NULL;
+    job.alt_list = NULL;
+    jobs.push_back(job);
+  }
+  if (jobs.empty())
+    return;
+
+  // Recognize them, on this thread alone if there is nothing to share.
+  int next_job = 0;
+  CCUtilMutex job_mutex;
+  int num_workers = cube_worker_cntxts_.size() + 1;
+  if (num_workers > jobs.size())
+    num_workers = jobs.size();
+  if (num_workers <= 1) {
+    cube_recognize_jobs(cube_cntxt_, &jobs, &next_job, &job_mutex);
+  } else {
+    ThreadPool pool(num_workers);
+    pool.Schedule(new CubeWorkerTask(this, cube_cntxt_, &jobs, &next_job,
+                                     &job_mutex));
+    for (int i = 1; i < num_workers; ++i) {
+      pool.Schedule(new CubeWorkerTask(this, cube_worker_cntxts_[i - 1],
+                                       &jobs, &next_job, &job_mutex));
+    }
+    pool.WaitIdle();
+  }
+
+  // Combine and apply in page order. Jobs were made in page order and
+  // DeleteCurrentWord only removes the current word, so one walk suffices.
+  int j = 0;
+  for (page_res_it.restart_page();
+       page_res_it.word() != NULL && j < jobs.size();
+       page_res_it.forward()) {
+    if (page_res_it.word() != jobs[j].word)
+      continue;
+    cube_apply_result(jobs[j].cube_obj, jobs[j].alt_list, &page_res_it);
+    delete jobs[j].cube_obj;
+    ++j;
+  }
+  ASSERT_HOST(j == jobs.size());
+}
+
+/**********************************************************************
+ * cube_recognize_jobs
+ *
+ * Worker loop for run_cube: takes the next unclaimed job and runs cube
+ * on it with the given context until none are left. Only the job's own
+ * fields are written, so workers need no locking beyond claiming a job.
+ **********************************************************************/
+void Tesseract::cube_recognize_jobs(CubeRecoContext *cntxt,
+                                    GenericVector<CubeWordJob> *jobs,
+                                    int *next_job, CCUtilMutex *job_mutex) {
+  while (true) {
+    job_mutex->Lock();
+    int index = (*next_job)++;
+    job_mutex->Unlock();
+    if (index >= jobs->size())
+      return;
+    CubeWordJob* job = &(*jobs)[index];
+    job->cube_obj = new tesseract::CubeObject(
+        cntxt, pix_binary_, job->word_box.left(),
+        pix_binary_->h - job->word_box.top(),
+        job->word_box.width(), job->word_box.height());
+    job->alt_list = job->cube_obj->RecognizeWord();
   }
 }
 
+/**********************************************************************
+ * cube_word_needed
+ *
+ * Returns false if cube can be skipped for the word: the combiner is
+ * present and either there is no tesseract result to combine with, or
+ * tesseract's certainty is already above the combiner's run threshold.
+ *
+ **********************************************************************/
+bool Tesseract::cube_word_needed(WERD_RES *word) {
+  if (tess_cube_combiner_ == NULL)
+    return true;
+  if (!word->best_choice) {
+    if (cube_debug_level > 0)
+      tprintf("Cube WARNING (Tesseract::cube_recognize): Cannot run combiner "
+              "without a tess result.\n");
+    return false;
+  }
+  int combiner_run_thresh = convert_prob_to_tess_certainty(
+      cube_cntxt_->Params()->CombinerRunThresh());
+  return word->best_choice->certainty() < combiner_run_thresh;
+}
+
 /**********************************************************************
  * cube_recognize
  *
@@ -296,26 +431,28 @@ void Tesseract::cube_recognize(
                                CubeObject *cube_obj,
                                PAGE_RES_IT *page_res_it
                                ) {
-  // Retrieve tesseract's data structure for the current word.
-  WERD_RES *tess_werd_res = page_res_it->word();
-  if (!tess_werd_res->best_choice && tess_cube_combiner_ != NULL) {
-    if (cube_debug_level > 0)
-      tprintf("Cube WARNING (Tesseract::cube_recognize): Cannot run combiner "
-              "without a tess result.\n");
-    return;
-  }
-
   // Skip cube entirely if combiner is present but tesseract's
   // certainty is greater than threshold.
-  int combiner_run_thresh = convert_prob_to_tess_certainty(
-      cube_cntxt_->Params()->CombinerRunThresh());
-  if (tess_cube_combiner_ != NULL &&
-      (tess_werd_res->best_choice->certainty() >= combiner_run_thresh)) {
+  if (!cube_word_needed(page_res_it->word()))
     return;
-  }
 
   // Run cube
   WordAltList *cube_alt_list = cube_obj->RecognizeWord();
+  cube_apply_result(cube_obj, cube_alt_list, page_res_it);
+}
+
+/**********************************************************************
+ * cube_apply_result
+ *
+ * The second half of cube_recognize, given the alternates from a
+ * RecognizeWord call already made on cube_obj for the current word.
+ *
+ **********************************************************************/
+void Tesseract::cube_apply_result(CubeObject *cube_obj,
+                                  WordAltList *cube_alt_list,
+                                  PAGE_RES_IT *page_res_it) {
+  // Retrieve tesseract's data structure for the current word.
+  WERD_RES *tess_werd_res = page_res_it->word();
   if (!cube_alt_list || cube_alt_list->AltCount() <= 0) {
     if (cube_debug_level > 0) {
       tprintf("Cube returned nothing for word at:");
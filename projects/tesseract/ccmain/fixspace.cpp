@@ -58,6 +58,10 @@ void Tesseract::fix_fuzzy_spaces(ETEXT_DESC *monitor,
   inT16 new_length;
   BOOL8 prevent_null_wd_fixsp;   // DONT process blobless wds
   inT32 word_index;              // current word
+  // In degrade mode recog_all_words has already decided to run this pass,
+  // so only cancellation stops it: a half-fixed page is neither the
+  // complete pass nor a cleanly skipped one.
+  bool degrade = tessedit_degrade_on_deadline;
 
   block_res_it.set_to_list(&page_res->block_res_list);
   word_index = 0;
@@ -80,7 +84,7 @@ void Tesseract::fix_fuzzy_spaces(ETEXT_DESC *monitor,
           if (monitor != NULL) {
             monitor->ocr_alive = TRUE;
             monitor->progress = 90 + 5 * word_index / word_count;
-            if (monitor->deadline_exceeded() ||
+            if ((!degrade && monitor->deadline_exceeded()) ||
                 (monitor->cancel != NULL &&
                  (*monitor->cancel)(monitor->cancel_this, stats_.dict_words)))
             return;
@@ -98,7 +102,7 @@ void Tesseract::fix_fuzzy_spaces(ETEXT_DESC *monitor,
           if (monitor != NULL) {
             monitor->ocr_alive = TRUE;
             monitor->progress = 90 + 5 * word_index / word_count;
-            if (monitor->deadline_exceeded() ||
+            if ((!degrade && monitor->deadline_exceeded()) ||
                 (monitor->cancel != NULL &&
                  (*monitor->cancel)(monitor->cancel_this, stats_.dict_words)))
             return;
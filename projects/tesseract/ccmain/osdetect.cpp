@@ -30,6 +30,7 @@
 #include "strngs.h"
 #include "tabvector.h"
 #include "tesseractclass.h"
+#include "tesslog.h"
 #include "textord.h"
 #include "tstruct.h"
 
@@ -247,7 +248,7 @@ int os_detect_blobs(BLOBNBOX_CLIST* blob_list, OSResults* osr,
 
   // If there are too few characters, skip this page entirely.
   if (real_max < kMinCharactersToTry / 2) {
-    printf("Too few characters. Skipping this page\n");
+    TLOG_INFO("Too few characters. Skipping this page\n");
     return 0;
   }
 
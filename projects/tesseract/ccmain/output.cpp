@@ -694,8 +694,8 @@ void Tesseract::write_results(                    //write output
 								blob_box.left (), blob_box.right (),
 								/*page_image.get_ysize () - 1 - blob_box.top (),
 								page_image.get_ysize () - 1 - blob_box.bottom (),*/
-								pix_grey_->h - 1 - blob_box.top (),
-								pix_grey_->h - 1 - blob_box.bottom (),
+								ImageHeight() - 1 - blob_box.top (),
+								ImageHeight() - 1 - blob_box.bottom (),
 								font, (uinT8) rating,
 								ptsize,                //point size
 								blanks, enhancement,   //enhancement
@@ -710,8 +710,8 @@ void Tesseract::write_results(                    //write output
 								blob_box.left (), blob_box.right (),
 								/*page_image.get_ysize () - 1 - blob_box.top (),
 								page_image.get_ysize () - 1 - blob_box.bottom (),*/
-								pix_grey_->h - 1 - blob_box.top (),
-								pix_grey_->h - 1 - blob_box.bottom (),
+								ImageHeight() - 1 - blob_box.top (),
+								ImageHeight() - 1 - blob_box.bottom (),
 								font, (uinT8) rating,
 								ptsize,                //point size
 								blanks, enhancement,   //enhancement
@@ -753,8 +753,8 @@ void Tesseract::write_results(                    //write output
 			blob_box.left (), blob_box.right (),
 			/*page_image.get_ysize () - 1 - blob_box.top (),
 			page_image.get_ysize () - 1 - blob_box.bottom (),*/
-			pix_grey_->h - 1 - blob_box.top (),
-			pix_grey_->h - 1 - blob_box.bottom (),
+			ImageHeight() - 1 - blob_box.top (),
+			ImageHeight() - 1 - blob_box.bottom (),
 			font,
 			rating,                    //confidence
 			ptsize,                    //point size
@@ -108,6 +108,27 @@ static Pix* RemoveEnclosingCircle(Pix* pixs) {
  */
 int Tesseract::SegmentPage(const STRING* input_file, BLOCK_LIST* blocks,
                            Tesseract* osd_tess, OSResults* osr) {
+  TO_BLOCK_LIST to_blocks;
+  PageSegMode pageseg_mode;
+  int result = FindPageBlocks(input_file, blocks, &to_blocks, osd_tess, osr,
+                              &pageseg_mode);
+  if (result < 0 || pageseg_mode == PSM_OSD_ONLY || blocks->empty())
+    return result;
+  TextordBlocks(pageseg_mode, blocks, &to_blocks);
+  return result;
+}
+
+/**
+ * The part of SegmentPage that needs the whole page: finds the blocks, and
+ * when the mode finds blocks, their TO_BLOCKs in to_blocks. TextordBlocks
+ * then makes their rows and words, all at once or a few blocks at a time.
+ * Returns as SegmentPage, and sets *pageseg_mode to the mode TextordBlocks
+ * must use, which a UNLV zone file overrides.
+ */
+int Tesseract::FindPageBlocks(const STRING* input_file, BLOCK_LIST* blocks,
+                              TO_BLOCK_LIST* to_blocks,
+                              Tesseract* osd_tess, OSResults* osr,
+                              PageSegMode* pageseg_mode) {
   ASSERT_HOST(pix_binary_ != NULL);
   int width = pixGetWidth(pix_binary_);
   int height = pixGetHeight(pix_binary_);
@@ -116,10 +137,10 @@ int Tesseract::SegmentPage(const STRING* input_file, BLOCK_LIST* blocks,
   if (resolution < kMinCredibleResolution)
     resolution = kDefaultResolution;
   // Get page segmentation mode.
-  PageSegMode pageseg_mode = static_cast<PageSegMode>(
+  *pageseg_mode = static_cast<PageSegMode>(
       static_cast<int>(tessedit_pageseg_mode));
   // If a UNLV zone file can be found, use that instead of segmentation.
-  if (!PSM_COL_FIND_ENABLED(pageseg_mode) &&
+  if (!PSM_COL_FIND_ENABLED(*pageseg_mode) &&
       input_file != NULL && input_file->length() > 0) {
     STRING name = *input_file;
     const char* lastdot = strrchr(name.string(), '.');
@@ -136,26 +157,25 @@ int Tesseract::SegmentPage(const STRING* input_file, BLOCK_LIST* blocks,
     block_it.add_to_end(block);
   } else {
     // UNLV file present. Use PSM_SINGLE_COLUMN.
-    pageseg_mode = PSM_SINGLE_COLUMN;
+    *pageseg_mode = PSM_SINGLE_COLUMN;
   }
-  bool single_column = !PSM_COL_FIND_ENABLED(pageseg_mode);
-  bool osd_enabled = PSM_OSD_ENABLED(pageseg_mode);
-  bool osd_only = pageseg_mode == PSM_OSD_ONLY;
+  bool single_column = !PSM_COL_FIND_ENABLED(*pageseg_mode);
+  bool osd_enabled = PSM_OSD_ENABLED(*pageseg_mode);
+  bool osd_only = *pageseg_mode == PSM_OSD_ONLY;
 
   int auto_page_seg_ret_val = 0;
-  TO_BLOCK_LIST to_blocks;
-  if (osd_enabled || PSM_BLOCK_FIND_ENABLED(pageseg_mode)) {
+  if (osd_enabled || PSM_BLOCK_FIND_ENABLED(*pageseg_mode)) {
     auto_page_seg_ret_val =
         AutoPageSeg(resolution, single_column, osd_enabled, osd_only,
-                    blocks, &to_blocks, osd_tess, osr);
+                    blocks, to_blocks, osd_tess, osr);
     if (osd_only)
       return auto_page_seg_ret_val;
     // To create blobs from the image region bounds uncomment this line:
-    //  to_blocks.clear();  // Uncomment to go back to the old mode.
+    //  to_blocks->clear();  // Uncomment to go back to the old mode.
   } else {
     deskew_ = FCOORD(1.0f, 0.0f);
     reskew_ = FCOORD(1.0f, 0.0f);
-    if (pageseg_mode == PSM_CIRCLE_WORD) {
+    if (*pageseg_mode == PSM_CIRCLE_WORD) {
       Pix* pixcleaned = RemoveEnclosingCircle(pix_binary_);
       if (pixcleaned != NULL) {
         pixDestroy(&pix_binary_);
@@ -172,11 +192,22 @@ int Tesseract::SegmentPage(const STRING* input_file, BLOCK_LIST* blocks,
     tprintf("Empty page\n");
     return 0;  // AutoPageSeg found an empty page.
   }
+  return auto_page_seg_ret_val;
+}
 
-  textord_.TextordPage(pageseg_mode, width, height, pix_binary_,
-                       blocks, &to_blocks);
+/**
+ * Makes the rows and words of blocks found by FindPageBlocks. to_blocks
+ * holds the TO_BLOCKs of blocks if FindPageBlocks made any, and is
+ * otherwise empty. Textord makes its page-wide estimates, such as the skew
+ * gradient, over the blocks it is given, so the layout may differ slightly
+ * when they are given a few at a time.
+ */
+void Tesseract::TextordBlocks(PageSegMode pageseg_mode, BLOCK_LIST* blocks,
+                              TO_BLOCK_LIST* to_blocks) {
+  textord_.TextordPage(pageseg_mode, pixGetWidth(pix_binary_),
+                       pixGetHeight(pix_binary_), pix_binary_,
+                       blocks, to_blocks);
   SetupWordScripts(blocks);
-  return auto_page_seg_ret_val;
 }
 
 // TODO(rays) This is a hack to set all the words with a default script.
@@ -606,7 +606,8 @@ void Tesseract::process_image_event( // action in image win
  */
 void Tesseract::debug_word(PAGE_RES* page_res, const TBOX &selection_box) {
   ResetAdaptiveClassifier();
-  recog_all_words(page_res, NULL, &selection_box, word_config_.string(), 0);
+  recog_all_words(page_res, NULL, &selection_box, word_config_.string(), 0,
+                  true);
 }
 }  // namespace tesseract
 
@@ -1,6 +1,6 @@
 /**********************************************************************
  * File:        scaleimg.cpp  (Formerly scaleim.c)
- * Description: Smart scaling of images.
+ * Description: Fast area-averaging reduction of images.
  * Author:      Phil Cheatle
  * Created:     Wed Nov 18 16:12:03 GMT 1992
  *
@@ -18,353 +18,121 @@
  **********************************************************************/
 
 /*************************************************************************
- * This is really Sheelagh's code that I've hacked into a more usable form.
- * You simply call scale_image() passing in source and target images. The target
- * image should be empty, but created - in order to define the destination
- * size.
+ * This replaces Sheelagh's dynamic programming scale_image, which worked
+ * on IMAGEs and was no longer called. ScaleDownByArea works on Pix, and is
+ * a plain box filter split into a vertical and a horizontal pass. The
+ * vertical pass, which does most of the work, is a multiply-accumulate of
+ * whole rows of bytes that the compiler can vectorize.
  *************************************************************************/
 
-#ifdef _MSC_VER
-#pragma warning(disable:4244)  // Conversion warnings
-#endif
-
 #include "mfcpch.h"
-#include          <stdlib.h>
 #include          <string.h>
-#include          "fileerr.h"
-#include          "tprintf.h"
-//#include          "grphics.h"
-#include          "img.h"
-//#include                                      "basefile.h"
-#include          "imgscale.h"
+#include          "allheaders.h"
+#include          "genericvector.h"
+#include          "host.h"
 #include          "scaleimg.h"
 
-void scale_image(                     //scale an image
-                 IMAGE &image,        //source image
-                 IMAGE &target_image  //target image
-                ) {
-  inT32 xsize, ysize, new_xsize, new_ysize;
-  IMAGELINE line, new_line;
-  int *hires, *lores, *oldhires, *oldlores;
-  int i, j, n, oldn, row, col;
-  int offset = 0;                //not used here
-  float factor;
-  uinT8 curr_colour, new_colour;
-  int dummy = -1;
-  IMAGE image2;                  //horiz scaled image
-
-  xsize = image.get_xsize ();
-  ysize = image.get_ysize ();
-  new_xsize = target_image.get_xsize ();
-  new_ysize = target_image.get_ysize ();
-  if (new_ysize > new_xsize)
-    new_line.init (new_ysize);
-  else
-    new_line.init (new_xsize);
-
-  factor = (float) xsize / (float) new_xsize;
-
-  hires = (int *) calloc (xsize, sizeof (int));
-  lores = (int *) calloc (new_xsize, sizeof (int));
-  oldhires = (int *) calloc (xsize, sizeof (int));
-  oldlores = (int *) calloc (new_xsize, sizeof (int));
-  if ((hires == NULL) || (lores == NULL) || (oldhires == NULL)
-  || (oldlores == NULL)) {
-    fprintf (stderr, "Calloc error in scale_image\n");
-    err_exit();
-  }
-
-  image2.create (new_xsize, ysize, image.get_bpp ());
-
-  oldn = 0;
-  /* do first row separately because hires[col-1] doesn't make sense here */
-  image.fast_get_line (0, 0, xsize, &line);
-  /* each line nominally begins with white */
-  curr_colour = 1;
-  n = 0;
-  for (i = 0; i < xsize; i++) {
-    new_colour = *(line.pixels + i);
-    if (new_colour != curr_colour) {
-      hires[n] = i;
-      n++;
-      curr_colour = new_colour;
-    }
-  }
-  if (offset != 0)
-    for (i = 0; i < n; i++)
-      hires[i] += offset;
-
-  if (n > new_xsize) {
-    tprintf ("Too many transitions (%d) on line 0\n", n);
-    scale_image_cop_out(image,
-                        target_image,
-                        factor,
-                        hires,
-                        lores,
-                        oldhires,
-                        oldlores);
-    return;
-  }
-  else if (n > 0)
-    dyn_prog (n, hires, lores, new_xsize, &dummy, &dummy, 0, factor);
-  else
-    lores[0] = new_xsize;
-
-  curr_colour = 1;
-  j = 0;
-  for (i = 0; i < new_xsize; i++) {
-    if (lores[j] == i) {
-      curr_colour = 1 - curr_colour;
-      j++;
-    }
-    *(new_line.pixels + i) = curr_colour;
-  }
-  image2.put_line (0, 0, new_xsize, &new_line, 0);
-
-  for (i = 0; i < n; i++) {
-    oldhires[i] = hires[i];
-    oldlores[i] = lores[i];
-  }
-
-  for (i = n; i < oldn; i++) {
-    oldhires[i] = 0;
-    oldlores[i] = 0;
-  }
-  oldn = n;
-
-  for (row = 1; row < ysize; row++) {
-    image.fast_get_line (0, row, xsize, &line);
-    /* each line nominally begins with white */
-    curr_colour = 1;
-    n = 0;
-    for (i = 0; i < xsize; i++) {
-      new_colour = *(line.pixels + i);
-      if (new_colour != curr_colour) {
-        hires[n] = i;
-        n++;
-        curr_colour = new_colour;
-      }
-    }
-    for (i = n; i < oldn; i++) {
-      hires[i] = 0;
-      lores[i] = 0;
-    }
-    if (offset != 0)
-      for (i = 0; i < n; i++)
-        hires[i] += offset;
-
-    if (n > new_xsize) {
-      tprintf ("Too many transitions (%d) on line %d\n", n, row);
-      scale_image_cop_out(image,
-                          target_image,
-                          factor,
-                          hires,
-                          lores,
-                          oldhires,
-                          oldlores);
-      return;
-    }
-    else if (n > 0)
-      dyn_prog(n, hires, lores, new_xsize, oldhires, oldlores, oldn, factor);
-    else
-      lores[0] = new_xsize;
-
-    curr_colour = 1;
-    j = 0;
-    for (i = 0; i < new_xsize; i++) {
-      if (lores[j] == i) {
-        curr_colour = 1 - curr_colour;
-        j++;
-      }
-      *(new_line.pixels + i) = curr_colour;
-    }
-    image2.put_line (0, row, new_xsize, &new_line, 0);
-
-    for (i = 0; i < n; i++) {
-      oldhires[i] = hires[i];
-      oldlores[i] = lores[i];
-    }
-    for (i = n; i < oldn; i++) {
-      oldhires[i] = 0;
-      oldlores[i] = 0;
-    }
-    oldn = n;
-  }
-
-  free(hires);
-  free(lores);
-  free(oldhires);
-  free(oldlores);
-
-  /* NOW DO THE VERTICAL SCALING from image2 to target_image*/
-
-  xsize = new_xsize;
-  factor = (float) ysize / (float) new_ysize;
-  offset = 0;
-
-  hires = (int *) calloc (ysize, sizeof (int));
-  lores = (int *) calloc (new_ysize, sizeof (int));
-  oldhires = (int *) calloc (ysize, sizeof (int));
-  oldlores = (int *) calloc (new_ysize, sizeof (int));
-  if ((hires == NULL) || (lores == NULL) || (oldhires == NULL)
-  || (oldlores == NULL)) {
-    fprintf (stderr, "Calloc error in scale_image (vert)\n");
-    err_exit();
-  }
-
-  oldn = 0;
-  /* do first col separately because hires[col-1] doesn't make sense here */
-  image2.get_column (0, 0, ysize, &line, 0);
-  /* each line nominally begins with white */
-  curr_colour = 1;
-  n = 0;
-  for (i = 0; i < ysize; i++) {
-    new_colour = *(line.pixels + i);
-    if (new_colour != curr_colour) {
-      hires[n] = i;
-      n++;
-      curr_colour = new_colour;
-    }
-  }
-
-  if (offset != 0)
-    for (i = 0; i < n; i++)
-      hires[i] += offset;
-
-  if (n > new_ysize) {
-    tprintf ("Too many transitions (%d) on column 0\n", n);
-    scale_image_cop_out(image,
-                        target_image,
-                        factor,
-                        hires,
-                        lores,
-                        oldhires,
-                        oldlores);
-    return;
-  }
-  else if (n > 0)
-    dyn_prog (n, hires, lores, new_ysize, &dummy, &dummy, 0, factor);
-  else
-    lores[0] = new_ysize;
-
-  curr_colour = 1;
-  j = 0;
-  for (i = 0; i < new_ysize; i++) {
-    if (lores[j] == i) {
-      curr_colour = 1 - curr_colour;
-      j++;
-    }
-    *(new_line.pixels + i) = curr_colour;
-  }
-  target_image.put_column (0, 0, new_ysize, &new_line, 0);
+namespace tesseract {
+
+// Weight of a source pixel wholly inside a destination pixel. Partly
+// covered ones weigh in proportion.
+const int kAreaOne = 256;
+// A pix stores its bytes in 32 bit words, most significant byte first, so
+// on a little-endian machine the byte of 8 bit pixel x is at x ^ 3. A 32
+// bit pixel is a whole word, so its channels need no swizzle.
+#ifdef L_BIG_ENDIAN
+const int kByteSwizzle = 0;
+#else
+const int kByteSwizzle = 3;
+#endif
 
-  for (i = 0; i < n; i++) {
-    oldhires[i] = hires[i];
-    oldlores[i] = lores[i];
+// The source pixels covered by one destination pixel along one axis.
+struct AreaSpan {
+  int start;    // First source pixel.
+  int count;    // Number of source pixels.
+  int weights;  // Index in the weights vector of the weight of the first.
+  int total;    // Sum of the weights.
+};
+
+// Splits src_size source pixels between dst_size destination pixels,
+// adding a span per destination pixel to spans and the weight of each
+// source pixel in it to weights.
+static void MakeAreaSpans(int src_size, int dst_size,
+                          GenericVector<AreaSpan>* spans,
+                          GenericVector<uinT32>* weights) {
+  inT64 end = 0;
+  for (int d = 0; d < dst_size; ++d) {
+    inT64 start = end;
+    end = static_cast<inT64>(d + 1) * src_size * kAreaOne / dst_size;
+    AreaSpan span;
+    span.start = static_cast<int>(start / kAreaOne);
+    span.weights = weights->size();
+    span.total = static_cast<int>(end - start);
+    for (int s = span.start; static_cast<inT64>(s) * kAreaOne < end; ++s) {
+      inT64 lo = static_cast<inT64>(s) * kAreaOne;
+      inT64 hi = lo + kAreaOne;
+      if (lo < start) lo = start;
+      if (hi > end) hi = end;
+      weights->push_back(static_cast<uinT32>(hi - lo));
+    }
+    span.count = weights->size() - span.weights;
+    spans->push_back(span);
   }
-  for (i = n; i < oldn; i++) {
-    oldhires[i] = 0;
-    oldlores[i] = 0;
-  }
-  oldn = n;
-
-  for (col = 1; col < xsize; col++) {
-    image2.get_column (col, 0, ysize, &line, 0);
-    /* each line nominally begins with white */
-    curr_colour = 1;
-    n = 0;
-    for (i = 0; i < ysize; i++) {
-      new_colour = *(line.pixels + i);
-      if (new_colour != curr_colour) {
-        hires[n] = i;
-        n++;
-        curr_colour = new_colour;
-      }
-    }
-    for (i = n; i < oldn; i++) {
-      hires[i] = 0;
-      lores[i] = 0;
-    }
-
-    if (offset != 0)
-      for (i = 0; i < n; i++)
-        hires[i] += offset;
-
-    if (n > new_ysize) {
-      tprintf ("Too many transitions (%d) on column %d\n", n, col);
-      scale_image_cop_out(image,
-                          target_image,
-                          factor,
-                          hires,
-                          lores,
-                          oldhires,
-                          oldlores);
-      return;
-    }
-    else if (n > 0)
-      dyn_prog(n, hires, lores, new_ysize, oldhires, oldlores, oldn, factor);
-    else
-      lores[0] = new_ysize;
+}
 
-    curr_colour = 1;
-    j = 0;
-    for (i = 0; i < new_ysize; i++) {
-      if (lores[j] == i) {
-        curr_colour = 1 - curr_colour;
-        j++;
+// Reduces pix to width x height by averaging the area under each pixel.
+Pix* ScaleDownByArea(Pix* pix, int width, int height) {
+  int src_width = pixGetWidth(pix);
+  int src_height = pixGetHeight(pix);
+  int depth = pixGetDepth(pix);
+  if ((depth != 8 && depth != 32) || width <= 0 || height <= 0 ||
+      width > src_width || height > src_height)
+    return NULL;
+  int channels = depth / 8;
+  int swizzle = channels == 1 ? kByteSwizzle : 0;
+  GenericVector<AreaSpan> x_spans, y_spans;
+  GenericVector<uinT32> x_weights, y_weights;
+  MakeAreaSpans(src_width, width, &x_spans, &x_weights);
+  MakeAreaSpans(src_height, height, &y_spans, &y_weights);
+
+  Pix* result = pixCreate(width, height, depth);
+  if (result == NULL)
+    return NULL;
+  const uinT8* src_data = reinterpret_cast<const uinT8*>(pixGetData(pix));
+  int src_bpl = pixGetWpl(pix) * sizeof(l_uint32);
+  uinT8* dst_data = reinterpret_cast<uinT8*>(pixGetData(result));
+  int dst_bpl = pixGetWpl(result) * sizeof(l_uint32);
+  // Weighted sums down the source rows of the current destination row,
+  // for every byte of a source row. At most 255 * total, which fits.
+  GenericVector<uinT32> column_sums;
+  column_sums.init_to_size(src_bpl, 0);
+  uinT32* sums = &column_sums[0];
+  for (int y = 0; y < height; ++y) {
+    const AreaSpan& y_span = y_spans[y];
+    memset(sums, 0, src_bpl * sizeof(*sums));
+    for (int s = 0; s < y_span.count; ++s) {
+      uinT32 weight = y_weights[y_span.weights + s];
+      const uinT8* src_line = src_data + (y_span.start + s) * src_bpl;
+      for (int i = 0; i < src_bpl; ++i)
+        sums[i] += weight * src_line[i];
+    }
+    uinT8* dst_line = dst_data + y * dst_bpl;
+    for (int x = 0; x < width; ++x) {
+      const AreaSpan& x_span = x_spans[x];
+      const uinT32* weights = &x_weights[x_span.weights];
+      uinT64 area = static_cast<uinT64>(x_span.total) * y_span.total;
+      for (int c = 0; c < channels; ++c) {
+        uinT64 sum = 0;
+        for (int s = 0; s < x_span.count; ++s) {
+          int byte = ((x_span.start + s) * channels + c) ^ swizzle;
+          sum += static_cast<uinT64>(weights[s]) * sums[byte];
+        }
+        dst_line[(x * channels + c) ^ swizzle] =
+            static_cast<uinT8>((sum + area / 2) / area);
       }
-      *(new_line.pixels + i) = curr_colour;
-    }
-    target_image.put_column (col, 0, new_ysize, &new_line, 0);
-
-    for (i = 0; i < n; i++) {
-      oldhires[i] = hires[i];
-      oldlores[i] = lores[i];
-    }
-    for (i = n; i < oldn; i++) {
-      oldhires[i] = 0;
-      oldlores[i] = 0;
     }
-    oldn = n;
   }
-  free(hires);
-  free(lores);
-  free(oldhires);
-  free(oldlores);
+  return result;
 }
 
-
-/**********************************************************************
- * scale_image_cop_out
- *
- * Cop-out of scale_image by doing it the easy way and free the data.
- **********************************************************************/
-
-void scale_image_cop_out(                      //scale an image
-                         IMAGE &image,         //source image
-                         IMAGE &target_image,  //target image
-                         float factor,         //scale factor
-                         int *hires,
-                         int *lores,
-                         int *oldhires,
-                         int *oldlores) {
-  inT32 xsize, ysize, new_xsize, new_ysize;
-
-  xsize = image.get_xsize ();
-  ysize = image.get_ysize ();
-  new_xsize = target_image.get_xsize ();
-  new_ysize = target_image.get_ysize ();
-
-  if (factor <= 0.5)
-    reduce_sub_image (&image, 0, 0, xsize, ysize,
-      &target_image, 0, 0, (inT32) (1.0 / factor), FALSE);
-  else if (factor >= 2)
-    enlarge_sub_image (&image, 0, 0, &target_image,
-        0, 0, new_xsize, new_ysize, (inT32) factor, FALSE);
-  else
-    copy_sub_image (&image, 0, 0, xsize, ysize, &target_image, 0, 0, FALSE);
-  free(hires);
-  free(lores);
-  free(oldhires);
-  free(oldlores);
-}
+}  // namespace tesseract.
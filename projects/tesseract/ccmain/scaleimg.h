@@ -1,6 +1,6 @@
 /**********************************************************************
  * File:        scaleimg.h  (Formerly scaleim.h)
- * Description: Smart scaling of images.
+ * Description: Fast area-averaging reduction of images.
  * Author:      Phil Cheatle
  * Created:     Wed Nov 18 16:12:03 GMT 1992
  *
@@ -20,16 +20,18 @@
 #ifndef           SCALEIMG_H
 #define           SCALEIMG_H
 
-void scale_image(                     //scale an image
-                 IMAGE &image,        //source image
-                 IMAGE &target_image  //target image
-                );
-void scale_image_cop_out(                      //scale an image
-                         IMAGE &image,         //source image
-                         IMAGE &target_image,  //target image
-                         float factor,         //scale factor
-                         int *hires,
-                         int *lores,
-                         int *oldhires,
-                         int *oldlores);
+struct Pix;
+
+namespace tesseract {
+
+// Returns a copy of the 8 bit grey or 32 bit colour pix reduced to width x
+// height, each pixel of which is the average of the area of pix it
+// covers, with partly covered source pixels weighted by the part covered.
+// The reduction may be by any factor, and by different ones in x and y,
+// but must not enlarge. Returns NULL on other depths or sizes.
+// The caller must pixDestroy the result.
+Pix* ScaleDownByArea(Pix* pix, int width, int height);
+
+}  // namespace tesseract.
+
 #endif
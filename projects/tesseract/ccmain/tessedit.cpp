@@ -167,9 +167,23 @@ bool Tesseract::init_tesseract_lang_data(
             static_cast<int>(tessedit_ocr_engine_mode));
   }
 
-  // Load the unicharset
-  if (!tessdata_manager.SeekToStart(TESSDATA_UNICHARSET) ||
-      !unicharset.load_from_file(tessdata_manager.GetDataFilePtr())) {
+  // Load the unicharset, from its compiled form if there is an up to date
+  // one, as that needs no parsing. The compiled form already holds the
+  // unichars that loading the ambigs inserts, so unless there are no ambigs
+  // it is only used along with up to date compiled ambigs.
+  bool compiled_unicharset =
+      tessdata_manager.GetComponentSize(TESSDATA_AMBIGS) < 0 ||
+      (!tessedit_ambigs_training &&
+       tessdata_manager.SeekToCompiledStart(TESSDATA_AMBIGS_BIN,
+                                            TESSDATA_AMBIGS));
+  compiled_unicharset = compiled_unicharset &&
+      tessdata_manager.SeekToCompiledStart(TESSDATA_UNICHARSET_BIN,
+                                           TESSDATA_UNICHARSET) &&
+      unicharset.load_from_binary(tessdata_manager.GetDataFilePtr(), false);
+  if (compiled_unicharset) {
+    if (tessdata_manager_debug_level) tprintf("Loaded compiled unicharset\n");
+  } else if (!tessdata_manager.SeekToStart(TESSDATA_UNICHARSET) ||
+             !unicharset.load_from_file(tessdata_manager.GetDataFilePtr())) {
     return false;
   }
   if (unicharset.size() > MAX_NUM_CLASSES) {
@@ -179,7 +193,16 @@ bool Tesseract::init_tesseract_lang_data(
   right_to_left_ = unicharset.any_right_to_left();
   if (tessdata_manager_debug_level) tprintf("Loaded unicharset\n");
 
-  if (!tessedit_ambigs_training &&
+  // The compiled ambigs refer to the unichars of the compiled unicharset,
+  // and leave it unchanged.
+  if (compiled_unicharset && !tessedit_ambigs_training &&
+      tessdata_manager.SeekToCompiledStart(TESSDATA_AMBIGS_BIN,
+                                           TESSDATA_AMBIGS) &&
+      unichar_ambigs.LoadCompiledAmbigs(tessdata_manager.GetDataFilePtr(),
+                                        use_ambigs_for_adaption,
+                                        unicharset)) {
+    if (tessdata_manager_debug_level) tprintf("Loaded compiled ambigs\n");
+  } else if (!tessedit_ambigs_training &&
       tessdata_manager.SeekToStart(TESSDATA_AMBIGS)) {
     unichar_ambigs.LoadUnicharAmbigs(
         tessdata_manager.GetDataFilePtr(),
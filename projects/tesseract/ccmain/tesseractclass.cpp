@@ -348,6 +348,39 @@ Tesseract::Tesseract()
                     " TessdataManager functions.", this->params()),
     double_MEMBER(min_orientation_margin, 12.0,
                   "Min acceptable orientation margin", this->params()),
+    BOOL_MEMBER(tessedit_degrade_on_deadline, false,
+                "On a deadline, skip optional stages instead of aborting",
+                this->params()),
+    INT_MEMBER(tessedit_degrade_reserve_ms, 50,
+               "Skip optional stages when this few msecs remain",
+               this->params()),
+    INT_MEMBER(cube_num_threads, 1,
+               "Threads running cube on a page, each with its own model copy",
+               this->params()),
+    INT_MEMBER(tessedit_target_dpi, 0,
+               "If non-zero, grey and colour images of a higher resolution are"
+               " scaled down to this many dpi before thresholding",
+               this->params()),
+    INT_MEMBER(tessedit_strip_size, 8192,
+               "Pages wider or taller than 32767 pixels, once scaled to"
+               " tessedit_target_dpi, are recognized in overlapping strips of"
+               " at most this many scaled pixels each way",
+               this->params()),
+    INT_MEMBER(tessedit_strip_overlap, 512,
+               "Pixels shared by neighbouring strips. Must exceed the size of"
+               " the largest word",
+               this->params()),
+    INT_MEMBER(tessedit_strip_threads, 0,
+               "Engines recognizing strips at once, 0 for one per processor",
+               this->params()),
+    BOOL_MEMBER(tessedit_memory_budget, false,
+                "Free the source image as soon as it is thresholded, and keep"
+                " a grey copy only if tessedit_keep_grey_image is set",
+                this->params()),
+    BOOL_MEMBER(tessedit_keep_grey_image, false,
+                "With tessedit_memory_budget, keep the grey image for"
+                " PageIterator::GetImage",
+                this->params()),
     backup_config_file_(NULL),
     pix_binary_(NULL),
     pix_grey_(NULL),
@@ -367,6 +400,8 @@ Tesseract::~Tesseract() {
     delete cube_cntxt_;
     cube_cntxt_ = NULL;
   }
+  cube_worker_cntxts_.delete_data_pointers();
+  cube_worker_cntxts_.clear();
   if (tess_cube_combiner_ != NULL) {
     delete tess_cube_combiner_;
     tess_cube_combiner_ = NULL;
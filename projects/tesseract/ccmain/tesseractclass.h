@@ -44,6 +44,7 @@ class WERD_CHOICE;
 class WERD;
 class BLOB_CHOICE_LIST_CLIST;
 struct OSResults;
+class BoxFileIndex;
 
 
 // Top-level class for all tesseract global instance data.
@@ -94,6 +95,8 @@ class CubeLineObject;
 class CubeObject;
 class CubeRecoContext;
 class TesseractCubeCombiner;
+class WordAltList;
+struct CubeWordJob;
 
 // A collection of various variables for statistics and debugging.
 struct TesseractStats {
@@ -174,6 +177,12 @@ class Tesseract : public Wordrec {
 
   int SegmentPage(const STRING* input_file, BLOCK_LIST* blocks,
                   Tesseract* osd_tess, OSResults* osr);
+  int FindPageBlocks(const STRING* input_file, BLOCK_LIST* blocks,
+                     TO_BLOCK_LIST* to_blocks,
+                     Tesseract* osd_tess, OSResults* osr,
+                     PageSegMode* pageseg_mode);
+  void TextordBlocks(PageSegMode pageseg_mode, BLOCK_LIST* blocks,
+                     TO_BLOCK_LIST* to_blocks);
   void SetupWordScripts(BLOCK_LIST* blocks);
   int AutoPageSeg(int resolution, bool single_column,
                   bool osd, bool only_osd,
@@ -183,11 +192,14 @@ class Tesseract : public Wordrec {
   //// control.h /////////////////////////////////////////////////////////
   bool ProcessTargetWord(const TBOX& word_box, const TBOX& target_word_box,
                          const char* word_config, int pass);
+  bool SkipOptionalStage(ETEXT_DESC* monitor, RecognitionStage stage,
+                         PAGE_RES* page_res);
   void recog_all_words(PAGE_RES* page_res,
                        ETEXT_DESC* monitor,
                        const TBOX* target_word_box,
                        const char* word_config,
-                       int dopasses);
+                       int dopasses,
+                       bool page_passes);
   void classify_word_pass1(                 //recog one word
                            WERD_RES *word,  //word to do
                            ROW *row,
@@ -232,12 +244,20 @@ class Tesseract : public Wordrec {
       BLOB_CHOICE_LIST_CLIST *blob_choices);  // detailed results
   void font_recognition_pass(  //good chars in word
                              PAGE_RES_IT &page_res_it);
+  void word_font_pass(PAGE_RES_IT &page_res_it);
+  void modal_font_pass(PAGE_RES_IT &page_res_it);
   BOOL8 check_debug_pt(WERD_RES *word, int location);
   //// cube_control.cpp ///////////////////////////////////////////////////
   bool init_cube_objects(bool load_combiner,
                          TessdataManager *tessdata_manager);
   void run_cube(PAGE_RES *page_res);
+  void cube_recognize_jobs(CubeRecoContext *cntxt,
+                           GenericVector<CubeWordJob> *jobs,
+                           int *next_job, CCUtilMutex *job_mutex);
+  bool cube_word_needed(WERD_RES *word);
   void cube_recognize(CubeObject *cube_obj, PAGE_RES_IT *page_res_it);
+  void cube_apply_result(CubeObject *cube_obj, WordAltList *cube_alt_list,
+                         PAGE_RES_IT *page_res_it);
   void fill_werd_res(const BoxWord& cube_box_word,
                      WERD_CHOICE* cube_werd_choice,
                      const char* cube_best_str,
@@ -452,6 +472,10 @@ class Tesseract : public Wordrec {
   // is not required before calling ApplyBoxTraining.
   PAGE_RES* ApplyBoxes(const STRING& fname, bool find_segmentation,
                        BLOCK_LIST *block_list);
+  // As ApplyBoxes above, but with the boxes of the given page of boxes, so a
+  // box file read once can serve all the pages of its image.
+  PAGE_RES* ApplyBoxes(const BoxFileIndex& boxes, int page,
+                       bool find_segmentation, BLOCK_LIST *block_list);
 
   // Builds a PAGE_RES from the block_list in the way required for ApplyBoxes:
   // All fuzzy spaces are removed, and all the words are maximally chopped.
@@ -757,6 +781,30 @@ class Tesseract : public Wordrec {
   // choice in OSResults::orientations) to believe the page orientation.
   double_VAR_H(min_orientation_margin, 12.0,
                "Min acceptable orientation margin");
+  BOOL_VAR_H(tessedit_degrade_on_deadline, false,
+             "On a deadline, skip optional stages instead of aborting");
+  INT_VAR_H(tessedit_degrade_reserve_ms, 50,
+            "Skip optional stages when this few msecs remain");
+  INT_VAR_H(cube_num_threads, 1,
+            "Threads running cube on a page, each with its own model copy");
+  INT_VAR_H(tessedit_target_dpi, 0,
+            "If non-zero, grey and colour images of a higher resolution are"
+            " scaled down to this many dpi before thresholding");
+  INT_VAR_H(tessedit_strip_size, 8192,
+            "Pages wider or taller than 32767 pixels, once scaled to"
+            " tessedit_target_dpi, are recognized in overlapping strips of"
+            " at most this many scaled pixels each way");
+  INT_VAR_H(tessedit_strip_overlap, 512,
+            "Pixels shared by neighbouring strips. Must exceed the size of"
+            " the largest word");
+  INT_VAR_H(tessedit_strip_threads, 0,
+            "Engines recognizing strips at once, 0 for one per processor");
+  BOOL_VAR_H(tessedit_memory_budget, false,
+             "Free the source image as soon as it is thresholded, and keep"
+             " a grey copy only if tessedit_keep_grey_image is set");
+  BOOL_VAR_H(tessedit_keep_grey_image, false,
+             "With tessedit_memory_budget, keep the grey image for"
+             " PageIterator::GetImage");
 
   //// ambigsrecog.cpp /////////////////////////////////////////////////////////
   FILE *init_recog_training(const STRING &fname);
@@ -794,6 +842,9 @@ class Tesseract : public Wordrec {
   TesseractStats stats_;
   // Cube objects.
   CubeRecoContext* cube_cntxt_;
+  // Extra contexts for cube_num_threads > 1. The classifier keeps its
+  // working buffers in the context, so no two threads may share one.
+  GenericVector<CubeRecoContext*> cube_worker_cntxts_;
   TesseractCubeCombiner *tess_cube_combiner_;
 
 private: // some methods to write more outputs
@@ -25,15 +25,20 @@
 
 #include "img.h"
 #include "otsuthr.h"
+#include "scaleimg.h"
 
 namespace tesseract {
 
+// Images are only scaled down to the target resolution if they are at
+// least this much above it, as a small reduction costs more than it saves.
+const float kMinScaleDownRatio = 1.2f;
+
 ImageThresholder::ImageThresholder()
   : pix_(NULL),
     image_data_(NULL),
     image_width_(0), image_height_(0),
     image_bytespp_(0), image_bytespl_(0),
-    scale_(1), yres_(300) {
+    scale_(1.0f), yres_(300), target_yres_(0), work_bytes_(0) {
   SetRectangle(0, 0, 0, 0);
 }
 
@@ -78,7 +83,7 @@ void ImageThresholder::SetImage(const unsigned char* imagedata,
   image_height_ = height;
   image_bytespp_ = bytes_per_pixel;
   image_bytespl_ = bytes_per_line;
-  scale_ = 1;
+  scale_ = 1.0f;
   yres_ = 300;
   Init();
 }
@@ -128,7 +133,7 @@ void ImageThresholder::SetImage(const Pix* pix) {
   depth = pixGetDepth(pix_);
   image_bytespp_ = depth / 8;
   image_bytespl_ = pixGetWpl(pix_) * sizeof(l_uint32);
-  scale_ = 1;
+  scale_ = 1.0f;
   yres_ = pixGetYRes(src);
   Init();
 }
@@ -137,6 +142,9 @@ void ImageThresholder::SetImage(const Pix* pix) {
 // Creates a Pix and sets pix to point to the resulting pointer.
 // Caller must use pixDestroy to free the created Pix.
 void ImageThresholder::ThresholdToPix(Pix** pix) {
+  work_bytes_ = 0;
+  if (ThresholdScaledToPix(pix))
+    return;
   if (pix_ != NULL) {
     if (image_bytespp_ == 0) {
       // We have a binary image, so it just has to be cloned.
@@ -152,6 +160,9 @@ void ImageThresholder::ThresholdToPix(Pix** pix) {
         // buffer to the raw interface to complete the conversion.
         IMAGE temp_image;
         temp_image.FromPix(pix_);
+        work_bytes_ = static_cast<size_t>(
+            COMPUTE_IMAGE_XDIM(temp_image.get_xsize(), temp_image.get_bpp())) *
+            temp_image.get_ysize();
         OtsuThresholdRectToPix(temp_image.get_buffer(),
                                image_bytespp_,
                                COMPUTE_IMAGE_XDIM(temp_image.get_xsize(),
@@ -174,6 +185,58 @@ void ImageThresholder::Init() {
   SetRectangle(0, 0, image_width_, image_height_);
 }
 
+// Scales the source rectangle down to the target resolution with an area
+// average, which keeps the edges of the text, and thresholds the result.
+// The rectangle and image sizes stay those of the source, so that callers
+// can map results back to it with scale_.
+bool ImageThresholder::ThresholdScaledToPix(Pix** pix) {
+  scale_ = 1.0f;
+  float scale = TargetScaleFactor(IsBinary(), yres_, target_yres_);
+  if (scale == 1.0f)
+    return false;
+  int width = MAX(static_cast<int>(rect_width_ * scale + 0.5f), 1);
+  int height = MAX(static_cast<int>(rect_height_ * scale + 0.5f), 1);
+  Pix* rect_pix = GetPixRect();
+  Pix* scaled_pix = ScaleDownByArea(rect_pix, width, height);
+  // A cropped rectangle is a copy, and a full image only a clone.
+  size_t rect_bytes = IsFullImage() ? 0 : PixBytes(rect_pix);
+  pixDestroy(&rect_pix);
+  if (scaled_pix == NULL)
+    return false;
+  size_t scaled_bytes = PixBytes(scaled_pix);
+  ImageThresholder scaled_thresholder;
+  scaled_thresholder.SetImage(scaled_pix);
+  pixDestroy(&scaled_pix);
+  scaled_thresholder.ThresholdToPix(pix);
+  work_bytes_ = scaled_bytes + MAX(rect_bytes,
+                                   scaled_thresholder.GetWorkBytes());
+  scale_ = scale;
+  int xres = pix_ != NULL ? pixGetXRes(pix_) : yres_;
+  pixSetResolution(*pix, static_cast<int>(xres * scale + 0.5f), target_yres_);
+  return true;
+}
+
+float ImageThresholder::TargetScaleFactor(bool binary, int yres,
+                                          int target_yres) {
+  if (target_yres <= 0 || binary || yres < target_yres * kMinScaleDownRatio)
+    return 1.0f;
+  return static_cast<float>(target_yres) / yres;
+}
+
+size_t ImageThresholder::GetSourceBytes() const {
+  if (pix_ != NULL)
+    return PixBytes(pix_);
+  return image_data_ != NULL ?
+      static_cast<size_t>(image_bytespl_) * image_height_ : 0;
+}
+
+size_t ImageThresholder::PixBytes(Pix* pix) {
+  if (pix == NULL)
+    return 0;
+  return static_cast<size_t>(pixGetWpl(pix)) * sizeof(l_uint32) *
+      pixGetHeight(pix);
+}
+
 // Get a clone/copy of the source image rectangle.
 // The returned Pix must be pixDestroyed.
 // This function will be used in the future by the page layout analysis, and
@@ -20,6 +20,8 @@
 #ifndef TESSERACT_CCMAIN_THRESHOLDER_H__
 #define TESSERACT_CCMAIN_THRESHOLDER_H__
 
+#include <stddef.h>
+
 class IMAGE;
 struct Pix;
 
@@ -76,16 +78,43 @@ class ImageThresholder {
     return image_bytespp_ == 0;
   }
 
-  int GetScaleFactor() const {
+  /// Size of the thresholded image over that of the source rectangle. Any
+  /// coordinates in the thresholded image must be divided by it to get
+  /// coordinates in the source rectangle.
+  float GetScaleFactor() const {
     return scale_;
   }
   int GetSourceYResolution() const {
     return yres_;
   }
   int GetScaledYResolution() const {
-    return scale_ * yres_;
+    return static_cast<int>(scale_ * yres_ + 0.5f);
   }
 
+  /// Bytes of the source image as held, after any conversion made by
+  /// SetImage. A raw image is counted although it is not owned.
+  size_t GetSourceBytes() const;
+  /// Bytes of the largest temporary image made by the last ThresholdToPix,
+  /// such as the scaled-down copy, on top of the source and the result.
+  size_t GetWorkBytes() const {
+    return work_bytes_;
+  }
+  /// Returns the bytes of pixel data in pix, or 0 if it is NULL.
+  static size_t PixBytes(Pix* pix);
+
+  /// Sets the resolution in dpi that ThresholdToPix scales grey and colour
+  /// images of a higher resolution down to before thresholding them, or 0
+  /// to threshold them at their own. Accuracy peaks at about 300 dpi, so
+  /// thresholding 400-600 dpi scans at their own resolution mostly costs
+  /// time in every later stage.
+  void SetTargetResolution(int target_yres) {
+    target_yres_ = target_yres;
+  }
+  /// Returns the scale factor ThresholdToPix uses for a source image of
+  /// the given y resolution, binary or not, with the given target
+  /// resolution, or 1 if it is not scaled down.
+  static float TargetScaleFactor(bool binary, int yres, int target_yres);
+
   /// Pix vs raw, which to use?
   /// Implementations should provide the ability to source and target Pix
   /// where possible. A future version of Tesseract may choose to use Pix
@@ -122,6 +151,11 @@ class ImageThresholder {
   /// Common initialization shared between SetImage methods.
   virtual void Init();
 
+  /// If the target resolution calls for it, scales the source rectangle
+  /// down and thresholds that to the output Pix, setting scale_. Returns
+  /// false, leaving pix alone and scale_ at 1, otherwise.
+  bool ThresholdScaledToPix(Pix** pix);
+
   /// Return true if we are processing the full image.
   bool IsFullImage() const {
     return rect_left_ == 0 && rect_top_ == 0 &&
@@ -156,8 +190,10 @@ class ImageThresholder {
   int                  image_bytespp_;  //< Bytes per pixel of source image/pix.
   int                  image_bytespl_;  //< Bytes per line of source image/pix.
   // Limits of image rectangle to be processed.
-  int                  scale_;          //< Scale factor from original image.
+  float                scale_;          //< Scale factor from original image.
   int                  yres_;           //< y pixels/inch in source image
+  int                  target_yres_;    //< Resolution to scale down to, or 0.
+  size_t               work_bytes_;     //< Temporary bytes of last threshold.
   int                  rect_left_;
   int                  rect_top_;
   int                  rect_width_;
@@ -84,6 +84,7 @@ int decreasing_top_order(  //
 void BLOCK::rotate(const FCOORD& rotation) {
   poly_block()->rotate(rotation);
   box = *poly_block()->bounding_box();
+  clear_mask();
 }
 
 /**
@@ -134,6 +135,7 @@ void BLOCK::compress() {  // squash it up
   icoordelt_it.set_to_list (&rightside);
   icoordelt_it.add_to_end (new ICOORDELT (box.right (), box.bottom ()));
   icoordelt_it.add_to_end (new ICOORDELT (box.right (), box.top ()));
+  clear_mask();
 }
 
 
@@ -40,6 +40,7 @@ PAGE_RES::PAGE_RES(
   char_count = 0;
   rej_count = 0;
   rejected = FALSE;
+  skipped_stages = 0;
 
   for (block_it.mark_cycle_pt();
        !block_it.cycled_list(); block_it.forward()) {
@@ -55,8 +55,11 @@ class PAGE_RES {                 // page result
   // Updated every time PAGE_RES_IT iterating on this PAGE_RES moves to
   // the next word. This pointer is not owned by PAGE_RES class.
   WERD_CHOICE **prev_word_best_choice;
+  // Bitwise OR of the tesseract::RecognitionStage values that were left
+  // out of this page to meet a deadline.
+  inT32 skipped_stages;
 
-  PAGE_RES() {
+  PAGE_RES() : skipped_stages(0) {
   }                            // empty constructor
 
   PAGE_RES(BLOCK_LIST *block_list,   // real blocks
@@ -56,6 +56,7 @@ inT16 ymax):    box (ICOORD (xmin, ymin), ICOORD (xmax, ymax)) {
   right_it.add_to_end (new ICOORDELT (xmax, ymin));
   right_it.add_to_end (new ICOORDELT (xmax, ymax));
   index_ = 0;
+  mask_ = NULL;
 }
 
 
@@ -79,6 +80,7 @@ void PDBLK::set_sides(                       //set vertex lists
   rightside.clear ();
   right_it.move_to_first ();
   right_it.add_list_before (right);
+  clear_mask();
 }
 
 
@@ -126,11 +128,17 @@ void PDBLK::move(                  // reposition block
     *(it.data ()) += vec;
 
   box.move (vec);
+  clear_mask();
 }
 
 // Returns a binary Pix mask with a 1 pixel for every pixel within the
 // block. Rotates the coordinate system by rerotation prior to rendering.
+// Rasterizing the polygon costs far more than copying the result, so the
+// mask is kept for the next call.
 Pix* PDBLK::render_mask(const FCOORD& rerotation) {
+  if (mask_ != NULL && mask_rotation_ == rerotation)
+    return pixCopy(NULL, mask_);
+  clear_mask();
   TBOX rotated_box(box);
   rotated_box.rotate(rerotation);
   Pix* pix = pixCreate(rotated_box.width(), rotated_box.height(), 1);
@@ -167,7 +175,15 @@ Pix* PDBLK::render_mask(const FCOORD& rerotation) {
     pixRasterop(pix, 0, 0, rotated_box.width(), rotated_box.height(),
                 PIX_SET, NULL, 0, 0);
   }
-  return pix;
+  mask_ = pix;
+  mask_rotation_ = rerotation;
+  return pixCopy(NULL, mask_);
+}
+
+// Frees the mask kept by render_mask.
+void PDBLK::clear_mask() {
+  if (mask_ != NULL)
+    pixDestroy(&mask_);
 }
 
 
@@ -277,6 +293,7 @@ const PDBLK & source             //from this
   leftside.deep_copy(&source.leftside, &ICOORDELT::deep_copy);
   rightside.deep_copy(&source.rightside, &ICOORDELT::deep_copy);
   box = source.box;
+  clear_mask();
   return *this;
 }
 
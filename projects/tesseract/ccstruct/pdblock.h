@@ -41,6 +41,7 @@ class PDBLK
     PDBLK() {
       hand_poly = NULL;
       index_ = 0;
+      mask_ = NULL;
     }
     ///simple constructor
     PDBLK(inT16 xmin,  //< bottom left
@@ -57,6 +58,7 @@ class PDBLK
     ///destructor
     ~PDBLK () {
       if (hand_poly) delete hand_poly;
+      clear_mask();
     }
 
     POLY_BLOCK *poly_block() {
@@ -65,6 +67,7 @@ class PDBLK
     ///set the poly block
     void set_poly_block(POLY_BLOCK *blk) {
       hand_poly = blk;
+      clear_mask();
     }
     ///get box
     void bounding_box(ICOORD &bottom_left,        //bottom left
@@ -92,7 +95,13 @@ class PDBLK
 
     // Returns a binary Pix mask with a 1 pixel for every pixel within the
     // block. Rotates the coordinate system by rerotation prior to rendering.
+    // The mask is kept, so it is rendered again only for a different
+    // rerotation or after the block changes. Each call returns a copy,
+    // which the caller must pixDestroy.
     Pix* render_mask(const FCOORD& rerotation);
+    // Frees the mask kept by render_mask. Anything that changes the outline
+    // of the block must call it.
+    void clear_mask();
     ///draw histogram
     ///@param window window to draw in
     ///@param serial serial number
@@ -117,6 +126,8 @@ class PDBLK
     ICOORDELT_LIST rightside;    //< right side vertices
     TBOX box;                    //< bounding box
     int index_;                  //< Serial number of this block.
+    Pix* mask_;                  //< Kept by render_mask.
+    FCOORD mask_rotation_;       //< Rerotation mask_ was rendered with.
 };
 
 class DLLSYM BLOCK_RECT_IT       //rectangle iterator
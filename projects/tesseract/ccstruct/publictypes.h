@@ -144,6 +144,28 @@ enum OcrEngineMode {
                                 // default OEM_TESSERACT_ONLY.
 };
 
+// The optional stages of recognition that may be left out of a page when
+// tessedit_degrade_on_deadline is set and the time budget runs short, and
+// the strips left out of a page recognized in strips.
+// TessBaseAPI::GetSkippedStages returns a bitwise OR of these.
+enum RecognitionStage {
+  RS_PASS2         = 1,   // Pass 2 re-classification, for some or all words.
+  RS_FUZZY_SPACES  = 2,   // fix_fuzzy_spaces.
+  RS_CUBE          = 4,   // Cube recognition and combining.
+  RS_FONTS         = 8,   // font_recognition_pass.
+  RS_STRIPS        = 16   // Strips that failed or ran out of time.
+};
+
+// The text formats of the page results. TessBaseAPI::RenderText takes an
+// array of buffers indexed by these.
+enum TextFormat {
+  TF_UTF8,   // As TessBaseAPI::GetUTF8Text.
+  TF_HOCR,   // As TessBaseAPI::GetHOCRText.
+  TF_BOX,    // As TessBaseAPI::GetBoxText.
+  TF_UNLV,   // As TessBaseAPI::GetUNLVText.
+  TF_COUNT
+};
+
 }  // namespace tesseract.
 
 #endif  // TESSERACT_CCSTRUCT_PUBLICTYPES_H__
@@ -198,6 +198,25 @@ void WERD_CHOICE::string_and_lengths(const UNICHARSET &current_unicharset,
   }
 }
 
+/**
+ * build_unichar_text
+ *
+ * Converts unichar_ids_ to unichar_string_ and unichar_lengths_ with the
+ * unicharset given to populate_unichars(), unless that has already been
+ * done since. Both are left empty if there is no unicharset.
+ */
+void WERD_CHOICE::build_unichar_text() const {
+  if (unichar_text_built_)
+    return;
+  if (unicharset_ != NULL) {
+    string_and_lengths(*unicharset_, &unichar_string_, &unichar_lengths_);
+  } else {
+    unichar_string_ = "";
+    unichar_lengths_ = "";
+  }
+  unichar_text_built_ = true;
+}
+
 /**
  * append_unichar_id
  *
@@ -249,8 +268,10 @@ WERD_CHOICE & WERD_CHOICE::operator+= (const WERD_CHOICE & second) {
              second.permuter() != permuter_) {
     permuter_ = COMPOUND_PERM;
   }
-  unichar_string_ += second.unichar_string();
-  unichar_lengths_ += second.unichar_lengths();
+  // The text is rebuilt from the combined unichar ids when next needed.
+  if (unicharset_ == NULL)
+    unicharset_ = second.unicharset_;
+  unichar_text_built_ = false;
 
   // Append a deep copy of second blob_choices if it exists.
   if (second.blob_choices_ != NULL) {
@@ -302,8 +323,8 @@ WERD_CHOICE& WERD_CHOICE::operator=(const WERD_CHOICE& source) {
   certainty_ = source.certainty();
   permuter_ = source.permuter();
   fragment_mark_ = source.fragment_mark();
-  unichar_string_ = source.unichar_string();
-  unichar_lengths_ = source.unichar_lengths();
+  unicharset_ = source.unicharset_;
+  unichar_text_built_ = false;
 
   // Delete existing blob_choices
   this->delete_blob_choices();
@@ -359,7 +380,7 @@ const void WERD_CHOICE::print(const char *msg) const {
     tprintf(" fragment_mark_ true");
   }
   tprintf("\n");
-  if (unichar_string_.length() > 0) {
+  if (unichar_string().length() > 0) {
     tprintf("unichar_string_ %s unichar_lengths_ %s\n",
             unichar_string_.string(), unichar_lengths_.string());
   }
@@ -243,8 +243,8 @@ class WERD_CHOICE {
     permuter_ = NO_PERM;
     fragment_mark_ = false;
     blob_choices_ = NULL;
-    unichar_string_ = "";
-    unichar_lengths_ = "";
+    unicharset_ = NULL;
+    unichar_text_built_ = false;
   }
 
   /// Helper function to build a WERD_CHOICE from the given string,
@@ -262,8 +262,7 @@ class WERD_CHOICE {
     rating_ = kBadRating;
     certainty_ = -MAX_FLOAT32;
     fragment_mark_ = false;
-    unichar_string_ = "";
-    unichar_lengths_ = "";
+    unichar_text_built_ = false;
   }
 
   /// This function assumes that there is enough space reserved
@@ -306,22 +305,25 @@ class WERD_CHOICE {
     }
     return word_str;
   }
-  /// Since this function walks over the whole word to convert unichar ids
-  /// to unichars, it is best to call it once, e.g. after all changes to
-  /// unichar_ids_ in WERD_CHOICE are finished.
+  /// Records the unicharset that unichar_string() and unichar_lengths()
+  /// convert unichar ids with. The conversion itself is deferred until one
+  /// of them is called, so choices whose text is never looked at (most of
+  /// those made during the segmentation search) cost nothing here. Call it
+  /// again after changing unichar_ids_ to discard any text already built.
   void populate_unichars(const UNICHARSET &current_unicharset) {
-    this->string_and_lengths(current_unicharset, &unichar_string_,
-                             &unichar_lengths_);
+    unicharset_ = &current_unicharset;
+    unichar_text_built_ = false;
   }
-  /// Undoes populate_unichars, so that unichar_string_ and unichar_lengths_
-  /// are empty.
+  /// Undoes populate_unichars, so that unichar_string() and
+  /// unichar_lengths() are empty.
   void depopulate_unichars() {
-    unichar_string_ = "";
-    unichar_lengths_ = "";
+    unicharset_ = NULL;
+    unichar_text_built_ = false;
   }
   /// This function should only be called if populate_unichars()
   /// was called and WERD_CHOICE did not change since then.
   const STRING &unichar_string() const {
+    build_unichar_text();
     assert(unichar_string_.length() <= 0 ||
            unichar_string_.length() >= length_);  // sanity check
     return unichar_string_;
@@ -329,6 +331,7 @@ class WERD_CHOICE {
   /// This function should only be called if populate_unichars()
   /// was called and WERD_CHOICE did not change since then.
   const STRING &unichar_lengths() const {
+    build_unichar_text();
     assert(unichar_lengths_.length() <= 0 ||
            unichar_lengths_.length() == length_);  // sanity check
     return unichar_lengths_;
@@ -354,14 +357,18 @@ class WERD_CHOICE {
                              // contained a fragment
   BLOB_CHOICE_LIST_CLIST *blob_choices_;  // best choices for each blob
 
-  // The following variables are only populated by calling populate_unichars().
-  // They are not synchronized with the values in unichar_ids otherwise.
-  STRING unichar_string_;
-  STRING unichar_lengths_;
-  bool unichar_info_present;
+  // Set by populate_unichars(). The text below is built from unichar_ids_
+  // with it on the first call to unichar_string() or unichar_lengths()
+  // afterwards, and is not synchronized with unichar_ids_ otherwise.
+  const UNICHARSET *unicharset_;
+  mutable bool unichar_text_built_;
+  mutable STRING unichar_string_;
+  mutable STRING unichar_lengths_;
 
  private:
   void delete_blob_choices();
+  // Fills in unichar_string_ and unichar_lengths_ if they are out of date.
+  void build_unichar_text() const;
 };
 
 // Make WERD_CHOICE listable.
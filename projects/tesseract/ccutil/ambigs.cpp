@@ -20,6 +20,7 @@
 
 #include "ambigs.h"
 #include "helpers.h"
+#include "serialis.h"
 
 #ifdef WIN32
 #define strtok_r strtok_s
@@ -44,10 +45,13 @@ void UnicharAmbigs::LoadUnicharAmbigs(FILE *AmbigFile,
                                       UNICHARSET *unicharset) {
   int i, j;
   UnicharIdVector *adaption_ambigs_entry;
+  // Built per unichar while reading, then packed into definite_ambig_ids_.
+  GenericVector<UnicharIdVector *> one_to_one_definite_ambigs;
+  Clear();
   for (i = 0; i < unicharset->size(); ++i) {
     replace_ambigs_.push_back(NULL);
     dang_ambigs_.push_back(NULL);
-    one_to_one_definite_ambigs_.push_back(NULL);
+    one_to_one_definite_ambigs.push_back(NULL);
     if (use_ambigs_for_adaption) {
       ambigs_for_adaption_.push_back(NULL);
       reverse_ambigs_for_adaption_.push_back(NULL);
@@ -96,13 +100,13 @@ void UnicharAmbigs::LoadUnicharAmbigs(FILE *AmbigFile,
                     ReplacementAmbigPartSize, ReplacementString, type,
                     ambig_spec, unicharset);
 
-    // Update one_to_one_definite_ambigs_.
+    // Update one_to_one_definite_ambigs.
     if (TestAmbigPartSize == 1 &&
         ReplacementAmbigPartSize == 1 && type == DEFINITE_AMBIG) {
-      if (one_to_one_definite_ambigs_[TestUnicharIds[0]] == NULL) {
-        one_to_one_definite_ambigs_[TestUnicharIds[0]] = new UnicharIdVector();
+      if (one_to_one_definite_ambigs[TestUnicharIds[0]] == NULL) {
+        one_to_one_definite_ambigs[TestUnicharIds[0]] = new UnicharIdVector();
       }
-      one_to_one_definite_ambigs_[TestUnicharIds[0]]->push_back(
+      one_to_one_definite_ambigs[TestUnicharIds[0]]->push_back(
           ambig_spec->correct_ngram_id);
     }
     // Update ambigs_for_adaption_.
@@ -138,20 +142,17 @@ void UnicharAmbigs::LoadUnicharAmbigs(FILE *AmbigFile,
   }
   delete[] buffer;
 
-  // Fill in reverse_ambigs_for_adaption from ambigs_for_adaption vector.
-  if (use_ambigs_for_adaption) {
-    for (i = 0; i < ambigs_for_adaption_.size(); ++i) {
-      adaption_ambigs_entry = ambigs_for_adaption_[i];
-      if (adaption_ambigs_entry == NULL) continue;
-      for (j = 0; j < adaption_ambigs_entry->size(); ++j) {
-        UNICHAR_ID ambig_id = (*adaption_ambigs_entry)[j];
-        if (reverse_ambigs_for_adaption_[ambig_id] == NULL) {
-          reverse_ambigs_for_adaption_[ambig_id] = new UnicharIdVector();
-        }
-        reverse_ambigs_for_adaption_[ambig_id]->push_back(i);
-      }
-    }
+  // Pack one_to_one_definite_ambigs into definite_ambig_ids_.
+  for (i = 0; i < one_to_one_definite_ambigs.size(); ++i) {
+    definite_ambig_starts_.push_back(definite_ambig_ids_.size());
+    if (one_to_one_definite_ambigs[i] == NULL) continue;
+    for (j = 0; j < one_to_one_definite_ambigs[i]->size(); ++j)
+      definite_ambig_ids_.push_back((*one_to_one_definite_ambigs[i])[j]);
   }
+  definite_ambig_starts_.push_back(definite_ambig_ids_.size());
+  one_to_one_definite_ambigs.delete_data_pointers();
+
+  if (use_ambigs_for_adaption) BuildReverseAmbigsForAdaption();
 
   // Print what was read from the input file.
   if (debug_level > 1) {
@@ -198,6 +199,213 @@ void UnicharAmbigs::LoadUnicharAmbigs(FILE *AmbigFile,
   }
 }
 
+void UnicharAmbigs::Clear() {
+  replace_ambigs_.delete_data_pointers();
+  replace_ambigs_.clear();
+  dang_ambigs_.delete_data_pointers();
+  dang_ambigs_.clear();
+  definite_ambig_starts_.clear();
+  definite_ambig_ids_.clear();
+  ambigs_for_adaption_.delete_data_pointers();
+  ambigs_for_adaption_.clear();
+  reverse_ambigs_for_adaption_.delete_data_pointers();
+  reverse_ambigs_for_adaption_.clear();
+}
+
+void UnicharAmbigs::BuildReverseAmbigsForAdaption() {
+  for (int i = 0; i < ambigs_for_adaption_.size(); ++i) {
+    const UnicharIdVector *adaption_ambigs_entry = ambigs_for_adaption_[i];
+    if (adaption_ambigs_entry == NULL) continue;
+    for (int j = 0; j < adaption_ambigs_entry->size(); ++j) {
+      UNICHAR_ID ambig_id = (*adaption_ambigs_entry)[j];
+      if (reverse_ambigs_for_adaption_[ambig_id] == NULL) {
+        reverse_ambigs_for_adaption_[ambig_id] = new UnicharIdVector();
+      }
+      reverse_ambigs_for_adaption_[ambig_id]->push_back(i);
+    }
+  }
+}
+
+// Writes the specs of the given table in table order, each list in its
+// sorted order.
+static void WriteCompiledAmbigTable(const UnicharAmbigsVector &table,
+                                    FILE *file) {
+  inT32 num_specs = 0;
+  for (int i = 0; i < table.size(); ++i) {
+    if (table[i] != NULL) num_specs += table[i]->length();
+  }
+  fwrite(&num_specs, sizeof(num_specs), 1, file);
+  for (int i = 0; i < table.size(); ++i) {
+    if (table[i] == NULL) continue;
+    AmbigSpec_IT spec_it(table[i]);
+    for (spec_it.mark_cycle_pt(); !spec_it.cycled_list(); spec_it.forward()) {
+      const AmbigSpec *spec = spec_it.data();
+      inT32 size = spec->wrong_ngram_size;
+      inT32 type = spec->type;
+      inT32 correct_ngram_id = spec->correct_ngram_id;
+      fwrite(&size, sizeof(size), 1, file);
+      fwrite(&type, sizeof(type), 1, file);
+      fwrite(&correct_ngram_id, sizeof(correct_ngram_id), 1, file);
+      fwrite(spec->wrong_ngram, sizeof(spec->wrong_ngram[0]), size, file);
+      fwrite(spec->correct_fragments, sizeof(spec->correct_fragments[0]),
+             size, file);
+    }
+  }
+}
+
+// Writes a vector per unichar as an array of start indices followed by
+// the contents of all of them, as in definite_ambig_ids_.
+static void WriteCompiledIdVectors(
+    const GenericVector<UnicharIdVector *> &vectors, int num_unichars,
+    FILE *file) {
+  inT32 start = 0;
+  for (int i = 0; i < num_unichars; ++i) {
+    fwrite(&start, sizeof(start), 1, file);
+    if (i < vectors.size() && vectors[i] != NULL) start += vectors[i]->size();
+  }
+  fwrite(&start, sizeof(start), 1, file);
+  for (int i = 0; i < num_unichars && i < vectors.size(); ++i) {
+    if (vectors[i] == NULL) continue;
+    for (int j = 0; j < vectors[i]->size(); ++j) {
+      inT32 id = (*vectors[i])[j];
+      fwrite(&id, sizeof(id), 1, file);
+    }
+  }
+}
+
+// The compiled form is one block (see serialis.h) holding the number of
+// unichars, the replaceable and dangerous tables, and then the definite
+// and adaption ambigs in the layout of definite_ambig_ids_.
+bool UnicharAmbigs::SaveCompiledAmbigs(FILE *file,
+                                       const UNICHARSET &unicharset) const {
+  ASSERT_HOST(ambigs_for_adaption_.size() == dang_ambigs_.size());
+  long start = BeginCompiledBlock(file);
+  inT32 num_unichars = unicharset.size();
+  fwrite(&num_unichars, sizeof(num_unichars), 1, file);
+  WriteCompiledAmbigTable(replace_ambigs_, file);
+  WriteCompiledAmbigTable(dang_ambigs_, file);
+  inT32 num_definite_ambigs = definite_ambig_ids_.size();
+  fwrite(&definite_ambig_starts_[0], sizeof(inT32), dang_ambigs_.size(),
+         file);
+  for (int i = dang_ambigs_.size(); i <= num_unichars; ++i)
+    fwrite(&num_definite_ambigs, sizeof(num_definite_ambigs), 1, file);
+  if (num_definite_ambigs > 0) {
+    fwrite(&definite_ambig_ids_[0], sizeof(definite_ambig_ids_[0]),
+           num_definite_ambigs, file);
+  }
+  WriteCompiledIdVectors(ambigs_for_adaption_, num_unichars, file);
+  return EndCompiledBlock(file, start);
+}
+
+// Reads count unichar ids into ids, checking that they are in range.
+static bool ReadCompiledIds(const char *data, int size, int *pos, int count,
+                            int num_unichars, UNICHAR_ID *ids) {
+  if (!ReadCompiledArray(data, size, pos, count, ids)) return false;
+  for (int i = 0; i < count; ++i) {
+    if (ids[i] < 0 || ids[i] >= num_unichars) return false;
+  }
+  return true;
+}
+
+// Reads the table written by WriteCompiledAmbigTable into table, which
+// must have a NULL entry per unichar.
+static bool ReadCompiledAmbigTable(const char *data, int size, int *pos,
+                                   UnicharAmbigsVector *table) {
+  inT32 num_specs;
+  if (!ReadCompiledValue(data, size, pos, &num_specs)) return false;
+  for (int s = 0; s < num_specs; ++s) {
+    inT32 ngram_size, type, correct_ngram_id;
+    if (!ReadCompiledValue(data, size, pos, &ngram_size) ||
+        !ReadCompiledValue(data, size, pos, &type) ||
+        !ReadCompiledValue(data, size, pos, &correct_ngram_id) ||
+        ngram_size <= 0 || ngram_size > MAX_AMBIG_SIZE ||
+        type < 0 || type >= AMBIG_TYPE_COUNT ||
+        correct_ngram_id < 0 || correct_ngram_id >= table->size())
+      return false;
+    AmbigSpec *spec = new AmbigSpec();
+    spec->wrong_ngram_size = ngram_size;
+    spec->type = static_cast<AmbigType>(type);
+    spec->correct_ngram_id = correct_ngram_id;
+    spec->wrong_ngram[ngram_size] = INVALID_UNICHAR_ID;
+    spec->correct_fragments[ngram_size] = INVALID_UNICHAR_ID;
+    if (!ReadCompiledIds(data, size, pos, ngram_size, table->size(),
+                         spec->wrong_ngram) ||
+        !ReadCompiledIds(data, size, pos, ngram_size, table->size(),
+                         spec->correct_fragments)) {
+      delete spec;
+      return false;
+    }
+    // The specs were written in sorted order.
+    AmbigSpec_LIST *&list = (*table)[spec->wrong_ngram[0]];
+    if (list == NULL) list = new AmbigSpec_LIST();
+    AmbigSpec_IT spec_it(list);
+    spec_it.add_to_end(spec);
+  }
+  return true;
+}
+
+// Reads the start indices and ids written by WriteCompiledIdVectors.
+static bool ReadCompiledIdArrays(const char *data, int size, int *pos,
+                                 int num_unichars,
+                                 GenericVector<int> *starts,
+                                 GenericVector<UNICHAR_ID> *ids) {
+  starts->init_to_size(num_unichars + 1, 0);
+  if (!ReadCompiledArray(data, size, pos, num_unichars + 1, &(*starts)[0]))
+    return false;
+  for (int i = 0; i < num_unichars; ++i) {
+    if ((*starts)[i] < 0 || (*starts)[i] > (*starts)[i + 1]) return false;
+  }
+  int num_ids = (*starts)[num_unichars];
+  if ((*starts)[0] != 0 || num_ids > size) return false;
+  ids->init_to_size(num_ids, 0);
+  return num_ids == 0 ||
+         ReadCompiledIds(data, size, pos, num_ids, num_unichars, &(*ids)[0]);
+}
+
+bool UnicharAmbigs::LoadCompiledAmbigs(FILE *file,
+                                       bool use_ambigs_for_adaption,
+                                       const UNICHARSET &unicharset) {
+  Clear();
+  int size;
+  char *data = ReadCompiledBlock(file, &size);
+  if (data == NULL) return false;
+  int pos = 0;
+  inT32 num_unichars;
+  bool ok = ReadCompiledValue(data, size, &pos, &num_unichars) &&
+            num_unichars == unicharset.size();
+  if (ok) {
+    replace_ambigs_.init_to_size(num_unichars, NULL);
+    dang_ambigs_.init_to_size(num_unichars, NULL);
+    ok = ReadCompiledAmbigTable(data, size, &pos, &replace_ambigs_) &&
+         ReadCompiledAmbigTable(data, size, &pos, &dang_ambigs_) &&
+         ReadCompiledIdArrays(data, size, &pos, num_unichars,
+                              &definite_ambig_starts_, &definite_ambig_ids_);
+  }
+  if (ok && use_ambigs_for_adaption) {
+    GenericVector<int> starts;
+    GenericVector<UNICHAR_ID> ids;
+    ok = ReadCompiledIdArrays(data, size, &pos, num_unichars, &starts, &ids);
+    for (int i = 0; ok && i < num_unichars; ++i) {
+      if (starts[i] == starts[i + 1]) {
+        ambigs_for_adaption_.push_back(NULL);
+        continue;
+      }
+      UnicharIdVector *entry = new UnicharIdVector();
+      entry->reserve(starts[i + 1] - starts[i]);
+      for (int j = starts[i]; j < starts[i + 1]; ++j)
+        entry->push_back(ids[j]);
+      ambigs_for_adaption_.push_back(entry);
+    }
+    if (ok) {
+      reverse_ambigs_for_adaption_.init_to_size(num_unichars, NULL);
+      BuildReverseAmbigsForAdaption();
+    }
+  }
+  delete [] data;
+  if (!ok) Clear();
+  return ok;
+}
+
 bool UnicharAmbigs::ParseAmbiguityLine(
     int line_num, int version, int debug_level, const UNICHARSET &unicharset,
     char *buffer, int *TestAmbigPartSize, UNICHAR_ID *TestUnicharIds,
@@ -206,7 +414,7 @@ bool UnicharAmbigs::ParseAmbiguityLine(
   char *token;
   char *next_token;
   if (!(token = strtok_r(buffer, kAmbigDelimiters, &next_token)) ||
-      !sscanf(token, "%d", TestAmbigPartSize) || TestAmbigPartSize <= 0) {
+      !sscanf(token, "%d", TestAmbigPartSize) || *TestAmbigPartSize <= 0) {
     if (debug_level) tprintf(kIllegalMsg, line_num);
     return false;
   }
@@ -142,9 +142,7 @@ class UnicharAmbigs {
  public:
   UnicharAmbigs() {}
   ~UnicharAmbigs() {
-    replace_ambigs_.delete_data_pointers();
-    dang_ambigs_.delete_data_pointers();
-    one_to_one_definite_ambigs_.delete_data_pointers();
+    Clear();
   }
 
   const UnicharAmbigsVector &dang_ambigs() const { return dang_ambigs_; }
@@ -157,17 +155,37 @@ class UnicharAmbigs {
   // character. For example the ambiguity "rn -> m", would be located in the
   // table at index of unicharset.unichar_to_id('r').
   // In 1-1 ambiguities (e.g. s -> S, 1 -> I) are recorded in
-  // one_to_one_definite_ambigs_. This vector is also indexed by the class id
-  // of the wrong part of the ambiguity and each entry contains a vector of
-  // unichar ids that are ambiguous to it.
+  // the one-to-one definite ambigs, which are also indexed by the class id
+  // of the wrong part of the ambiguity and list the unichar ids that are
+  // ambiguous to it.
+  // The correct parts of the ambiguities, and the fragments of those, are
+  // inserted into unicharset.
   void LoadUnicharAmbigs(FILE *ambigs_file, inT64 end_offset, int debug_level,
                          bool use_ambigs_for_adaption, UNICHARSET *unicharset);
 
-  // Returns definite 1-1 ambigs for the given unichar id.
-  inline const UnicharIdVector *OneToOneDefiniteAmbigs(
-      UNICHAR_ID unichar_id) const {
-    if (one_to_one_definite_ambigs_.empty()) return NULL;
-    return one_to_one_definite_ambigs_[unichar_id];
+  // Writes the tables in the compiled form read by LoadCompiledAmbigs. They
+  // must have been loaded with use_ambigs_for_adaption.
+  bool SaveCompiledAmbigs(FILE *file, const UNICHARSET &unicharset) const;
+
+  // Loads tables written by SaveCompiledAmbigs in a single read. Unlike
+  // LoadUnicharAmbigs this leaves the unicharset alone, which must be the
+  // compiled one saved after LoadUnicharAmbigs had inserted into it.
+  // Returns false, with the tables empty, if the tables were compiled
+  // against a unicharset of another size or are damaged.
+  bool LoadCompiledAmbigs(FILE *file, bool use_ambigs_for_adaption,
+                          const UNICHARSET &unicharset);
+
+  // Sets *ambigs to the definite 1-1 ambigs of the given unichar id and
+  // returns how many there are.
+  inline int OneToOneDefiniteAmbigs(UNICHAR_ID unichar_id,
+                                    const UNICHAR_ID **ambigs) const {
+    if (definite_ambig_starts_.empty()) {
+      *ambigs = NULL;
+      return 0;
+    }
+    int start = definite_ambig_starts_[unichar_id];
+    *ambigs = &definite_ambig_ids_[start];
+    return definite_ambig_starts_[unichar_id + 1] - start;
   }
 
   // Returns a pointer to the vector with all unichar ids that appear in the
@@ -191,6 +209,10 @@ class UnicharAmbigs {
   }
 
  private:
+  // Deletes all the tables.
+  void Clear();
+  // Fills in reverse_ambigs_for_adaption_ from ambigs_for_adaption_.
+  void BuildReverseAmbigsForAdaption();
 
   bool ParseAmbiguityLine(int line_num, int version, int debug_level,
                           const UNICHARSET &unicharset, char *buffer,
@@ -204,7 +226,12 @@ class UnicharAmbigs {
                        AmbigSpec *ambig_spec, UNICHARSET *unicharset);
   UnicharAmbigsVector dang_ambigs_;
   UnicharAmbigsVector replace_ambigs_;
-  GenericVector<UnicharIdVector *> one_to_one_definite_ambigs_;
+  // The definite 1-1 ambigs of all unichars in one array: those of unichar
+  // id i are definite_ambig_ids_[definite_ambig_starts_[i]] up to
+  // definite_ambig_ids_[definite_ambig_starts_[i + 1]], so the matcher
+  // reads them without a pointer chase per class.
+  GenericVector<int> definite_ambig_starts_;
+  GenericVector<UNICHAR_ID> definite_ambig_ids_;
   GenericVector<UnicharIdVector *> ambigs_for_adaption_;
   GenericVector<UnicharIdVector *> reverse_ambigs_for_adaption_;
 };
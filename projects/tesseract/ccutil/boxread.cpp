@@ -26,14 +26,20 @@
 // Special char code used to identify multi-blob labels.
 static const char* kMultiBlobLabelCode = "WordStr";
 
-// Open the boxfile based on the given image filename.
-FILE* OpenBoxFile(const STRING& fname) {
+// Returns the name of the box file of the given image filename.
+STRING BoxFileName(const STRING& fname) {
   STRING filename = fname;
   const char *lastdot = strrchr(filename.string(), '.');
   if (lastdot != NULL)
     filename[lastdot - filename.string()] = '\0';
 
   filename += ".box";
+  return filename;
+}
+
+// Open the boxfile based on the given image filename.
+FILE* OpenBoxFile(const STRING& fname) {
+  STRING filename = BoxFileName(fname);
   FILE* box_file = NULL;
   if (!(box_file = fopen(filename.string(), "r"))) {
     CANTOPENFILE.error("read_next_box", TESSEXIT,
@@ -59,80 +65,143 @@ bool read_next_box(int *line_number, FILE* box_file, char* utf8_str,
                        x_min, y_min, x_max, y_max);
 }
 
+// Interprets the line of a box file in buff, as read_next_box describes.
+// Returns true, with the box in utf8_str and the coords, and its page in
+// page, if it is a box of target_page, or of any page if target_page is -1.
+// Returns false for a blank line, a line in error, which is reported, or a
+// box of another page.
+static bool ParseBoxLine(int target_page, int line_number, char* buff,
+                         char* utf8_str, int* x_min, int* y_min,
+                         int* x_max, int* y_max, int* page) {
+  int count = 0;
+  char uch[kBoxReadBufSize];
+  char *buffptr = buff;
+
+  *page = 0;
+  const unsigned char *ubuf = reinterpret_cast<const unsigned char*>(buffptr);
+  if (ubuf[0] == 0xef && ubuf[1] == 0xbb && ubuf[2] == 0xbf)
+    buffptr += 3;  // Skip unicode file designation.
+  // Check for blank lines in box file
+  while (*buffptr == ' ' || *buffptr == '\t')
+    buffptr++;
+  if (*buffptr == '\0')
+    return false;
+  // Read the unichar without messing up on Tibetan.
+  // According to issue 253 the utf-8 surrogates 85 and A0 are treated
+  // as whitespace by sscanf, so it is more reliable to just find
+  // ascii space and tab.
+  int uch_len = 0;
+  while (*buffptr != '\0' && *buffptr != ' ' && *buffptr != '\t')
+    uch[uch_len++] = *buffptr++;
+  uch[uch_len] = '\0';
+  if (*buffptr != '\0') ++buffptr;
+  count = sscanf(buffptr, "%d %d %d %d %d",
+                 x_min, y_min, x_max, y_max, page);
+  if (count != 5) {
+    if (target_page <= 0) {
+      // If target_page is negative or zero, allow lines with no page number
+      *page = 0;
+      count = sscanf(buffptr, "%d %d %d %d", x_min, y_min, x_max, y_max);
+    } else {
+      tprintf("Box file format error on line %i; ignored\n", line_number);
+      return false;
+    }
+  }
+  if (target_page >= 0 && target_page != *page)
+    return false;  // Not on the appropriate page.
+  // Test for long space-delimited string label.
+  if (strcmp(uch, kMultiBlobLabelCode) == 0 &&
+      (buffptr = strchr(buffptr, '#')) != NULL) {
+    strcpy(uch, buffptr + 1);
+    chomp_string(uch);
+    uch_len = strlen(uch);
+  }
+  // Validate UTF8 by making unichars with it.
+  int used = 0;
+  while (used < uch_len) {
+    UNICHAR ch(uch + used, uch_len - used);
+    int new_used = ch.utf8_len();
+    if (new_used == 0) {
+      tprintf("Bad UTF-8 str %s starts with 0x%02x at line %d, col %d\n",
+              uch + used, uch[used], line_number, used + 1);
+      count = 0;
+      break;
+    }
+    used += new_used;
+  }
+  if (count < 4 || used == 0) {
+    tprintf("Box file format error on line %i; ignored\n", line_number);
+    return false;
+  }
+  strncpy(utf8_str, uch, kBoxReadBufSize);
+  return true;  // Successfully read a box.
+}
+
 // As read_next_box above, but get a specific page number. (0-based)
 // Use -1 to read any page number. Files without page number all
 // read as if they are page 0.
 bool read_next_box(int target_page, int *line_number,
                    FILE* box_file, char* utf8_str,
                    int* x_min, int* y_min, int* x_max, int* y_max) {
-  int count = 0;
-  int page = 0;
   char buff[kBoxReadBufSize];   // boxfile read buffer
-  char uch[kBoxReadBufSize];
-  char *buffptr = buff;
+  int page;
 
   while (fgets(buff, sizeof(buff) - 1, box_file)) {
     (*line_number)++;
+    if (ParseBoxLine(target_page, *line_number, buff, utf8_str,
+                     x_min, y_min, x_max, y_max, &page))
+      return true;
+  }
+  fclose(box_file);
+  return false;  // EOF
+}
 
-    buffptr = buff;
-    const unsigned char *ubuf = reinterpret_cast<const unsigned char*>(buffptr);
-    if (ubuf[0] == 0xef && ubuf[1] == 0xbb && ubuf[2] == 0xbf)
-      buffptr += 3;  // Skip unicode file designation.
-    // Check for blank lines in box file
-    while (*buffptr == ' ' || *buffptr == '\t')
-      buffptr++;
-    if (*buffptr != '\0') {
-      // Read the unichar without messing up on Tibetan.
-      // According to issue 253 the utf-8 surrogates 85 and A0 are treated
-      // as whitespace by sscanf, so it is more reliable to just find
-      // ascii space and tab.
-      int uch_len = 0;
-      while (*buffptr != '\0' && *buffptr != ' ' && *buffptr != '\t')
-        uch[uch_len++] = *buffptr++;
-      uch[uch_len] = '\0';
-      if (*buffptr != '\0') ++buffptr;
-      count = sscanf(buffptr, "%d %d %d %d %d",
-                     x_min, y_min, x_max, y_max, &page);
-      if (count != 5) {
-        if (target_page <= 0) {
-          // If target_page is negative or zero, allow lines with no page number
-          page = 0;
-          count = sscanf(buffptr, "%d %d %d %d", x_min, y_min, x_max, y_max);
-        } else {
-          tprintf("Box file format error on line %i; ignored\n", *line_number);
-          continue;
-        }
-      }
-      if (target_page >= 0 && target_page != page)
-        continue;  // Not on the appropriate page.
-      // Test for long space-delimited string label.
-      if (strcmp(uch, kMultiBlobLabelCode) == 0 &&
-          (buffptr = strchr(buffptr, '#')) != NULL) {
-        strcpy(uch, buffptr + 1);
-        chomp_string(uch);
-        uch_len = strlen(uch);
-      }
-      // Validate UTF8 by making unichars with it.
-      int used = 0;
-      while (used < uch_len) {
-        UNICHAR ch(uch + used, uch_len - used);
-        int new_used = ch.utf8_len();
-        if (new_used == 0) {
-          tprintf("Bad UTF-8 str %s starts with 0x%02x at line %d, col %d\n",
-                  uch + used, uch[used], *line_number, used + 1);
-          count = 0;
-          break;
-        }
-        used += new_used;
-      }
-      if (count < 4 || used == 0) {
-        tprintf("Box file format error on line %i; ignored\n", *line_number);
-      } else {
-        strncpy(utf8_str, uch, kBoxReadBufSize);
-        return true;  // Successfully read a box.
-      }
+void BoxFileIndex::ReadBoxes(FILE* box_file) {
+  boxes_.clear();
+  GenericVector<int> pages;           // Of each box.
+  char buff[kBoxReadBufSize];
+  char utf8_str[kBoxReadBufSize];
+  int line_number = 0;
+  BoxFileBox box;
+  int page;
+  while (fgets(buff, sizeof(buff) - 1, box_file)) {
+    ++line_number;
+    if (ParseBoxLine(-1, line_number, buff, utf8_str, &box.x_min, &box.y_min,
+                     &box.x_max, &box.y_max, &page) && page >= 0) {
+      box.text = utf8_str;
+      box.line_number = line_number;
+      boxes_.push_back(box);
+      pages.push_back(page);
     }
   }
   fclose(box_file);
-  return false;  // EOF
+
+  // Group the boxes by page, keeping the order of the file within each.
+  int num_pages = 0;
+  for (int i = 0; i < pages.size(); ++i) {
+    if (pages[i] >= num_pages)
+      num_pages = pages[i] + 1;
+  }
+  page_starts_.init_to_size(num_pages + 1, 0);
+  for (int i = 0; i < pages.size(); ++i)
+    ++page_starts_[pages[i] + 1];
+  for (int p = 0; p < num_pages; ++p)
+    page_starts_[p + 1] += page_starts_[p];
+  // next[p] is where the next box of page p goes.
+  GenericVector<int> next(page_starts_);
+  page_boxes_.init_to_size(boxes_.size(), 0);
+  for (int i = 0; i < pages.size(); ++i)
+    page_boxes_[next[pages[i]]++] = i;
+}
+
+bool BoxFileIndex::Load(const STRING& fname) {
+  boxes_.clear();
+  page_boxes_.clear();
+  page_starts_.clear();
+  page_starts_.push_back(0);
+  FILE* box_file = fopen(BoxFileName(fname).string(), "r");
+  if (box_file == NULL)
+    return false;
+  ReadBoxes(box_file);
+  return true;
 }
@@ -21,11 +21,15 @@
 #define TESSERACT_CCUTIL_BOXREAD_H__
 
 #include <stdio.h>
+#include "genericvector.h"
 #include "strngs.h"
 
 // Size of buffer used to read a line from a box file.
 const int kBoxReadBufSize = 1024;
 
+// Returns the name of the box file of the given image filename.
+STRING BoxFileName(const STRING& fname);
+
 // Open the boxfile based on the given image filename.
 FILE* OpenBoxFile(const STRING& fname);
 
@@ -45,4 +49,57 @@ bool read_next_box(int *line_number, FILE* box_file, char* utf8_str,
 bool read_next_box(int page, int *line_number, FILE* box_file, char* utf8_str,
                    int* x_min, int* y_min, int* x_max, int* y_max);
 
+// A box of a box file, in tesseract coordinates.
+struct BoxFileBox {
+  BoxFileBox() : x_min(0), y_min(0), x_max(0), y_max(0), line_number(0) {}
+
+  STRING text;           // UTF-8, the units of a WordStr space-delimited.
+  int x_min, y_min, x_max, y_max;
+  int line_number;       // In the box file, for reporting errors.
+};
+
+// All the boxes of a box file, read once and indexed by page, for a
+// multi-page image whose pages would otherwise each scan the whole file
+// with read_next_box. Lines are interpreted exactly as read_next_box does.
+class BoxFileIndex {
+ public:
+  BoxFileIndex() {
+    page_starts_.push_back(0);
+  }
+
+  // Reads the boxes of box_file, in place of any read before, and closes
+  // it. Lines in error are reported and skipped.
+  void ReadBoxes(FILE* box_file);
+  // As ReadBoxes, on the box file of the given image filename. Returns
+  // false, with no boxes, if it can't be opened.
+  bool Load(const STRING& fname);
+
+  // Returns the number of pages, one more than the last with any boxes.
+  int num_pages() const {
+    return page_starts_.size() - 1;
+  }
+  // Returns the number of boxes of the given page (0-based), or of all the
+  // pages if page is -1, as for read_next_box. Pages without boxes have
+  // none.
+  int num_boxes(int page) const {
+    if (page < 0)
+      return boxes_.size();
+    return page >= num_pages()
+        ? 0 : page_starts_[page + 1] - page_starts_[page];
+  }
+  // Returns the index-th box of the given page, or of all the pages if page
+  // is -1, in the order of the file.
+  const BoxFileBox& box(int page, int index) const {
+    if (page < 0)
+      return boxes_[index];
+    return boxes_[page_boxes_[page_starts_[page] + index]];
+  }
+
+ private:
+  GenericVector<BoxFileBox> boxes_;   // In the order of the file.
+  GenericVector<int> page_boxes_;     // Indices in boxes_, grouped by page.
+  GenericVector<int> page_starts_;    // Index in page_boxes_ of the first
+                                      // box of each page, then the size.
+};
+
 #endif  // TESSERACT_CCUTIL_BOXREAD_H__
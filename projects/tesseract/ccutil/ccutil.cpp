@@ -49,4 +49,5 @@ void CCUtilMutex::Unlock() {
 }
 
 CCUtilMutex tprintfMutex;  // should remain global
+CCUtilMutex stringParamMutex;
 } // namespace tesseract
@@ -94,6 +94,9 @@ class CCUtil {
 };
 
 extern CCUtilMutex tprintfMutex;  // should remain global
+// Held while a string parameter is set, so that a thread reading a global
+// one, as the log writer reads debug_file, never sees half a value.
+extern CCUtilMutex stringParamMutex;
 }  // namespace tesseract
 
 #endif  // TESSERACT_CCUTIL_CCUTIL_H__
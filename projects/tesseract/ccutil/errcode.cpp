@@ -26,6 +26,7 @@
 #include          <signal.h>
 #endif
 #include          "tprintf.h"
+#include          "tesslog.h"
 //#include                                      "ipeerr.h"
 #include          "errcode.h"
 
@@ -75,6 +76,8 @@ const char *format, ...          //special message
                                  //no specific
     msgptr += sprintf (msgptr, "\n");
 
+  // Anything logged before the error should appear before it.
+  tesseract::TessLogFlush();
   fprintf(stderr, msg);
   /*if ((strstr (message, "File") != NULL) ||
     (strstr (message, "file") != NULL))
@@ -22,11 +22,82 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "tesscallback.h"
 #include "errcode.h"
 #include "helpers.h"
 
+namespace tesseract {
+
+// Describes how GenericVector may relocate elements of type T when it grows,
+// inserts, removes or sorts. Move() transfers the value of *from into *to,
+// leaving *from valid but unspecified; from and to are never the same
+// element. MoveRange() moves count elements and CopyRange() copies them,
+// between arrays that do not overlap. Specialize it for element types that
+// own memory, so that relocation hands over the memory instead of
+// deep-copying it, and for plain data, so that ranges go by memcpy. The
+// choice is made by the specialization, at compile time, so memcpy is
+// never instantiated for a type that has a copy constructor.
+template <typename T>
+struct GenericVectorTraits {
+  static void Move(T* from, T* to) {
+    *to = *from;
+  }
+  static void MoveRange(T* from, T* to, int count) {
+    for (int i = 0; i < count; ++i)
+      Move(&from[i], &to[i]);
+  }
+  static void CopyRange(const T* from, T* to, int count) {
+    for (int i = 0; i < count; ++i)
+      to[i] = from[i];
+  }
+};
+
+// Relocation of types that can be copied with memcpy.
+template <typename T>
+struct GenericVectorBitwiseTraits {
+  static void Move(T* from, T* to) {
+    *to = *from;
+  }
+  static void MoveRange(T* from, T* to, int count) {
+    if (count > 0)
+      memcpy(to, from, count * sizeof(T));
+  }
+  static void CopyRange(const T* from, T* to, int count) {
+    if (count > 0)
+      memcpy(to, from, count * sizeof(T));
+  }
+};
+
+template <typename T>
+struct GenericVectorTraits<T*> : public GenericVectorBitwiseTraits<T*> {
+};
+
+#define GENERICVECTOR_BITWISE_TYPE(T) \
+  template <> \
+  struct GenericVectorTraits<T> : public GenericVectorBitwiseTraits<T> { \
+  }
+
+GENERICVECTOR_BITWISE_TYPE(bool);
+GENERICVECTOR_BITWISE_TYPE(char);
+GENERICVECTOR_BITWISE_TYPE(signed char);
+GENERICVECTOR_BITWISE_TYPE(unsigned char);
+GENERICVECTOR_BITWISE_TYPE(short);
+GENERICVECTOR_BITWISE_TYPE(unsigned short);
+GENERICVECTOR_BITWISE_TYPE(int);
+GENERICVECTOR_BITWISE_TYPE(unsigned int);
+GENERICVECTOR_BITWISE_TYPE(long);
+GENERICVECTOR_BITWISE_TYPE(unsigned long);
+GENERICVECTOR_BITWISE_TYPE(long long);
+GENERICVECTOR_BITWISE_TYPE(unsigned long long);
+GENERICVECTOR_BITWISE_TYPE(float);
+GENERICVECTOR_BITWISE_TYPE(double);
+
+#undef GENERICVECTOR_BITWISE_TYPE
+
+}  // namespace tesseract
+
 template <typename T>
 class GenericVector {
  public:
@@ -84,6 +155,10 @@ class GenericVector {
   int push_back(T object);
   void operator+=(T t);
 
+  // Appends a default-constructed element and returns it, so that it can be
+  // filled in place instead of being built elsewhere and copied in.
+  T &emplace_back();
+
   // Push an element in the front of the array
   // Note: This function is O(n)
   int push_front(T object);
@@ -148,11 +223,10 @@ class GenericVector {
     return data_new;
   }
 
-  // Sorts the members of this vector using the less than comparator (cmp_lt),
-  // which compares the values. Useful for GenericVectors to primitive types.
-  // Will not work so great for pointers (unless you just want to sort some
-  // pointers). You need to provide a specialization to sort_cmp to use
-  // your type.
+  // Sorts the members of this vector using operator<, which is inlined
+  // rather than called through a qsort comparator. Useful for GenericVectors
+  // to primitive types. Will not work so great for pointers (unless you just
+  // want to sort some pointers). The sort is not stable.
   void sort();
 
   // Sort the array into the order defined by the qsort function comparator.
@@ -203,6 +277,11 @@ class GenericVector {
   // Init the object, allocating size memory.
   void init(int size);
 
+  // Quicksort of data_[begin, end) by operator<, finishing small ranges
+  // with an insertion sort.
+  void sort_range(int begin, int end);
+  void swap_elements(int i, int j);
+
   // We are assuming that the object generally placed in thie
   // vector are small enough that for efficiency it makes sence
   // to start with a larger initial size.
@@ -217,6 +296,24 @@ class GenericVector {
 
 namespace tesseract {
 
+// Growing a vector of vectors hands over each inner array.
+template <typename T>
+struct GenericVectorTraits<GenericVector<T> > {
+  static void Move(GenericVector<T>* from, GenericVector<T>* to) {
+    to->move(from);
+  }
+  static void MoveRange(GenericVector<T>* from, GenericVector<T>* to,
+                        int count) {
+    for (int i = 0; i < count; ++i)
+      to[i].move(&from[i]);
+  }
+  static void CopyRange(const GenericVector<T>* from, GenericVector<T>* to,
+                        int count) {
+    for (int i = 0; i < count; ++i)
+      to[i] = from[i];
+  }
+};
+
 template <typename T>
 bool cmp_eq(T const & t1, T const & t2) {
   return t1 == t2;
@@ -271,14 +368,13 @@ GenericVector<T>::~GenericVector() {
 }
 
 // Reserve some memory. If the internal array contains elements, they are
-// copied.
+// moved to the new array.
 template <typename T>
 void GenericVector<T>::reserve(int size) {
   if (size_reserved_ >= size || size <= 0)
     return;
   T* new_array = new T[size];
-  for (int i = 0; i < size_used_; ++i)
-    new_array[i] = data_[i];
+  tesseract::GenericVectorTraits<T>::MoveRange(data_, new_array, size_used_);
   if (data_ != NULL) delete[] data_;
   data_ = new_array;
   size_reserved_ = size;
@@ -332,7 +428,7 @@ void GenericVector<T>::insert(T t, int index) {
   if (size_reserved_ == size_used_)
     double_the_size();
   for (int i = size_used_; i > index; --i) {
-    data_[i] = data_[i-1];
+    tesseract::GenericVectorTraits<T>::Move(&data_[i-1], &data_[i]);
   }
   data_[index] = t;
   size_used_++;
@@ -344,7 +440,7 @@ template <typename T>
 void GenericVector<T>::remove(int index) {
   ASSERT_HOST(index >= 0 && index < size_used_);
   for (int i = index; i < size_used_ - 1; ++i) {
-    data_[i] = data_[i+1];
+    tesseract::GenericVectorTraits<T>::Move(&data_[i+1], &data_[i]);
   }
   size_used_--;
 }
@@ -389,7 +485,7 @@ int GenericVector<T>::push_front(T object) {
   if (size_used_ == size_reserved_)
     double_the_size();
   for (int i = size_used_; i > 0; --i)
-    data_[i] = data_[i-1];
+    tesseract::GenericVectorTraits<T>::Move(&data_[i-1], &data_[i]);
   data_[0] = object;
   ++size_used_;
   return 0;
@@ -400,12 +496,22 @@ void GenericVector<T>::operator+=(T t) {
   push_back(t);
 }
 
+template <typename T>
+T &GenericVector<T>::emplace_back() {
+  if (size_used_ == size_reserved_)
+    double_the_size();
+  T &slot = data_[size_used_++];
+  // The slot may still hold an element removed or truncated earlier.
+  slot = T();
+  return slot;
+}
+
 template <typename T>
 GenericVector<T> &GenericVector<T>::operator+=(const GenericVector& other) {
   this->reserve(size_used_ + other.size_used_);
-  for (int i = 0; i < other.size(); ++i) {
-    this->operator+=(other.data_[i]);
-  }
+  tesseract::GenericVectorTraits<T>::CopyRange(other.data_, data_ + size_used_,
+                                               other.size_used_);
+  size_used_ += other.size_used_;
   return *this;
 }
 
@@ -527,7 +633,60 @@ void GenericVector<T>::move(GenericVector<T>* from) {
 
 template <typename T>
 void GenericVector<T>::sort() {
-  sort(&tesseract::sort_cmp<T>);
+  sort_range(0, size_used_);
+}
+
+template <typename T>
+void GenericVector<T>::swap_elements(int i, int j) {
+  T tmp;
+  tesseract::GenericVectorTraits<T>::Move(&data_[i], &tmp);
+  tesseract::GenericVectorTraits<T>::Move(&data_[j], &data_[i]);
+  tesseract::GenericVectorTraits<T>::Move(&tmp, &data_[j]);
+}
+
+template <typename T>
+void GenericVector<T>::sort_range(int begin, int end) {
+  const int kInsertionSortSize = 16;
+  while (end - begin > kInsertionSortSize) {
+    // Median of three as the pivot, which is left at begin.
+    int mid = begin + (end - begin) / 2;
+    if (data_[mid] < data_[begin])
+      swap_elements(mid, begin);
+    if (data_[end - 1] < data_[mid]) {
+      swap_elements(end - 1, mid);
+      if (data_[mid] < data_[begin])
+        swap_elements(mid, begin);
+    }
+    swap_elements(begin, mid);
+    // Hoare partition around data_[begin].
+    int lo = begin;
+    int hi = end;
+    for (;;) {
+      do {
+        ++lo;
+      } while (lo < end && data_[lo] < data_[begin]);
+      do {
+        --hi;
+      } while (data_[begin] < data_[hi]);
+      if (lo >= hi)
+        break;
+      swap_elements(lo, hi);
+    }
+    if (hi != begin)
+      swap_elements(begin, hi);
+    // Recurse into the smaller side to bound the stack depth.
+    if (hi - begin < end - hi - 1) {
+      sort_range(begin, hi);
+      begin = hi + 1;
+    } else {
+      sort_range(hi + 1, end);
+      end = hi;
+    }
+  }
+  for (int i = begin + 1; i < end; ++i) {
+    for (int j = i; j > begin && data_[j] < data_[j - 1]; --j)
+      swap_elements(j, j - 1);
+  }
 }
 
 #endif  // TESSERACT_CCUTIL_GENERICVECTOR_H_
@@ -29,6 +29,9 @@
 
 //#define COUNTING_CLASS_STRUCTURES
 
+DLLSYM bool mem_counting_on = false;
+DLLSYM MEM_COUNTS mem_counts = { 0, 0 };
+
 /**********************************************************************
  * new
  *
@@ -95,6 +98,8 @@ DLLSYM char *alloc_string(             //allocate string
 
   count++;                       //add size byte
   if (count <= MAX_STRUCTS * sizeof (MEMUNION)) {
+    if (mem_counting_on)
+      ++mem_counts.allocs;         //alloc_mem counts the rest
     string = (char *) alloc_struct (count, "alloc_string");
     //get a fast structure
     if (string == NULL) {
@@ -114,6 +119,8 @@ DLLSYM char *alloc_string(             //allocate string
   }
   return &string[1];             //string for user
 #else
+  if (mem_counting_on)
+    ++mem_counts.allocs;
   // Round up the amount allocated to a multiple of 4
   return static_cast<char*>(malloc((count + 3) & ~3));
 #endif
@@ -418,6 +425,8 @@ DLLSYM void *alloc_mem_p(             //allocate permanent space
 DLLSYM void *alloc_mem(             //get some memory
                        inT32 count  //no of bytes to get
                       ) {
+  if (mem_counting_on)
+    ++mem_counts.allocs;
   #ifdef RAYS_MALLOC
   #ifdef TESTING_BIGSTUFF
   if (main_mem.biggestblock == 0)
@@ -82,6 +82,20 @@
 	free_big_mem(ptrs);									/*and the ptrs*/\
 } \
 
+/**********************************************************************
+ * MEM_COUNTS
+ *
+ * Allocation counts for benchmarks, kept only while mem_counting_on is
+ * set. They are exact only while a single thread allocates.
+ **********************************************************************/
+struct MEM_COUNTS {
+  inT64 allocs;                  //calls of alloc_mem and alloc_string
+  inT64 inline_strings;          //STRINGs stored without allocating
+};
+
+extern DLLSYM bool mem_counting_on;
+extern DLLSYM MEM_COUNTS mem_counts;
+
 extern DLLSYM void check_mem(                     //check consistency
                              const char *string,  //context message
                              inT8 level           //level of check
@@ -335,6 +335,18 @@ class ETEXT_DESC                 /*output header */
     return (now.tv_sec > end_time.tv_sec || (now.tv_sec == end_time.tv_sec &&
                                              now.tv_usec > end_time.tv_usec));
   }
+
+  // Returns the number of milliseconds left before the end_time, 0 if it
+  // has passed, or MAX_INT32 if no deadline has been set.
+  inT32 remaining_msecs() const {
+    if (end_time.tv_sec == 0 && end_time.tv_usec == 0) return MAX_INT32;
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    double remaining = (end_time.tv_sec - now.tv_sec) * 1000.0 +
+                       (end_time.tv_usec - now.tv_usec) / 1000.0;
+    if (remaining <= 0.0) return 0;
+    return remaining >= MAX_INT32 ? MAX_INT32 : static_cast<inT32>(remaining);
+  }
 };
 
 #endif
@@ -27,6 +27,7 @@
 #include          "scanutils.h"
 #include          "tprintf.h"
 #include          "params.h"
+#include          "ccutil.h"
 
 #define PLUS          '+'        //flag states
 #define MINUS         '-'
@@ -106,7 +107,11 @@ bool ParamUtils::SetParam(const char *name, const char* value,
   // Look for the parameter among string parameters.
   StringParam *sp = FindParam<StringParam>(name, GlobalParams()->string_params,
                                            member_params->string_params);
-  if (sp != NULL && (!init_only || sp->is_init())) sp->set_value(value);
+  if (sp != NULL && (!init_only || sp->is_init())) {
+    tesseract::stringParamMutex.Lock();
+    sp->set_value(value);
+    tesseract::stringParamMutex.Unlock();
+  }
   if (*value == '\0') return (sp != NULL);
 
   // Look for the parameter among int parameters.
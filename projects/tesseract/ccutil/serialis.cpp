@@ -52,3 +52,31 @@ DLLSYM uinT16 reverse16(            //switch endian
                        ) {
   return ((num & 0xff) << 8) | ((num >> 8) & 0xff);
 }
+
+DLLSYM long BeginCompiledBlock(FILE *file) {
+  long start = ftell(file);
+  inT32 size = 0;
+  fwrite(&size, sizeof(size), 1, file);
+  return start;
+}
+
+DLLSYM bool EndCompiledBlock(FILE *file, long start) {
+  long end = ftell(file);
+  inT32 size = end - start - sizeof(size);
+  if (fseek(file, start, SEEK_SET) != 0) return false;
+  fwrite(&size, sizeof(size), 1, file);
+  return fseek(file, end, SEEK_SET) == 0 && !ferror(file);
+}
+
+DLLSYM char *ReadCompiledBlock(FILE *file, int *size) {
+  inT32 num_bytes;
+  if (fread(&num_bytes, sizeof(num_bytes), 1, file) != 1 || num_bytes < 0)
+    return NULL;
+  char *data = new char[num_bytes];
+  if (fread(data, 1, num_bytes, file) != static_cast<size_t>(num_bytes)) {
+    delete [] data;
+    return NULL;
+  }
+  *size = num_bytes;
+  return data;
+}
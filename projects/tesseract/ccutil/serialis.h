@@ -32,6 +32,42 @@ extern DLLSYM uinT64 reverse64(uinT64);
 extern DLLSYM uinT32 reverse32(uinT32);
 extern DLLSYM uinT16 reverse16(uinT16);
 
+// Compiled data, such as the compiled tessdata components, is written with
+// fwrite in the byte order of the writing machine, as blocks that start
+// with their size so that a reader gets each with a single fread and then
+// decodes it from memory.
+
+// Writes a placeholder for the size of a block and returns its position.
+extern DLLSYM long BeginCompiledBlock(FILE *file);
+// Fills in the size of the block begun at start, leaving the file at its
+// end. Returns false on a write error.
+extern DLLSYM bool EndCompiledBlock(FILE *file, long start);
+// Reads a whole block into a new[]ed buffer and sets *size to its size.
+// Returns NULL if the file is too short.
+extern DLLSYM char *ReadCompiledBlock(FILE *file, int *size);
+
+// Copies a value of type T from *pos of a block of size bytes and advances
+// *pos. Returns false if the block is too short.
+template <typename T>
+inline bool ReadCompiledValue(const char *data, int size, int *pos,
+                              T *value) {
+  if (*pos + static_cast<int>(sizeof(T)) > size) return false;
+  memcpy(value, data + *pos, sizeof(T));
+  *pos += sizeof(T);
+  return true;
+}
+
+// As ReadCompiledValue, for count consecutive values.
+template <typename T>
+inline bool ReadCompiledArray(const char *data, int size, int *pos,
+                              int count, T *values) {
+  if (count < 0 || *pos + count * static_cast<int>(sizeof(T)) > size)
+    return false;
+  memcpy(values, data + *pos, count * sizeof(T));
+  *pos += count * sizeof(T);
+  return true;
+}
+
 /***********************************************************************
   QUOTE_IT   MACRO DEFINITION
   ===========================
@@ -33,48 +33,65 @@ const int kMaxIntSize = 22;
  * The implementation hides this header at the start of the data
  * buffer and appends the string on the end to keep sizeof(STRING)
  * unchanged from earlier versions so serialization is not affected.
+ * Short strings skip the buffer and live inside the STRING itself,
+ * which also keeps sizeof(STRING) unchanged.
  *
  * The collection of MACROS provide different implementations depending
  * on whether the string keeps track of its strlen or not so that this
  * feature can be added in later when consumers dont modifify the string
  **********************************************************************/
 
-// Smallest string to allocate by default
+// Smallest heap buffer to allocate when a string outgrows inline storage.
 const int kMinCapacity = 16;
 
+// Heap storage comes from alloc_mem rather than alloc_string, as the
+// latter does not return aligned memory and the inline tag needs the low
+// bit of a real pointer to be clear.
 char* STRING::AllocData(int used, int capacity) {
-  data_ = (STRING_HEADER *)alloc_string(capacity + sizeof(STRING_HEADER));
+  if (capacity <= kInlineCapacity) {
+    // Every STRING took a heap buffer before short ones were kept inline.
+    if (mem_counting_on)
+      ++mem_counts.inline_strings;
+    memset(inline_, 0, sizeof(inline_));
+    inline_[TagIndex()] = InlineTag(used);
+  } else {
+    data_ = (STRING_HEADER *)alloc_mem(capacity + sizeof(STRING_HEADER));
 
-  // header is the metadata for this memory block
-  STRING_HEADER* header = GetHeader();
-  header->capacity_ = capacity;
-  header->used_ = used;
+    // header is the metadata for this memory block
+    data_->capacity_ = capacity;
+    data_->used_ = used;
+  }
   return GetCStr();
 }
 
 void STRING::DiscardData() {
-  free_string((char *)data_);
+  if (!IsInline())
+    free_mem(data_);
 }
 
 // This is a private method; ensure FixHeader is called (or used_ is well defined)
 // beforehand
 char* STRING::ensure_cstr(inT32 min_capacity) {
-  STRING_HEADER* orig_header = GetHeader();
-  if (min_capacity <= orig_header->capacity_)
-    return ((char *)this->data_) + sizeof(STRING_HEADER);
+  int capacity = GetCapacity();
+  if (min_capacity <= capacity)
+    return GetCStr();
 
   // if we are going to grow bigger, than double our existing
   // size, but if that still is not big enough then keep the
   // requested capacity
-  if (min_capacity < 2 * orig_header->capacity_)
-    min_capacity = 2 * orig_header->capacity_;
+  if (min_capacity < 2 * capacity)
+    min_capacity = 2 * capacity;
+  if (min_capacity < kMinCapacity)
+    min_capacity = kMinCapacity;
 
+  FixHeader();
+  int used = GetUsed();
   int alloc = sizeof(STRING_HEADER) + min_capacity;
-  STRING_HEADER* new_header = (STRING_HEADER*)(alloc_string(alloc));
+  STRING_HEADER* new_header = (STRING_HEADER*)(alloc_mem(alloc));
 
-  memcpy(&new_header[1], GetCStr(), orig_header->used_);
+  memcpy(&new_header[1], GetCStr(), used);
   new_header->capacity_ = min_capacity;
-  new_header->used_ = orig_header->used_;
+  new_header->used_ = used;
 
   // free old memory, then rebind to new memory
   DiscardData();
@@ -87,21 +104,19 @@ char* STRING::ensure_cstr(inT32 min_capacity) {
 // This is const, but is modifying a mutable field
 // this way it can be used on const or non-const instances.
 void STRING::FixHeader() const {
-  const STRING_HEADER* header = GetHeader();
-  if (header->used_ < 0)
-    header->used_ = strlen(GetCStr()) + 1;
+  if (GetUsed() < 0)
+    SetUsed(strlen(GetCStr()) + 1);
 }
 
 
 STRING::STRING() {
   // 0 indicates old NULL -- it doesnt even have '\0'
-  AllocData(0, kMinCapacity);
+  AllocData(0, 0);
 }
 
 STRING::STRING(const STRING& str) {
   str.FixHeader();
-  const STRING_HEADER* str_header  = str.GetHeader();
-  int   str_used  = str_header->used_;
+  int   str_used  = str.GetUsed();
   char *this_cstr = AllocData(str_used, str_used);
   memcpy(this_cstr, str.GetCStr(), str_used);
   assert(InvariantOk());
@@ -128,17 +143,16 @@ BOOL8 STRING::contains(const char c) const {
 
 inT32 STRING::length() const {
   FixHeader();
-  return GetHeader()->used_ - 1;
+  return GetUsed() - 1;
 }
 
 const char* STRING::string() const {
-  const STRING_HEADER* header = GetHeader();
-  if (header->used_ == 0)
+  if (GetUsed() == 0)
     return NULL;
 
   // mark header length unreliable because tesseract might
   // cast away the const and mutate the string directly.
-  header->used_ = -1;
+  SetUsed(-1);
   return GetCStr();
 }
 
@@ -157,8 +171,8 @@ const char& STRING::operator[](inT32 index) const {
 void STRING::insert_range(inT32 index, const char* str, int len) {
   // if index is outside current range, then also grow size of string
   // to accmodate the requested range.
-  STRING_HEADER* this_header = GetHeader();
-  int used = this_header->used_;
+  int this_used = GetUsed();
+  int used = this_used;
   if (index > used)
     used = index;
 
@@ -167,40 +181,40 @@ void STRING::insert_range(inT32 index, const char* str, int len) {
     // move existing string from index to '\0' inclusive.
     memmove(this_cstr + index + len,
            this_cstr + index,
-           this_header->used_ - index);
+           this_used - index);
   } else if (len > 0) {
     // We are going to overwrite previous null terminator, so write the new one.
-    this_cstr[this_header->used_ + len - 1] = '\0';
+    this_cstr[this_used + len - 1] = '\0';
 
     // If the old header did not have the terminator,
     // then we need to account for it now that we've added it.
     // Otherwise it was already accounted for; we just moved it.
-    if (this_header->used_ == 0)
-      ++this_header->used_;
+    if (this_used == 0)
+      ++this_used;
   }
 
   // Write new string to index.
   // The string is already terminated from the conditions above.
   memcpy(this_cstr + index, str, len);
-  this_header->used_ += len;
+  SetUsed(this_used + len);
 
   assert(InvariantOk());
 }
 
 void STRING::erase_range(inT32 index, int len) {
   char* this_cstr = GetCStr();
-  STRING_HEADER* this_header = GetHeader();
+  int this_used = GetUsed();
 
   memcpy(this_cstr+index, this_cstr+index+len,
-         this_header->used_ - index - len);
-  this_header->used_ -= len;
+         this_used - index - len);
+  SetUsed(this_used - len);
   assert(InvariantOk());
 }
 
 void STRING::truncate_at(inT32 index) {
   char* this_cstr = ensure_cstr(index);
   this_cstr[index] = '\0';
-  GetHeader()->used_ = index;
+  SetUsed(index);
   assert(InvariantOk());
 }
 
@@ -208,7 +222,7 @@ void STRING::truncate_at(inT32 index) {
 char& STRING::operator[](inT32 index) const {
   // Code is casting away this const and mutating the string,
   // so mark used_ as -1 to flag it unreliable.
-  GetHeader()->used_ = -1;
+  SetUsed(-1);
   return ((char *)GetCStr())[index];
 }
 #endif
@@ -216,10 +230,8 @@ char& STRING::operator[](inT32 index) const {
 BOOL8 STRING::operator==(const STRING& str) const {
   FixHeader();
   str.FixHeader();
-  const STRING_HEADER* str_header = str.GetHeader();
-  const STRING_HEADER* this_header = GetHeader();
-  int this_used = this_header->used_;
-  int str_used  = str_header->used_;
+  int this_used = GetUsed();
+  int str_used  = str.GetUsed();
 
   return (this_used == str_used)
           && (memcmp(GetCStr(), str.GetCStr(), this_used) == 0);
@@ -228,10 +240,8 @@ BOOL8 STRING::operator==(const STRING& str) const {
 BOOL8 STRING::operator!=(const STRING& str) const {
   FixHeader();
   str.FixHeader();
-  const STRING_HEADER* str_header = str.GetHeader();
-  const STRING_HEADER* this_header = GetHeader();
-  int this_used = this_header->used_;
-  int str_used  = str_header->used_;
+  int this_used = GetUsed();
+  int str_used  = str.GetUsed();
 
   return (this_used != str_used)
          || (memcmp(GetCStr(), str.GetCStr(), this_used) != 0);
@@ -239,28 +249,26 @@ BOOL8 STRING::operator!=(const STRING& str) const {
 
 BOOL8 STRING::operator!=(const char* cstr) const {
   FixHeader();
-  const STRING_HEADER* this_header = GetHeader();
+  int this_used = GetUsed();
 
   if (cstr == NULL)
-    return this_header->used_ > 1;  // either '\0' or NULL
+    return this_used > 1;  // either '\0' or NULL
   else {
     inT32 length = strlen(cstr) + 1;
-    return (this_header->used_ != length)
+    return (this_used != length)
             || (memcmp(GetCStr(), cstr, length) != 0);
   }
 }
 
 STRING& STRING::operator=(const STRING& str) {
   str.FixHeader();
-  const STRING_HEADER* str_header = str.GetHeader();
-  int   str_used = str_header->used_;
+  int   str_used = str.GetUsed();
 
-  GetHeader()->used_ = 0;  // clear since ensure doesnt need to copy data
+  SetUsed(0);  // clear since ensure doesnt need to copy data
   char* this_cstr = ensure_cstr(str_used);
-  STRING_HEADER* this_header = GetHeader();
 
   memcpy(this_cstr, str.GetCStr(), str_used);
-  this_header->used_ = str_used;
+  SetUsed(str_used);
 
   assert(InvariantOk());
   return *this;
@@ -269,20 +277,18 @@ STRING& STRING::operator=(const STRING& str) {
 STRING & STRING::operator+=(const STRING& str) {
   FixHeader();
   str.FixHeader();
-  const STRING_HEADER* str_header = str.GetHeader();
-  const char* str_cstr = str.GetCStr();
-  int  str_used  = str_header->used_;
-  int  this_used = GetHeader()->used_;
+  int  str_used  = str.GetUsed();
+  int  this_used = GetUsed();
   char* this_cstr = ensure_cstr(this_used + str_used);
-
-  STRING_HEADER* this_header = GetHeader();  // after ensure for realloc
+  // after ensure, in case str is this and was reallocated
+  const char* str_cstr = str.GetCStr();
 
   if (this_used > 1) {
-    memcpy(this_cstr + this_used - 1, str_cstr, str_used);
-    this_header->used_ += str_used - 1;  // overwrite '\0'
+    memmove(this_cstr + this_used - 1, str_cstr, str_used);
+    SetUsed(this_used + str_used - 1);  // overwrite '\0'
   } else {
     memcpy(this_cstr, str_cstr, str_used);
-    this_header->used_ = str_used;
+    SetUsed(str_used);
   }
 
   assert(InvariantOk());
@@ -300,15 +306,13 @@ void STRING::add_str_int(const char* str, int number) {
 }
 
 STRING & STRING::operator=(const char* cstr) {
-  STRING_HEADER* this_header = GetHeader();
   if (cstr) {
     int len = strlen(cstr) + 1;
 
-    this_header->used_ = 0;  // dont bother copying data if need to realloc
+    SetUsed(0);  // dont bother copying data if need to realloc
     char* this_cstr = ensure_cstr(len);
-    this_header = GetHeader();  // for realloc
     memcpy(this_cstr, cstr, len);
-    this_header->used_ = len;
+    SetUsed(len);
   }
   else {
     // Reallocate to zero capacity buffer, consistent with the corresponding
@@ -334,17 +338,15 @@ STRING STRING::operator+(const STRING& str) const {
 STRING STRING::operator+(const char ch) const {
   STRING result;
   FixHeader();
-  const STRING_HEADER* this_header = GetHeader();
-  int this_used = this_header->used_;
+  int this_used = GetUsed();
   char* result_cstr = result.ensure_cstr(this_used + 1);
-  STRING_HEADER* result_header = result.GetHeader();
-  int result_used = result_header->used_;
+  int result_used = result.GetUsed();
 
   // copies '\0' but we'll overwrite that
   memcpy(result_cstr, GetCStr(), this_used);
   result_cstr[result_used] = ch;      // overwrite old '\0'
   result_cstr[result_used + 1] = '\0';  // append on '\0'
-  ++result_header->used_;
+  result.SetUsed(result_used + 1);
 
   assert(InvariantOk());
   return result;
@@ -357,18 +359,17 @@ STRING&  STRING::operator+=(const char *str) {
 
   FixHeader();
   int len = strlen(str) + 1;
-  int this_used = GetHeader()->used_;
+  int this_used = GetUsed();
   char* this_cstr = ensure_cstr(this_used + len);
-  STRING_HEADER* this_header = GetHeader();  // after ensure for realloc
 
   // if we had non-empty string then append overwriting old '\0'
   // otherwise replace
   if (this_used > 0) {
     memcpy(this_cstr + this_used - 1, str, len);
-    this_header->used_ += len - 1;
+    SetUsed(this_used + len - 1);
   } else {
     memcpy(this_cstr, str, len);
-    this_header->used_ = len;
+    SetUsed(len);
   }
 
   assert(InvariantOk());
@@ -381,16 +382,15 @@ STRING& STRING::operator+=(const char ch) {
     return *this;
 
   FixHeader();
-  int   this_used = GetHeader()->used_;
+  int   this_used = GetUsed();
   char* this_cstr = ensure_cstr(this_used + 1);
-  STRING_HEADER* this_header = GetHeader();
 
   if (this_used > 0)
     --this_used; // undo old empty null if there was one
 
   this_cstr[this_used++] = ch;   // append ch to end
   this_cstr[this_used++] = '\0'; // append '\0' after ch
-  this_header->used_ = this_used;
+  SetUsed(this_used);
 
   assert(InvariantOk());
   return *this;
@@ -79,6 +79,13 @@ class DLLSYM STRING
     // ensure capcaity but keep pointer encapsulated
     inline void ensure(inT32 min_capacity) { ensure_cstr(min_capacity); }
 
+    // Exchanges contents with other without copying or allocating.
+    inline void swap(STRING* other) {
+      STRING_HEADER* tmp = data_;
+      data_ = other->data_;
+      other->data_ = tmp;
+    }
+
   private:
     typedef struct STRING_HEADER {
       // How much space was allocated in the string buffer for char data.
@@ -102,28 +109,62 @@ class DLLSYM STRING
     // for one pointer in this structure. So we are embedding a data structure
     // at the start of the storage that will hold additional state variables,
     // then storing the actual string contents immediately after.
-    STRING_HEADER* data_;
+    //
+    // Strings whose capacity (including the '\0') fits in kInlineCapacity
+    // do not allocate at all: they are kept in the bytes of the pointer
+    // itself. Heap storage is always aligned, so the least significant bit
+    // of a real pointer is 0. An inline string sets that bit in its tag byte
+    // and keeps used_ + 1 in the remaining bits of the tag.
+    union {
+      STRING_HEADER* data_;
+      char inline_[sizeof(STRING_HEADER*)];
+    };
+    enum { kInlineCapacity = sizeof(STRING_HEADER*) - 1 };
 
-    // returns the header part of the storage
-    inline STRING_HEADER* GetHeader() {
-      return data_;
+    // Index in inline_ of the least significant byte of data_.
+    static inline int TagIndex() {
+      const inT16 probe = 1;
+      return *reinterpret_cast<const char*>(&probe) == 1 ? 0 : kInlineCapacity;
+    }
+    static inline char InlineTag(int used) {
+      return static_cast<char>(((used + 1) << 1) | 1);
     }
-    inline const STRING_HEADER* GetHeader() const {
-      return data_;
+    inline bool IsInline() const {
+      return (inline_[TagIndex()] & 1) != 0;
+    }
+
+    // used_ and capacity_ of whichever storage is in use.
+    inline int GetUsed() const {
+      if (IsInline())
+        return (static_cast<unsigned char>(inline_[TagIndex()]) >> 1) - 1;
+      return data_->used_;
+    }
+    inline void SetUsed(int used) const {
+      if (IsInline())
+        const_cast<char*>(inline_)[TagIndex()] = InlineTag(used);
+      else
+        data_->used_ = used;
+    }
+    inline int GetCapacity() const {
+      return IsInline() ? kInlineCapacity : data_->capacity_;
     }
 
     // returns the string data part of storage
     inline char* GetCStr() {
+      if (IsInline())
+        return inline_ + (TagIndex() == 0 ? 1 : 0);
       return ((char *)data_) + sizeof(STRING_HEADER);
     };
 
     inline const char* GetCStr() const {
+      if (IsInline())
+        return inline_ + (TagIndex() == 0 ? 1 : 0);
       return ((const char *)data_) + sizeof(STRING_HEADER);
     };
     inline bool InvariantOk() const {
 #if STRING_IS_PROTECTED
-      return (GetHeader()->used_ == 0) ?
-        (string() == NULL) : (GetHeader()->used_ == (strlen(string()) + 1));
+      return (GetUsed() == 0) ?
+        (string() == NULL) : (GetUsed() == (strlen(string()) + 1));
 #else
       return true;
 #endif
@@ -136,7 +177,32 @@ class DLLSYM STRING
 
     void FixHeader() const;  // make used_ non-negative, even if const
 
+    // Sets up storage for capacity chars, inline if it fits.
+
     char* AllocData(int used, int capacity);
     void DiscardData();
 };
+
+namespace tesseract {
+
+template <typename T> struct GenericVectorTraits;
+
+// A GenericVector<STRING> hands over the buffers when it relocates.
+template <>
+struct GenericVectorTraits<STRING> {
+  static void Move(STRING* from, STRING* to) {
+    to->swap(from);
+  }
+  static void MoveRange(STRING* from, STRING* to, int count) {
+    for (int i = 0; i < count; ++i)
+      to[i].swap(&from[i]);
+  }
+  static void CopyRange(const STRING* from, STRING* to, int count) {
+    for (int i = 0; i < count; ++i)
+      to[i] = from[i];
+  }
+};
+
+}  // namespace tesseract
+
 #endif
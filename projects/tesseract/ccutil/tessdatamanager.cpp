@@ -40,6 +40,8 @@ bool TessdataManager::Init(const char *data_file_name, int debug_level) {
     tprintf("Error opening data file %s\n", data_file_name);
     return false;
   }
+  for (i = 0; i < TESSDATA_NUM_ENTRIES; ++i)
+    checksums_[i] = -1;
   fread(&actual_tessdata_num_entries_, sizeof(inT32), 1, data_file_);
   bool swap = (actual_tessdata_num_entries_ > kMaxNumTessdataEntries);
   if (swap) {
@@ -63,6 +65,89 @@ bool TessdataManager::Init(const char *data_file_name, int debug_level) {
   return true;
 }
 
+inT64 TessdataManager::GetComponentSize(TessdataType tessdata_type) {
+  if (tessdata_type >= actual_tessdata_num_entries_ ||
+      offset_table_[tessdata_type] < 0)
+    return -1;
+  inT64 end_offset = GetEndOffset(tessdata_type);
+  if (end_offset < 0) {
+    // The last component runs to the end of the file.
+    ASSERT_HOST(fseek(data_file_, 0, SEEK_END) == 0);
+    end_offset = ftell(data_file_) - 1;
+  }
+  return end_offset - offset_table_[tessdata_type] + 1;
+}
+
+bool TessdataManager::GetComponentChecksum(TessdataType tessdata_type,
+                                           uinT32 *checksum) {
+  if (tessdata_type < actual_tessdata_num_entries_ &&
+      checksums_[tessdata_type] >= 0) {
+    *checksum = static_cast<uinT32>(checksums_[tessdata_type]);
+    return true;
+  }
+  inT64 size = GetComponentSize(tessdata_type);
+  if (size < 0 || !SeekToStart(tessdata_type)) return false;
+  uinT32 hash = 2166136261U;  // FNV-1a 32 bit offset basis.
+  unsigned char buffer[4096];
+  while (size > 0) {
+    size_t count = size < static_cast<inT64>(sizeof(buffer))
+        ? static_cast<size_t>(size) : sizeof(buffer);
+    if (fread(buffer, 1, count, data_file_) != count) return false;
+    for (size_t i = 0; i < count; ++i) {
+      hash ^= buffer[i];
+      hash *= 16777619U;  // FNV-1a 32 bit prime.
+    }
+    size -= count;
+  }
+  checksums_[tessdata_type] = hash;
+  *checksum = hash;
+  return true;
+}
+
+bool TessdataManager::SeekToCompiledStart(TessdataType compiled_type,
+                                          TessdataType source_type) {
+  if (compiled_type >= actual_tessdata_num_entries_) return false;
+  inT64 source_size = GetComponentSize(source_type);
+  uinT32 source_checksum = 0;
+  if (source_size < 0 ||
+      !GetComponentChecksum(source_type, &source_checksum) ||
+      !SeekToStart(compiled_type))
+    return false;
+  inT32 magic = 0;
+  inT32 version = 0;
+  inT64 compiled_source_size = -1;
+  uinT32 compiled_source_checksum = 0;
+  if (fread(&magic, sizeof(magic), 1, data_file_) != 1 ||
+      fread(&version, sizeof(version), 1, data_file_) != 1 ||
+      fread(&compiled_source_size, sizeof(compiled_source_size), 1,
+            data_file_) != 1 ||
+      fread(&compiled_source_checksum, sizeof(compiled_source_checksum), 1,
+            data_file_) != 1)
+    return false;
+  if (magic != kCompiledTessdataMagic ||
+      version != kCompiledTessdataVersion ||
+      compiled_source_size != source_size ||
+      compiled_source_checksum != source_checksum) {
+    if (debug_level_) {
+      tprintf("TessdataManager: ignoring out of date or foreign %s\n",
+              kTessdataFileSuffixes[compiled_type]);
+    }
+    return false;
+  }
+  return true;
+}
+
+void TessdataManager::WriteCompiledHeader(inT64 source_size,
+                                          uinT32 source_checksum,
+                                          FILE *output_file) {
+  inT32 magic = kCompiledTessdataMagic;
+  inT32 version = kCompiledTessdataVersion;
+  fwrite(&magic, sizeof(magic), 1, output_file);
+  fwrite(&version, sizeof(version), 1, output_file);
+  fwrite(&source_size, sizeof(source_size), 1, output_file);
+  fwrite(&source_checksum, sizeof(source_checksum), 1, output_file);
+}
+
 void TessdataManager::CopyFile(FILE *input_file, FILE *output_file,
                                bool newline_end, inT64 num_bytes_to_copy) {
   if (num_bytes_to_copy == 0) return;
@@ -41,6 +41,9 @@ static const char kFreqDawgFileSuffix[] = "freq-dawg";
 static const char kFixedLengthDawgsFileSuffix[] = "fixed-length-dawgs";
 static const char kCubeUnicharsetFileSuffix[] = "cube-unicharset";
 static const char kCubeSystemDawgFileSuffix[] = "cube-word-dawg";
+static const char kCompiledUnicharsetFileSuffix[] = "unicharset-bin";
+static const char kCompiledCutoffsFileSuffix[] = "pffmtable-bin";
+static const char kCompiledAmbigsFileSuffix[] = "unicharambigs-bin";
 
 namespace tesseract {
 
@@ -58,6 +61,9 @@ enum TessdataType {
   TESSDATA_FIXED_LENGTH_DAWGS,  // 10
   TESSDATA_CUBE_UNICHARSET,     // 11
   TESSDATA_CUBE_SYSTEM_DAWG,    // 12
+  TESSDATA_UNICHARSET_BIN,      // 13
+  TESSDATA_PFFMTABLE_BIN,       // 14
+  TESSDATA_AMBIGS_BIN,          // 15
 
   TESSDATA_NUM_ENTRIES
 };
@@ -80,6 +86,9 @@ static const char * const kTessdataFileSuffixes[] = {
   kFixedLengthDawgsFileSuffix,  // 10
   kCubeUnicharsetFileSuffix,    // 11
   kCubeSystemDawgFileSuffix,    // 12
+  kCompiledUnicharsetFileSuffix,  // 13
+  kCompiledCutoffsFileSuffix,   // 14
+  kCompiledAmbigsFileSuffix,    // 15
 };
 
 /**
@@ -100,6 +109,9 @@ static const bool kTessdataFileIsText[] = {
   false,                        // 10
   true,                         // 11
   false,                        // 12
+  false,                        // 13
+  false,                        // 14
+  false,                        // 15
 };
 
 /**
@@ -111,6 +123,18 @@ static const bool kTessdataFileIsText[] = {
  */
 static const int kMaxNumTessdataEntries = 1000;
 
+/**
+ * Compiled components (TESSDATA_UNICHARSET_BIN, TESSDATA_PFFMTABLE_BIN and
+ * TESSDATA_AMBIGS_BIN) are binary copies of text components, written by
+ * compile_tessdata so that they load without parsing. Each starts with
+ * kCompiledTessdataMagic, kCompiledTessdataVersion and the size and FNV-1a
+ * checksum of the text component it was made from, so that a compiled
+ * component is ignored once its source has been replaced, even by one of
+ * the same size, or if it was written with the other byte order.
+ */
+static const inT32 kCompiledTessdataMagic = 0x54534243;  // "TSBC"
+static const inT32 kCompiledTessdataVersion = 2;
+
 
 class TessdataManager {
  public:
@@ -119,6 +143,7 @@ class TessdataManager {
     actual_tessdata_num_entries_ = 0;
     for (int i = 0; i < TESSDATA_NUM_ENTRIES; ++i) {
       offset_table_[i] = -1;
+      checksums_[i] = -1;
     }
   }
   ~TessdataManager() {}
@@ -167,6 +192,35 @@ class TessdataManager {
     }
     return (index == actual_tessdata_num_entries_) ? -1 : offset_table_[index] - 1;
   }
+  /**
+   * Returns the size in bytes of the data of the given type, or -1 if
+   * there is none.
+   */
+  inT64 GetComponentSize(TessdataType tessdata_type);
+
+  /**
+   * Sets *checksum to the FNV-1a checksum of the data of the given type.
+   * Returns false if there is none or it can't be read. Leaves data_file_
+   * at an unspecified position.
+   */
+  bool GetComponentChecksum(TessdataType tessdata_type, uinT32 *checksum);
+
+  /**
+   * Returns false if there is no data of type compiled_type, or if it was
+   * not compiled from the data of type source_type now in the file.
+   * Otherwise positions data_file_ just past the header of the compiled
+   * data, ready for its reader.
+   */
+  bool SeekToCompiledStart(TessdataType compiled_type,
+                           TessdataType source_type);
+
+  /**
+   * Writes the header of a compiled component made from a text component
+   * of source_size bytes with the given checksum.
+   */
+  static void WriteCompiledHeader(inT64 source_size, uinT32 source_checksum,
+                                  FILE *output_file);
+
   /** Closes data_file_ (if it was opened by Init()). */
   inline void End() {
     if (data_file_ != NULL) {
@@ -258,6 +312,11 @@ class TessdataManager {
    * when new tessdata types are introduced.
    */
   inT32 actual_tessdata_num_entries_;
+  /**
+   * GetComponentChecksum results, or -1 if not yet computed, as compiled
+   * components may be checked against the same source more than once.
+   */
+  inT64 checksums_[TESSDATA_NUM_ENTRIES];
   FILE *data_file_;  ///< pointer to the data file.
   int debug_level_;
 };
@@ -0,0 +1,384 @@
+///////////////////////////////////////////////////////////////////////
+// File:        tesslog.cpp
+// Description: Leveled logging behind tprintf, with per-engine sinks and a
+//              background writer fed through a lock-free ring buffer.
+// Created:     Sat Oct 17 10:12:36 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include "mfcpch.h"
+#include "tesslog.h"
+#include <stdlib.h>
+#include <string.h>
+#include "ccutil.h"
+#include "tprintf.h"
+
+#ifndef WIN32
+#include <errno.h>
+#endif
+
+namespace tesseract {
+
+// Longest message kept, excluding the '\0'. Longer ones are truncated.
+const int kMaxLogMsgLen = 1024;
+// Messages the ring holds before callers wait for the writer. Must be a
+// power of 2.
+const int kLogRingSize = 256;
+
+// One entry of the ring buffer. sequence tells producers and the writer
+// who owns the slot: it equals the position a producer may claim it at,
+// that position + 1 once the message is ready for the writer, and
+// position + kLogRingSize once the writer has finished with it.
+struct LogSlot {
+  volatile uinT32 sequence;
+  TessLogSink* sink;
+  char msg[kMaxLogMsgLen + 1];
+};
+
+// Per-thread state, reached through a thread-specific key.
+struct LogThreadState {
+  TessLogSink* sink;               // NULL for the default sink.
+  char buffer[kMaxLogMsgLen + 1];  // Format buffer.
+};
+
+static LogSlot log_ring[kLogRingSize];
+static volatile uinT32 log_ring_head = 0;  // Next position to claim.
+static uinT32 log_ring_tail = 0;           // Next position to write.
+static volatile uinT32 log_written = 0;    // Positions written so far.
+static volatile bool log_started = false;
+static bool log_writer_running = false;
+// Callers waiting on a full ring or in TessLogFlush count themselves in
+// log_waiters, under log_wait_mutex, and wait on log_progress_sem. The
+// writer posts it once per waiter whenever it has written messages, so
+// each wake-up goes to a waiter that had already found it had to wait.
+static CCUtilMutex* log_wait_mutex = NULL;
+static int log_waiters = 0;
+
+#ifdef WIN32
+static DWORD log_thread_key;
+static HANDLE log_ring_sem;
+static HANDLE log_progress_sem;
+static DWORD log_writer_id;
+#else
+static pthread_key_t log_thread_key;
+static sem_t log_ring_sem;
+static sem_t log_progress_sem;
+static pthread_t log_writer;
+#endif
+
+// Returns the value *value had; *value is set to new_value only if that
+// was old_value.
+static uinT32 CompareAndSwap(volatile uinT32* value, uinT32 old_value,
+                             uinT32 new_value) {
+#ifdef WIN32
+  return static_cast<uinT32>(InterlockedCompareExchange(
+      reinterpret_cast<volatile LONG*>(value), new_value, old_value));
+#else
+  return __sync_val_compare_and_swap(value, old_value, new_value);
+#endif
+}
+
+static void MemoryFence() {
+#ifdef WIN32
+  MemoryBarrier();
+#else
+  __sync_synchronize();
+#endif
+}
+
+static bool OnWriterThread() {
+  if (!log_writer_running)
+    return false;
+#ifdef WIN32
+  return GetCurrentThreadId() == log_writer_id;
+#else
+  return pthread_equal(pthread_self(), log_writer) != 0;
+#endif
+}
+
+// Blocks until done(arg) is true. done must only become true through the
+// writer's progress.
+static void WaitForWriter(bool (*done)(uinT32), uinT32 arg) {
+  for (;;) {
+    // Tested under the mutex, so progress made after the test finds this
+    // waiter counted and posts for it.
+    log_wait_mutex->Lock();
+    MemoryFence();
+    if (done(arg)) {
+      log_wait_mutex->Unlock();
+      return;
+    }
+    ++log_waiters;
+    log_wait_mutex->Unlock();
+#ifdef WIN32
+    WaitForSingleObject(log_progress_sem, INFINITE);
+#else
+    while (sem_wait(&log_progress_sem) != 0 && errno == EINTR) {}
+#endif
+  }
+}
+
+// Writes every message that is ready, in order, then wakes any waiters.
+static void DrainRing() {
+  bool wrote = false;
+  for (;;) {
+    LogSlot* slot = &log_ring[log_ring_tail & (kLogRingSize - 1)];
+    if (slot->sequence != log_ring_tail + 1)
+      break;
+    MemoryFence();
+    slot->sink->WriteMessage(slot->msg);
+    MemoryFence();
+    slot->sequence = log_ring_tail + kLogRingSize;
+    ++log_ring_tail;
+    log_written = log_ring_tail;
+    wrote = true;
+  }
+  if (wrote) {
+    log_wait_mutex->Lock();
+#ifdef WIN32
+    if (log_waiters > 0)
+      ReleaseSemaphore(log_progress_sem, log_waiters, NULL);
+#else
+    for (int i = 0; i < log_waiters; ++i)
+      sem_post(&log_progress_sem);
+#endif
+    log_waiters = 0;
+    log_wait_mutex->Unlock();
+  }
+}
+
+#ifdef WIN32
+static DWORD WINAPI WriterMain(LPVOID) {
+  for (;;) {
+    WaitForSingleObject(log_ring_sem, INFINITE);
+    DrainRing();
+  }
+  return 0;
+}
+#else
+static void* WriterMain(void*) {
+  for (;;) {
+    while (sem_wait(&log_ring_sem) != 0 && errno == EINTR) {}
+    DrainRing();
+  }
+  return NULL;
+}
+
+static void FreeThreadState(void* state) {
+  delete reinterpret_cast<LogThreadState*>(state);
+}
+#endif
+
+static void FlushAtExit() {
+  TessLogFlush();
+}
+
+// Sets up the ring, the thread key and the writer thread on first use.
+static void StartLogging() {
+  if (log_started)
+    return;
+  tprintfMutex.Lock();
+  if (!log_started) {
+    for (int i = 0; i < kLogRingSize; ++i)
+      log_ring[i].sequence = i;
+    log_wait_mutex = new CCUtilMutex;
+    // Constructs the default sink before any thread can race to do so.
+    TessLogDefaultSink();
+#ifdef WIN32
+    log_thread_key = TlsAlloc();
+    log_ring_sem = CreateSemaphore(NULL, 0, MAX_INT32, NULL);
+    log_progress_sem = CreateSemaphore(NULL, 0, MAX_INT32, NULL);
+    HANDLE thread = CreateThread(NULL, 0, WriterMain, NULL, 0,
+                                 &log_writer_id);
+    log_writer_running = thread != NULL;
+    if (thread != NULL)
+      CloseHandle(thread);
+#else
+    pthread_key_create(&log_thread_key, FreeThreadState);
+    sem_init(&log_ring_sem, 0, 0);
+    sem_init(&log_progress_sem, 0, 0);
+    log_writer_running =
+        pthread_create(&log_writer, NULL, WriterMain, NULL) == 0;
+    if (log_writer_running)
+      pthread_detach(log_writer);
+#endif
+    if (log_writer_running)
+      atexit(FlushAtExit);
+    MemoryFence();
+    log_started = true;
+  }
+  tprintfMutex.Unlock();
+}
+
+// Returns the calling thread's state, creating it if need be. On Windows
+// the state of a thread is never freed.
+static LogThreadState* ThreadState() {
+  StartLogging();
+#ifdef WIN32
+  LogThreadState* state =
+      reinterpret_cast<LogThreadState*>(TlsGetValue(log_thread_key));
+#else
+  LogThreadState* state =
+      reinterpret_cast<LogThreadState*>(pthread_getspecific(log_thread_key));
+#endif
+  if (state == NULL) {
+    state = new LogThreadState;
+    state->sink = NULL;
+    state->buffer[0] = '\0';
+#ifdef WIN32
+    TlsSetValue(log_thread_key, state);
+#else
+    pthread_setspecific(log_thread_key, state);
+#endif
+  }
+  return state;
+}
+
+// True once the writer has freed the slot for position pos.
+static bool SlotFree(uinT32 pos) {
+  LogSlot* slot = &log_ring[pos & (kLogRingSize - 1)];
+  return static_cast<inT32>(slot->sequence - pos) >= 0;
+}
+
+// True once every position before target has been written.
+static bool WrittenUpTo(uinT32 target) {
+  return static_cast<inT32>(log_written - target) >= 0;
+}
+
+// Copies msg into a free slot of the ring and wakes the writer. Waits for
+// the writer if the ring is full, so messages are never dropped or
+// reordered.
+static void Enqueue(TessLogSink* sink, const char* msg) {
+  if (!log_writer_running || OnWriterThread()) {
+    // No writer, or a sink logging from inside the writer: write it here.
+    tprintfMutex.Lock();
+    sink->WriteMessage(msg);
+    tprintfMutex.Unlock();
+    return;
+  }
+  uinT32 pos = log_ring_head;
+  LogSlot* slot;
+  for (;;) {
+    slot = &log_ring[pos & (kLogRingSize - 1)];
+    inT32 diff = static_cast<inT32>(slot->sequence - pos);
+    if (diff == 0) {
+      if (CompareAndSwap(&log_ring_head, pos, pos + 1) == pos)
+        break;
+    } else if (diff < 0) {
+      WaitForWriter(SlotFree, pos);  // Full.
+    }
+    pos = log_ring_head;
+  }
+  slot->sink = sink;
+  strcpy(slot->msg, msg);
+  MemoryFence();
+  slot->sequence = pos + 1;
+#ifdef WIN32
+  ReleaseSemaphore(log_ring_sem, 1, NULL);
+#else
+  sem_post(&log_ring_sem);
+#endif
+}
+
+TessLogSink::TessLogSink(const char* filename)
+  : filename_(filename != NULL ? filename : ""), fp_(NULL),
+    open_failed_(false) {
+}
+
+TessLogSink::TessLogSink() : fp_(NULL), open_failed_(false) {
+}
+
+TessLogSink::~TessLogSink() {
+  TessLogFlush();
+  if (fp_ != NULL)
+    fclose(fp_);
+}
+
+void TessLogSink::WriteMessage(const char* msg) {
+  if (fp_ == NULL && !open_failed_ && filename_.length() > 0) {
+    fp_ = fopen(filename_.string(), "w");
+    open_failed_ = fp_ == NULL;
+  }
+  fputs(msg, fp_ != NULL ? fp_ : stderr);
+}
+
+TessLogSink* TessLogSetThreadSink(TessLogSink* sink) {
+  LogThreadState* state = ThreadState();
+  TessLogSink* previous = state->sink;
+  state->sink = sink;
+  return previous;
+}
+
+bool TessLogEnabled(int level) {
+  return level >= TESS_LOG_ERROR || level >= debug_log_level;
+}
+
+void TessLogMessageV(int level, const char* format, va_list args) {
+  if (!TessLogEnabled(level))
+    return;
+  LogThreadState* state = ThreadState();
+#ifdef __MSW32__
+  _vsnprintf(state->buffer, kMaxLogMsgLen, format, args);
+#else
+  vsnprintf(state->buffer, kMaxLogMsgLen, format, args);
+#endif
+  state->buffer[kMaxLogMsgLen] = '\0';
+  TessLogSink* sink = state->sink;
+  Enqueue(sink != NULL ? sink : TessLogDefaultSink(), state->buffer);
+  // Errors usually precede an abort, so make sure they get out.
+  if (level >= TESS_LOG_ERROR)
+    TessLogFlush();
+}
+
+void TessLogMessage(int level, const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  TessLogMessageV(level, format, args);
+  va_end(args);
+}
+
+void TessLogDebug(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  TessLogMessageV(TESS_LOG_DEBUG, format, args);
+  va_end(args);
+}
+
+void TessLogInfo(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  TessLogMessageV(TESS_LOG_INFO, format, args);
+  va_end(args);
+}
+
+void TessLogWarning(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  TessLogMessageV(TESS_LOG_WARNING, format, args);
+  va_end(args);
+}
+
+void TessLogError(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  TessLogMessageV(TESS_LOG_ERROR, format, args);
+  va_end(args);
+}
+
+void TessLogFlush() {
+  if (!log_writer_running || OnWriterThread())
+    return;
+  WaitForWriter(WrittenUpTo, log_ring_head);
+}
+
+}  // namespace tesseract.
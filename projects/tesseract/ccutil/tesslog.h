@@ -0,0 +1,140 @@
+///////////////////////////////////////////////////////////////////////
+// File:        tesslog.h
+// Description: Leveled logging behind tprintf, with per-engine sinks and a
+//              background writer fed through a lock-free ring buffer.
+// Created:     Sat Oct 17 10:12:36 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_CCUTIL_TESSLOG_H__
+#define TESSERACT_CCUTIL_TESSLOG_H__
+
+#include <stdarg.h>
+#include <stdio.h>
+#include "host.h"
+#include "strngs.h"
+
+// Message levels. They are macros rather than an enum so that
+// TESS_MIN_LOG_LEVEL can be tested by the preprocessor.
+#define TESS_LOG_DEBUG    0
+#define TESS_LOG_INFO     1
+#define TESS_LOG_WARNING  2
+#define TESS_LOG_ERROR    3
+
+// Messages below this level are compiled out entirely, arguments included.
+// Release builds can set it with -DTESS_MIN_LOG_LEVEL=TESS_LOG_INFO to drop
+// the debug output of the hot paths.
+#ifndef TESS_MIN_LOG_LEVEL
+#define TESS_MIN_LOG_LEVEL TESS_LOG_DEBUG
+#endif
+
+// The TLOG_* macros are used like tprintf, as in
+// TLOG_DEBUG("Pass1: %s\n", text). Below TESS_MIN_LOG_LEVEL they expand to
+// a loop that never runs, so the arguments are not even evaluated. Above
+// it, they are only evaluated if the level passes the debug_log_level
+// parameter, which can be changed at run time.
+#if TESS_MIN_LOG_LEVEL <= TESS_LOG_DEBUG
+#define TLOG_DEBUG \
+  if (!tesseract::TessLogEnabled(TESS_LOG_DEBUG)) {} \
+  else tesseract::TessLogDebug
+#else
+#define TLOG_DEBUG while (false) tesseract::TessLogDebug
+#endif
+#if TESS_MIN_LOG_LEVEL <= TESS_LOG_INFO
+#define TLOG_INFO \
+  if (!tesseract::TessLogEnabled(TESS_LOG_INFO)) {} \
+  else tesseract::TessLogInfo
+#else
+#define TLOG_INFO while (false) tesseract::TessLogInfo
+#endif
+#if TESS_MIN_LOG_LEVEL <= TESS_LOG_WARNING
+#define TLOG_WARNING \
+  if (!tesseract::TessLogEnabled(TESS_LOG_WARNING)) {} \
+  else tesseract::TessLogWarning
+#else
+#define TLOG_WARNING while (false) tesseract::TessLogWarning
+#endif
+#define TLOG_ERROR tesseract::TessLogError
+
+namespace tesseract {
+
+// Where log messages end up. Messages are formatted on the calling thread
+// and written by a background thread, so a sink may be used by any number
+// of threads without them waiting on each other or on the file.
+class TessLogSink {
+ public:
+  // Messages go to filename, which is truncated when the first message
+  // arrives, or to stderr if filename is NULL or empty.
+  explicit TessLogSink(const char* filename);
+  // Writes out any messages still queued for this sink.
+  virtual ~TessLogSink();
+
+  // Writes msg to the destination. Only called by the writer thread, or
+  // with tprintfMutex held when there is no writer thread.
+  virtual void WriteMessage(const char* msg);
+
+ protected:
+  TessLogSink();
+
+ private:
+  STRING filename_;
+  FILE* fp_;
+  bool open_failed_;
+};
+
+// Returns the sink used by threads that have not set one: the original
+// tprintf destination, controlled by the debug_file and debug_window_on
+// globals.
+TessLogSink* TessLogDefaultSink();
+
+// Sends this thread's messages to sink, or to the default sink if NULL.
+// Returns the previous sink of the thread.
+TessLogSink* TessLogSetThreadSink(TessLogSink* sink);
+
+// Sets the thread's sink for the lifetime of the object. Engines put one at
+// the top of each entry point, so that the output of an engine goes to its
+// own sink whichever thread runs it.
+class TessLogSinkScope {
+ public:
+  explicit TessLogSinkScope(TessLogSink* sink)
+    : previous_(TessLogSetThreadSink(sink)) {}
+  ~TessLogSinkScope() {
+    TessLogSetThreadSink(previous_);
+  }
+
+ private:
+  TessLogSink* previous_;
+};
+
+// Returns true if messages of the given level are written, as set by the
+// debug_log_level parameter. Errors are always written.
+bool TessLogEnabled(int level);
+
+// Formats a message into a buffer private to the calling thread and queues
+// it for the thread's sink, if the level is enabled. Use the TLOG_* macros
+// instead, so that levels below TESS_MIN_LOG_LEVEL cost nothing.
+void TessLogMessage(int level, const char* format, ...);
+void TessLogMessageV(int level, const char* format, va_list args);
+// TessLogMessage at a fixed level, for the TLOG_* macros.
+void TessLogDebug(const char* format, ...);
+void TessLogInfo(const char* format, ...);
+void TessLogWarning(const char* format, ...);
+void TessLogError(const char* format, ...);
+
+// Blocks until every message queued before the call has been written.
+// Called before aborting, and at exit.
+void TessLogFlush();
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_CCUTIL_TESSLOG_H__
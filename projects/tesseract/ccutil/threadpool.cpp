@@ -0,0 +1,235 @@
+///////////////////////////////////////////////////////////////////////
+// File:        threadpool.cpp
+// Description: Fixed-size pool of worker threads running TessClosures,
+//              and the event primitive used to wait on their results.
+// Created:     Tue Oct 13 09:02:41 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include "threadpool.h"
+#include "tprintf.h"
+
+#ifndef WIN32
+#include <errno.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace tesseract {
+
+ThreadEvent::ThreadEvent() {
+#ifdef WIN32
+  event_ = CreateEvent(NULL, TRUE, FALSE, NULL);
+#else
+  pthread_mutex_init(&mutex_, NULL);
+  pthread_cond_init(&cond_, NULL);
+  signalled_ = false;
+#endif
+}
+
+ThreadEvent::~ThreadEvent() {
+#ifdef WIN32
+  CloseHandle(event_);
+#else
+  pthread_cond_destroy(&cond_);
+  pthread_mutex_destroy(&mutex_);
+#endif
+}
+
+void ThreadEvent::Signal() {
+#ifdef WIN32
+  SetEvent(event_);
+#else
+  pthread_mutex_lock(&mutex_);
+  signalled_ = true;
+  pthread_cond_broadcast(&cond_);
+  pthread_mutex_unlock(&mutex_);
+#endif
+}
+
+void ThreadEvent::Reset() {
+#ifdef WIN32
+  ResetEvent(event_);
+#else
+  pthread_mutex_lock(&mutex_);
+  signalled_ = false;
+  pthread_mutex_unlock(&mutex_);
+#endif
+}
+
+bool ThreadEvent::Wait(int timeout_msecs) {
+#ifdef WIN32
+  return WaitForSingleObject(event_, timeout_msecs < 0 ? INFINITE
+                                                       : timeout_msecs) ==
+         WAIT_OBJECT_0;
+#else
+  pthread_mutex_lock(&mutex_);
+  if (timeout_msecs < 0) {
+    while (!signalled_)
+      pthread_cond_wait(&cond_, &mutex_);
+  } else {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    struct timespec end_time;
+    long usecs = now.tv_usec + (timeout_msecs % 1000) * 1000L;
+    end_time.tv_sec = now.tv_sec + timeout_msecs / 1000 + usecs / 1000000;
+    end_time.tv_nsec = (usecs % 1000000) * 1000;
+    while (!signalled_) {
+      if (pthread_cond_timedwait(&cond_, &mutex_, &end_time) == ETIMEDOUT)
+        break;
+    }
+  }
+  bool result = signalled_;
+  pthread_mutex_unlock(&mutex_);
+  return result;
+#endif
+}
+
+ThreadPool::ThreadPool(int num_threads)
+  : queue_head_(NULL), queue_tail_(NULL), pending_(0) {
+  if (num_threads <= 0)
+    num_threads = NumProcessors();
+  idle_.Signal();
+#ifdef WIN32
+  queue_sem_ = CreateSemaphore(NULL, 0, MAX_INT32, NULL);
+  for (int i = 0; i < num_threads; ++i) {
+    HANDLE thread = CreateThread(NULL, 0, WorkerMain, this, 0, NULL);
+    if (thread != NULL)
+      threads_.push_back(thread);
+  }
+#else
+  sem_init(&queue_sem_, 0, 0);
+  for (int i = 0; i < num_threads; ++i) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, WorkerMain, this) == 0)
+      threads_.push_back(thread);
+  }
+#endif
+  if (threads_.empty())
+    tprintf("ThreadPool: failed to start any worker threads!\n");
+}
+
+ThreadPool::~ThreadPool() {
+  // A NULL task stops one worker. They are queued behind the real work, so
+  // everything scheduled before now still runs.
+  for (int i = 0; i < threads_.size(); ++i)
+    Enqueue(NULL);
+  for (int i = 0; i < threads_.size(); ++i) {
+#ifdef WIN32
+    WaitForSingleObject(threads_[i], INFINITE);
+    CloseHandle(threads_[i]);
+#else
+    pthread_join(threads_[i], NULL);
+#endif
+  }
+#ifdef WIN32
+  CloseHandle(queue_sem_);
+#else
+  sem_destroy(&queue_sem_);
+#endif
+  // Anything left can only be here if no worker ever started.
+  while (queue_head_ != NULL) {
+    TaskNode* node = queue_head_;
+    queue_head_ = node->next;
+    delete node->task;
+    delete node;
+  }
+}
+
+void ThreadPool::Schedule(TessClosure* task) {
+  if (threads_.empty()) {
+    // No workers, so run it here rather than lose it.
+    task->Run();
+    delete task;
+    return;
+  }
+  queue_mutex_.Lock();
+  if (pending_++ == 0)
+    idle_.Reset();
+  queue_mutex_.Unlock();
+  Enqueue(task);
+}
+
+void ThreadPool::WaitIdle() {
+  idle_.Wait(-1);
+}
+
+int ThreadPool::NumProcessors() {
+#ifdef WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+#else
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? static_cast<int>(count) : 1;
+#endif
+}
+
+#ifdef WIN32
+DWORD WINAPI ThreadPool::WorkerMain(LPVOID arg) {
+#else
+void* ThreadPool::WorkerMain(void* arg) {
+#endif
+  ThreadPool* pool = reinterpret_cast<ThreadPool*>(arg);
+  TessClosure* task;
+  while ((task = pool->Dequeue()) != NULL) {
+    task->Run();
+    delete task;
+    pool->TaskDone();
+  }
+  return 0;
+}
+
+void ThreadPool::Enqueue(TessClosure* task) {
+  TaskNode* node = new TaskNode;
+  node->task = task;
+  node->next = NULL;
+  queue_mutex_.Lock();
+  if (queue_tail_ == NULL)
+    queue_head_ = node;
+  else
+    queue_tail_->next = node;
+  queue_tail_ = node;
+  queue_mutex_.Unlock();
+#ifdef WIN32
+  ReleaseSemaphore(queue_sem_, 1, NULL);
+#else
+  sem_post(&queue_sem_);
+#endif
+}
+
+TessClosure* ThreadPool::Dequeue() {
+#ifdef WIN32
+  WaitForSingleObject(queue_sem_, INFINITE);
+#else
+  while (sem_wait(&queue_sem_) != 0 && errno == EINTR) {}
+#endif
+  queue_mutex_.Lock();
+  TaskNode* node = queue_head_;
+  queue_head_ = node->next;
+  if (queue_head_ == NULL)
+    queue_tail_ = NULL;
+  queue_mutex_.Unlock();
+  TessClosure* task = node->task;
+  delete node;
+  return task;
+}
+
+void ThreadPool::TaskDone() {
+  queue_mutex_.Lock();
+  if (--pending_ == 0)
+    idle_.Signal();
+  queue_mutex_.Unlock();
+}
+
+}  // namespace tesseract.
@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////
+// File:        threadpool.h
+// Description: Fixed-size pool of worker threads running TessClosures,
+//              and the event primitive used to wait on their results.
+// Created:     Tue Oct 13 09:02:41 PDT 2026
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_CCUTIL_THREADPOOL_H__
+#define TESSERACT_CCUTIL_THREADPOOL_H__
+
+#include "ccutil.h"
+#include "genericvector.h"
+#include "tesscallback.h"
+
+namespace tesseract {
+
+// A manual-reset event. Once Signal() has been called, every Wait returns
+// immediately until the next Reset().
+class ThreadEvent {
+ public:
+  ThreadEvent();
+  ~ThreadEvent();
+
+  void Signal();
+  void Reset();
+  // Returns true if the event is signalled within timeout_msecs, or waits
+  // indefinitely if timeout_msecs is negative.
+  bool Wait(int timeout_msecs);
+
+ private:
+#ifdef WIN32
+  HANDLE event_;
+#else
+  pthread_mutex_t mutex_;
+  pthread_cond_t cond_;
+  bool signalled_;
+#endif
+};
+
+// Runs TessClosures on a fixed number of threads in the order they were
+// scheduled. The pool owns each scheduled closure and deletes it after it
+// has Run, so self-deleting closures must not be used.
+class ThreadPool {
+ public:
+  // Starts num_threads workers. If num_threads <= 0, one is started per
+  // processor.
+  explicit ThreadPool(int num_threads);
+  // Runs every task already scheduled, then stops and joins the workers.
+  ~ThreadPool();
+
+  // Queues task to be run by the first free worker.
+  void Schedule(TessClosure* task);
+  // Blocks until all scheduled tasks have finished running.
+  void WaitIdle();
+
+  int num_threads() const {
+    return threads_.size();
+  }
+
+  // Returns the number of processors available, or 1 if it is unknown.
+  static int NumProcessors();
+
+ private:
+  struct TaskNode {
+    TessClosure* task;   // NULL tells a worker to exit.
+    TaskNode* next;
+  };
+
+#ifdef WIN32
+  static DWORD WINAPI WorkerMain(LPVOID arg);
+#else
+  static void* WorkerMain(void* arg);
+#endif
+  // Pushes a task on the queue and wakes one worker.
+  void Enqueue(TessClosure* task);
+  // Blocks until a task is available and removes it from the queue.
+  TessClosure* Dequeue();
+  // Called by a worker after each task completes.
+  void TaskDone();
+
+  CCUtilMutex queue_mutex_;
+  TaskNode* queue_head_;
+  TaskNode* queue_tail_;
+  // Tasks scheduled but not yet finished, and the event signalled when
+  // that count falls to zero.
+  int pending_;
+  ThreadEvent idle_;
+#ifdef WIN32
+  HANDLE queue_sem_;
+  GenericVector<HANDLE> threads_;
+#else
+  sem_t queue_sem_;
+  GenericVector<pthread_t> threads_;
+#endif
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_CCUTIL_THREADPOOL_H__
@@ -33,60 +33,81 @@
 #include          "tprintf.h"
 #include          "ccutil.h"
 
-#define MAX_MSG_LEN     1024
-
 #define EXTERN
-// Since tprintf is protected by a mutex, these parameters can rmain global.
+// Only the log writer thread reads these, so they can remain global.
+// debug_file is read with stringParamMutex held, as it may be set while
+// messages are being written.
 DLLSYM STRING_VAR (debug_file, "", "File to send tprintf output to");
 DLLSYM BOOL_VAR (debug_window_on, FALSE,
 "Send tprintf to window unless file set");
+// Read by every thread that logs, so it is an int, which is set whole.
+DLLSYM INT_VAR (debug_log_level, TESS_LOG_DEBUG,
+"Lowest level of message written: 0 debug, 1 info, 2 warning, 3 error");
+
+namespace tesseract {
+
+// The original tprintf destination: debug_file if it is set, otherwise the
+// debug window if debug_window_on, otherwise stderr. The parameters are
+// looked at for every message, so they can be changed at any time.
+class DefaultLogSink : public TessLogSink {
+ public:
+  DefaultLogSink() : debugfp_(NULL), debugwin_(NULL) {}
+
+  virtual void WriteMessage(const char* msg) {
+    // Only a copy of debug_file is used outside the lock.
+    stringParamMutex.Lock();
+    bool changed = strcmp (debug_name_.string (), debug_file.string ()) != 0;
+    if (changed)
+      debug_name_ = debug_file.string ();
+    stringParamMutex.Unlock();
+    if (changed && debugfp_ != NULL) {
+      fclose(debugfp_);
+      debugfp_ = NULL;
+    }
+    if (debugfp_ == NULL && debug_name_.length () > 0)
+      debugfp_ = fopen (debug_name_.string (), "w");
+    if (debugfp_ != NULL)
+      fprintf (debugfp_, "%s", msg);
+    else {
+
+      if (debug_window_on) {
+        if (debugwin_ == NULL)
+                                 //in pixels
+          debugwin_ = new DEBUG_WIN ("Debug Window", DEBUG_WIN_XPOS,
+                                     DEBUG_WIN_YPOS,
+                                 //in pixels
+            DEBUG_WIN_XSIZE, DEBUG_WIN_YSIZE,
+            debug_lines);
+        debugwin_->dprintf (msg);
+      }
+      else {
+        fprintf (stderr, "%s", msg);
+      }
+    }
+  }
+
+ private:
+  STRING debug_name_;            //debug_file when last read
+  FILE *debugfp_;                //debug file
+  DEBUG_WIN *debugwin_;          //debug window
+};
+
+TessLogSink* TessLogDefaultSink() {
+  static DefaultLogSink default_sink;
+  return &default_sink;
+}
+
+}  // namespace tesseract
 
 DLLSYM void
 tprintf (                        //Trace printf
 const char *format, ...          //special message
 ) {
-  tesseract::tprintfMutex.Lock();
   va_list args;                  //variable args
-  static FILE *debugfp = NULL;   //debug file
-                                 //debug window
-  static DEBUG_WIN *debugwin = NULL;
-  inT32 offset = 0;              //into message
-  static char msg[MAX_MSG_LEN + 1];
 
   va_start(args, format);  //variable list
-  #ifdef __MSW32__
-                                 //Format into msg
-  offset += _vsnprintf (msg + offset, MAX_MSG_LEN - offset, format, args);
-  #else
-                                 //Format into msg
-  offset += vsprintf (msg + offset, format, args);
-  #endif
+  tesseract::TessLogMessageV(TESS_LOG_INFO, format, args);
   va_end(args);
-
-  if (debugfp == NULL && strlen (debug_file.string ()) > 0)
-    debugfp = fopen (debug_file.string (), "w");
-  else if (debugfp != NULL && strlen (debug_file.string ()) == 0) {
-    fclose(debugfp);
-    debugfp = NULL;
-  }
-  if (debugfp != NULL)
-    fprintf (debugfp, "%s", msg);
-  else {
-
-    if (debug_window_on) {
-      if (debugwin == NULL)
-                                 //in pixels
-        debugwin = new DEBUG_WIN ("Debug Window", DEBUG_WIN_XPOS, DEBUG_WIN_YPOS,
-                                 //in pixels
-          DEBUG_WIN_XSIZE, DEBUG_WIN_YSIZE,
-          debug_lines);
-      debugwin->dprintf (msg);
-    }
-    else {
-      fprintf (stderr, "%s", msg);
-    }
-  }
-  tesseract::tprintfMutex.Unlock();
 }
 
 
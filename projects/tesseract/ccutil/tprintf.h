@@ -21,10 +21,13 @@
 #define           TPRINTF_H
 
 #include                   "params.h"
+#include                   "tesslog.h"
 
 extern DLLSYM STRING_VAR_H (debug_file, "", "File to send tprintf output to");
 extern DLLSYM BOOL_VAR_H (debug_window_on, TRUE,
 "Send tprintf to window unless file set");
+extern DLLSYM INT_VAR_H (debug_log_level, TESS_LOG_DEBUG,
+"Lowest level of message written: 0 debug, 1 info, 2 warning, 3 error");
 
 DLLSYM void tprintf (            //Trace printf
 const char *format, ...          //special message
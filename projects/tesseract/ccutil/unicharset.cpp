@@ -26,12 +26,15 @@
 #include "unichar.h"
 #include "unicharset.h"
 #include "params.h"
+#include "serialis.h"
 
 static const int ISALPHA_MASK = 0x1;
 static const int ISLOWER_MASK = 0x2;
 static const int ISUPPER_MASK = 0x4;
 static const int ISDIGIT_MASK = 0x8;
 static const int ISPUNCTUATION_MASK = 0x10;
+// Only used in the compiled form, which keeps the ngrams added for ambigs.
+static const int ISNGRAM_MASK = 0x20;
 // Y coordinate threshold for determining cap-height vs x-height.
 // TODO(rays) Bring the global definition down to the ccutil library level,
 // so this constant is relative to some other constants.
@@ -343,6 +346,128 @@ bool UNICHARSET::load_from_file(FILE *file, bool skip_fragments) {
   return true;
 }
 
+// Writes str to the compiled form, as a length byte followed by the bytes.
+static void WriteCompiledString(const char* str, FILE* file) {
+  uinT8 length = static_cast<uinT8>(strlen(str));
+  fwrite(&length, sizeof(length), 1, file);
+  fwrite(str, 1, length, file);
+}
+
+// Reads a string written by WriteCompiledString into str, which has room
+// for max_length bytes and the '\0'.
+static bool ReadCompiledString(const char* data, int size, int* pos,
+                               int max_length, char* str) {
+  uinT8 length;
+  if (!ReadCompiledValue(data, size, pos, &length) || length > max_length ||
+      *pos + length > size)
+    return false;
+  memcpy(str, data + *pos, length);
+  str[length] = '\0';
+  *pos += length;
+  return true;
+}
+
+// The compiled form is one block (see serialis.h) holding the script
+// table, the number of unichars, how many of them were loaded, and then one
+// record per unichar. Script ids index the script table as written, which
+// the loader rebuilds in the same order.
+bool UNICHARSET::save_to_binary(FILE *file, int num_loaded) const {
+  long start = BeginCompiledBlock(file);
+  inT32 num_scripts = script_table_size_used;
+  fwrite(&num_scripts, sizeof(num_scripts), 1, file);
+  for (int i = 0; i < script_table_size_used; ++i)
+    WriteCompiledString(script_table[i], file);
+  inT32 unicharset_size = size_used;
+  inT32 loaded_size = num_loaded;
+  fwrite(&unicharset_size, sizeof(unicharset_size), 1, file);
+  fwrite(&loaded_size, sizeof(loaded_size), 1, file);
+  for (UNICHAR_ID id = 0; id < size_used; ++id) {
+    const UNICHAR_PROPERTIES& props = unichars[id].properties;
+    WriteCompiledString(unichars[id].representation, file);
+    uinT8 flags = static_cast<uinT8>(get_properties(id));
+    if (props.isngram)
+      flags |= ISNGRAM_MASK;
+    fwrite(&flags, sizeof(flags), 1, file);
+    fwrite(&props.min_bottom, sizeof(props.min_bottom), 1, file);
+    fwrite(&props.max_bottom, sizeof(props.max_bottom), 1, file);
+    fwrite(&props.min_top, sizeof(props.min_top), 1, file);
+    fwrite(&props.max_top, sizeof(props.max_top), 1, file);
+    inT32 script_id = props.script_id;
+    inT32 other_case = props.other_case;
+    fwrite(&script_id, sizeof(script_id), 1, file);
+    fwrite(&other_case, sizeof(other_case), 1, file);
+  }
+  return EndCompiledBlock(file, start);
+}
+
+bool UNICHARSET::load_from_binary(FILE *file, bool skip_fragments) {
+  int num_bytes;
+  char* data = ReadCompiledBlock(file, &num_bytes);
+  if (data == NULL)
+    return false;
+
+  this->clear();
+  int pos = 0;
+  inT32 num_scripts;
+  bool ok = ReadCompiledValue(data, num_bytes, &pos, &num_scripts);
+  for (int i = 0; ok && i < num_scripts; ++i) {
+    char script[256];
+    ok = ReadCompiledString(data, num_bytes, &pos, 255, script) &&
+         add_script(script) == i;
+  }
+  inT32 unicharset_size, loaded_size;
+  ok = ok && ReadCompiledValue(data, num_bytes, &pos, &unicharset_size) &&
+       ReadCompiledValue(data, num_bytes, &pos, &loaded_size);
+  if (ok) this->reserve(unicharset_size);
+  for (UNICHAR_ID id = 0; ok && id < unicharset_size; ++id) {
+    // The rest were inserted after loading, and play no part in the
+    // properties of the set as a whole.
+    if (id == loaded_size)
+      post_load_setup();
+    char unichar[UNICHAR_LEN + 1];
+    uinT8 flags, min_bottom, max_bottom, min_top, max_top;
+    inT32 script_id, other_case;
+    if (!ReadCompiledString(data, num_bytes, &pos, UNICHAR_LEN, unichar) ||
+        !ReadCompiledValue(data, num_bytes, &pos, &flags) ||
+        !ReadCompiledValue(data, num_bytes, &pos, &min_bottom) ||
+        !ReadCompiledValue(data, num_bytes, &pos, &max_bottom) ||
+        !ReadCompiledValue(data, num_bytes, &pos, &min_top) ||
+        !ReadCompiledValue(data, num_bytes, &pos, &max_top) ||
+        !ReadCompiledValue(data, num_bytes, &pos, &script_id) ||
+        !ReadCompiledValue(data, num_bytes, &pos, &other_case) ||
+        script_id < 0 || script_id >= script_table_size_used) {
+      ok = false;
+      break;
+    }
+    this->unichars[id].properties.other_case = other_case;
+    // Skip fragments if needed, as load_from_file does.
+    CHAR_FRAGMENT *frag = NULL;
+    if (skip_fragments && (frag = CHAR_FRAGMENT::parse_from_string(unichar))) {
+      delete frag;
+      continue;
+    }
+    this->unichar_insert(unichar);
+
+    this->set_isalpha(id, flags & ISALPHA_MASK);
+    this->set_islower(id, flags & ISLOWER_MASK);
+    this->set_isupper(id, flags & ISUPPER_MASK);
+    this->set_isdigit(id, flags & ISDIGIT_MASK);
+    this->set_ispunctuation(id, flags & ISPUNCTUATION_MASK);
+    this->set_isngram(id, flags & ISNGRAM_MASK);
+    this->unichars[id].properties.script_id = script_id;
+    this->unichars[id].properties.enabled = true;
+    this->set_top_bottom(id, min_bottom, max_bottom, min_top, max_top);
+  }
+  delete [] data;
+  if (!ok) {
+    this->clear();
+    return false;
+  }
+  if (loaded_size >= unicharset_size)
+    post_load_setup();
+  return true;
+}
+
 // Sets up internal data after loading the file, based on the char
 // properties. Called from load_from_file, but also needs to be run
 // during set_unicharset_properties.
@@ -256,6 +256,17 @@ class UNICHARSET {
   bool load_from_file(FILE *file, bool skip_fragments);
   bool load_from_file(FILE *file) { return load_from_file(file, false); }
 
+  // Saves the UNICHARSET in the compiled form read by load_from_binary.
+  // The unichars from num_loaded on were inserted after loading, as those
+  // of the ambigs are, so the loader sets them up after post_load_setup as
+  // well. Returns true if the operation is successful.
+  bool save_to_binary(FILE *file, int num_loaded) const;
+
+  // Loads the UNICHARSET from the compiled form written by save_to_binary,
+  // which is read in one go and needs no parsing. The previous data is
+  // lost. Returns true if the operation is successful.
+  bool load_from_binary(FILE *file, bool skip_fragments);
+
   // Sets up internal data after loading the file, based on the char
   // properties. Called from load_from_file, but also needs to be run
   // during set_unicharset_properties.
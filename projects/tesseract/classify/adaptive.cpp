@@ -217,6 +217,7 @@ TEMP_CONFIG NewTempConfig(int MaxProtoId) {
   Config->Protos = NewBitVector (NumProtos);
 
   Config->NumTimesSeen = 1;
+  Config->LastUsed = 0;
   Config->MaxProtoId = MaxProtoId;
   Config->ProtoVectorSize = WordsInVectorOfSize (NumProtos);
   Config->ContextsSeen = NIL_LIST;
@@ -419,7 +420,8 @@ TEMP_CONFIG ReadTempConfig(FILE *File) {
   Config =
     (TEMP_CONFIG) alloc_struct (sizeof (TEMP_CONFIG_STRUCT),
     "TEMP_CONFIG_STRUCT");
-  fread ((char *) Config, sizeof (TEMP_CONFIG_STRUCT), 1, File);
+  fread ((char *) Config, TEMP_CONFIG_FILE_SIZE, 1, File);
+  Config->LastUsed = 0;
 
   Config->Protos = NewBitVector (Config->ProtoVectorSize * BITSINLONG);
   fread ((char *) Config->Protos, sizeof (uinT32),
@@ -549,7 +551,7 @@ void WriteTempConfig(FILE *File, TEMP_CONFIG Config) {
                                  /* contexts not yet implemented */
   assert (Config->ContextsSeen == NULL);
 
-  fwrite ((char *) Config, sizeof (TEMP_CONFIG_STRUCT), 1, File);
+  fwrite ((char *) Config, TEMP_CONFIG_FILE_SIZE, 1, File);
   fwrite ((char *) Config->Protos, sizeof (uinT32),
     Config->ProtoVectorSize, File);
 
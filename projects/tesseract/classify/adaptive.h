@@ -23,6 +23,7 @@
 ----------------------------------------------------------------------------*/
 #include "oldlist.h"
 #include "intproto.h"
+#include <stddef.h>
 #include <stdio.h>
 
 typedef struct
@@ -43,6 +44,10 @@ typedef struct
   PROTO_ID MaxProtoId;
   LIST ContextsSeen;
   BIT_VECTOR Protos;
+  // Adaptation clock value when the config was last created or matched,
+  // for picking the config to evict from a full class. Not saved with the
+  // adapted templates; must stay the last member.
+  uinT32 LastUsed;
 } TEMP_CONFIG_STRUCT;
 typedef TEMP_CONFIG_STRUCT *TEMP_CONFIG;
 
@@ -102,6 +107,10 @@ typedef ADAPT_TEMPLATES_STRUCT *ADAPT_TEMPLATES;
 #define IncreaseConfidence(TempConfig)	\
 ((TempConfig)->NumTimesSeen++)
 
+// Size of a TEMP_CONFIG_STRUCT as saved in adapted templates files, which
+// predate the LastUsed member.
+#define TEMP_CONFIG_FILE_SIZE (offsetof (TEMP_CONFIG_STRUCT, LastUsed))
+
 void AddAdaptedClass(ADAPT_TEMPLATES Templates,
                     ADAPT_CLASS Class,
                     CLASS_ID ClassId);
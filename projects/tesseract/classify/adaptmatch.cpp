@@ -132,6 +132,16 @@ int MakeTempProtoPerm(void *item1, void *item2);
 
 void SetAdaptiveThreshold(FLOAT32 Threshold);
 
+/*-----------------------------------------------------------------------------
+        Global Data Definitions and Declarations
+-----------------------------------------------------------------------------*/
+namespace tesseract {
+// The ClassifierModels in use by some Classify.
+static GenericVector<ClassifierModel*> classifier_models;
+// Guards classifier_models and the ref_count of its models.
+static CCUtilMutex classifier_models_mutex;
+}  // namespace tesseract
+
 
 /*-----------------------------------------------------------------------------
               Public Code
@@ -349,6 +359,14 @@ void Classify::LearnWord(const char* filename, const char *rejmap,
   delete [] thresholds;
 }  // LearnWord.
 
+// While tr_file is not NULL, static training writes its features to it,
+// labelled with the font of filename, instead of to the one file that
+// LearnBlob keeps open for the whole process.
+void Classify::SetTrainingFile(FILE* tr_file, const STRING& filename) {
+  tr_file_ = tr_file;
+  tr_font_name_ = tr_file != NULL ? TrainingFontName(filename) : STRING();
+}
+
 // Builds a blob of length fragments, from the word, starting at start,
 // and then learns it, as having the given correct_text.
 // If filename is not NULL, then LearnBlob
@@ -394,7 +412,12 @@ void Classify::LearnPieces(const char* filename, int start, int length,
     classify_norm_method.set_value(character);  // force char norm spc 30/11/93
     tess_bn_matching.set_value(false);    // turn it off
     tess_cn_matching.set_value(false);
-    LearnBlob(feature_defs_, filename, blob, word->denorm, correct_text);
+    if (tr_file_ != NULL) {
+      LearnBlob(feature_defs_, tr_file_, blob, word->denorm, correct_text,
+                tr_font_name_.string());
+    } else {
+      LearnBlob(feature_defs_, filename, blob, word->denorm, correct_text);
+    }
   } else {
     if (!unicharset.contains_unichar(correct_text)) {
       unicharset.unichar_insert(correct_text);
@@ -452,28 +475,151 @@ void Classify::EndAdaptiveClassifier() {
     AdaptedTemplates = NULL;
   }
 
-  if (PreTrainedTemplates != NULL) {
-    free_int_templates(PreTrainedTemplates);
-    PreTrainedTemplates = NULL;
-  }
+  if (model_ != NULL)
+    ReleaseClassifierModel();
   getDict().EndDangerousAmbigs();
   FreeNormProtos();
-  if (AllProtosOn != NULL) {
-    FreeBitVector(AllProtosOn);
+  if (PrunedProtos != NULL) {
     FreeBitVector(PrunedProtos);
-    FreeBitVector(AllConfigsOn);
-    FreeBitVector(AllProtosOff);
-    FreeBitVector(AllConfigsOff);
     FreeBitVector(TempProtoMask);
-    AllProtosOn = NULL;
     PrunedProtos = NULL;
-    AllConfigsOn = NULL;
-    AllProtosOff = NULL;
-    AllConfigsOff = NULL;
     TempProtoMask = NULL;
   }
 }                                /* EndAdaptiveClassifier */
 
+/*---------------------------------------------------------------------------*/
+/**
+ * This routine points PreTrainedTemplates, CharNormCutoffs,
+ * NormProtos and the constant proto and config masks at the
+ * ClassifierModel of the language, loading the model if no
+ * other Classify has it.  The registry lock is held while
+ * loading, so engines initialized together load it only once.
+ *
+ * @param load_pre_trained_templates  Whether the model has the
+ *                     pre-trained templates, or only the masks
+ *                     needed by an adaptive only classifier.
+ *
+ * @note Exceptions: none
+ */
+void Classify::AcquireClassifierModel(bool load_pre_trained_templates) {
+  STRING key;
+  if (load_pre_trained_templates)
+    key = language_data_path_prefix;
+  classifier_models_mutex.Lock();
+  ClassifierModel* model = NULL;
+  for (int i = 0; i < classifier_models.size(); ++i) {
+    if (classifier_models[i]->key == key &&
+        classifier_models[i]->unicharset_size == unicharset.size()) {
+      model = classifier_models[i];
+      break;
+    }
+  }
+  if (model == NULL) {
+    model = new ClassifierModel;
+    model->key = key;
+    model->unicharset_size = unicharset.size();
+    if (load_pre_trained_templates) {
+      ASSERT_HOST(tessdata_manager.SeekToStart(TESSDATA_INTTEMP));
+      model->templates =
+        ReadIntTemplates(tessdata_manager.GetDataFilePtr());
+      if (tessdata_manager.DebugLevel() > 0) tprintf("Loaded inttemp\n");
+      // ReadIntTemplates read the font tables into this Classify, and
+      // moving them takes their callbacks.
+      model->fontinfo_table.move(&fontinfo_table_);
+      model->fontset_table.move(&fontset_table_);
+      InitFontTables();
+
+      // Prefer the compiled pffmtable, which needs no parsing.
+      if (tessdata_manager.SeekToCompiledStart(TESSDATA_PFFMTABLE_BIN,
+                                               TESSDATA_PFFMTABLE) &&
+          ReadCompiledCutoffs(tessdata_manager.GetDataFilePtr(),
+                              unicharset.size(), model->char_norm_cutoffs)) {
+        if (tessdata_manager.DebugLevel() > 0)
+          tprintf("Loaded compiled pffmtable\n");
+      } else {
+        ASSERT_HOST(tessdata_manager.SeekToStart(TESSDATA_PFFMTABLE));
+        ReadNewCutoffs(tessdata_manager.GetDataFilePtr(),
+                       tessdata_manager.GetEndOffset(TESSDATA_PFFMTABLE),
+                       model->char_norm_cutoffs);
+        if (tessdata_manager.DebugLevel() > 0) tprintf("Loaded pffmtable\n");
+      }
+
+      ASSERT_HOST(tessdata_manager.SeekToStart(TESSDATA_NORMPROTO));
+      model->norm_protos =
+        ReadNormProtos(tessdata_manager.GetDataFilePtr(),
+                       tessdata_manager.GetEndOffset(TESSDATA_NORMPROTO));
+      if (tessdata_manager.DebugLevel() > 0) tprintf("Loaded normproto\n");
+    }
+    model->all_protos_on = NewBitVector(MAX_NUM_PROTOS);
+    model->all_configs_on = NewBitVector(MAX_NUM_CONFIGS);
+    model->all_protos_off = NewBitVector(MAX_NUM_PROTOS);
+    model->all_configs_off = NewBitVector(MAX_NUM_CONFIGS);
+    set_all_bits(model->all_protos_on, WordsInVectorOfSize(MAX_NUM_PROTOS));
+    set_all_bits(model->all_configs_on,
+                 WordsInVectorOfSize(MAX_NUM_CONFIGS));
+    zero_all_bits(model->all_protos_off, WordsInVectorOfSize(MAX_NUM_PROTOS));
+    zero_all_bits(model->all_configs_off,
+                  WordsInVectorOfSize(MAX_NUM_CONFIGS));
+    classifier_models.push_back(model);
+  } else if (tessdata_manager.DebugLevel() > 0) {
+    tprintf("Sharing the classifier of %d other engines\n", model->ref_count);
+  }
+  ++model->ref_count;
+  classifier_models_mutex.Unlock();
+
+  model_ = model;
+  PreTrainedTemplates = model->templates;
+  CharNormCutoffs = model->char_norm_cutoffs;
+  NormProtos = model->norm_protos;
+  AllProtosOn = model->all_protos_on;
+  AllConfigsOn = model->all_configs_on;
+  AllProtosOff = model->all_protos_off;
+  AllConfigsOff = model->all_configs_off;
+}                                /* AcquireClassifierModel */
+
+/*---------------------------------------------------------------------------*/
+/**
+ * This routine lets go of the ClassifierModel, and frees it
+ * if no other Classify uses it.
+ *
+ * @note Exceptions: none
+ */
+void Classify::ReleaseClassifierModel() {
+  ClassifierModel* model = model_;
+  classifier_models_mutex.Lock();
+  bool last = --model->ref_count == 0;
+  if (last) {
+    for (int i = 0; i < classifier_models.size(); ++i) {
+      if (classifier_models[i] == model) {
+        classifier_models.remove(i);
+        break;
+      }
+    }
+  }
+  classifier_models_mutex.Unlock();
+
+  model_ = NULL;
+  PreTrainedTemplates = NULL;
+  CharNormCutoffs = NULL;
+  NormProtos = NULL;
+  AllProtosOn = NULL;
+  AllConfigsOn = NULL;
+  AllProtosOff = NULL;
+  AllConfigsOff = NULL;
+  if (!last)
+    return;
+  if (model->templates != NULL)
+    free_int_templates(model->templates);
+  // FreeNormProtos frees the ones of this Classify.
+  NormProtos = model->norm_protos;
+  FreeNormProtos();
+  FreeBitVector(model->all_protos_on);
+  FreeBitVector(model->all_configs_on);
+  FreeBitVector(model->all_protos_off);
+  FreeBitVector(model->all_configs_off);
+  delete model;
+}                                /* ReleaseClassifierModel */
+
 
 /*---------------------------------------------------------------------------*/
 /**
@@ -501,40 +647,16 @@ void Classify::InitAdaptiveClassifier(bool load_pre_trained_templates) {
 
   // If there is no language_data_path_prefix, the classifier will be
   // adaptive only.
-  if (language_data_path_prefix.length() > 0 &&
-      load_pre_trained_templates) {
-    ASSERT_HOST(tessdata_manager.SeekToStart(TESSDATA_INTTEMP));
-    PreTrainedTemplates =
-      ReadIntTemplates(tessdata_manager.GetDataFilePtr());
-    if (tessdata_manager.DebugLevel() > 0) tprintf("Loaded inttemp\n");
-
-    ASSERT_HOST(tessdata_manager.SeekToStart(TESSDATA_PFFMTABLE));
-    ReadNewCutoffs(tessdata_manager.GetDataFilePtr(),
-                   tessdata_manager.GetEndOffset(TESSDATA_PFFMTABLE),
-                   CharNormCutoffs);
-    if (tessdata_manager.DebugLevel() > 0) tprintf("Loaded pffmtable\n");
-
-    ASSERT_HOST(tessdata_manager.SeekToStart(TESSDATA_NORMPROTO));
-    NormProtos =
-      ReadNormProtos(tessdata_manager.GetDataFilePtr(),
-                     tessdata_manager.GetEndOffset(TESSDATA_NORMPROTO));
-    if (tessdata_manager.DebugLevel() > 0) tprintf("Loaded normproto\n");
-  }
+  AcquireClassifierModel(language_data_path_prefix.length() > 0 &&
+                         load_pre_trained_templates);
 
   im_.Init(&classify_debug_level, classify_integer_matcher_multiplier);
   InitIntegerFX();
+  SetupClassBounds();
 
-  AllProtosOn = NewBitVector(MAX_NUM_PROTOS);
   PrunedProtos = NewBitVector(MAX_NUM_PROTOS);
-  AllConfigsOn = NewBitVector(MAX_NUM_CONFIGS);
-  AllProtosOff = NewBitVector(MAX_NUM_PROTOS);
-  AllConfigsOff = NewBitVector(MAX_NUM_CONFIGS);
   TempProtoMask = NewBitVector(MAX_NUM_PROTOS);
-  set_all_bits(AllProtosOn, WordsInVectorOfSize(MAX_NUM_PROTOS));
   set_all_bits(PrunedProtos, WordsInVectorOfSize(MAX_NUM_PROTOS));
-  set_all_bits(AllConfigsOn, WordsInVectorOfSize(MAX_NUM_CONFIGS));
-  zero_all_bits(AllProtosOff, WordsInVectorOfSize(MAX_NUM_PROTOS));
-  zero_all_bits(AllConfigsOff, WordsInVectorOfSize(MAX_NUM_CONFIGS));
 
   for (int i = 0; i < MAX_NUM_CLASSES; i++) {
      BaselineCutoffs[i] = 0;
@@ -619,6 +741,9 @@ void Classify::PrintAdaptiveStatistics(FILE *File) {
   fprintf (File, "\nADAPTIVE LEARNER STATISTICS:\n");
   fprintf (File, "\tNumber of words adapted to: %d\n", NumWordsAdaptedTo);
   fprintf (File, "\tNumber of chars adapted to: %d\n", NumCharsAdaptedTo);
+  fprintf (File, "\tTemp configs evicted: %d\n", NumTempConfigsEvicted);
+  fprintf (File, "\tTemp protos reclaimed: %d\n", NumTempProtosReclaimed);
+  fprintf (File, "\tAdaptations failed: %d\n", NumAdaptationsFailed);
 
   PrintAdaptedTemplates(File, AdaptedTemplates);
   #endif
@@ -713,6 +838,7 @@ void Classify::InitAdaptedClass(TBLOB *Blob,
   }
 
   Config = NewTempConfig (NumFeatures - 1);
+  Config->LastUsed = ++AdaptationClock;
   TempConfigFor (Class, 0) = Config;
 
   /* this is a kludge to construct cutoffs for adapted templates */
@@ -910,6 +1036,7 @@ void Classify::AdaptToChar(TBLOB *Blob,
 
       TempConfig = TempConfigFor (Class, IntResult.Config);
       IncreaseConfidence(TempConfig);
+      TempConfig->LastUsed = ++AdaptationClock;
       if (TempConfig->NumTimesSeen > Class->MaxNumTimesSeen) {
         Class->MaxNumTimesSeen = TempConfig->NumTimesSeen;
       }
@@ -1056,11 +1183,14 @@ void Classify::AddNewResult(ADAPT_RESULTS *results,
                             FLOAT32 rating,
                             int config_id,
                             int config2_id) {
+  // Most candidates are rejected against the best match alone, so that is
+  // tested before searching the results.
+  if (rating > results->best_match.rating + matcher_bad_match_pad)
+    return;
   ScoredClass *old_match = FindScoredUnichar(results, class_id);
   ScoredClass match = {class_id, rating, config_id, config2_id};
 
-  if (rating > results->best_match.rating + matcher_bad_match_pad ||
-      (old_match && rating >= old_match->rating))
+  if (old_match && rating >= old_match->rating)
     return;
 
   if (!unicharset.get_fragment(class_id))
@@ -1157,6 +1287,10 @@ void Classify::AmbigClassifier(TBLOB *Blob,
 /*---------------------------------------------------------------------------*/
 /// Factored-out calls to IntegerMatcher based on class pruner results.
 /// Returns integer matcher results inside CLASS_PRUNER_RESULTS structure.
+/// All the candidates are matched first, then their ratings are corrected
+/// in one tight pass over the results, and only then are they added to
+/// final_results, so the corrections are not interleaved with the matcher
+/// and the debug output.
 void Classify::MasterMatcher(INT_TEMPLATES templates,
                              inT16 num_features,
                              INT_FEATURE_ARRAY features,
@@ -1171,7 +1305,6 @@ void Classify::MasterMatcher(INT_TEMPLATES templates,
   int bottom = blob_box.bottom();
   for (int c = 0; c < num_classes; c++) {
     CLASS_ID class_id = results[c].Class;
-    INT_RESULT_STRUCT& int_result = results[c].IMResult;
     BIT_VECTOR protos = classes != NULL ? classes[class_id]->PermProtos
                                         : AllProtosOn;
     BIT_VECTOR configs = classes != NULL ? classes[class_id]->PermConfigs
@@ -1180,12 +1313,19 @@ void Classify::MasterMatcher(INT_TEMPLATES templates,
     im_.Match(ClassForClassId(templates, class_id),
               protos, configs, final_results->BlobLength,
               num_features, features, norm_factors[class_id],
-              &int_result, classify_adapt_feature_threshold, debug,
+              &results[c].IMResult, classify_adapt_feature_threshold, debug,
               matcher_debug_separate_windows);
-    // Compute class feature corrections.
-    double miss_penalty = tessedit_class_miss_scale *
-                          int_result.FeatureMisses;
-    if (matcher_debug_level >= 2 || classify_debug_level > 1) {
+  }
+
+  if (class_bounds_.size() != unicharset.size())
+    SetupClassBounds();
+  bool penalize_misfits = classify_misfit_junk_penalty > 0.0;
+  if (matcher_debug_level >= 2 || classify_debug_level > 1) {
+    for (int c = 0; c < num_classes; c++) {
+      CLASS_ID class_id = results[c].Class;
+      const INT_RESULT_STRUCT& int_result = results[c].IMResult;
+      double miss_penalty = tessedit_class_miss_scale *
+                            int_result.FeatureMisses;
       cprintf("%s-%-2d %2.1f(CP%2.1f, IM%2.1f + MP%2.1f)  ",
               unicharset.id_to_unichar(class_id), int_result.Config,
               (int_result.Rating + miss_penalty) * 100.0,
@@ -1193,55 +1333,70 @@ void Classify::MasterMatcher(INT_TEMPLATES templates,
               int_result.Rating * 100.0, miss_penalty * 100.0);
       if (c % 4 == 3)
         cprintf ("\n");
-    }
-    // Penalize non-alnums for being vertical misfits.
-    if (!unicharset.get_isalpha(class_id) &&
-        !unicharset.get_isdigit(class_id) &&
-        norm_factors[class_id] != 0 && classify_misfit_junk_penalty > 0.0) {
-      int min_bottom, max_bottom, min_top, max_top;
-      unicharset.get_top_bottom(class_id, &min_bottom, &max_bottom,
-                                &min_top, &max_top);
-      if (classify_debug_level > 1) {
-        tprintf("top=%d, vs [%d, %d], bottom=%d, vs [%d, %d]\n",
-                top, min_top, max_top, bottom, min_bottom, max_bottom);
-      }
-      if (top < min_top || top > max_top ||
-          bottom < min_bottom || bottom > max_bottom) {
-        miss_penalty += classify_misfit_junk_penalty;
+      if (classify_debug_level > 1 && penalize_misfits &&
+          norm_factors[class_id] != 0 &&
+          !unicharset.get_isalpha(class_id) &&
+          !unicharset.get_isdigit(class_id)) {
+        const ClassBounds& bounds = class_bounds_[class_id];
+        TLOG_DEBUG("top=%d, vs [%d, %d], bottom=%d, vs [%d, %d]\n",
+                   top, bounds.min_top, bounds.max_top,
+                   bottom, bounds.min_bottom, bounds.max_bottom);
       }
     }
-    int_result.Rating += miss_penalty;
-    if (int_result.Rating > WORST_POSSIBLE_RATING)
-      int_result.Rating = WORST_POSSIBLE_RATING;
+  }
+
+  // Compute class feature corrections, and penalize non-alnums for being
+  // vertical misfits. Alnums have bounds that nothing falls outside of, so
+  // every candidate takes the same branch-free path.
+  double miss_scale = tessedit_class_miss_scale;
+  double junk_penalty = penalize_misfits ? classify_misfit_junk_penalty : 0.0;
+  const ClassBounds* class_bounds = &class_bounds_[0];
+  for (int c = 0; c < num_classes; c++) {
+    CLASS_ID class_id = results[c].Class;
+    INT_RESULT_STRUCT& int_result = results[c].IMResult;
+    const ClassBounds& bounds = class_bounds[class_id];
+    int misfit = (top < bounds.min_top) | (top > bounds.max_top) |
+                 (bottom < bounds.min_bottom) | (bottom > bounds.max_bottom);
+    misfit &= norm_factors[class_id] != 0;
+    double penalty = miss_scale * int_result.FeatureMisses +
+                     misfit * junk_penalty;
+    FLOAT32 rating = int_result.Rating + penalty;
+    int_result.Rating = rating > WORST_POSSIBLE_RATING ? WORST_POSSIBLE_RATING
+                                                       : rating;
+  }
+
+  for (int c = 0; c < num_classes; c++) {
+    CLASS_ID class_id = results[c].Class;
+    const INT_RESULT_STRUCT& int_result = results[c].IMResult;
     AddNewResult(final_results, class_id, int_result.Rating,
                  int_result.Config, int_result.Config2);
     // Add unichars ambiguous with class_id with the same rating as class_id.
-    if (use_definite_ambigs_for_classifier) {
-      const UnicharIdVector *definite_ambigs =
-        getDict().getUnicharAmbigs().OneToOneDefiniteAmbigs(class_id);
-      int ambigs_size = (definite_ambigs == NULL) ? 0 : definite_ambigs->size();
-      for (int ambig = 0; ambig < ambigs_size; ++ambig) {
-        UNICHAR_ID ambig_class_id = (*definite_ambigs)[ambig];
-        // Do not include ambig_class_id if it has permanent adapted templates.
-        if (classes[class_id]->NumPermConfigs > 0) continue;
-        ScoredClass* ambig_match =
-            FindScoredUnichar(final_results, ambig_class_id);
-        if (matcher_debug_level >= 3) {
-          tprintf("class: %d definite ambig: %d rating: old %.4f new %.4f\n",
-                  class_id, ambig_class_id,
-                  ambig_match ? ambig_match->rating : WORST_POSSIBLE_RATING,
-                  int_result.Rating);
-        }
-        if (ambig_match) {
-          // ambig_class_id was already added to final_results,
-          // so just need to modify the rating.
-          if (int_result.Rating < ambig_match->rating) {
-            ambig_match->rating = int_result.Rating;
-          }
-        } else {
-          AddNewResult(final_results, ambig_class_id, int_result.Rating,
-                       int_result.Config, int_result.Config2);
+    // Do not include them if class_id has permanent adapted templates.
+    if (!use_definite_ambigs_for_classifier ||
+        (classes != NULL && classes[class_id]->NumPermConfigs > 0))
+      continue;
+    const UNICHAR_ID *definite_ambigs;
+    int ambigs_size = getDict().getUnicharAmbigs().OneToOneDefiniteAmbigs(
+        class_id, &definite_ambigs);
+    for (int ambig = 0; ambig < ambigs_size; ++ambig) {
+      UNICHAR_ID ambig_class_id = definite_ambigs[ambig];
+      ScoredClass* ambig_match =
+          FindScoredUnichar(final_results, ambig_class_id);
+      if (matcher_debug_level >= 3) {
+        TLOG_DEBUG("class: %d definite ambig: %d rating: old %.4f"
+                   " new %.4f\n", class_id, ambig_class_id,
+                   ambig_match ? ambig_match->rating : WORST_POSSIBLE_RATING,
+                   int_result.Rating);
+      }
+      if (ambig_match) {
+        // ambig_class_id was already added to final_results,
+        // so just need to modify the rating.
+        if (int_result.Rating < ambig_match->rating) {
+          ambig_match->rating = int_result.Rating;
         }
+      } else {
+        AddNewResult(final_results, ambig_class_id, int_result.Rating,
+                     int_result.Config, int_result.Config2);
       }
     }
   }
@@ -1249,6 +1404,30 @@ void Classify::MasterMatcher(INT_TEMPLATES templates,
     cprintf("\n");
 }
 
+// Fills in class_bounds_ from the top and bottom ranges of the unicharset.
+// Only non-alnums are penalized as vertical misfits, so the others get
+// bounds that cover every position.
+void Classify::SetupClassBounds() {
+  int num_classes = unicharset.size();
+  class_bounds_.init_to_size(num_classes, ClassBounds());
+  for (int class_id = 0; class_id < num_classes; ++class_id) {
+    ClassBounds& bounds = class_bounds_[class_id];
+    if (unicharset.get_isalpha(class_id) ||
+        unicharset.get_isdigit(class_id)) {
+      bounds.min_bottom = bounds.min_top = -MAX_INT16;
+      bounds.max_bottom = bounds.max_top = MAX_INT16;
+    } else {
+      int min_bottom, max_bottom, min_top, max_top;
+      unicharset.get_top_bottom(class_id, &min_bottom, &max_bottom,
+                                &min_top, &max_top);
+      bounds.min_bottom = min_bottom;
+      bounds.max_bottom = max_bottom;
+      bounds.min_top = min_top;
+      bounds.max_top = max_top;
+    }
+  }
+}
+
 /*---------------------------------------------------------------------------*/
 /**
  * This routine extracts baseline normalized features
@@ -2029,7 +2208,7 @@ int Classify::MakeNewTemporaryConfig(ADAPT_TEMPLATES Templates,
   int MaxProtoId, OldMaxProtoId;
   int BlobLength = 0;
   int MaskSize;
-  int ConfigId;
+  int ConfigId = -1;
   TEMP_CONFIG Config;
   int i;
   int debug_level = NO_DEBUG;
@@ -2042,10 +2221,14 @@ int Classify::MakeNewTemporaryConfig(ADAPT_TEMPLATES Templates,
   Class = Templates->Class[ClassId];
 
   if (IClass->NumConfigs >= MAX_NUM_CONFIGS) {
-    ++NumAdaptationsFailed;
-    if (classify_learning_debug_level >= 1)
-      cprintf("Cannot make new temporary config: maximum number exceeded.\n");
-    return -1;
+    if (classify_adapt_evict_lru)
+      ConfigId = EvictTempConfig(IClass, Class, false);
+    if (ConfigId < 0) {
+      ++NumAdaptationsFailed;
+      if (classify_learning_debug_level >= 1)
+        cprintf("Cannot make new temporary config: maximum number exceeded.\n");
+      return -1;
+    }
   }
 
   OldMaxProtoId = IClass->NumProtos - 1;
@@ -2069,15 +2252,24 @@ int Classify::MakeNewTemporaryConfig(ADAPT_TEMPLATES Templates,
   MaxProtoId = MakeNewTempProtos(FloatFeatures, NumBadFeatures, BadFeatures,
                                  IClass, Class, TempProtoMask);
   if (MaxProtoId == NO_PROTO) {
-    ++NumAdaptationsFailed;
+    // The protos of an evicted config are free for ReclaimTempProto at the
+    // next adaptation, so the class is only full, and the classifier due
+    // for a reset, when it has no config holding protos left to evict.
+    if (!classify_adapt_evict_lru ||
+        EvictTempConfig(IClass, Class, true) < 0)
+      ++NumAdaptationsFailed;
     if (classify_learning_debug_level >= 1)
       cprintf("Cannot make new temp protos: maximum number exceeded.\n");
     return -1;
   }
 
-  ConfigId = AddIntConfig(IClass);
+  if (ConfigId < 0)
+    ConfigId = AddIntConfig(IClass);
+  else
+    FreeTempConfig(TempConfigFor(Class, ConfigId));
   ConvertConfig(TempProtoMask, ConfigId, IClass);
   Config = NewTempConfig(MaxProtoId);
+  Config->LastUsed = ++AdaptationClock;
   TempConfigFor(Class, ConfigId) = Config;
   copy_all_bits(TempProtoMask, Config->Protos, Config->ProtoVectorSize);
 
@@ -2088,6 +2280,106 @@ int Classify::MakeNewTemporaryConfig(ADAPT_TEMPLATES Templates,
   return ConfigId;
 }                              /* MakeNewTemporaryConfig */
 
+/*---------------------------------------------------------------------------*/
+/**
+ * This routine frees the slot of the least recently used
+ * temporary config of a class that has run out of configs,
+ * so that a new config can take its place instead of the
+ * whole adaptive classifier having to be reset.  The slot
+ * is left holding an empty temporary config, which matches
+ * nothing, until MakeNewTemporaryConfig replaces it.  The
+ * protos of the evicted config stay in the class until
+ * ReclaimTempProto needs their ids.  When a class runs out
+ * of protos instead, only configs still holding protos are
+ * worth evicting.
+ *
+ * @param IClass integer class to evict a config from
+ * @param Class adapted class to evict a config from
+ * @param HoldingProtos skip configs that were already emptied
+ *
+ * @return The id of the freed config, or -1 if there is no
+ * config to evict.
+ * @note Exceptions: none
+ */
+int Classify::EvictTempConfig(INT_CLASS IClass, ADAPT_CLASS Class,
+                              bool HoldingProtos) {
+  int Victim = -1;
+  int ConfigId;
+  int ProtoId;
+
+  for (ConfigId = 0; ConfigId < IClass->NumConfigs; ConfigId++) {
+    if (ConfigIsPermanent(Class, ConfigId))
+      continue;
+    if (HoldingProtos && IClass->ConfigLengths[ConfigId] == 0)
+      continue;
+    if (Victim < 0 || TempConfigFor(Class, ConfigId)->LastUsed <
+        TempConfigFor(Class, Victim)->LastUsed)
+      Victim = ConfigId;
+  }
+  if (Victim < 0)
+    return -1;
+
+  if (classify_learning_debug_level >= 1)
+    cprintf("Evicting temp config %d, seen %d times.\n",
+            Victim, TempConfigFor(Class, Victim)->NumTimesSeen);
+
+  for (ProtoId = 0; ProtoId < IClass->NumProtos; ProtoId++)
+    reset_bit(ProtoForProtoId(IClass, ProtoId)->Configs, Victim);
+  IClass->ConfigLengths[Victim] = 0;
+  FreeTempConfig(TempConfigFor(Class, Victim));
+  TempConfigFor(Class, Victim) = NewTempConfig(0);
+  NumTempConfigsEvicted++;
+  return Victim;
+}                              /* EvictTempConfig */
+
+/*---------------------------------------------------------------------------*/
+/**
+ * This routine finds a temporary proto of a class that has
+ * run out of protos which is no longer used by any config,
+ * as happens once the configs using it have been evicted,
+ * and frees it so that its id can be given to a new proto.
+ * Protos already in TempProtoMask are never reclaimed.  The
+ * proto pruner keeps the bits of the old proto, which only
+ * costs a little pruning power.
+ *
+ * @param IClass integer class to reclaim a proto from
+ * @param Class adapted class to reclaim a proto from
+ * @param TempProtoMask protos chosen for the config being built
+ *
+ * @return The id of the freed proto, or NO_PROTO if every
+ * proto is in use.
+ * @note Exceptions: none
+ */
+PROTO_ID Classify::ReclaimTempProto(INT_CLASS IClass,
+                                    ADAPT_CLASS Class,
+                                    BIT_VECTOR TempProtoMask) {
+  LIST Protos;
+  TEMP_PROTO TempProto;
+  INT_PROTO IProto;
+  PROTO_ID Pid;
+  int Word;
+
+  Protos = Class->TempProtos;
+  iterate(Protos) {
+    TempProto = (TEMP_PROTO) first_node(Protos);
+    Pid = TempProto->ProtoId;
+    if (test_bit(TempProtoMask, Pid))
+      continue;
+    IProto = ProtoForProtoId(IClass, Pid);
+    for (Word = 0; Word < WERDS_PER_CONFIG_VEC; Word++)
+      if (IProto->Configs[Word] != 0)
+        break;
+    if (Word < WERDS_PER_CONFIG_VEC)
+      continue;
+
+    Class->TempProtos = delete_d(Class->TempProtos, TempProto, NULL);
+    FreeTempProto(TempProto);
+    NumTempProtosReclaimed++;
+    return Pid;
+  }
+  return NO_PROTO;
+}                              /* ReclaimTempProto */
+
 /*---------------------------------------------------------------------------*/
 /**
  * This routine finds sets of sequential bad features
@@ -2158,6 +2450,8 @@ PROTO_ID Classify::MakeNewTempProtos(FEATURE_SET Features,
     A2 = F2->Params[PicoFeatDir];
 
     Pid = AddIntProto(IClass);
+    if (Pid == NO_PROTO && classify_adapt_evict_lru)
+      Pid = ReclaimTempProto(IClass, Class, TempProtoMask);
     if (Pid == NO_PROTO)
       return (NO_PROTO);
 
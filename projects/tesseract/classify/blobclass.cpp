@@ -48,6 +48,25 @@ extern char imagefile[];
             Public Code
 ----------------------------------------------------------------------------**/
 
+// Returns the font to label the features learned from the page filename
+// with: classify_font_name if set, else the [fontname] of a filename of
+// the form [lang].[fontname].exp[num].
+STRING TrainingFontName(const STRING& filename) {
+  STRING CurrFontName = classify_font_name;
+  if (CurrFontName == kUnknownFontName) {
+    // The [lang], [fontname] and [num] fields should not have '.' characters.
+    const char *basename = strrchr(filename.string(), '/');
+    const char *firstdot = strchr(basename ? basename : filename.string(), '.');
+    const char *lastdot  = strrchr(filename.string(), '.');
+    if (firstdot != lastdot && firstdot != NULL && lastdot != NULL) {
+      ++firstdot;
+      CurrFontName = firstdot;
+      CurrFontName[lastdot - firstdot] = '\0';
+    }
+  }
+  return CurrFontName;
+}
+
 /*---------------------------------------------------------------------------*/
 void LearnBlob(const FEATURE_DEFS_STRUCT &FeatureDefs, const STRING& filename,
                TBLOB * Blob, const DENORM& denorm, const char* BlobText) {
@@ -73,19 +92,7 @@ void LearnBlob(const FEATURE_DEFS_STRUCT &FeatureDefs, const STRING& filename,
   STRING Filename(filename);
 
   // If no fontname was set, try to extract it from the filename
-  STRING CurrFontName = classify_font_name;
-  if (CurrFontName == kUnknownFontName) {
-    // filename is expected to be of the form [lang].[fontname].exp[num]
-    // The [lang], [fontname] and [num] fields should not have '.' characters.
-    const char *basename = strrchr(filename.string(), '/');
-    const char *firstdot = strchr(basename ? basename : filename.string(), '.');
-    const char *lastdot  = strrchr(filename.string(), '.');
-    if (firstdot != lastdot && firstdot != NULL && lastdot != NULL) {
-      ++firstdot;
-      CurrFontName = firstdot;
-      CurrFontName[lastdot - firstdot] = '\0';
-    }
-  }
+  STRING CurrFontName = TrainingFontName(filename);
 
   // if a feature file is not yet open, open it
   // the name of the file is the name of the image plus TRAIN_SUFFIX
@@ -39,6 +39,11 @@
 /**----------------------------------------------------------------------------
           Public Function Prototypes
 ----------------------------------------------------------------------------**/
+// Returns the font to label the features learned from the page filename
+// with: classify_font_name if set, else the [fontname] of a filename of
+// the form [lang].[fontname].exp[num].
+STRING TrainingFontName(const STRING& filename);
+
 void LearnBlob(const FEATURE_DEFS_STRUCT &FeatureDefs, const STRING& filename,
                TBLOB * Blob, const DENORM& denorm, const char* BlobText);
 
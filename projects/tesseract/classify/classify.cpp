@@ -54,6 +54,12 @@ void delete_callback_fs(FontSet fs) {
 }
 
 namespace tesseract {
+ClassifierModel::ClassifierModel()
+  : unicharset_size(0), ref_count(0), templates(NULL), norm_protos(NULL),
+    all_protos_on(NULL), all_configs_on(NULL), all_protos_off(NULL),
+    all_configs_off(NULL) {
+}
+
 Classify::Classify()
   : INT_MEMBER(tessedit_single_match, FALSE,
                "Top choice only from CP", this->params()),
@@ -131,6 +137,10 @@ Classify::Classify()
     INT_MEMBER(classify_adapt_feature_threshold, 230,
                "Threshold for good features during adaptive 0-255",
                this->params()),
+    BOOL_MEMBER(classify_adapt_evict_lru, true,
+                "Evict least recently used temp configs from full classes"
+                " instead of resetting the adaptive classifier",
+                this->params()),
     BOOL_MEMBER(disable_character_fragments, TRUE,
                 "Do not include character fragments in the"
                 " results of the classifier", this->params()),
@@ -159,16 +169,11 @@ Classify::Classify()
     BOOL_MEMBER(classify_bln_numeric_mode, 0,
                 "Assume the input is numbers [0-9].", this->params()),
     dict_(&image_) {
-  fontinfo_table_.set_compare_callback(
-      NewPermanentTessCallback(compare_fontinfo));
-  fontinfo_table_.set_clear_callback(
-      NewPermanentTessCallback(delete_callback));
-  fontset_table_.set_compare_callback(
-      NewPermanentTessCallback(compare_font_set));
-  fontset_table_.set_clear_callback(
-      NewPermanentTessCallback(delete_callback_fs));
+  InitFontTables();
+  model_ = NULL;
   AdaptedTemplates = NULL;
   PreTrainedTemplates = NULL;
+  CharNormCutoffs = NULL;
   AllProtosOn = NULL;
   PrunedProtos = NULL;
   AllConfigsOn = NULL;
@@ -188,12 +193,16 @@ Classify::Classify()
   NumAmbigClassesTried = 0;
   NumClassesOutput = 0;
   NumAdaptationsFailed = 0;
+  NumTempConfigsEvicted = 0;
+  NumTempProtosReclaimed = 0;
+  AdaptationClock = 0;
 
   FeaturesHaveBeenExtracted = false;
   FeaturesOK = true;
   learn_debug_win_ = NULL;
   learn_fragmented_word_debug_win_ = NULL;
   learn_fragments_debug_win_ = NULL;
+  tr_file_ = NULL;
 }
 
 Classify::~Classify() {
@@ -203,4 +212,15 @@ Classify::~Classify() {
   delete learn_fragments_debug_win_;
 }
 
+void Classify::InitFontTables() {
+  fontinfo_table_.set_compare_callback(
+      NewPermanentTessCallback(compare_fontinfo));
+  fontinfo_table_.set_clear_callback(
+      NewPermanentTessCallback(delete_callback));
+  fontset_table_.set_compare_callback(
+      NewPermanentTessCallback(compare_font_set));
+  fontset_table_.set_clear_callback(
+      NewPermanentTessCallback(delete_callback_fs));
+}
+
 }  // namespace tesseract
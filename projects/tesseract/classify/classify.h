@@ -24,6 +24,7 @@
 #include "classify.h"
 #include "dict.h"
 #include "featdefs.h"
+#include "genericvector.h"
 #include "intfx.h"
 #include "intmatcher.h"
 #include "ratngs.h"
@@ -47,6 +48,28 @@ enum CharSegmentationType {
   CST_NGRAM      // Multiple characters.
 };
 
+// The read-only classifier data of a language: the pre-trained templates
+// with the cutoffs, norm protos and font tables loaded along with them, and
+// the constant proto and config masks. It is loaded once and shared by every
+// Classify that loads the same language, so that each of them only holds
+// its adapted templates and scratch space.
+struct ClassifierModel {
+  ClassifierModel();
+
+  STRING key;           // Language data path prefix, empty if adaptive only.
+  int unicharset_size;  // Size of the unicharset it was loaded against.
+  int ref_count;        // Number of Classify instances sharing it.
+  INT_TEMPLATES templates;
+  CLASS_CUTOFF_ARRAY char_norm_cutoffs;
+  NORM_PROTOS *norm_protos;
+  UnicityTable<FontInfo> fontinfo_table;
+  UnicityTable<FontSet> fontset_table;
+  BIT_VECTOR all_protos_on;
+  BIT_VECTOR all_configs_on;
+  BIT_VECTOR all_protos_off;
+  BIT_VECTOR all_configs_off;
+};
+
 class Classify : public CCStruct {
  public:
   Classify();
@@ -91,6 +114,11 @@ class Classify : public CCStruct {
   // If rejmap is not NULL, then only chars with a rejmap entry of '1' will
   // be learned, otherwise all chars with good correct_text are learned.
   void LearnWord(const char* filename, const char *rejmap, WERD_RES *word);
+  // While tr_file is not NULL, static training writes its features to it,
+  // labelled with the font of filename, instead of to the one file that
+  // LearnBlob keeps open for the whole process. Lets engines on different
+  // threads train at once. NULL restores the default.
+  void SetTrainingFile(FILE* tr_file, const STRING& filename);
 
   // Builds a blob of length fragments, from the word, starting at start,
   // and then learn it, as having the given correct_text.
@@ -105,6 +133,11 @@ class Classify : public CCStruct {
                    float threshold, CharSegmentationType segmentation,
                    const char* correct_text, WERD_RES *word);
   void InitAdaptiveClassifier(bool load_pre_trained_templates);
+  // Points the shared members at the ClassifierModel of the language,
+  // loading it if no other Classify has.
+  void AcquireClassifierModel(bool load_pre_trained_templates);
+  // Lets go of the ClassifierModel, freeing it if no other Classify uses it.
+  void ReleaseClassifierModel();
   void InitAdaptedClass(TBLOB *Blob,
                         CLASS_ID ClassId,
                         ADAPT_CLASS Class,
@@ -126,6 +159,8 @@ class Classify : public CCStruct {
                      const TBOX& blob_box,
                      CLASS_PRUNER_RESULTS results,
                      ADAPT_RESULTS* final_results);
+  // Fills in class_bounds_ from the top and bottom ranges of the unicharset.
+  void SetupClassBounds();
   void ConvertMatchesToChoices(ADAPT_RESULTS *Results,
                                BLOB_CHOICE_LIST *Choices);
   void AddNewResult(ADAPT_RESULTS *Results,
@@ -157,6 +192,10 @@ class Classify : public CCStruct {
                              int NumFeatures,
                              INT_FEATURE_ARRAY Features,
                              FEATURE_SET FloatFeatures);
+  int EvictTempConfig(INT_CLASS IClass, ADAPT_CLASS Class, bool HoldingProtos);
+  PROTO_ID ReclaimTempProto(INT_CLASS IClass,
+                            ADAPT_CLASS Class,
+                            BIT_VECTOR TempProtoMask);
   void MakePermanent(ADAPT_TEMPLATES Templates,
                      CLASS_ID ClassId,
                      int ConfigId,
@@ -242,11 +281,15 @@ class Classify : public CCStruct {
                            bool* pretrained_on);
   void ShowMatchDisplay();
   /* font detection ***********************************************************/
+  // The font tables of the pre-trained templates live in the shared
+  // ClassifierModel. Without templates, the instance has its own.
   UnicityTable<FontInfo>& get_fontinfo_table() {
-    return fontinfo_table_;
+    return model_ != NULL && model_->templates != NULL ?
+        model_->fontinfo_table : fontinfo_table_;
   }
   UnicityTable<FontSet>& get_fontset_table() {
-    return fontset_table_;
+    return model_ != NULL && model_->templates != NULL ?
+        model_->fontset_table : fontset_table_;
   }
   /* mfoutline.cpp ***********************************************************/
   void NormalizeOutlines(LIST Outlines, FLOAT32 *XScale, FLOAT32 *YScale);
@@ -311,6 +354,9 @@ class Classify : public CCStruct {
             "Threshold for good protos during adaptive 0-255");
   INT_VAR_H(classify_adapt_feature_threshold, 230,
             "Threshold for good features during adaptive 0-255");
+  BOOL_VAR_H(classify_adapt_evict_lru, true,
+             "Evict least recently used temp configs from full classes"
+             " instead of resetting the adaptive classifier");
   BOOL_VAR_H(disable_character_fragments, TRUE,
              "Do not include character fragments in the"
              " results of the classifier");
@@ -335,10 +381,12 @@ class Classify : public CCStruct {
             "Integer Matcher Multiplier  0-255:   ");
 
   // Use class variables to hold onto built-in templates and adapted templates.
+  // The built-in templates belong to model_.
   INT_TEMPLATES PreTrainedTemplates;
   ADAPT_TEMPLATES AdaptedTemplates;
 
   // Create dummy proto and config masks for use with the built-in templates.
+  // The constant ones belong to model_.
   BIT_VECTOR AllProtosOn;
   BIT_VECTOR PrunedProtos;
   BIT_VECTOR AllConfigsOn;
@@ -347,8 +395,11 @@ class Classify : public CCStruct {
   BIT_VECTOR TempProtoMask;
   bool EnableLearning;
   /* normmatch.cpp */
+  // Belongs to model_ once InitAdaptiveClassifier has loaded it.
   NORM_PROTOS *NormProtos;
   /* font detection ***********************************************************/
+  // ReadIntTemplates reads into these, and InitAdaptiveClassifier then moves
+  // them to model_.
   UnicityTable<FontInfo> fontinfo_table_;
   UnicityTable<FontSet> fontset_table_;
 
@@ -358,11 +409,16 @@ class Classify : public CCStruct {
  protected:
   IntegerMatcher im_;
   FEATURE_DEFS_STRUCT feature_defs_;
+  // Shared with the other Classify instances of the same language. NULL
+  // until InitAdaptiveClassifier.
+  ClassifierModel* model_;
   // Must be set for the classifier to operate. Ususally set in
   // Tesseract::recog_word_recursive, being the main word-level entry point.
   DENORM denorm_;
 
  private:
+  // Sets the callbacks of fontinfo_table_ and fontset_table_.
+  void InitFontTables();
 
   Dict dict_;
 
@@ -378,6 +434,10 @@ class Classify : public CCStruct {
   int NumAmbigClassesTried;
   int NumClassesOutput;
   int NumAdaptationsFailed;
+  int NumTempConfigsEvicted;
+  int NumTempProtosReclaimed;
+  // Ticks at every adaptation, to stamp TEMP_CONFIG::LastUsed.
+  uinT32 AdaptationClock;
 
   /* variables used to hold onto extracted features.  This is used
   to map from the old scheme in which baseline features and char norm
@@ -389,11 +449,25 @@ class Classify : public CCStruct {
   INT_FEATURE_ARRAY CharNormFeatures;
   INT_FX_RESULT_STRUCT FXInfo;
 
-  CLASS_CUTOFF_ARRAY CharNormCutoffs;
+  uinT16* CharNormCutoffs;  // Belongs to model_.
   CLASS_CUTOFF_ARRAY BaselineCutoffs;
+  // Vertical misfit bounds per class, in baseline-normalized coordinates,
+  // so MasterMatcher tests all its candidates without going through the
+  // unicharset. Classes never penalized as misfits get bounds that no blob
+  // falls outside of.
+  struct ClassBounds {
+    inT16 min_bottom;
+    inT16 max_bottom;
+    inT16 min_top;
+    inT16 max_top;
+  };
+  GenericVector<ClassBounds> class_bounds_;
   ScrollView* learn_debug_win_;
   ScrollView* learn_fragmented_word_debug_win_;
   ScrollView* learn_fragments_debug_win_;
+  // Set by SetTrainingFile. Not owned.
+  FILE* tr_file_;
+  STRING tr_font_name_;
 };
 }  // namespace tesseract
 
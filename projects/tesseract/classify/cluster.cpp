@@ -23,6 +23,9 @@
 #include "tprintf.h"
 #include "danerror.h"
 #include "freelist.h"
+#include "ccutil.h"
+#include "genericvector.h"
+#include "threadpool.h"
 #include <math.h>
 
 #define HOTELLING 1  // If true use Hotelling's test to decide where to split.
@@ -180,6 +183,7 @@ struct BUCKETS {
   uinT16 Bucket[BUCKETTABLESIZE];// mapping to histogram buckets
   uinT32 *Count;                 // frequency of occurence histogram
   FLOAT32 *ExpectedCount;        // expected histogram
+  FLOAT64 *Probability;          // expected fraction of samples per bucket
 };
 
 struct CHISTRUCT{
@@ -196,6 +200,21 @@ struct ClusteringContext {
   inT32 next;  // next candidate to be used
 };
 
+// One piece of the prototype list made by ComputePrototypesInParallel: a
+// prototype made while splitting the top of the cluster tree, or a subtree
+// whose prototypes are made by a worker thread. Pieces are kept in the
+// order in which ComputePrototypes would reach them.
+struct PROTOPIECE {
+  PROTOTYPE *Prototype;
+  CLUSTER *Subtree;
+  GenericVector<PROTOTYPE *> Prototypes;  // made from Subtree, in order
+};
+
+// Guard the caches of histograms and chi-squared values, which are shared
+// by the threads of ComputePrototypesInParallel.
+static tesseract::CCUtilMutex bucket_cache_mutex;
+static tesseract::CCUtilMutex chi_cache_mutex;
+
 typedef FLOAT64 (*DENSITYFUNC) (inT32);
 typedef FLOAT64 (*SOLVEFUNC) (CHISTRUCT *, double);
 
@@ -256,6 +275,21 @@ register FLOAT32 m1[], register FLOAT32 m2[]);
 
 void ComputePrototypes(CLUSTERER *Clusterer, CLUSTERCONFIG *Config);
 
+void ComputePrototypesInParallel(CLUSTERER *Clusterer,
+                                 CLUSTERCONFIG *Config,
+                                 int NumThreads);
+
+void MakeTreePrototypes(CLUSTERER *Clusterer,
+                        CLUSTERCONFIG *Config,
+                        CLUSTER *Root,
+                        GenericVector<PROTOTYPE *> *Prototypes);
+
+void SplitClusterTree(CLUSTERER *Clusterer,
+                      CLUSTERCONFIG *Config,
+                      CLUSTER *Root,
+                      inT32 MaxSubtreeSamples,
+                      GenericVector<PROTOPIECE *> *Pieces);
+
 PROTOTYPE *MakePrototype(CLUSTERER *Clusterer,
                          CLUSTERCONFIG *Config,
                          CLUSTER *Cluster);
@@ -517,6 +551,31 @@ LIST ClusterSamples(CLUSTERER *Clusterer, CLUSTERCONFIG *Config) {
 }                                // ClusterSamples
 
 
+/** ClusterSamplesInParallel ************************************************
+Parameters:	Clusterer	data struct containing samples to be clustered
+      Config		parameters which control clustering process
+      NumThreads	threads to use, or <= 0 for one per processor
+Operation:	This routine does the same as ClusterSamples, but tests
+      independent subtrees of the cluster tree for prototypes
+      on a pool of NumThreads threads.  The prototypes, and their
+      order in the list, are the same as those of ClusterSamples.
+      The cluster tree itself is still built on the calling thread.
+Return:		Pointer to a list of prototypes
+Exceptions:	None
+*******************************************************************************/
+LIST ClusterSamplesInParallel(CLUSTERER *Clusterer, CLUSTERCONFIG *Config,
+                              int NumThreads) {
+  if (Clusterer->Root == NULL)
+    CreateClusterTree(Clusterer);
+
+  FreeProtoList (&Clusterer->ProtoList);
+  Clusterer->ProtoList = NIL_LIST;
+
+  ComputePrototypesInParallel(Clusterer, Config, NumThreads);
+  return (Clusterer->ProtoList);
+}                                // ClusterSamplesInParallel
+
+
 /** FreeClusterer *************************************************************
 Parameters:	Clusterer	pointer to data structure to be freed
 Operation:	This routine frees all of the memory allocated to the
@@ -920,14 +979,39 @@ Exceptions:	None
 History:	5/30/89, DSJ, Created.
 *******************************************************************************/
 void ComputePrototypes(CLUSTERER *Clusterer, CLUSTERCONFIG *Config) {
+  GenericVector<PROTOTYPE *> Prototypes;
+  int i;
+
+  if (Clusterer->Root != NULL)
+    MakeTreePrototypes(Clusterer, Config, Clusterer->Root, &Prototypes);
+  for (i = 0; i < Prototypes.size(); i++)
+    Clusterer->ProtoList = push (Clusterer->ProtoList, Prototypes[i]);
+}                                // ComputePrototypes
+
+
+/** MakeTreePrototypes ******************************************************
+Parameters:	Clusterer	data structure holding cluster tree
+      Config		parameters used to control prototype generation
+      Root		root of the part of the cluster tree to analyze
+      Prototypes	vector to append the new prototypes to
+Operation:	This routine decides which clusters under Root should
+      be represented by prototypes, and appends the prototypes to
+      Prototypes in the order in which they are made.  Clusters
+      are analyzed depth first, left before right.
+Return:		None
+Exceptions:	None
+*******************************************************************************/
+void MakeTreePrototypes(CLUSTERER *Clusterer,
+                        CLUSTERCONFIG *Config,
+                        CLUSTER *Root,
+                        GenericVector<PROTOTYPE *> *Prototypes) {
   LIST ClusterStack = NIL_LIST;
   CLUSTER *Cluster;
   PROTOTYPE *Prototype;
 
   // use a stack to keep track of clusters waiting to be processed
   // initially the only cluster on the stack is the root cluster
-  if (Clusterer->Root != NULL)
-    ClusterStack = push (NIL_LIST, Clusterer->Root);
+  ClusterStack = push (NIL_LIST, Root);
 
   // loop until we have analyzed all clusters which are potential prototypes
   while (ClusterStack != NIL_LIST) {
@@ -938,14 +1022,143 @@ void ComputePrototypes(CLUSTERER *Clusterer, CLUSTERCONFIG *Config) {
     ClusterStack = pop (ClusterStack);
     Prototype = MakePrototype(Clusterer, Config, Cluster);
     if (Prototype != NULL) {
-      Clusterer->ProtoList = push (Clusterer->ProtoList, Prototype);
+      Prototypes->push_back(Prototype);
     }
     else {
       ClusterStack = push (ClusterStack, Cluster->Right);
       ClusterStack = push (ClusterStack, Cluster->Left);
     }
   }
-}                                // ComputePrototypes
+}                                // MakeTreePrototypes
+
+
+// Makes the prototypes of one subtree on a worker thread.
+class SubtreePrototypesTask : public TessClosure {
+ public:
+  SubtreePrototypesTask(CLUSTERER *Clusterer, CLUSTERCONFIG *Config,
+                        PROTOPIECE *Piece)
+    : Clusterer_(Clusterer), Config_(Config), Piece_(Piece) {}
+  virtual void Run() {
+    MakeTreePrototypes(Clusterer_, Config_, Piece_->Subtree,
+                       &Piece_->Prototypes);
+  }
+
+ private:
+  CLUSTERER *Clusterer_;
+  CLUSTERCONFIG *Config_;
+  PROTOPIECE *Piece_;
+};
+
+
+/** ComputePrototypesInParallel *********************************************
+Parameters:	Clusterer	data structure holding cluster tree
+      Config		parameters used to control prototype generation
+      NumThreads	threads to use, or <= 0 for one per processor
+Operation:	This routine makes the same prototype list as
+      ComputePrototypes.  The top of the cluster tree is analyzed
+      on the calling thread until it has been cut into subtrees of
+      at most MaxSubtreeSamples samples, several per thread.  Each
+      subtree is then analyzed by MakeTreePrototypes on a thread
+      of a pool, and the results are put back together in the
+      order in which ComputePrototypes would have made them.
+Return:		None
+Exceptions:	None
+*******************************************************************************/
+#define SUBTREESPERTHREAD 8
+void ComputePrototypesInParallel(CLUSTERER *Clusterer,
+                                 CLUSTERCONFIG *Config,
+                                 int NumThreads) {
+  GenericVector<PROTOPIECE *> Pieces;
+  tesseract::ThreadPool *Pool;
+  SubtreePrototypesTask *Task;
+  inT32 MaxSubtreeSamples;
+  int NumPieces;
+  int i, j;
+
+  if (Clusterer->Root == NULL)
+    return;
+
+  Pool = new tesseract::ThreadPool(NumThreads);
+  NumPieces = SUBTREESPERTHREAD *
+    (Pool->num_threads() > 0 ? Pool->num_threads() : 1);
+  MaxSubtreeSamples = Clusterer->Root->SampleCount / NumPieces;
+  if (MaxSubtreeSamples < 1)
+    MaxSubtreeSamples = 1;
+  SplitClusterTree(Clusterer, Config, Clusterer->Root,
+                   MaxSubtreeSamples, &Pieces);
+
+  // Pieces is complete, so pointers into it stay valid while tasks run.
+  for (i = 0; i < Pieces.size(); i++) {
+    if (Pieces[i]->Subtree == NULL)
+      continue;
+    Task = new SubtreePrototypesTask(Clusterer, Config, Pieces[i]);
+    if (Pool->num_threads() > 0) {
+      Pool->Schedule(Task);
+    } else {
+      Task->Run();
+      delete Task;
+    }
+  }
+  Pool->WaitIdle();
+  delete Pool;
+
+  for (i = 0; i < Pieces.size(); i++) {
+    if (Pieces[i]->Prototype != NULL)
+      Clusterer->ProtoList = push (Clusterer->ProtoList, Pieces[i]->Prototype);
+    for (j = 0; j < Pieces[i]->Prototypes.size(); j++)
+      Clusterer->ProtoList = push (Clusterer->ProtoList,
+                                   Pieces[i]->Prototypes[j]);
+  }
+  Pieces.delete_data_pointers();
+}                                // ComputePrototypesInParallel
+
+
+/** SplitClusterTree ********************************************************
+Parameters:	Clusterer	data structure holding cluster tree
+      Config		parameters used to control prototype generation
+      Root		root of the cluster tree to split
+      MaxSubtreeSamples	largest subtree handed to a worker
+      Pieces		vector to append the pieces of the proto list to
+Operation:	This routine walks the cluster tree in the same order as
+      MakeTreePrototypes.  A cluster of at most MaxSubtreeSamples
+      samples becomes a subtree piece for a worker to analyze.  A
+      larger cluster is analyzed here: it becomes a prototype
+      piece if a prototype can be made from it, and is split
+      otherwise.
+Return:		None
+Exceptions:	None
+*******************************************************************************/
+void SplitClusterTree(CLUSTERER *Clusterer,
+                      CLUSTERCONFIG *Config,
+                      CLUSTER *Root,
+                      inT32 MaxSubtreeSamples,
+                      GenericVector<PROTOPIECE *> *Pieces) {
+  LIST ClusterStack = NIL_LIST;
+  CLUSTER *Cluster;
+  PROTOTYPE *Prototype;
+  PROTOPIECE *Piece;
+
+  // an explicit stack, as in MakeTreePrototypes, since cluster trees
+  // can be far too deep to recurse down
+  ClusterStack = push (NIL_LIST, Root);
+  while (ClusterStack != NIL_LIST) {
+    Cluster = (CLUSTER *) first_node (ClusterStack);
+    ClusterStack = pop (ClusterStack);
+    Prototype = NULL;
+    if (Cluster->SampleCount > MaxSubtreeSamples) {
+      Prototype = MakePrototype(Clusterer, Config, Cluster);
+      if (Prototype == NULL) {
+        ClusterStack = push (ClusterStack, Cluster->Right);
+        ClusterStack = push (ClusterStack, Cluster->Left);
+        continue;
+      }
+    }
+    Piece = new PROTOPIECE;
+    Piece->Prototype = Prototype;
+    Piece->Subtree = Prototype == NULL ? Cluster : NULL;
+    Pieces->push_back(Piece);
+  }
+}                                // SplitClusterTree
 
 
 /** MakePrototype ***********************************************************
@@ -1708,6 +1921,7 @@ BUCKETS *GetBuckets(CLUSTERER* clusterer,
   // search for an old bucket structure with the same number of buckets
   LIST *bucket_cache = clusterer->bucket_cache;
   uinT16 NumberOfBuckets = OptimumNumberOfBuckets(SampleCount);
+  bucket_cache_mutex.Lock();
   BUCKETS *Buckets = (BUCKETS *) first_node(search(
       bucket_cache[(int)Distribution], &NumberOfBuckets,
       NumBucketsMatch));
@@ -1716,6 +1930,9 @@ BUCKETS *GetBuckets(CLUSTERER* clusterer,
   if (Buckets != NULL) {
     bucket_cache[(int) Distribution] =
         delete_d(bucket_cache[(int) Distribution], Buckets, ListEntryMatch);
+  }
+  bucket_cache_mutex.Unlock();
+  if (Buckets != NULL) {
     if (SampleCount != Buckets->SampleCount)
       AdjustBuckets(Buckets, SampleCount);
     if (Confidence != Buckets->Confidence) {
@@ -1778,12 +1995,14 @@ BUCKETS *MakeBuckets(DISTRIBUTION Distribution,
     (uinT32 *) Emalloc(Buckets->NumberOfBuckets * sizeof (uinT32));
   Buckets->ExpectedCount =
     (FLOAT32 *) Emalloc(Buckets->NumberOfBuckets * sizeof (FLOAT32));
+  Buckets->Probability =
+    (FLOAT64 *) Emalloc(Buckets->NumberOfBuckets * sizeof (FLOAT64));
 
   // initialize simple fields
   Buckets->Distribution = Distribution;
   for (i = 0; i < Buckets->NumberOfBuckets; i++) {
     Buckets->Count[i] = 0;
-    Buckets->ExpectedCount[i] = 0.0;
+    Buckets->Probability[i] = 0.0;
   }
 
   // all currently defined distributions are symmetrical
@@ -1815,23 +2034,26 @@ BUCKETS *MakeBuckets(DISTRIBUTION Distribution,
         NextBucketBoundary += BucketProbability;
       }
       Buckets->Bucket[i] = CurrentBucket;
-      Buckets->ExpectedCount[CurrentBucket] +=
-        (FLOAT32) (ProbabilityDelta * SampleCount);
+      Buckets->Probability[CurrentBucket] += ProbabilityDelta;
       LastProbDensity = ProbDensity;
     }
     // place any leftover probability into the last bucket
-    Buckets->ExpectedCount[CurrentBucket] +=
-      (FLOAT32) ((0.5 - Probability) * SampleCount);
+    Buckets->Probability[CurrentBucket] += 0.5 - Probability;
 
     // copy upper half of distribution to lower half
     for (i = 0, j = BUCKETTABLESIZE - 1; i < j; i++, j--)
       Buckets->Bucket[i] =
         Mirror(Buckets->Bucket[j], Buckets->NumberOfBuckets);
 
-    // copy upper half of expected counts to lower half
+    // copy upper half of probabilities to lower half
     for (i = 0, j = Buckets->NumberOfBuckets - 1; i <= j; i++, j--)
-      Buckets->ExpectedCount[i] += Buckets->ExpectedCount[j];
+      Buckets->Probability[i] += Buckets->Probability[j];
   }
+  // the expected counts depend only on the probabilities and SampleCount,
+  // so a histogram taken from the cache matches a new one exactly
+  for (i = 0; i < Buckets->NumberOfBuckets; i++)
+    Buckets->ExpectedCount[i] =
+      (FLOAT32) (Buckets->Probability[i] * SampleCount);
   return Buckets;
 }                                // MakeBuckets
 
@@ -1917,6 +2139,7 @@ ComputeChiSquared (uinT16 DegreesOfFreedom, FLOAT64 Alpha)
      for the specified number of degrees of freedom.  Search the list for
      the desired chi-squared. */
   SearchKey.Alpha = Alpha;
+  chi_cache_mutex.Lock();
   OldChiSquared = (CHISTRUCT *) first_node (search (ChiWith[DegreesOfFreedom],
     &SearchKey, AlphaMatch));
 
@@ -1931,6 +2154,7 @@ ComputeChiSquared (uinT16 DegreesOfFreedom, FLOAT64 Alpha)
   else {
     // further optimization might move OldChiSquared to front of list
   }
+  chi_cache_mutex.Unlock();
 
   return (OldChiSquared->ChiSquared);
 
@@ -2261,7 +2485,9 @@ void FreeBuckets(CLUSTERER* clusterer, BUCKETS *buckets) {
   LIST *bucket_cache = clusterer->bucket_cache;
   if (buckets != NULL) {
     int dist = (int)buckets->Distribution;
+    bucket_cache_mutex.Lock();
     bucket_cache[dist] = (LIST) push(bucket_cache[dist], buckets);
+    bucket_cache_mutex.Unlock();
   }
 }                                // FreeBuckets
 
@@ -2368,21 +2594,20 @@ void AdjustBuckets(BUCKETS *Buckets, uinT32 NewSampleCount) {
  **		Buckets		histogram data structure to adjust
  **		NewSampleCount	new sample count to adjust to
  **	Operation:
- **		This routine multiplies each ExpectedCount histogram entry
- **		by NewSampleCount/OldSampleCount so that the histogram
- **		is now adjusted to the new sample count.
+ **		This routine recomputes each ExpectedCount histogram entry
+ **		from the bucket probabilities so that the histogram
+ **		is now adjusted to the new sample count.  The result does
+ **		not depend on the sample counts the histogram was used for
+ **		before.
  **	Return: none
  **	Exceptions: none
  **	History: Thu Aug  3 14:31:14 1989, DSJ, Created.
  */
   int i;
-  FLOAT64 AdjustFactor;
-
-  AdjustFactor = (((FLOAT64) NewSampleCount) /
-    ((FLOAT64) Buckets->SampleCount));
 
   for (i = 0; i < Buckets->NumberOfBuckets; i++) {
-    Buckets->ExpectedCount[i] *= AdjustFactor;
+    Buckets->ExpectedCount[i] =
+      (FLOAT32) (Buckets->Probability[i] * NewSampleCount);
   }
 
   Buckets->SampleCount = NewSampleCount;
@@ -2602,8 +2827,7 @@ CLUSTER * Cluster, FLOAT32 MaxIllegal)
  */
 #define ILLEGAL_CHAR    2
 {
-  static BOOL8 *CharFlags = NULL;
-  static inT32 NumFlags = 0;
+  BOOL8 *CharFlags;
   int i;
   LIST SearchState;
   SAMPLE *Sample;
@@ -2616,14 +2840,10 @@ CLUSTER * Cluster, FLOAT32 MaxIllegal)
   NumCharInCluster = Cluster->SampleCount;
   NumIllegalInCluster = 0;
 
-  if (Clusterer->NumChar > NumFlags) {
-    if (CharFlags != NULL)
-      memfree(CharFlags);
-    NumFlags = Clusterer->NumChar;
-    CharFlags = (BOOL8 *) Emalloc (NumFlags * sizeof (BOOL8));
-  }
-
-  for (i = 0; i < NumFlags; i++)
+  // the flags are allocated per call, so that clusters can be checked on
+  // several threads at once
+  CharFlags = (BOOL8 *) Emalloc (Clusterer->NumChar * sizeof (BOOL8));
+  for (i = 0; i < Clusterer->NumChar; i++)
     CharFlags[i] = FALSE;
 
   // find each sample in the cluster and check if we have seen it before
@@ -2640,10 +2860,13 @@ CLUSTER * Cluster, FLOAT32 MaxIllegal)
       }
       NumCharInCluster--;
       PercentIllegal = (FLOAT32) NumIllegalInCluster / NumCharInCluster;
-      if (PercentIllegal > MaxIllegal)
+      if (PercentIllegal > MaxIllegal) {
+        memfree(CharFlags);
         return (TRUE);
+      }
     }
   }
+  memfree(CharFlags);
   return (FALSE);
 
 }                                // MultipleCharSamples
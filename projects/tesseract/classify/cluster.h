@@ -107,6 +107,9 @@ SAMPLE *MakeSample (CLUSTERER * Clusterer, FLOAT32 Feature[], inT32 CharID);
 
 LIST ClusterSamples(CLUSTERER *Clusterer, CLUSTERCONFIG *Config);
 
+LIST ClusterSamplesInParallel(CLUSTERER *Clusterer, CLUSTERCONFIG *Config,
+                              int NumThreads);
+
 void FreeClusterer(CLUSTERER *Clusterer);
 
 void FreeProtoList(LIST *ProtoList);
@@ -29,6 +29,7 @@
 #include "scanutils.h"
 #include "serialis.h"
 #include "unichar.h"
+#include "unicharset.h"
 
 #define REALLY_QUOTE_IT(x) QUOTE_IT(x)
 
@@ -43,16 +44,36 @@ void Classify::ReadNewCutoffs(FILE *CutoffFile, inT64 end_offset,
                               CLASS_CUTOFF_ARRAY Cutoffs) {
 /*
  **	Parameters:
- **		Filename	name of file containing cutoff definitions
+ **		CutoffFile	file containing cutoff definitions
+ **		end_offset	file offset where the definitions end, or -1
  **		Cutoffs		array to put cutoffs into
  **	Globals: none
- **	Operation: Open Filename, read in all of the class-id/cutoff pairs
+ **	Operation: Read the cutoffs of the classes of this classifier's
+ **		unicharset with ReadCutoffs.
+ **	Return: none
+ **	Exceptions: none
+ **	History: Wed Feb 20 09:38:26 1991, DSJ, Created.
+ */
+  ReadCutoffs(CutoffFile, end_offset, unicharset, Cutoffs);
+}                                /* ReadNewCutoffs */
+
+
+/*---------------------------------------------------------------------------*/
+void ReadCutoffs(FILE *CutoffFile, inT64 end_offset,
+                 const UNICHARSET &unicharset, CLASS_CUTOFF_ARRAY Cutoffs) {
+/*
+ **	Parameters:
+ **		CutoffFile	file containing cutoff definitions
+ **		end_offset	file offset where the definitions end, or -1
+ **		unicharset	unichars the class ids refer to
+ **		Cutoffs		array to put cutoffs into
+ **	Globals: none
+ **	Operation: Read in all of the class-id/cutoff pairs
  **		and insert them into the Cutoffs array.  Cutoffs are
  **		indexed in the array by class id.  Unused entries in the
  **		array are set to an arbitrarily high cutoff value.
  **	Return: none
  **	Exceptions: none
- **	History: Wed Feb 20 09:38:26 1991, DSJ, Created.
  */
   char Class[UNICHAR_LEN + 1];
   CLASS_ID ClassId;
@@ -73,6 +94,59 @@ void Classify::ReadNewCutoffs(FILE *CutoffFile, inT64 end_offset,
     Cutoffs[ClassId] = Cutoff;
     SkipNewline(CutoffFile);
   }
-}                                /* ReadNewCutoffs */
+}                                /* ReadCutoffs */
+
+
+/*---------------------------------------------------------------------------*/
+void WriteCompiledCutoffs(FILE *File, int NumClasses,
+                          const CLASS_CUTOFF_ARRAY Cutoffs) {
+/*
+ **	Parameters:
+ **		File		open file to write to
+ **		NumClasses	number of classes in the unicharset
+ **		Cutoffs		cutoffs read by ReadCutoffs
+ **	Globals: none
+ **	Operation: Write the cutoffs of the first NumClasses class ids
+ **		in the compiled form read by ReadCompiledCutoffs: the
+ **		number of classes, then the cutoffs in class id order, in
+ **		the byte order of this machine.
+ **	Return: none
+ **	Exceptions: none
+ */
+  inT32 Count = NumClasses;
+
+  fwrite(&Count, sizeof(Count), 1, File);
+  fwrite(Cutoffs, sizeof(Cutoffs[0]), NumClasses, File);
+}                                /* WriteCompiledCutoffs */
+
+
+/*---------------------------------------------------------------------------*/
+bool ReadCompiledCutoffs(FILE *File, int NumClasses,
+                         CLASS_CUTOFF_ARRAY Cutoffs) {
+/*
+ **	Parameters:
+ **		File		open file positioned at compiled cutoffs
+ **		NumClasses	number of classes in the current unicharset
+ **		Cutoffs		array to put cutoffs into
+ **	Globals: none
+ **	Operation: Read cutoffs written by WriteCompiledCutoffs with a
+ **		single read.  Unused entries in the array are set to an
+ **		arbitrarily high cutoff value, as by ReadCutoffs.
+ **	Return: FALSE if the cutoffs were compiled against a unicharset
+ **		of a different size, or the file is too short.
+ **	Exceptions: none
+ */
+  inT32 Count;
+  int i;
+
+  if (fread(&Count, sizeof(Count), 1, File) != 1 || Count != NumClasses ||
+      Count < 0 || Count > MAX_NUM_CLASSES ||
+      fread(Cutoffs, sizeof(Cutoffs[0]), Count, File) !=
+      static_cast<size_t>(Count))
+    return false;
+  for (i = Count; i < MAX_NUM_CLASSES; i++)
+    Cutoffs[i] = MAX_CUTOFF;
+  return true;
+}                                /* ReadCompiledCutoffs */
 
 }  // namespace tesseract
@@ -23,12 +23,27 @@
 ----------------------------------------------------------------------------**/
 #include "matchdefs.h"
 
+#include <stdio.h>
+
 typedef uinT16 CLASS_CUTOFF_ARRAY[MAX_NUM_CLASSES];
 
+class UNICHARSET;
+
 /**----------------------------------------------------------------------------
           Public Function Prototypes
 ----------------------------------------------------------------------------**/
 
+namespace tesseract {
+void ReadCutoffs(FILE *CutoffFile, inT64 end_offset,
+                 const UNICHARSET &unicharset, CLASS_CUTOFF_ARRAY Cutoffs);
+
+void WriteCompiledCutoffs(FILE *File, int NumClasses,
+                          const CLASS_CUTOFF_ARRAY Cutoffs);
+
+bool ReadCompiledCutoffs(FILE *File, int NumClasses,
+                         CLASS_CUTOFF_ARRAY Cutoffs);
+}  // namespace tesseract
+
 /*
 #if defined(__STDC__) || defined(__cplusplus)
 # define _ARGS(s) s